@@ -24,6 +24,19 @@ namespace geodesy::core::gfx {
 	class mesh : public phys::mesh {
 	public:
 
+		// Reduced precision vertex layout for bandwidth bound passes. Position stays in full
+		// precision, the remaining attributes are stored as half and padded to four components
+		// since R16G16B16A16_SFLOAT is the widely supported 16 bit vertex format. Bind with
+		// the explicit format overload of pipeline::rasterizer::bind.
+		struct packed_vertex {
+			math::vec<float, 3> 			Position;
+			math::vec<math::half, 4> 		Normal;
+			math::vec<math::half, 4> 		Tangent;
+			math::vec<math::half, 4> 		Bitangent;
+			math::vec<math::half, 4> 		TextureCoordinate;
+			math::vec<math::half, 4> 		Color;
+		};
+
 		struct instance {
 
 			struct uniform_data {
@@ -71,6 +84,9 @@ namespace geodesy::core::gfx {
 		mesh(const aiMesh* aMesh);
 		mesh(std::shared_ptr<gpu::context> aContext, std::shared_ptr<mesh> aMesh);
 
+		// Converts host vertices to the packed layout, opt in, the default vertex buffer is unchanged.
+		static std::vector<packed_vertex> pack(const std::vector<vertex>& aVertex);
+
 	};
 
 }
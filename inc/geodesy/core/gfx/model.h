@@ -54,6 +54,8 @@ namespace geodesy::core::gfx {
 		std::shared_ptr<gfx::node>						Hierarchy;			// Root Node Hierarchy 
 		std::vector<phys::animation> 					Animation; 			// Overrides Bind Pose Transform
 		std::vector<std::shared_ptr<mesh>> 				Mesh;
+		std::vector<std::vector<std::shared_ptr<phys::mesh>>> 	CollisionMesh; 	// Convex pieces per mesh, shared by every node instancing it.
+		phys::collision::hull_report 					CollisionReport; 	// Vertex reduction from render to collision meshes.
 		std::vector<std::shared_ptr<material>> 			Material;
 		std::vector<std::shared_ptr<gpu::image>> 		Texture;
 		std::vector<light> 								Light;				// Not Relevant To Model, open as stage.
@@ -61,7 +63,7 @@ namespace geodesy::core::gfx {
 		// std::shared_ptr<gpu::buffer> 					UniformBuffer;
 
 		model();
-		model(std::string aFilePath, file::manager* aFileManager = nullptr);
+		model(std::string aFilePath, file::manager* aFileManager = nullptr, const phys::collision::hull_create_info& aHullCreateInfo = phys::collision::hull_create_info());
 		model(std::shared_ptr<gpu::context> aContext, std::shared_ptr<model> aModel, gpu::image::create_info aCreateInfo = {});
 		~model();
 
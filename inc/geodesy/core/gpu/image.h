@@ -451,6 +451,10 @@ namespace geodesy::core::gpu {
 
 		VkMemoryRequirements memory_requirements() const;
 
+		// Converts host pixel data between 32 and 16 bit float formats with the same channel
+		// count, i.e. R32G32B32A32_SFLOAT <-> R16G16B16A16_SFLOAT. Must be called before device upload.
+		void convert(format aFormat);
+
 		// Checks if the image has an alpha channel.
 		bool has_alpha_channel() const;
 
@@ -148,6 +148,8 @@ namespace geodesy::core::gpu {
 
 			// bind maps the vertex attributes in the shader to where the vertex buffer is intended to be bound.
 			void bind(uint32_t aBindingIndex, size_t aVertexStride, uint32_t aLocationIndex, size_t aVertexOffset, input_rate aInputRate = input_rate::VERTEX);
+			// Same as above, but overrides the reflected attribute format, i.e. a vec3 shader input fed from R16G16B16A16_SFLOAT data.
+			void bind(uint32_t aBindingIndex, size_t aVertexStride, uint32_t aLocationIndex, size_t aVertexOffset, image::format aFormat, input_rate aInputRate = input_rate::VERTEX);
 
 			// attach attaches an image to a pipeline's output, conveying the format and layout of the image during rendering.
 			void attach(uint32_t aAttachmentIndex, std::shared_ptr<image> aAttachmentImage, image::layout aImageLayout = image::layout::SHADER_READ_ONLY_OPTIMAL);
@@ -4,6 +4,7 @@
 
 #include "io/file.h"
 #include "io/dynalib.h"
+#include "io/mapped_file.h"
 #include "io/socket.h"
 
 #endif // !GEODESY_CORE_IO_H
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef GEODESY_CORE_IO_MAPPED_FILE_H
+#define GEODESY_CORE_IO_MAPPED_FILE_H
+
+/*
+* Read/write memory mapping of a scratch file, used as paging space for data
+* sets larger than memory. The file is created (or truncated) at the requested
+* size on construction and removed on destruction, so its contents only live
+* as long as the mapping. Pages are loaded on demand by the operating system,
+* release() hands a range back to the operating system so it stops counting
+* against the resident memory of the process, its contents stay in the file.
+*/
+
+#include "../../config.h"
+
+namespace geodesy::core::io {
+
+	class mapped_file {
+	public:
+
+		std::string		Path;
+		size_t			Size;
+		void*			Data;
+		void*			Handle;
+		void*			MappingHandle;
+
+		// Granularity release() works at, ranges should be aligned to it.
+		static size_t page_size();
+
+		mapped_file();
+		mapped_file(std::string aPath, size_t aSize);
+		~mapped_file();
+
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+
+		// Schedules write back of a modified range.
+		void flush(size_t aOffset, size_t aSize);
+		// Writes back and drops a range from the resident set.
+		void release(size_t aOffset, size_t aSize);
+
+	};
+
+}
+
+#endif // !GEODESY_CORE_IO_MAPPED_FILE_H
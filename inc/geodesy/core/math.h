@@ -4,10 +4,17 @@
 
 #include "math/config.h"
 #include "math/constants.h"
+#include "math/simd.h"
 #include "math/complex.h"
 #include "math/quaternion.h"
 #include "math/vec.h"
+#include "math/half.h"
 #include "math/mat.h"
+#include "math/affine.h"
 #include "math/field.h"
+#include "math/chunked_field.h"
+#include "math/fft.h"
+#include "math/multigrid.h"
+#include "math/batch.h"
 
 #endif // !GEODESY_CORE_MATH_H
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+#ifndef GEODESY_CORE_MATH_AFFINE_H
+#define GEODESY_CORE_MATH_AFFINE_H
+
+// ------------------------------ affine.h ------------------------------ //
+/*
+Compact representation of an affine transform as a 3x3 linear part and a
+translation, equivalent to the upper 3x4 block of a mat<T, 4, 4> whose last
+row is (0, 0, 0, 1). Scene graph transforms are always of this form, so
+composing two of them costs a 3x3 product plus a matrix vector product
+instead of a full 4x4 product, and the implicit bottom row never has to be
+stored or multiplied. Expand to mat<T, 4, 4> only when the data has to be
+handed to the GPU.
+// Example usage:
+affine<float> Model(Position, Orientation, Scale);
+affine<float> World = Parent * Model;
+vec<float, 3> P = World.transform_point(vec<float, 3>(1.0f, 0.0f, 0.0f));
+mat<float, 4, 4> Uniform = mat<float, 4, 4>(World);
+*/
+
+#include "config.h"
+#include "quaternion.h"
+#include "vec.h"
+#include "mat.h"
+
+namespace geodesy::core::math {
+
+	template <typename T>
+	class affine {
+	public:
+
+		mat<T, 3, 3>		Linear;				// Rotation, scale and shear.
+		vec<T, 3>			Translation;		// Applied after the linear part.
+
+		// Identity transform.
+		affine() {
+			Linear = {
+				1.0f, 0.0f, 0.0f,
+				0.0f, 1.0f, 0.0f,
+				0.0f, 0.0f, 1.0f
+			};
+			Translation = { 0.0f, 0.0f, 0.0f };
+		}
+
+		affine(const mat<T, 3, 3>& aLinear, const vec<T, 3>& aTranslation) : Linear(aLinear), Translation(aTranslation) {}
+
+		// Builds T * R * S directly, the rotation columns are scaled in place.
+		affine(const vec<T, 3>& aPosition, const quaternion<T>& aOrientation, const vec<T, 3>& aScale) {
+			const T w = aOrientation[0];
+			const T x = aOrientation[1];
+			const T y = aOrientation[2];
+			const T z = aOrientation[3];
+
+			const T xx = x * x,  yy = y * y,  zz = z * z;
+			const T xy = x * y,  xz = x * z,  yz = y * z;
+			const T wx = w * x,  wy = w * y,  wz = w * z;
+
+			Linear(0,0) = (1.0 - 2.0 * (yy + zz)) * aScale[0];
+			Linear(1,0) = (      2.0 * (xy + wz)) * aScale[0];
+			Linear(2,0) = (      2.0 * (xz - wy)) * aScale[0];
+			Linear(0,1) = (      2.0 * (xy - wz)) * aScale[1];
+			Linear(1,1) = (1.0 - 2.0 * (xx + zz)) * aScale[1];
+			Linear(2,1) = (      2.0 * (yz + wx)) * aScale[1];
+			Linear(0,2) = (      2.0 * (xz + wy)) * aScale[2];
+			Linear(1,2) = (      2.0 * (yz - wx)) * aScale[2];
+			Linear(2,2) = (1.0 - 2.0 * (xx + yy)) * aScale[2];
+			Translation = aPosition;
+		}
+
+		// Takes the upper 3x4 block, the bottom row is assumed to be (0, 0, 0, 1).
+		explicit affine(const mat<T, 4, 4>& aMatrix) {
+			for (std::size_t j = 0; j < 3; j++) {
+				for (std::size_t i = 0; i < 3; i++) {
+					Linear(i, j) = aMatrix(i, j);
+				}
+				Translation[j] = aMatrix(j, 3);
+			}
+		}
+
+		// Expands to a full homogeneous matrix, for GPU uniform data.
+		explicit operator mat<T, 4, 4>() const {
+			mat<T, 4, 4> Out;
+			for (std::size_t j = 0; j < 3; j++) {
+				for (std::size_t i = 0; i < 3; i++) {
+					Out(i, j) = Linear(i, j);
+				}
+				Out(j, 3) = Translation[j];
+			}
+			Out(3, 3) = T(1);
+			return Out;
+		}
+
+		// Accessor into the 3x4 block, column 3 is the translation.
+		T operator()(std::size_t aRow, std::size_t aColumn) const {
+			return aColumn < 3 ? Linear(aRow, aColumn) : Translation[aRow];
+		}
+
+		// Composition, (A * B) applies B first.
+		affine<T> operator*(const affine<T>& aRhs) const {
+			return affine<T>(Linear * aRhs.Linear, Linear * aRhs.Translation + Translation);
+		}
+
+		affine<T>& operator*=(const affine<T>& aRhs) {
+			(*this) = (*this) * aRhs;
+			return *this;
+		}
+
+		// Element wise scaling and summation, used for weighted blending of transforms.
+		affine<T> operator*(const T& aRhs) const {
+			return affine<T>(Linear * aRhs, Translation * aRhs);
+		}
+
+		affine<T> operator+(const affine<T>& aRhs) const {
+			return affine<T>(Linear + aRhs.Linear, Translation + aRhs.Translation);
+		}
+
+		affine<T>& operator+=(const affine<T>& aRhs) {
+			(*this) = (*this) + aRhs;
+			return *this;
+		}
+
+		// Transforms a position, translation is applied.
+		vec<T, 3> transform_point(const vec<T, 3>& aPoint) const {
+			return Linear * aPoint + Translation;
+		}
+
+		// Transforms a direction, translation is ignored.
+		vec<T, 3> transform_vector(const vec<T, 3>& aVector) const {
+			return Linear * aVector;
+		}
+
+	};
+
+	template <typename T> inline
+	affine<T> operator*(const T& aLhs, const affine<T>& aRhs) {
+		return aRhs * aLhs;
+	}
+
+	// Inverse of an affine transform, the linear part is inverted through its adjugate.
+	template <typename T> inline
+	affine<T> inverse(const affine<T>& aTransform) {
+		mat<T, 3, 3> InverseLinear = inverse3(aTransform.Linear);
+		return affine<T>(InverseLinear, -(InverseLinear * aTransform.Translation));
+	}
+
+	// Inverse of a transform whose linear part is a pure rotation.
+	template <typename T> inline
+	affine<T> inverse_rigid(const affine<T>& aTransform) {
+		mat<T, 3, 3> InverseLinear = transpose(aTransform.Linear);
+		return affine<T>(InverseLinear, -(InverseLinear * aTransform.Translation));
+	}
+
+	// Inverse transpose of the linear part, maps surface normals under the transform.
+	template <typename T> inline
+	mat<T, 3, 3> normal_matrix(const affine<T>& aTransform) {
+		return transpose(inverse3(aTransform.Linear));
+	}
+
+}
+
+#endif // !GEODESY_CORE_MATH_AFFINE_H
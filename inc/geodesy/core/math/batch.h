@@ -0,0 +1,375 @@
+#pragma once
+#ifndef GEODESY_CORE_MATH_BATCH_H
+#define GEODESY_CORE_MATH_BATCH_H
+
+// ------------------------------ batch.h ------------------------------ //
+/*
+Bulk kernels for transforming and reducing large arrays of points and matrices.
+Point data is passed as structure-of-arrays views (x[], y[], z[]) with an element
+stride, so tightly packed SoA buffers and existing AoS layouts (for instance the
+Position member of phys::mesh::vertex) can both be processed in place without
+repacking. Work is split into fixed size chunks that are distributed over threads
+with OpenMP, and the inner loops are kept branch free so the compiler can vectorize
+them when the stride is 1.
+
+The kernels pay off when one matrix meets many points, mesh vertices being the main case.
+Per instance work, where every element carries its own affine transform and is placed
+once, as draw call priorities, TLAS instances and bone uploads are, stays on math::affine.
+// Example usage:
+batch::span3<const float> P = batch::view(Mesh.Vertex.data(), Mesh.Vertex.size(), &phys::mesh::vertex::Position);
+batch::bounds(P, Min, Max);
+*/
+
+#include <array>
+#include <vector>
+#include <stdexcept>
+#include "vec.h"
+#include "mat.h"
+#include <omp.h>
+
+namespace geodesy::core::math::batch {
+
+	// Number of elements processed per task, sized so a chunk of three float streams stays in L1.
+	constexpr std::size_t ChunkSize = 1024;
+
+	// Structure-of-arrays view of three component data. Element i of a component lives
+	// at X[i * Stride], Y[i * Stride], Z[i * Stride].
+	template <typename T>
+	struct span3 {
+		T*				X;
+		T*				Y;
+		T*				Z;
+		std::size_t		Count;
+		std::size_t		Stride;
+
+		span3() : X(nullptr), Y(nullptr), Z(nullptr), Count(0), Stride(1) {}
+		span3(T* aX, T* aY, T* aZ, std::size_t aCount, std::size_t aStride = 1) : X(aX), Y(aY), Z(aZ), Count(aCount), Stride(aStride) {}
+
+		// Mutable views convert to read only views.
+		template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+		span3(const span3<U>& aView) : X(aView.X), Y(aView.Y), Z(aView.Z), Count(aView.Count), Stride(aView.Stride) {}
+
+		vec<std::remove_const_t<T>, 3> operator[](std::size_t aIndex) const {
+			return vec<std::remove_const_t<T>, 3>(X[aIndex * Stride], Y[aIndex * Stride], Z[aIndex * Stride]);
+		}
+	};
+
+	// Views a vec<T, 3> member of an array of structures as a span3, no copies are made.
+	template <typename S, typename T>
+	span3<T> view(S* aArray, std::size_t aCount, vec<T, 3> S::* aMember) {
+		static_assert(sizeof(S) % sizeof(T) == 0, "batch::view(): Structure size must be a multiple of the component size.");
+		if (aCount == 0) return span3<T>();
+		T* Base = (aArray[0].*aMember).data();
+		return span3<T>(Base, Base + 1, Base + 2, aCount, sizeof(S) / sizeof(T));
+	}
+
+	template <typename S, typename T>
+	span3<const T> view(const S* aArray, std::size_t aCount, vec<T, 3> S::* aMember) {
+		static_assert(sizeof(S) % sizeof(T) == 0, "batch::view(): Structure size must be a multiple of the component size.");
+		if (aCount == 0) return span3<const T>();
+		const T* Base = (aArray[0].*aMember).data();
+		return span3<const T>(Base, Base + 1, Base + 2, aCount, sizeof(S) / sizeof(T));
+	}
+
+	// Views a contiguous array of vec<T, 3> as a span3.
+	template <typename T>
+	span3<T> view(vec<T, 3>* aArray, std::size_t aCount) {
+		if (aCount == 0) return span3<T>();
+		T* Base = aArray[0].data();
+		return span3<T>(Base, Base + 1, Base + 2, aCount, 3);
+	}
+
+	template <typename T>
+	span3<const T> view(const vec<T, 3>* aArray, std::size_t aCount) {
+		if (aCount == 0) return span3<const T>();
+		const T* Base = aArray[0].data();
+		return span3<const T>(Base, Base + 1, Base + 2, aCount, 3);
+	}
+
+	inline std::size_t chunk_count(std::size_t aCount) {
+		return (aCount + ChunkSize - 1) / ChunkSize;
+	}
+
+	// ------------------------- Point Transforms ------------------------- //
+
+	// Applies an affine 4x4 transform to points, out = M * (x, y, z, 1). aIn and aOut may alias.
+	template <typename T, typename S> inline
+	void transform_points(const mat<T, 4, 4>& aTransform, span3<S> aIn, span3<T> aOut) {
+		static_assert(std::is_same_v<std::remove_const_t<S>, T>, "batch::transform_points(): Input and output component types must match.");
+		if (aOut.Count < aIn.Count) {
+			throw std::invalid_argument("batch::transform_points(): Output is smaller than input.");
+		}
+		const T m00 = aTransform(0,0), m01 = aTransform(0,1), m02 = aTransform(0,2), m03 = aTransform(0,3);
+		const T m10 = aTransform(1,0), m11 = aTransform(1,1), m12 = aTransform(1,2), m13 = aTransform(1,3);
+		const T m20 = aTransform(2,0), m21 = aTransform(2,1), m22 = aTransform(2,2), m23 = aTransform(2,3);
+		const std::ptrdiff_t ChunkTotal = chunk_count(aIn.Count);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t Start = c * ChunkSize;
+			const std::size_t End = std::min(Start + ChunkSize, aIn.Count);
+			const std::size_t SI = aIn.Stride, SO = aOut.Stride;
+			for (std::size_t i = Start; i < End; i++) {
+				const T x = aIn.X[i * SI], y = aIn.Y[i * SI], z = aIn.Z[i * SI];
+				aOut.X[i * SO] = m00 * x + m01 * y + m02 * z + m03;
+				aOut.Y[i * SO] = m10 * x + m11 * y + m12 * z + m13;
+				aOut.Z[i * SO] = m20 * x + m21 * y + m22 * z + m23;
+			}
+		}
+	}
+
+	// Applies only the linear (upper 3x3) part of a transform, for directions and offsets.
+	template <typename T, typename S> inline
+	void transform_vectors(const mat<T, 4, 4>& aTransform, span3<S> aIn, span3<T> aOut) {
+		static_assert(std::is_same_v<std::remove_const_t<S>, T>, "batch::transform_vectors(): Input and output component types must match.");
+		if (aOut.Count < aIn.Count) {
+			throw std::invalid_argument("batch::transform_vectors(): Output is smaller than input.");
+		}
+		const T m00 = aTransform(0,0), m01 = aTransform(0,1), m02 = aTransform(0,2);
+		const T m10 = aTransform(1,0), m11 = aTransform(1,1), m12 = aTransform(1,2);
+		const T m20 = aTransform(2,0), m21 = aTransform(2,1), m22 = aTransform(2,2);
+		const std::ptrdiff_t ChunkTotal = chunk_count(aIn.Count);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t Start = c * ChunkSize;
+			const std::size_t End = std::min(Start + ChunkSize, aIn.Count);
+			const std::size_t SI = aIn.Stride, SO = aOut.Stride;
+			for (std::size_t i = Start; i < End; i++) {
+				const T x = aIn.X[i * SI], y = aIn.Y[i * SI], z = aIn.Z[i * SI];
+				aOut.X[i * SO] = m00 * x + m01 * y + m02 * z;
+				aOut.Y[i * SO] = m10 * x + m11 * y + m12 * z;
+				aOut.Z[i * SO] = m20 * x + m21 * y + m22 * z;
+			}
+		}
+	}
+
+	// Transforms normals by the inverse transpose of the upper 3x3 and renormalizes them,
+	// so non-uniform scale does not skew them off the surface.
+	template <typename T, typename S> inline
+	void transform_normals(const mat<T, 4, 4>& aTransform, span3<S> aIn, span3<T> aOut) {
+		static_assert(std::is_same_v<std::remove_const_t<S>, T>, "batch::transform_normals(): Input and output component types must match.");
+		if (aOut.Count < aIn.Count) {
+			throw std::invalid_argument("batch::transform_normals(): Output is smaller than input.");
+		}
+		const mat<T, 3, 3> N = normal_matrix(aTransform);
+		const T n00 = N(0,0), n01 = N(0,1), n02 = N(0,2);
+		const T n10 = N(1,0), n11 = N(1,1), n12 = N(1,2);
+		const T n20 = N(2,0), n21 = N(2,1), n22 = N(2,2);
+		const std::ptrdiff_t ChunkTotal = chunk_count(aIn.Count);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t Start = c * ChunkSize;
+			const std::size_t End = std::min(Start + ChunkSize, aIn.Count);
+			const std::size_t SI = aIn.Stride, SO = aOut.Stride;
+			for (std::size_t i = Start; i < End; i++) {
+				const T x = aIn.X[i * SI], y = aIn.Y[i * SI], z = aIn.Z[i * SI];
+				const T nx = n00 * x + n01 * y + n02 * z;
+				const T ny = n10 * x + n11 * y + n12 * z;
+				const T nz = n20 * x + n21 * y + n22 * z;
+				const T Length2 = nx * nx + ny * ny + nz * nz;
+				// Degenerate normals stay zero instead of becoming NaN.
+				const T InvLength = Length2 > T(0) ? T(1) / std::sqrt(Length2) : T(0);
+				aOut.X[i * SO] = nx * InvLength;
+				aOut.Y[i * SO] = ny * InvLength;
+				aOut.Z[i * SO] = nz * InvLength;
+			}
+		}
+	}
+
+	// ------------------------- Matrix Arrays ------------------------- //
+
+	// aOut[i] = aLhs[i] * aRhs, for instance local transforms into a shared parent space.
+	template <typename T> inline
+	void multiply(const mat<T, 4, 4>* aLhs, const mat<T, 4, 4>& aRhs, mat<T, 4, 4>* aOut, std::size_t aCount) {
+		const std::ptrdiff_t ChunkTotal = chunk_count(aCount);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t End = std::min((c + 1) * ChunkSize, aCount);
+			for (std::size_t i = c * ChunkSize; i < End; i++) {
+				aOut[i] = aLhs[i] * aRhs;
+			}
+		}
+	}
+
+	// aOut[i] = aLhs * aRhs[i], for instance a world transform applied to every instance.
+	template <typename T> inline
+	void multiply(const mat<T, 4, 4>& aLhs, const mat<T, 4, 4>* aRhs, mat<T, 4, 4>* aOut, std::size_t aCount) {
+		const std::ptrdiff_t ChunkTotal = chunk_count(aCount);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t End = std::min((c + 1) * ChunkSize, aCount);
+			for (std::size_t i = c * ChunkSize; i < End; i++) {
+				aOut[i] = aLhs * aRhs[i];
+			}
+		}
+	}
+
+	// ------------------------- Reductions ------------------------- //
+
+	// Axis aligned bounding box of a point set. Leaves aMin/aMax untouched if empty.
+	template <typename U, typename T = std::remove_const_t<U>> inline
+	void bounds(span3<U> aIn, vec<T, 3>& aMin, vec<T, 3>& aMax) {
+		if (aIn.Count == 0) return;
+		const std::ptrdiff_t ChunkTotal = chunk_count(aIn.Count);
+		// Per chunk partials, reduced serially after. Avoids relying on OpenMP 3.1 min/max reductions.
+		std::vector<vec<T, 3>> ChunkMin(ChunkTotal), ChunkMax(ChunkTotal);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t Start = c * ChunkSize;
+			const std::size_t End = std::min(Start + ChunkSize, aIn.Count);
+			const std::size_t S = aIn.Stride;
+			T MinX = aIn.X[Start * S], MinY = aIn.Y[Start * S], MinZ = aIn.Z[Start * S];
+			T MaxX = MinX, MaxY = MinY, MaxZ = MinZ;
+			for (std::size_t i = Start + 1; i < End; i++) {
+				const T x = aIn.X[i * S], y = aIn.Y[i * S], z = aIn.Z[i * S];
+				MinX = x < MinX ? x : MinX; 	MaxX = x > MaxX ? x : MaxX;
+				MinY = y < MinY ? y : MinY; 	MaxY = y > MaxY ? y : MaxY;
+				MinZ = z < MinZ ? z : MinZ; 	MaxZ = z > MaxZ ? z : MaxZ;
+			}
+			ChunkMin[c] = vec<T, 3>(MinX, MinY, MinZ);
+			ChunkMax[c] = vec<T, 3>(MaxX, MaxY, MaxZ);
+		}
+		aMin = ChunkMin[0];
+		aMax = ChunkMax[0];
+		for (std::ptrdiff_t c = 1; c < ChunkTotal; c++) {
+			for (std::size_t j = 0; j < 3; j++) {
+				aMin[j] = std::min(aMin[j], ChunkMin[c][j]);
+				aMax[j] = std::max(aMax[j], ChunkMax[c][j]);
+			}
+		}
+	}
+
+	// Bounds of a point set along the unit axes in the columns of aAxis, aMin[j] and aMax[j] are
+	// the least and greatest projections onto axis j. Leaves aMin/aMax untouched if empty.
+	template <typename U, typename T = std::remove_const_t<U>> inline
+	void bounds(span3<U> aIn, const mat<T, 3, 3>& aAxis, vec<T, 3>& aMin, vec<T, 3>& aMax) {
+		if (aIn.Count == 0) return;
+		const std::ptrdiff_t ChunkTotal = chunk_count(aIn.Count);
+		std::vector<vec<T, 3>> ChunkMin(ChunkTotal), ChunkMax(ChunkTotal);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t Start = c * ChunkSize;
+			const std::size_t End = std::min(Start + ChunkSize, aIn.Count);
+			const std::size_t S = aIn.Stride;
+			T Min[3], Max[3];
+			for (std::size_t j = 0; j < 3; j++) {
+				Min[j] = aIn.X[Start * S] * aAxis(0, j) + aIn.Y[Start * S] * aAxis(1, j) + aIn.Z[Start * S] * aAxis(2, j);
+				Max[j] = Min[j];
+			}
+			for (std::size_t i = Start + 1; i < End; i++) {
+				const T x = aIn.X[i * S], y = aIn.Y[i * S], z = aIn.Z[i * S];
+				for (std::size_t j = 0; j < 3; j++) {
+					const T d = x * aAxis(0, j) + y * aAxis(1, j) + z * aAxis(2, j);
+					Min[j] = d < Min[j] ? d : Min[j];
+					Max[j] = d > Max[j] ? d : Max[j];
+				}
+			}
+			ChunkMin[c] = vec<T, 3>(Min[0], Min[1], Min[2]);
+			ChunkMax[c] = vec<T, 3>(Max[0], Max[1], Max[2]);
+		}
+		aMin = ChunkMin[0];
+		aMax = ChunkMax[0];
+		for (std::ptrdiff_t c = 1; c < ChunkTotal; c++) {
+			for (std::size_t j = 0; j < 3; j++) {
+				aMin[j] = std::min(aMin[j], ChunkMin[c][j]);
+				aMax[j] = std::max(aMax[j], ChunkMax[c][j]);
+			}
+		}
+	}
+
+	// Covariance of a point set about aMean, the mean of the outer products of the offsets.
+	template <typename U, typename T = std::remove_const_t<U>> inline
+	mat<T, 3, 3> covariance(span3<U> aIn, const vec<T, 3>& aMean) {
+		mat<T, 3, 3> Out{};
+		if (aIn.Count == 0) return Out;
+		const std::ptrdiff_t ChunkTotal = chunk_count(aIn.Count);
+		// xx yy zz xy xz yz, accumulated in double so large meshes far from the origin keep precision.
+		std::vector<std::array<double, 6>> ChunkSum(ChunkTotal);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t Start = c * ChunkSize;
+			const std::size_t End = std::min(Start + ChunkSize, aIn.Count);
+			const std::size_t S = aIn.Stride;
+			double XX = 0.0, YY = 0.0, ZZ = 0.0, XY = 0.0, XZ = 0.0, YZ = 0.0;
+			for (std::size_t i = Start; i < End; i++) {
+				const double x = aIn.X[i * S] - aMean[0], y = aIn.Y[i * S] - aMean[1], z = aIn.Z[i * S] - aMean[2];
+				XX += x * x; 	YY += y * y; 	ZZ += z * z;
+				XY += x * y; 	XZ += x * z; 	YZ += y * z;
+			}
+			ChunkSum[c] = { XX, YY, ZZ, XY, XZ, YZ };
+		}
+		std::array<double, 6> Sum = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			for (std::size_t k = 0; k < 6; k++) Sum[k] += ChunkSum[c][k];
+		}
+		const double Scale = 1.0 / (double)aIn.Count;
+		Out(0, 0) = T(Sum[0] * Scale); 	Out(1, 1) = T(Sum[1] * Scale); 	Out(2, 2) = T(Sum[2] * Scale);
+		Out(0, 1) = Out(1, 0) = T(Sum[3] * Scale);
+		Out(0, 2) = Out(2, 0) = T(Sum[4] * Scale);
+		Out(1, 2) = Out(2, 1) = T(Sum[5] * Scale);
+		return Out;
+	}
+
+	// Component-wise sum of a point set.
+	template <typename U, typename T = std::remove_const_t<U>> inline
+	vec<T, 3> sum(span3<U> aIn) {
+		const std::ptrdiff_t ChunkTotal = chunk_count(aIn.Count);
+		std::vector<vec<T, 3>> ChunkSum(ChunkTotal);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t Start = c * ChunkSize;
+			const std::size_t End = std::min(Start + ChunkSize, aIn.Count);
+			const std::size_t S = aIn.Stride;
+			T SumX = T(0), SumY = T(0), SumZ = T(0);
+			for (std::size_t i = Start; i < End; i++) {
+				SumX += aIn.X[i * S];
+				SumY += aIn.Y[i * S];
+				SumZ += aIn.Z[i * S];
+			}
+			ChunkSum[c] = vec<T, 3>(SumX, SumY, SumZ);
+		}
+		vec<T, 3> Out;
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			Out += ChunkSum[c];
+		}
+		return Out;
+	}
+
+	// Index of the point farthest from aCenter, or 0 if the set is empty.
+	template <typename U, typename T = std::remove_const_t<U>> inline
+	std::size_t farthest(span3<U> aIn, const vec<T, 3>& aCenter) {
+		if (aIn.Count == 0) return 0;
+		const std::ptrdiff_t ChunkTotal = chunk_count(aIn.Count);
+		std::vector<std::size_t> ChunkIndex(ChunkTotal);
+		std::vector<T> ChunkDistance(ChunkTotal);
+		#pragma omp parallel for if(ChunkTotal > 1)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t Start = c * ChunkSize;
+			const std::size_t End = std::min(Start + ChunkSize, aIn.Count);
+			const std::size_t S = aIn.Stride;
+			std::size_t Index = Start;
+			T MaxDistance2 = T(-1);
+			for (std::size_t i = Start; i < End; i++) {
+				const T dx = aIn.X[i * S] - aCenter[0], dy = aIn.Y[i * S] - aCenter[1], dz = aIn.Z[i * S] - aCenter[2];
+				const T Distance2 = dx * dx + dy * dy + dz * dz;
+				if (Distance2 > MaxDistance2) {
+					MaxDistance2 = Distance2;
+					Index = i;
+				}
+			}
+			ChunkIndex[c] = Index;
+			ChunkDistance[c] = MaxDistance2;
+		}
+		std::size_t Out = ChunkIndex[0];
+		T MaxDistance2 = ChunkDistance[0];
+		for (std::ptrdiff_t c = 1; c < ChunkTotal; c++) {
+			if (ChunkDistance[c] > MaxDistance2) {
+				MaxDistance2 = ChunkDistance[c];
+				Out = ChunkIndex[c];
+			}
+		}
+		return Out;
+	}
+
+}
+
+#endif // !GEODESY_CORE_MATH_BATCH_H
@@ -0,0 +1,578 @@
+#pragma once
+#ifndef GEODESY_CORE_MATH_CHUNKED_FIELD_H
+#define GEODESY_CORE_MATH_CHUNKED_FIELD_H
+
+// ------------------------------ chunked_field.h ------------------------------ //
+/*
+Sparse, optionally out of core, storage for fields too large to keep dense. The
+grid is split into bricks of BrickWidth^N samples which are only allocated once
+something other than the Background value is written into them, so untouched or
+uniform regions cost nothing. Reads of an unallocated brick return Background.
+
+When constructed with a paging file, every brick has a slot in a memory mapped
+scratch file instead of the heap. The most recently used bricks are kept resident,
+up to the given byte budget, and the least recently used ones are written back and
+dropped from memory, to be faulted back in from the file when touched again.
+
+chunked_field is a field expression, so the element wise operators, math functions
+and sampling of field work on it unchanged, and it can be mixed with dense fields
+on the same grid. Assignment evaluates one brick at a time in parallel, bricks
+whose result is entirely Background are released again.
+// Example usage:
+chunked_field<float, 3, float> Density(Lower, Upper, { 1024, 1024, 1024 }, "density.swap", 512 << 20);
+Density.set({ 10, 20, 30 }, 1.0f);
+Density = 0.5f * Density + Noise;
+float d = Density(vec<float, 3>(0.1f, 0.2f, 0.3f));
+*/
+
+#include <list>
+#include <mutex>
+#include <memory>
+#include <string>
+#include "field.h"
+#include "../io/mapped_file.h"
+#include <omp.h>
+
+namespace geodesy::core::math {
+
+	// Default brick edge length, around 16K samples per brick.
+	constexpr std::size_t chunked_field_brick_width(std::size_t aDimension) {
+		return aDimension >= 3 ? 16 : (aDimension == 2 ? 128 : 16384);
+	}
+
+	template <typename X, std::size_t N, typename Y, std::size_t W = chunked_field_brick_width(N)>
+	class chunked_field : public field_expression<chunked_field<X, N, Y, W>> {
+	public:
+
+		typedef X domain_type;
+		typedef Y range_type;
+		static constexpr std::size_t dimension_count 	= N;
+		static constexpr std::size_t BrickWidth 		= W;
+		static constexpr std::size_t BrickSize 			= integer_power(W, N);
+
+		struct brick {
+			Y*									Data;			// Heap block, or the brick's slot in the paging file.
+			bool								Allocated;		// Unallocated bricks read as Background.
+			bool								Resident;		// Listed in RecentList, paging only.
+			std::list<std::size_t>::iterator	Recent;
+		};
+
+		vec<std::size_t, N>						ElementCount;
+		vec<X, N>								LowerBound, UpperBound;
+		Y										Background;
+		vec<std::size_t, N>						BrickCount;
+		std::vector<brick>						Brick;
+
+		// Paging state, only used when backed by a file.
+		std::string								PagingPath;
+		std::unique_ptr<io::mapped_file>		File;
+		std::size_t								BrickBytes;		// Slot stride in the file, page aligned.
+		std::size_t								ResidentLimit;	// Maximum number of resident bricks.
+		std::list<std::size_t>					RecentList;		// Most recently used first.
+		std::unique_ptr<std::mutex>				Mutex;
+
+		chunked_field() : ElementCount(vec<std::size_t, N>{}), LowerBound(vec<X, N>{}), UpperBound(vec<X, N>{}), Background(), BrickCount(vec<std::size_t, N>{}), BrickBytes(0), ResidentLimit(0), Mutex(new std::mutex()) {}
+
+		// In memory sparse field.
+		chunked_field(vec<X, N> aLowerBound, vec<X, N> aUpperBound, vec<std::size_t, N> aElementCount, const Y& aBackground = Y()) : chunked_field() {
+			this->Background = aBackground;
+			this->reshape(make_domain(aLowerBound, aUpperBound, aElementCount));
+		}
+
+		// Field paged through a scratch file at aPagingPath, keeping at most aResidentBytes of bricks in memory.
+		chunked_field(vec<X, N> aLowerBound, vec<X, N> aUpperBound, vec<std::size_t, N> aElementCount, const std::string& aPagingPath, std::size_t aResidentBytes, const Y& aBackground = Y()) : chunked_field() {
+			static_assert(std::is_trivially_copyable_v<Y>, "chunked_field: Paged fields require a trivially copyable range type.");
+			this->Background 		= aBackground;
+			this->PagingPath 		= aPagingPath;
+			this->ResidentLimit 	= std::max<std::size_t>(1, aResidentBytes / (BrickSize * sizeof(Y)));
+			this->reshape(make_domain(aLowerBound, aUpperBound, aElementCount));
+		}
+
+		// Sparse copy of a dense field, bricks equal to aBackground are not stored.
+		explicit chunked_field(const field<X, N, Y>& aField, const Y& aBackground = Y()) : chunked_field() {
+			this->Background = aBackground;
+			this->reshape(aField.domain());
+			this->assign(aField);
+		}
+
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		chunked_field(const field_expression<E>& aExpression) : chunked_field() {
+			this->assign(aExpression);
+		}
+
+		chunked_field(const chunked_field&) = delete;
+		chunked_field& operator=(const chunked_field&) = delete;
+
+		chunked_field(chunked_field&& aOther) noexcept : chunked_field() {
+			this->swap(aOther);
+		}
+
+		chunked_field& operator=(chunked_field&& aOther) noexcept {
+			this->swap(aOther);
+			return *this;
+		}
+
+		~chunked_field() {
+			this->release_bricks();
+		}
+
+		void swap(chunked_field& aOther) noexcept {
+			std::swap(ElementCount, aOther.ElementCount);
+			std::swap(LowerBound, aOther.LowerBound);
+			std::swap(UpperBound, aOther.UpperBound);
+			std::swap(Background, aOther.Background);
+			std::swap(BrickCount, aOther.BrickCount);
+			std::swap(Brick, aOther.Brick);
+			std::swap(PagingPath, aOther.PagingPath);
+			std::swap(File, aOther.File);
+			std::swap(BrickBytes, aOther.BrickBytes);
+			std::swap(ResidentLimit, aOther.ResidentLimit);
+			std::swap(RecentList, aOther.RecentList);
+			std::swap(Mutex, aOther.Mutex);
+		}
+
+		// ------------------------- Storage ------------------------- //
+
+		// Total number of samples of the grid, allocated or not.
+		std::size_t size() const {
+			std::size_t Total = 1;
+			for (std::size_t i = 0; i < N; i++) Total *= ElementCount[i];
+			return Total;
+		}
+
+		std::size_t allocated_brick_count() const {
+			std::size_t Count = 0;
+			for (const brick& B : Brick) Count += B.Allocated ? 1 : 0;
+			return Count;
+		}
+
+		std::size_t resident_brick_count() const {
+			std::lock_guard<std::mutex> Lock(*Mutex);
+			return RecentList.size();
+		}
+
+		// Resizes the field to cover aDomain, every brick is released.
+		void reshape(const field_domain<X, N>& aDomain) {
+			this->release_bricks();
+			ElementCount 	= aDomain.ElementCount;
+			LowerBound 		= aDomain.LowerBound;
+			UpperBound 		= aDomain.UpperBound;
+			std::size_t BrickTotal = 1;
+			for (std::size_t i = 0; i < N; i++) {
+				BrickCount[i] = (ElementCount[i] + W - 1) / W;
+				BrickTotal *= BrickCount[i];
+			}
+			Brick.assign(BrickTotal, brick{ nullptr, false, false, RecentList.end() });
+			if (!PagingPath.empty() && (BrickTotal > 0)) {
+				const std::size_t Page = io::mapped_file::page_size();
+				BrickBytes = ((BrickSize * sizeof(Y) + Page - 1) / Page) * Page;
+				File = std::make_unique<io::mapped_file>(PagingPath, BrickBytes * BrickTotal);
+				for (std::size_t b = 0; b < BrickTotal; b++) {
+					Brick[b].Data = reinterpret_cast<Y*>(static_cast<char*>(File->Data) + b * BrickBytes);
+				}
+			}
+		}
+
+		// Value at a grid index, Background if its brick was never written.
+		Y get(const vec<std::size_t, N>& aIndex) const {
+			std::size_t b, l;
+			this->locate(aIndex, b, l);
+			return Brick[b].Allocated ? Brick[b].Data[l] : Background;
+		}
+
+		// Writes a grid index, allocating its brick on first write.
+		void set(const vec<std::size_t, N>& aIndex, const Y& aValue) {
+			std::size_t b, l;
+			this->locate(aIndex, b, l);
+			this->acquire(b)[l] = aValue;
+		}
+
+		// Value at a storage index of the equivalent dense field.
+		Y operator[](std::size_t aIndex) const {
+			vec<std::size_t, N> Index;
+			for (std::size_t i = 0; i < N; i++) {
+				Index[i] = aIndex % ElementCount[i];
+				aIndex /= ElementCount[i];
+			}
+			return this->get(Index);
+		}
+
+		// Dense copy, for handing to code that expects contiguous storage.
+		field<X, N, Y> dense() const {
+			field<X, N, Y> Out;
+			Out.reshape(this->domain());
+			this->for_each_brick([&](std::size_t aBrick, const vec<std::size_t, N>& aOrigin, const vec<std::size_t, N>& aExtent) {
+				const brick& B = Brick[aBrick];
+				this->for_each_sample(aOrigin, aExtent, [&](std::size_t aLocal, std::size_t aGlobal) {
+					Out[aGlobal] = B.Allocated ? B.Data[aLocal] : Background;
+				});
+			});
+			return Out;
+		}
+
+		// ------------------------- Sampler ------------------------- //
+
+		// Same interpolation and border policies as field::sampler, corners are fetched through the bricks.
+		class sampler {
+		public:
+
+			enum border : int {
+				CLAMP,		// Positions outside the domain use the nearest edge value.
+				WRAP,		// Positions outside the domain wrap around periodically.
+				ZERO,		// Positions outside the domain sample to Y().
+			};
+
+			const chunked_field*				Field;
+			border								Border;
+			vec<X, N>							LowerBound;
+			vec<X, N>							UpperBound;
+			vec<X, N>							InverseStep;
+			std::array<std::ptrdiff_t, N>		Count;
+
+			sampler(const chunked_field& aField, border aBorder = ZERO) : Field(&aField), Border(aBorder), LowerBound(aField.LowerBound), UpperBound(aField.UpperBound) {
+				for (std::size_t i = 0; i < N; i++) {
+					Count[i] = aField.ElementCount[i];
+					InverseStep[i] = (Count[i] > 1) && (UpperBound[i] != LowerBound[i]) ? (X)(Count[i] - 1) / (UpperBound[i] - LowerBound[i]) : X();
+				}
+			}
+
+			// Multilinear interpolation at aX.
+			Y operator()(const vec<X, N>& aX) const {
+				std::array<std::size_t, 2 * N> Corner;
+				std::array<X, 2 * N> Weight;
+
+				if (Border == ZERO) {
+					for (std::size_t i = 0; i < N; i++) {
+						if ((aX[i] < LowerBound[i]) || (aX[i] > UpperBound[i])) return Y();
+					}
+				}
+
+				for (std::size_t i = 0; i < N; i++) {
+					X U = (aX[i] - LowerBound[i]) * InverseStep[i];
+					X Floor = std::floor(U);
+					X T = U - Floor;
+					std::ptrdiff_t I0 = (std::ptrdiff_t)Floor;
+					std::ptrdiff_t I1 = I0 + 1;
+					switch (Border) {
+					case CLAMP:
+						I0 = std::min(std::max(I0, std::ptrdiff_t(0)), Count[i] - 1);
+						I1 = std::min(std::max(I1, std::ptrdiff_t(0)), Count[i] - 1);
+						break;
+					case WRAP:
+						I0 = ((I0 % Count[i]) + Count[i]) % Count[i];
+						I1 = ((I1 % Count[i]) + Count[i]) % Count[i];
+						break;
+					default:
+						I0 = std::min(I0, Count[i] - 1);
+						I1 = std::min(I1, Count[i] - 1);
+						break;
+					}
+					Corner[2 * i + 0] = (std::size_t)I0;
+					Corner[2 * i + 1] = (std::size_t)I1;
+					Weight[2 * i + 0] = X(1) - T;
+					Weight[2 * i + 1] = T;
+				}
+
+				Y Out = Y();
+				for (std::size_t c = 0; c < power_of_two(N); c++) {
+					vec<std::size_t, N> Index;
+					X Wc = X(1);
+					for (std::size_t i = 0; i < N; i++) {
+						std::size_t Bit = (c >> i) & 1;
+						Index[i] = Corner[2 * i + Bit];
+						Wc *= Weight[2 * i + Bit];
+					}
+					Out += Field->get(Index) * Wc;
+				}
+				return Out;
+			}
+
+			// Samples aCount positions from aIn into aOut, in parallel.
+			void sample(const vec<X, N>* aIn, Y* aOut, std::size_t aCount) const {
+				if (Field->size() == 0) {
+					throw std::runtime_error("chunked_field::sampler::sample(): Cannot sample an empty field.");
+				}
+				#pragma omp parallel for schedule(static)
+				for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aCount; i++) {
+					aOut[i] = (*this)(aIn[i]);
+				}
+			}
+
+			std::vector<Y> sample(const std::vector<vec<X, N>>& aIn) const {
+				std::vector<Y> Out(aIn.size());
+				this->sample(aIn.data(), Out.data(), aIn.size());
+				return Out;
+			}
+
+		};
+
+		// Access f(x) = y. Uses interpolation, returns Y() outside of the domain.
+		Y operator()(const vec<X, N>& aX) const {
+			if (this->size() == 0) return Y();
+			return sampler(*this, sampler::ZERO)(aX);
+		}
+
+		// ------------------------- Expression Interface ------------------------- //
+
+		field_domain<X, N> domain() const {
+			return make_domain(LowerBound, UpperBound, ElementCount);
+		}
+
+		bool aligned() const {
+			return true;
+		}
+
+		Y sample(const vec<X, N>& aX) const {
+			return (*this)(aX);
+		}
+
+		// Evaluates an expression brick by brick, bricks that come out entirely Background are released.
+		template <typename E>
+		chunked_field& assign(const field_expression<E>& aExpression) {
+			const E& Expression = aExpression.derived();
+			if (Expression.aligned()) {
+				// Element wise reads at the written index, safe even if this field is an operand.
+				if (Expression.domain() != this->domain()) {
+					this->reshape(Expression.domain());
+				}
+				this->evaluate(*this, [&](std::size_t aGlobal, const vec<std::size_t, N>&) { return Expression[aGlobal]; });
+			}
+			else {
+				// Operands are sampled at neighbouring points, so evaluate out of place.
+				chunked_field Out;
+				Out.Background = Background;
+				Out.ResidentLimit = ResidentLimit;
+				if (!PagingPath.empty()) {
+					// Alternate between two files, the current one may still be mapped.
+					Out.PagingPath = ((File != nullptr) && (File->Path == PagingPath)) ? PagingPath + ".swap" : PagingPath;
+				}
+				Out.reshape(Expression.domain());
+				this->evaluate(Out, [&](std::size_t, const vec<std::size_t, N>& aIndex) { return Expression.sample(Out.position(aIndex)); });
+				std::string Path = PagingPath;
+				this->swap(Out);
+				PagingPath = Path;
+			}
+			return *this;
+		}
+
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		chunked_field& operator=(const field_expression<E>& aRhs) {
+			return this->assign(aRhs);
+		}
+
+		// A uniform value becomes the background, every brick is released.
+		chunked_field& operator=(const Y& aRhs) {
+			field_domain<X, N> Domain = this->domain();
+			Background = aRhs;
+			this->reshape(Domain);
+			return *this;
+		}
+
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		chunked_field& operator+=(const field_expression<E>& aRhs) {
+			return this->assign(*this + aRhs.derived());
+		}
+
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		chunked_field& operator-=(const field_expression<E>& aRhs) {
+			return this->assign(*this - aRhs.derived());
+		}
+
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		chunked_field& operator*=(const field_expression<E>& aRhs) {
+			return this->assign(*this * aRhs.derived());
+		}
+
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		chunked_field& operator/=(const field_expression<E>& aRhs) {
+			return this->assign(*this / aRhs.derived());
+		}
+
+		chunked_field& operator+=(const Y& aRhs) {
+			return this->assign(*this + aRhs);
+		}
+
+		chunked_field& operator-=(const Y& aRhs) {
+			return this->assign(*this - aRhs);
+		}
+
+		chunked_field& operator*=(const Y& aRhs) {
+			return this->assign(*this * aRhs);
+		}
+
+		chunked_field& operator/=(const Y& aRhs) {
+			return this->assign(*this / aRhs);
+		}
+
+		vec<X, N> position(const vec<std::size_t, N>& aIndex) const {
+			vec<X, N> Out;
+			for (std::size_t i = 0; i < N; i++) {
+				Out[i] = LowerBound[i] + aIndex[i] * (UpperBound[i] - LowerBound[i]) / ((X)(ElementCount[i] - 1));
+			}
+			return Out;
+		}
+
+	private:
+
+		static field_domain<X, N> make_domain(const vec<X, N>& aLowerBound, const vec<X, N>& aUpperBound, const vec<std::size_t, N>& aElementCount) {
+			field_domain<X, N> Out;
+			Out.ElementCount 	= aElementCount;
+			Out.LowerBound 		= aLowerBound;
+			Out.UpperBound 		= aUpperBound;
+			return Out;
+		}
+
+		void locate(const vec<std::size_t, N>& aIndex, std::size_t& aBrick, std::size_t& aLocal) const {
+			std::size_t BrickMultiplier = 1, LocalMultiplier = 1;
+			aBrick = 0;
+			aLocal = 0;
+			for (std::size_t i = 0; i < N; i++) {
+				aBrick += (aIndex[i] / W) * BrickMultiplier;
+				aLocal += (aIndex[i] % W) * LocalMultiplier;
+				BrickMultiplier *= BrickCount[i];
+				LocalMultiplier *= W;
+			}
+		}
+
+		// Allocates a brick on first use and marks it most recently used.
+		Y* acquire(std::size_t aBrick) {
+			brick& B = Brick[aBrick];
+			std::lock_guard<std::mutex> Lock(*Mutex);
+			if (!B.Allocated) {
+				if (File == nullptr) {
+					B.Data = static_cast<Y*>(::operator new(BrickSize * sizeof(Y), std::align_val_t(64)));
+				}
+				std::uninitialized_fill_n(B.Data, BrickSize, Background);
+				B.Allocated = true;
+			}
+			if (File != nullptr) {
+				this->touch(aBrick);
+			}
+			return B.Data;
+		}
+
+		// Returns a brick to the unallocated state, its samples read as Background again.
+		void release(std::size_t aBrick) {
+			brick& B = Brick[aBrick];
+			std::lock_guard<std::mutex> Lock(*Mutex);
+			if (!B.Allocated) return;
+			if (File == nullptr) {
+				std::destroy_n(B.Data, BrickSize);
+				::operator delete(B.Data, std::align_val_t(64));
+				B.Data = nullptr;
+			}
+			else {
+				if (B.Resident) {
+					RecentList.erase(B.Recent);
+					B.Resident = false;
+				}
+				File->release(aBrick * BrickBytes, BrickBytes);
+			}
+			B.Allocated = false;
+		}
+
+		// LRU update, evicts the least recently used brick past the resident budget. Mutex must be held.
+		void touch(std::size_t aBrick) {
+			brick& B = Brick[aBrick];
+			if (B.Resident) {
+				RecentList.splice(RecentList.begin(), RecentList, B.Recent);
+				return;
+			}
+			RecentList.push_front(aBrick);
+			B.Recent = RecentList.begin();
+			B.Resident = true;
+			if (RecentList.size() > ResidentLimit) {
+				std::size_t Victim = RecentList.back();
+				RecentList.pop_back();
+				Brick[Victim].Resident = false;
+				File->release(Victim * BrickBytes, BrickBytes);
+			}
+		}
+
+		void release_bricks() {
+			if (File == nullptr) {
+				for (brick& B : Brick) {
+					if (B.Data == nullptr) continue;
+					std::destroy_n(B.Data, BrickSize);
+					::operator delete(B.Data, std::align_val_t(64));
+				}
+			}
+			Brick.clear();
+			RecentList.clear();
+			File.reset();
+		}
+
+		// Runs aFunction(Brick, Origin, Extent) for every brick in parallel, Extent is clipped to the grid.
+		template <typename F>
+		void for_each_brick(F aFunction) const {
+			const std::ptrdiff_t BrickTotal = (std::ptrdiff_t)Brick.size();
+			#pragma omp parallel for schedule(dynamic)
+			for (std::ptrdiff_t b = 0; b < BrickTotal; b++) {
+				vec<std::size_t, N> Origin, Extent;
+				std::size_t Remainder = (std::size_t)b;
+				for (std::size_t i = 0; i < N; i++) {
+					Origin[i] = (Remainder % BrickCount[i]) * W;
+					Extent[i] = std::min(W, ElementCount[i] - Origin[i]);
+					Remainder /= BrickCount[i];
+				}
+				aFunction((std::size_t)b, Origin, Extent);
+			}
+		}
+
+		// Visits the samples of one brick, passing the brick local and dense storage indices.
+		template <typename F>
+		void for_each_sample(const vec<std::size_t, N>& aOrigin, const vec<std::size_t, N>& aExtent, F aFunction) const {
+			vec<std::size_t, N> Local = vec<std::size_t, N>{};
+			std::size_t Count = 1;
+			for (std::size_t i = 0; i < N; i++) Count *= aExtent[i];
+			for (std::size_t s = 0; s < Count; s++) {
+				std::size_t LocalIndex = 0, GlobalIndex = 0, LocalMultiplier = 1, GlobalMultiplier = 1;
+				for (std::size_t i = 0; i < N; i++) {
+					LocalIndex += Local[i] * LocalMultiplier;
+					GlobalIndex += (aOrigin[i] + Local[i]) * GlobalMultiplier;
+					LocalMultiplier *= W;
+					GlobalMultiplier *= ElementCount[i];
+				}
+				aFunction(LocalIndex, GlobalIndex);
+				// Odometer increment over the clipped extent.
+				for (std::size_t i = 0; i < N; i++) {
+					if (++Local[i] < aExtent[i]) break;
+					Local[i] = 0;
+				}
+			}
+		}
+
+		// Fills aTarget brick by brick from aValue(GlobalIndex, GridIndex), keeping it sparse.
+		template <typename F>
+		void evaluate(chunked_field& aTarget, F aValue) const {
+			aTarget.for_each_brick([&](std::size_t aBrick, const vec<std::size_t, N>& aOrigin, const vec<std::size_t, N>& aExtent) {
+				std::vector<Y> Value(BrickSize, aTarget.Background);
+				bool Uniform = true;
+				aTarget.for_each_sample(aOrigin, aExtent, [&](std::size_t aLocal, std::size_t aGlobal) {
+					vec<std::size_t, N> Index;
+					std::size_t Remainder = aLocal;
+					for (std::size_t i = 0; i < N; i++) {
+						Index[i] = aOrigin[i] + Remainder % W;
+						Remainder /= W;
+					}
+					Value[aLocal] = aValue(aGlobal, Index);
+					Uniform = Uniform && (Value[aLocal] == aTarget.Background);
+				});
+				if (Uniform) {
+					aTarget.release(aBrick);
+				}
+				else {
+					Y* Data = aTarget.acquire(aBrick);
+					std::copy(Value.begin(), Value.end(), Data);
+				}
+			});
+		}
+
+	};
+
+	template <typename X, std::size_t N, typename Y, std::size_t W>
+	struct is_field_storage<chunked_field<X, N, Y, W>> : std::true_type {};
+
+}
+
+#endif // !GEODESY_CORE_MATH_CHUNKED_FIELD_H
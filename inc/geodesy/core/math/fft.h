@@ -0,0 +1,729 @@
+#pragma once
+#ifndef GEODESY_CORE_MATH_FFT_H
+#define GEODESY_CORE_MATH_FFT_H
+
+// ------------------------------ fft.h ------------------------------ //
+/*
+Mixed radix fast Fourier transforms over complex<T>, for plain arrays and for
+fields of any dimension. Sizes are factored into radix 4, 2, 3 and 5 stages with
+a generic odd radix for the remaining small primes, each stage is a Stockham
+autosort pass so no bit reversal is needed. Sizes with a prime factor larger
+than fft_plan::BluesteinThreshold are transformed through Bluestein's chirp z
+algorithm, so every length is O(n log n).
+
+Plans hold the factorization and twiddle tables of a length and are cached, the
+first transform of a new length builds its plan and every later transform of that
+length reuses it. Plans are immutable, so one plan may be used by many threads.
+
+Conventions follow the common numerical libraries, FORWARD uses exp(-2 pi i jk/n)
+and is unnormalized, INVERSE uses exp(+2 pi i jk/n) and scales by 1/n, so an
+INVERSE after a FORWARD returns the input.
+
+Real to complex transforms (rfft) of a length n produce the n/2 + 1 non redundant
+bins, for fields only the first axis is halved. Multidimensional transforms are
+separable, every line along an axis is transformed in parallel.
+
+convolve() does linear convolution through zero padded transforms, and
+fft_convolver does uniformly partitioned convolution of a stream in fixed blocks,
+i.e. long impulse responses for audio.
+// Example usage:
+field<float, 2, complex<float>> Spectrum = rfft(Image);
+fft(Signal.data(), Signal.size(), fft_direction::FORWARD);
+std::vector<float> Filtered = convolve(Signal, Kernel);
+fft_convolver<float> Reverb(Impulse.data(), Impulse.size(), 256);
+Reverb.process(InputBlock, OutputBlock);
+*/
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <stdexcept>
+#include "complex.h"
+#include "vec.h"
+#include "field.h"
+#include <omp.h>
+
+namespace geodesy::core::math {
+
+	enum fft_direction : int {
+		FORWARD 	= -1,		// exp(-2 pi i jk/n), unnormalized.
+		INVERSE 	= 1,		// exp(+2 pi i jk/n), scaled by 1/n.
+	};
+
+	// Smallest length >= aSize whose only prime factors are 2, 3 and 5, used to pad transforms.
+	inline std::size_t fft_fast_size(std::size_t aSize) {
+		if (aSize <= 1) return 1;
+		for (std::size_t n = aSize; ; n++) {
+			std::size_t m = n;
+			while (m % 2 == 0) m /= 2;
+			while (m % 3 == 0) m /= 3;
+			while (m % 5 == 0) m /= 5;
+			if (m == 1) return n;
+		}
+	}
+
+	// ------------------------- Plan ------------------------- //
+
+	template <typename T>
+	class fft_plan {
+	public:
+
+		// Largest prime handled by a direct radix stage, above this Bluestein is used.
+		static constexpr std::size_t BluesteinThreshold = 61;
+
+		struct stage {
+			std::size_t 					Radix;
+			std::size_t 					Span;			// Product of the radices of all earlier stages.
+			std::size_t 					Offset;			// Start of this stage in Twiddle.
+		};
+
+		std::size_t 						Size;
+		std::vector<stage> 					Stage;
+		std::vector<complex<T>> 			Twiddle;		// Forward twiddles, conjugated for INVERSE.
+		std::map<std::size_t, std::vector<complex<T>>> Root;	// Forward roots of unity of generic radices.
+
+		// Bluestein state, only used when a prime factor exceeds the threshold.
+		std::shared_ptr<const fft_plan<T>> 	Inner;
+		std::vector<complex<T>> 			Chirp;			// exp(-i pi k^2 / n)
+		std::vector<complex<T>> 			ChirpSpectrum[2];	// Transformed conjugate chirp, FORWARD and INVERSE.
+
+		explicit fft_plan(std::size_t aSize) : Size(aSize) {
+			if (aSize == 0) {
+				throw std::invalid_argument("fft_plan(): Size must be non zero.");
+			}
+			// Factor, radix 4 first since its butterfly is the cheapest per element.
+			std::vector<std::size_t> Factor;
+			std::size_t n = aSize;
+			while (n % 4 == 0) { Factor.push_back(4); n /= 4; }
+			while (n % 2 == 0) { Factor.push_back(2); n /= 2; }
+			for (std::size_t p = 3; p * p <= n; p += 2) {
+				while (n % p == 0) { Factor.push_back(p); n /= p; }
+			}
+			if (n > 1) Factor.push_back(n);
+
+			std::size_t LargestFactor = 1;
+			for (std::size_t p : Factor) LargestFactor = std::max(LargestFactor, p);
+			if (LargestFactor > BluesteinThreshold) {
+				this->build_bluestein();
+				return;
+			}
+
+			std::size_t Span = 1;
+			for (std::size_t p : Factor) {
+				stage Stage;
+				Stage.Radix 	= p;
+				Stage.Span 		= Span;
+				Stage.Offset 	= Twiddle.size();
+				// w(k, r) = exp(-2 pi i r k / (Span * p)), r = 1 .. p - 1.
+				for (std::size_t k = 0; k < Span; k++) {
+					for (std::size_t r = 1; r < p; r++) {
+						double Angle = -2.0 * constant::pi * (double)(r * k) / (double)(Span * p);
+						Twiddle.push_back(complex<T>((T)std::cos(Angle), (T)std::sin(Angle)));
+					}
+				}
+				if ((p > 5) && (Root.count(p) == 0)) {
+					std::vector<complex<T>> W(p);
+					for (std::size_t r = 0; r < p; r++) {
+						double Angle = -2.0 * constant::pi * (double)r / (double)p;
+						W[r] = complex<T>((T)std::cos(Angle), (T)std::sin(Angle));
+					}
+					Root[p] = W;
+				}
+				this->Stage.push_back(Stage);
+				Span *= p;
+			}
+		}
+
+		// Number of complex<T> elements of scratch space needed by execute().
+		std::size_t scratch_size() const {
+			return Inner ? 2 * Inner->Size + Inner->scratch_size() : Size;
+		}
+
+		// Unnormalized in place transform of Size contiguous elements.
+		void execute(complex<T>* aData, fft_direction aDirection, complex<T>* aScratch) const {
+			if (Inner) {
+				this->execute_bluestein(aData, aDirection, aScratch);
+				return;
+			}
+			complex<T>* In = aData;
+			complex<T>* Out = aScratch;
+			for (const stage& S : Stage) {
+				this->execute_stage(S, In, Out, aDirection);
+				std::swap(In, Out);
+			}
+			if (In != aData) {
+				std::copy(In, In + Size, aData);
+			}
+		}
+
+		// Cached plan for a length, built on first use. Thread safe.
+		static std::shared_ptr<const fft_plan<T>> get(std::size_t aSize) {
+			static std::mutex Mutex;
+			static std::map<std::size_t, std::shared_ptr<const fft_plan<T>>> Cache;
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				auto it = Cache.find(aSize);
+				if (it != Cache.end()) return it->second;
+			}
+			// Built outside of the lock, Bluestein plans request inner plans.
+			std::shared_ptr<const fft_plan<T>> Plan = std::make_shared<const fft_plan<T>>(aSize);
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return Cache.emplace(aSize, Plan).first->second;
+		}
+
+	private:
+
+		// Stockham pass, reads aIn with stride Size / Radix and writes aOut in autosorted order.
+		void execute_stage(const stage& aStage, const complex<T>* aIn, complex<T>* aOut, fft_direction aDirection) const {
+			const std::size_t p 		= aStage.Radix;
+			const std::size_t Span 		= aStage.Span;
+			const std::size_t Stride 	= Size / p;
+			const std::size_t Blocks 	= Stride / Span;
+			const T s 					= (T)aDirection;	// Imaginary sign.
+			const complex<T>* W 		= Twiddle.data() + aStage.Offset;
+			const complex<T>* R 		= p > 5 ? Root.at(p).data() : nullptr;
+			complex<T> v[BluesteinThreshold];
+			for (std::size_t b = 0; b < Blocks; b++) {
+				for (std::size_t k = 0; k < Span; k++) {
+					const std::size_t j = b * Span + k;
+					const complex<T>* w = W + k * (p - 1);
+					v[0] = aIn[j];
+					for (std::size_t r = 1; r < p; r++) {
+						const complex<T>& a = aIn[j + r * Stride];
+						const T wr = w[r - 1][0], wi = s * -w[r - 1][1];
+						v[r] = complex<T>(a[0] * wr - a[1] * wi, a[0] * wi + a[1] * wr);
+					}
+					complex<T>* y = aOut + b * Span * p + k;
+					switch (p) {
+					case 2: {
+						y[0] 		= complex<T>(v[0][0] + v[1][0], v[0][1] + v[1][1]);
+						y[Span] 	= complex<T>(v[0][0] - v[1][0], v[0][1] - v[1][1]);
+						break;
+					}
+					case 3: {
+						const T c = T(-0.5), sn = s * T(0.86602540378443864676);
+						const T t1r = v[1][0] + v[2][0], t1i = v[1][1] + v[2][1];
+						const T t2r = v[1][0] - v[2][0], t2i = v[1][1] - v[2][1];
+						const T mr = v[0][0] + c * t1r, mi = v[0][1] + c * t1i;
+						const T nr = -sn * t2i, ni = sn * t2r;
+						y[0] 		= complex<T>(v[0][0] + t1r, v[0][1] + t1i);
+						y[Span] 	= complex<T>(mr + nr, mi + ni);
+						y[2 * Span] = complex<T>(mr - nr, mi - ni);
+						break;
+					}
+					case 4: {
+						const T t0r = v[0][0] + v[2][0], t0i = v[0][1] + v[2][1];
+						const T t1r = v[0][0] - v[2][0], t1i = v[0][1] - v[2][1];
+						const T t2r = v[1][0] + v[3][0], t2i = v[1][1] + v[3][1];
+						// (v1 - v3) * (s i)
+						const T t3r = -s * (v[1][1] - v[3][1]), t3i = s * (v[1][0] - v[3][0]);
+						y[0] 		= complex<T>(t0r + t2r, t0i + t2i);
+						y[Span] 	= complex<T>(t1r + t3r, t1i + t3i);
+						y[2 * Span] = complex<T>(t0r - t2r, t0i - t2i);
+						y[3 * Span] = complex<T>(t1r - t3r, t1i - t3i);
+						break;
+					}
+					case 5: {
+						const T c1 = T(0.30901699437494742410), c2 = T(-0.80901699437494742410);
+						const T s1 = s * T(0.95105651629515357212), s2 = s * T(0.58778525229247312917);
+						const T t1r = v[1][0] + v[4][0], t1i = v[1][1] + v[4][1];
+						const T t2r = v[2][0] + v[3][0], t2i = v[2][1] + v[3][1];
+						const T t3r = v[1][0] - v[4][0], t3i = v[1][1] - v[4][1];
+						const T t4r = v[2][0] - v[3][0], t4i = v[2][1] - v[3][1];
+						const T m1r = v[0][0] + c1 * t1r + c2 * t2r, m1i = v[0][1] + c1 * t1i + c2 * t2i;
+						const T m2r = v[0][0] + c2 * t1r + c1 * t2r, m2i = v[0][1] + c2 * t1i + c1 * t2i;
+						// i * (s1 t3 + s2 t4) and i * (s2 t3 - s1 t4)
+						const T n1r = -(s1 * t3i + s2 * t4i), n1i = s1 * t3r + s2 * t4r;
+						const T n2r = -(s2 * t3i - s1 * t4i), n2i = s2 * t3r - s1 * t4r;
+						y[0] 		= complex<T>(v[0][0] + t1r + t2r, v[0][1] + t1i + t2i);
+						y[Span] 	= complex<T>(m1r + n1r, m1i + n1i);
+						y[2 * Span] = complex<T>(m2r + n2r, m2i + n2i);
+						y[3 * Span] = complex<T>(m2r - n2r, m2i - n2i);
+						y[4 * Span] = complex<T>(m1r - n1r, m1i - n1i);
+						break;
+					}
+					default: {
+						// Direct DFT of a small odd prime.
+						for (std::size_t q = 0; q < p; q++) {
+							T Re = T(0), Im = T(0);
+							for (std::size_t r = 0; r < p; r++) {
+								const complex<T>& u = R[(q * r) % p];
+								const T ur = u[0], ui = s * -u[1];
+								Re += v[r][0] * ur - v[r][1] * ui;
+								Im += v[r][0] * ui + v[r][1] * ur;
+							}
+							y[q * Span] = complex<T>(Re, Im);
+						}
+						break;
+					}
+					}
+				}
+			}
+		}
+
+		void build_bluestein() {
+			const std::size_t n = Size;
+			const std::size_t m = fft_fast_size(2 * n - 1);
+			Inner = fft_plan<T>::get(m);
+			Chirp.resize(n);
+			for (std::size_t k = 0; k < n; k++) {
+				// k^2 mod 2n keeps the angle argument small for large k.
+				std::size_t k2 = (std::size_t)(((unsigned long long)k * k) % (2 * n));
+				double Angle = -constant::pi * (double)k2 / (double)n;
+				Chirp[k] = complex<T>((T)std::cos(Angle), (T)std::sin(Angle));
+			}
+			std::vector<complex<T>> Scratch(Inner->scratch_size());
+			for (int d = 0; d < 2; d++) {
+				// Kernel b_k = conj(c_k) for FORWARD, c_k for INVERSE, wrapped for negative k.
+				std::vector<complex<T>>& B = ChirpSpectrum[d];
+				B.assign(m, complex<T>());
+				for (std::size_t k = 0; k < n; k++) {
+					complex<T> b = (d == 0) ? ~Chirp[k] : Chirp[k];
+					B[k] = b;
+					if (k > 0) B[m - k] = b;
+				}
+				Inner->execute(B.data(), fft_direction::FORWARD, Scratch.data());
+			}
+		}
+
+		void execute_bluestein(complex<T>* aData, fft_direction aDirection, complex<T>* aScratch) const {
+			const std::size_t n = Size;
+			const std::size_t m = Inner->Size;
+			const bool Forward = (aDirection == fft_direction::FORWARD);
+			const std::vector<complex<T>>& B = ChirpSpectrum[Forward ? 0 : 1];
+			complex<T>* A = aScratch;
+			complex<T>* InnerScratch = aScratch + 2 * m;
+			for (std::size_t k = 0; k < n; k++) {
+				const complex<T> c = Forward ? Chirp[k] : ~Chirp[k];
+				A[k] = aData[k] * c;
+			}
+			std::fill(A + n, A + m, complex<T>());
+			Inner->execute(A, fft_direction::FORWARD, InnerScratch);
+			for (std::size_t k = 0; k < m; k++) {
+				A[k] = A[k] * B[k];
+			}
+			Inner->execute(A, fft_direction::INVERSE, InnerScratch);
+			const T Scale = T(1) / (T)m;
+			for (std::size_t k = 0; k < n; k++) {
+				const complex<T> c = Forward ? Chirp[k] : ~Chirp[k];
+				aData[k] = (A[k] * c) * Scale;
+			}
+		}
+
+	};
+
+	// Half length plan and split twiddles for real transforms of even length.
+	template <typename T>
+	struct fft_real_plan {
+
+		std::size_t 						Size;
+		std::shared_ptr<const fft_plan<T>> 	Half;			// Complex plan of Size / 2, or Size when odd.
+		std::vector<complex<T>> 			Twiddle;		// exp(-2 pi i k / Size), k = 0 .. Size / 2.
+
+		explicit fft_real_plan(std::size_t aSize) : Size(aSize) {
+			if (aSize % 2 == 0) {
+				Half = fft_plan<T>::get(aSize / 2);
+				Twiddle.resize(aSize / 2 + 1);
+				for (std::size_t k = 0; k <= aSize / 2; k++) {
+					double Angle = -2.0 * constant::pi * (double)k / (double)aSize;
+					Twiddle[k] = complex<T>((T)std::cos(Angle), (T)std::sin(Angle));
+				}
+			}
+			else {
+				Half = fft_plan<T>::get(aSize);
+			}
+		}
+
+		std::size_t scratch_size() const {
+			return Half->Size + Half->scratch_size();
+		}
+
+		// aOut receives Size / 2 + 1 bins.
+		void forward(const T* aIn, complex<T>* aOut, complex<T>* aScratch) const {
+			complex<T>* Z = aScratch;
+			complex<T>* Scratch = aScratch + Half->Size;
+			if (Size % 2 != 0) {
+				for (std::size_t i = 0; i < Size; i++) Z[i] = complex<T>(aIn[i], T(0));
+				Half->execute(Z, fft_direction::FORWARD, Scratch);
+				std::copy(Z, Z + Size / 2 + 1, aOut);
+				return;
+			}
+			// Even and odd samples packed as real and imaginary parts.
+			const std::size_t h = Size / 2;
+			for (std::size_t i = 0; i < h; i++) Z[i] = complex<T>(aIn[2 * i], aIn[2 * i + 1]);
+			Half->execute(Z, fft_direction::FORWARD, Scratch);
+			for (std::size_t k = 0; k <= h; k++) {
+				const complex<T> a = Z[k % h];
+				const complex<T> b = ~Z[(h - k) % h];
+				// E = (a + b) / 2, O = (a - b) / 2i, X = E + W^k O
+				const T Er = T(0.5) * (a[0] + b[0]), Ei = T(0.5) * (a[1] + b[1]);
+				const T Or = T(0.5) * (a[1] - b[1]), Oi = -T(0.5) * (a[0] - b[0]);
+				const T wr = Twiddle[k][0], wi = Twiddle[k][1];
+				aOut[k] = complex<T>(Er + wr * Or - wi * Oi, Ei + wr * Oi + wi * Or);
+			}
+		}
+
+		// Reads Size / 2 + 1 bins, writes Size samples scaled by 1 / Size.
+		void inverse(const complex<T>* aIn, T* aOut, complex<T>* aScratch) const {
+			complex<T>* Z = aScratch;
+			complex<T>* Scratch = aScratch + Half->Size;
+			if (Size % 2 != 0) {
+				// Rebuild the redundant half from Hermitian symmetry.
+				for (std::size_t k = 0; k <= Size / 2; k++) Z[k] = aIn[k];
+				for (std::size_t k = Size / 2 + 1; k < Size; k++) Z[k] = ~aIn[Size - k];
+				Half->execute(Z, fft_direction::INVERSE, Scratch);
+				const T Scale = T(1) / (T)Size;
+				for (std::size_t i = 0; i < Size; i++) aOut[i] = Z[i][0] * Scale;
+				return;
+			}
+			const std::size_t h = Size / 2;
+			for (std::size_t k = 0; k < h; k++) {
+				const complex<T> a = aIn[k];
+				const complex<T> b = ~aIn[h - k];
+				// E = (a + b) / 2, O = (a - b) W^-k / 2, Z = E + i O
+				const T Er = T(0.5) * (a[0] + b[0]), Ei = T(0.5) * (a[1] + b[1]);
+				const T dr = T(0.5) * (a[0] - b[0]), di = T(0.5) * (a[1] - b[1]);
+				const T wr = Twiddle[k][0], wi = -Twiddle[k][1];
+				const T Or = dr * wr - di * wi, Oi = dr * wi + di * wr;
+				Z[k] = complex<T>(Er - Oi, Ei + Or);
+			}
+			Half->execute(Z, fft_direction::INVERSE, Scratch);
+			const T Scale = T(1) / (T)h;
+			for (std::size_t i = 0; i < h; i++) {
+				aOut[2 * i] 	= Z[i][0] * Scale;
+				aOut[2 * i + 1] = Z[i][1] * Scale;
+			}
+		}
+
+		static std::shared_ptr<const fft_real_plan<T>> get(std::size_t aSize) {
+			static std::mutex Mutex;
+			static std::map<std::size_t, std::shared_ptr<const fft_real_plan<T>>> Cache;
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				auto it = Cache.find(aSize);
+				if (it != Cache.end()) return it->second;
+			}
+			std::shared_ptr<const fft_real_plan<T>> Plan = std::make_shared<const fft_real_plan<T>>(aSize);
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return Cache.emplace(aSize, Plan).first->second;
+		}
+
+	};
+
+	// ------------------------- 1D Transforms ------------------------- //
+
+	// In place complex transform of aCount contiguous elements.
+	template <typename T> inline
+	void fft(complex<T>* aData, std::size_t aCount, fft_direction aDirection) {
+		if (aCount <= 1) return;
+		std::shared_ptr<const fft_plan<T>> Plan = fft_plan<T>::get(aCount);
+		std::vector<complex<T>> Scratch(Plan->scratch_size());
+		Plan->execute(aData, aDirection, Scratch.data());
+		if (aDirection == fft_direction::INVERSE) {
+			const T Scale = T(1) / (T)aCount;
+			for (std::size_t i = 0; i < aCount; i++) aData[i] *= Scale;
+		}
+	}
+
+	// Real input of aCount samples to aCount / 2 + 1 bins.
+	template <typename T> inline
+	void rfft(const T* aIn, std::size_t aCount, complex<T>* aOut) {
+		if (aCount == 0) return;
+		std::shared_ptr<const fft_real_plan<T>> Plan = fft_real_plan<T>::get(aCount);
+		std::vector<complex<T>> Scratch(Plan->scratch_size());
+		Plan->forward(aIn, aOut, Scratch.data());
+	}
+
+	// aCount / 2 + 1 bins back to aCount real samples, scaled by 1 / aCount.
+	template <typename T> inline
+	void irfft(const complex<T>* aIn, std::size_t aCount, T* aOut) {
+		if (aCount == 0) return;
+		std::shared_ptr<const fft_real_plan<T>> Plan = fft_real_plan<T>::get(aCount);
+		std::vector<complex<T>> Scratch(Plan->scratch_size());
+		Plan->inverse(aIn, aOut, Scratch.data());
+	}
+
+	// ------------------------- Multidimensional Transforms ------------------------- //
+
+	// Lines along an axis are gathered this many at a time, so strided axes read whole cache lines.
+	constexpr std::size_t FFTLineBatch = 8;
+
+	// Transforms every line along aAxis of a dense array laid out like field storage (axis 0 contiguous).
+	template <typename T, std::size_t N> inline
+	void fft_axis(complex<T>* aData, const vec<std::size_t, N>& aCount, std::size_t aAxis, fft_direction aDirection) {
+		const std::size_t n = aCount[aAxis];
+		if (n <= 1) return;
+		std::size_t Stride = 1, Total = 1;
+		for (std::size_t i = 0; i < N; i++) {
+			if (i < aAxis) Stride *= aCount[i];
+			Total *= aCount[i];
+		}
+		const std::size_t Outer = Total / (Stride * n);
+		const std::size_t Groups = (Stride + FFTLineBatch - 1) / FFTLineBatch;
+		const T Scale = aDirection == fft_direction::INVERSE ? T(1) / (T)n : T(1);
+		std::shared_ptr<const fft_plan<T>> Plan = fft_plan<T>::get(n);
+		const std::ptrdiff_t TaskCount = (std::ptrdiff_t)(Outer * Groups);
+		#pragma omp parallel
+		{
+			std::vector<complex<T>> Line(FFTLineBatch * n);
+			std::vector<complex<T>> Scratch(Plan->scratch_size());
+			#pragma omp for schedule(static)
+			for (std::ptrdiff_t Task = 0; Task < TaskCount; Task++) {
+				const std::size_t o = (std::size_t)Task / Groups;
+				const std::size_t g0 = ((std::size_t)Task % Groups) * FFTLineBatch;
+				const std::size_t g1 = std::min(g0 + FFTLineBatch, Stride);
+				complex<T>* Base = aData + o * Stride * n;
+				if (Stride == 1) {
+					// Contiguous line, transform in place.
+					Plan->execute(Base, aDirection, Scratch.data());
+					if (Scale != T(1)) for (std::size_t i = 0; i < n; i++) Base[i] *= Scale;
+					continue;
+				}
+				for (std::size_t i = 0; i < n; i++) {
+					for (std::size_t g = g0; g < g1; g++) {
+						Line[(g - g0) * n + i] = Base[i * Stride + g];
+					}
+				}
+				for (std::size_t g = g0; g < g1; g++) {
+					Plan->execute(Line.data() + (g - g0) * n, aDirection, Scratch.data());
+				}
+				for (std::size_t i = 0; i < n; i++) {
+					for (std::size_t g = g0; g < g1; g++) {
+						Base[i * Stride + g] = Line[(g - g0) * n + i] * Scale;
+					}
+				}
+			}
+		}
+	}
+
+	// In place N dimensional complex transform of a field, bounds are left untouched.
+	template <typename X, std::size_t N, typename T> inline
+	void fft(field<X, N, complex<T>>& aField, fft_direction aDirection) {
+		for (std::size_t a = 0; a < N; a++) {
+			fft_axis<T, N>(aField.data(), aField.ElementCount, a, aDirection);
+		}
+	}
+
+	// Real to complex transform of a field, axis 0 shrinks to ElementCount[0] / 2 + 1 bins.
+	// Bounds are carried over so irfft can restore the original field.
+	template <typename X, std::size_t N, typename T> inline
+	field<X, N, complex<T>> rfft(const field<X, N, T>& aField) {
+		const std::size_t n = aField.ElementCount[0];
+		vec<std::size_t, N> SpectrumCount = aField.ElementCount;
+		SpectrumCount[0] = n / 2 + 1;
+		field<X, N, complex<T>> Out(SpectrumCount);
+		Out.LowerBound = aField.LowerBound;
+		Out.UpperBound = aField.UpperBound;
+		if (aField.size() == 0) return Out;
+		const std::ptrdiff_t RowCount = (std::ptrdiff_t)(aField.size() / n);
+		std::shared_ptr<const fft_real_plan<T>> Plan = fft_real_plan<T>::get(n);
+		#pragma omp parallel
+		{
+			std::vector<complex<T>> Scratch(Plan->scratch_size());
+			#pragma omp for schedule(static)
+			for (std::ptrdiff_t r = 0; r < RowCount; r++) {
+				Plan->forward(aField.data() + r * n, Out.data() + r * SpectrumCount[0], Scratch.data());
+			}
+		}
+		for (std::size_t a = 1; a < N; a++) {
+			fft_axis<T, N>(Out.data(), Out.ElementCount, a, fft_direction::FORWARD);
+		}
+		return Out;
+	}
+
+	// Inverse of rfft, aCount is the original length of axis 0 since it is ambiguous from the bin count.
+	template <typename X, std::size_t N, typename T> inline
+	field<X, N, T> irfft(const field<X, N, complex<T>>& aSpectrum, std::size_t aCount) {
+		if (aSpectrum.ElementCount[0] != aCount / 2 + 1) {
+			throw std::invalid_argument("irfft(): Spectrum does not match the requested length.");
+		}
+		field<X, N, complex<T>> Work = aSpectrum;
+		for (std::size_t a = 1; a < N; a++) {
+			fft_axis<T, N>(Work.data(), Work.ElementCount, a, fft_direction::INVERSE);
+		}
+		vec<std::size_t, N> Count = aSpectrum.ElementCount;
+		Count[0] = aCount;
+		field<X, N, T> Out(Count);
+		Out.LowerBound = aSpectrum.LowerBound;
+		Out.UpperBound = aSpectrum.UpperBound;
+		if (Out.size() == 0) return Out;
+		const std::size_t Bins = aSpectrum.ElementCount[0];
+		const std::ptrdiff_t RowCount = (std::ptrdiff_t)(Out.size() / aCount);
+		std::shared_ptr<const fft_real_plan<T>> Plan = fft_real_plan<T>::get(aCount);
+		#pragma omp parallel
+		{
+			std::vector<complex<T>> Scratch(Plan->scratch_size());
+			#pragma omp for schedule(static)
+			for (std::ptrdiff_t r = 0; r < RowCount; r++) {
+				Plan->inverse(Work.data() + r * Bins, Out.data() + r * aCount, Scratch.data());
+			}
+		}
+		return Out;
+	}
+
+	// ------------------------- Convolution ------------------------- //
+
+	// Full linear convolution, aOut receives aSignalCount + aKernelCount - 1 samples.
+	template <typename T> inline
+	void convolve(const T* aSignal, std::size_t aSignalCount, const T* aKernel, std::size_t aKernelCount, T* aOut) {
+		if ((aSignalCount == 0) || (aKernelCount == 0)) return;
+		const std::size_t OutCount = aSignalCount + aKernelCount - 1;
+		const std::size_t n = fft_fast_size(OutCount);
+		std::shared_ptr<const fft_real_plan<T>> Plan = fft_real_plan<T>::get(n);
+		std::vector<complex<T>> Scratch(Plan->scratch_size());
+		std::vector<T> Padded(n);
+		std::vector<complex<T>> A(n / 2 + 1), B(n / 2 + 1);
+		std::copy(aSignal, aSignal + aSignalCount, Padded.begin());
+		Plan->forward(Padded.data(), A.data(), Scratch.data());
+		std::fill(Padded.begin(), Padded.end(), T(0));
+		std::copy(aKernel, aKernel + aKernelCount, Padded.begin());
+		Plan->forward(Padded.data(), B.data(), Scratch.data());
+		for (std::size_t k = 0; k < A.size(); k++) A[k] *= B[k];
+		Plan->inverse(A.data(), Padded.data(), Scratch.data());
+		std::copy(Padded.begin(), Padded.begin() + OutCount, aOut);
+	}
+
+	template <typename T> inline
+	std::vector<T> convolve(const std::vector<T>& aSignal, const std::vector<T>& aKernel) {
+		if (aSignal.empty() || aKernel.empty()) return std::vector<T>();
+		std::vector<T> Out(aSignal.size() + aKernel.size() - 1);
+		convolve(aSignal.data(), aSignal.size(), aKernel.data(), aKernel.size(), Out.data());
+		return Out;
+	}
+
+	// Convolution of a field with a kernel sampled on the same grid spacing. The result is on
+	// the grid of aField, with the kernel centered at index ElementCount / 2, and samples
+	// outside of aField treated as zero, i.e. the "same" mode of direct convolution.
+	template <typename X, std::size_t N, typename T> inline
+	field<X, N, T> convolve(const field<X, N, T>& aField, const field<X, N, T>& aKernel) {
+		vec<std::size_t, N> Padded;
+		for (std::size_t i = 0; i < N; i++) {
+			if ((aField.ElementCount[i] == 0) || (aKernel.ElementCount[i] == 0)) return field<X, N, T>(aField.ElementCount);
+			// Even lengths keep the real transform on its half length fast path.
+			Padded[i] = fft_fast_size(aField.ElementCount[i] + aKernel.ElementCount[i] - 1);
+			if ((i == 0) && (Padded[i] % 2 != 0)) Padded[i] = fft_fast_size(Padded[i] + 1);
+		}
+
+		// Zero pad both operands onto the common transform grid.
+		auto pad = [&](const field<X, N, T>& aSource) {
+			field<X, N, T> Out(Padded);
+			for (std::size_t i = 0; i < aSource.size(); i++) {
+				std::size_t Index = 0, Multiplier = 1, Remainder = i;
+				for (std::size_t a = 0; a < N; a++) {
+					Index += (Remainder % aSource.ElementCount[a]) * Multiplier;
+					Remainder /= aSource.ElementCount[a];
+					Multiplier *= Padded[a];
+				}
+				Out[Index] = aSource[i];
+			}
+			return Out;
+		};
+
+		field<X, N, complex<T>> A = rfft(pad(aField));
+		field<X, N, complex<T>> B = rfft(pad(aKernel));
+		#pragma omp parallel for
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)A.size(); i++) {
+			A[i] *= B[i];
+		}
+		field<X, N, T> Full = irfft(A, Padded[0]);
+
+		// Crop the centered window back onto the field's grid.
+		field<X, N, T> Out(aField.ElementCount);
+		Out.LowerBound = aField.LowerBound;
+		Out.UpperBound = aField.UpperBound;
+		#pragma omp parallel for
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)Out.size(); i++) {
+			std::size_t Index = 0, Multiplier = 1, Remainder = (std::size_t)i;
+			for (std::size_t a = 0; a < N; a++) {
+				Index += (Remainder % aField.ElementCount[a] + aKernel.ElementCount[a] / 2) * Multiplier;
+				Remainder /= aField.ElementCount[a];
+				Multiplier *= Padded[a];
+			}
+			Out[i] = Full[Index];
+		}
+		return Out;
+	}
+
+	// Uniformly partitioned overlap save convolution of a stream with a long impulse
+	// response. The kernel is split into blocks of BlockSize, each stored as a spectrum
+	// of length 2 * BlockSize, and each call to process() costs one forward and one
+	// inverse transform plus a complex multiply accumulate per partition, with a latency
+	// of BlockSize samples.
+	template <typename T>
+	class fft_convolver {
+	public:
+
+		std::size_t 										BlockSize;
+		std::size_t 										PartitionCount;
+		std::shared_ptr<const fft_real_plan<T>> 			Plan;
+		std::vector<std::vector<complex<T>>> 				KernelSpectrum;		// One per partition.
+		std::vector<std::vector<complex<T>>> 				InputSpectrum;		// Frequency domain delay line.
+		std::size_t 										Head;				// Newest entry of InputSpectrum.
+		std::vector<T> 										Window;				// Last 2 * BlockSize input samples.
+		std::vector<complex<T>> 							Accumulator;
+		std::vector<complex<T>> 							Scratch;
+		std::vector<T> 										Time;
+
+		fft_convolver(const T* aKernel, std::size_t aKernelCount, std::size_t aBlockSize) : BlockSize(aBlockSize), Head(0) {
+			if ((aBlockSize == 0) || (aKernelCount == 0)) {
+				throw std::invalid_argument("fft_convolver(): Block and kernel sizes must be non zero.");
+			}
+			const std::size_t n = 2 * BlockSize;
+			const std::size_t Bins = BlockSize + 1;
+			PartitionCount = (aKernelCount + BlockSize - 1) / BlockSize;
+			Plan = fft_real_plan<T>::get(n);
+			Scratch.resize(Plan->scratch_size());
+			Time.assign(n, T(0));
+			KernelSpectrum.resize(PartitionCount);
+			for (std::size_t p = 0; p < PartitionCount; p++) {
+				std::fill(Time.begin(), Time.end(), T(0));
+				const std::size_t Start = p * BlockSize;
+				const std::size_t Count = std::min(BlockSize, aKernelCount - Start);
+				std::copy(aKernel + Start, aKernel + Start + Count, Time.begin());
+				KernelSpectrum[p].resize(Bins);
+				Plan->forward(Time.data(), KernelSpectrum[p].data(), Scratch.data());
+			}
+			InputSpectrum.assign(PartitionCount, std::vector<complex<T>>(Bins));
+			Window.assign(n, T(0));
+			Accumulator.resize(Bins);
+		}
+
+		// Consumes BlockSize input samples and produces BlockSize output samples.
+		void process(const T* aIn, T* aOut) {
+			const std::size_t Bins = BlockSize + 1;
+			// Slide the input window and transform it into the newest delay line slot.
+			std::copy(Window.begin() + BlockSize, Window.end(), Window.begin());
+			std::copy(aIn, aIn + BlockSize, Window.begin() + BlockSize);
+			Head = (Head + PartitionCount - 1) % PartitionCount;
+			Plan->forward(Window.data(), InputSpectrum[Head].data(), Scratch.data());
+
+			// Y = sum_p X(t - p) H_p
+			std::fill(Accumulator.begin(), Accumulator.end(), complex<T>());
+			for (std::size_t p = 0; p < PartitionCount; p++) {
+				const complex<T>* Xp = InputSpectrum[(Head + p) % PartitionCount].data();
+				const complex<T>* Hp = KernelSpectrum[p].data();
+				for (std::size_t k = 0; k < Bins; k++) {
+					Accumulator[k][0] += Xp[k][0] * Hp[k][0] - Xp[k][1] * Hp[k][1];
+					Accumulator[k][1] += Xp[k][0] * Hp[k][1] + Xp[k][1] * Hp[k][0];
+				}
+			}
+
+			// Overlap save, the second half of the circular result is the valid linear part.
+			Plan->inverse(Accumulator.data(), Time.data(), Scratch.data());
+			std::copy(Time.begin() + BlockSize, Time.end(), aOut);
+		}
+
+		// Clears the stream history, the kernel is kept.
+		void reset() {
+			for (std::vector<complex<T>>& X : InputSpectrum) std::fill(X.begin(), X.end(), complex<T>());
+			std::fill(Window.begin(), Window.end(), T(0));
+			Head = 0;
+		}
+
+	};
+
+}
+
+#endif // !GEODESY_CORE_MATH_FFT_H
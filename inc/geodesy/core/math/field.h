@@ -13,14 +13,35 @@ Outside of the bounds, should return a zero value. Inspect this code and for ins
 if there are scalars that are being added, divided, singular argument functions, 
 we can skip using sampling to take averages. We can apply to each element directly 
 and save compute time. We want to be able compose compile time math expressions that readable.
+
+Arithmetic and the math functions below do not produce fields directly, they build
+lightweight expression nodes (field_unary, field_binary, field_scalar) that reference
+their operands. The whole expression is evaluated in a single parallel loop when it is
+assigned to a field, so no intermediate fields are allocated. When every field in an
+expression shares the same grid, the loop indexes storage directly. Fields on different
+grids are combined by sampling each operand at the grid points of the union (+, -) or
+intersection (*, /) domain. Since nodes hold references to fields, assign expressions to
+a field rather than keeping them in an auto variable past the lifetime of their operands.
+
+For lookups in hot loops, field::sampler caches the strides and inverse step sizes of
+a field once, and its batch sample() interpolates many positions in parallel.
+
+grad, div, curl and laplacian are finite difference stencils evaluated over row tiles
+sized to stay in cache, configured through a stencil (difference scheme and boundary).
 // Example usage:
-field<float, 1, float> x(-5.0f, 5.0f, 1024);
-field<float, 1, float> y = 10f * 0.5f * (sin(x * x) + 1.0f);
+field<float, 1, float> x(-5.0f, 5.0f, 1024, 1);
+field<float, 1, float> y = 10.0f * 0.5f * (sin(x * x) + 1.0f);
+field<float, 1, float>::sampler Lookup(y, field<float, 1, float>::sampler::CLAMP);
+Lookup.sample(Positions.data(), Values.data(), Positions.size());
 */
 
 #include <cmath>
+#include <array>
+#include <algorithm>
+#include <new>
 #include <vector>
 #include <stdexcept>
+#include <type_traits>
 #include "vec.h"
 #include <omp.h>
 
@@ -31,10 +52,95 @@ namespace geodesy::core::math {
     	return (n == 0) ? 1 : 2 * power_of_two(n - 1);
 	}
 
+	constexpr std::size_t integer_power(std::size_t aBase, std::size_t aExponent) {
+		return (aExponent == 0) ? 1 : aBase * integer_power(aBase, aExponent - 1);
+	}
+
+	// Allocator for field storage, aligns the element array to cache lines so the
+	// evaluation loops can use aligned vector loads.
+	template <typename T, std::size_t Alignment = 64>
+	struct aligned_allocator {
+		typedef T value_type;
+		template <typename U> struct rebind { typedef aligned_allocator<U, Alignment> other; };
+
+		aligned_allocator() noexcept {}
+		template <typename U> aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+		T* allocate(std::size_t aCount) {
+			return static_cast<T*>(::operator new(aCount * sizeof(T), std::align_val_t(Alignment)));
+		}
+
+		void deallocate(T* aPtr, std::size_t) noexcept {
+			::operator delete(aPtr, std::align_val_t(Alignment));
+		}
+
+		template <typename U> bool operator==(const aligned_allocator<U, Alignment>&) const noexcept { return true; }
+		template <typename U> bool operator!=(const aligned_allocator<U, Alignment>&) const noexcept { return false; }
+	};
+
+	// Sample grid of a field, the bounds and the number of samples along each dimension.
+	template <typename X, std::size_t N>
+	struct field_domain {
+		vec<std::size_t, N> ElementCount;
+		vec<X, N> LowerBound, UpperBound;
+
+		bool operator==(const field_domain<X, N>& aRhs) const {
+			return (ElementCount == aRhs.ElementCount) && (LowerBound == aRhs.LowerBound) && (UpperBound == aRhs.UpperBound);
+		}
+
+		bool operator!=(const field_domain<X, N>& aRhs) const {
+			return !(*this == aRhs);
+		}
+
+		// Union of two domains.
+		field_domain<X, N> operator|(const field_domain<X, N>& aRhs) const {
+			field_domain<X, N> Out;
+			for (std::size_t i = 0; i < N; i++) {
+				Out.LowerBound[i] 	= std::min(LowerBound[i], aRhs.LowerBound[i]);
+				Out.UpperBound[i] 	= std::max(UpperBound[i], aRhs.UpperBound[i]);
+				Out.ElementCount[i] = std::max(ElementCount[i], aRhs.ElementCount[i]);
+			}
+			return Out;
+		}
+
+		// Intersection of two domains.
+		field_domain<X, N> operator&(const field_domain<X, N>& aRhs) const {
+			field_domain<X, N> Out;
+			for (std::size_t i = 0; i < N; i++) {
+				Out.LowerBound[i] 	= std::max(LowerBound[i], aRhs.LowerBound[i]);
+				Out.UpperBound[i] 	= std::min(UpperBound[i], aRhs.UpperBound[i]);
+				Out.ElementCount[i] = std::max(ElementCount[i], aRhs.ElementCount[i]);
+			}
+			return Out;
+		}
+	};
+
+	// ------------------------- Expression Base ------------------------- //
+
+	// Base of every field expression node, including field itself. Nodes provide:
+	// domain()		- The sample grid the expression is evaluated on.
+	// aligned()	- True if every field in the expression lives on domain().
+	// operator[]	- Value at a storage index, only valid when aligned().
+	// sample()		- Value at an arbitrary position in the domain.
+	template <typename E>
+	struct field_expression {
+		const E& derived() const { return static_cast<const E&>(*this); }
+	};
+
+	template <typename E>
+	struct is_field_expression : std::is_base_of<field_expression<E>, E> {};
+
+	template <typename E>
+	constexpr bool is_field_expression_v = is_field_expression<std::decay_t<E>>::value;
+
 	template <typename X, std::size_t N, typename Y>
-	class field : public std::vector<Y> {
+	class field : public std::vector<Y, aligned_allocator<Y>>, public field_expression<field<X, N, Y>> {
 	public:
 
+		typedef X domain_type;
+		typedef Y range_type;
+		static constexpr std::size_t dimension_count = N;
+
 		// Domain boundaries, must have middle values to interpolate.
 		vec<std::size_t, N> ElementCount;
 		vec<X, N> LowerBound, UpperBound;
@@ -67,183 +173,225 @@ namespace geodesy::core::math {
 			}
 			this->resize(ElementCountTotal, Y());
 
-			// Check if domain needs to be generated.
-			if ((aDomainType > 0) && (aDomainType <= N)) {
-				// ds is the step size for each dimension.
-				vec<X, N> ds = (aUpperBound - aLowerBound);
-				for (std::size_t i = 0; i < N; i++) {
-					ds[i] /= aElementCount[i] - 1;
-				}
+			// Check if domain needs to be generated, only meaningful for scalar ranges.
+			if constexpr (std::is_convertible_v<X, Y>) {
+				if ((aDomainType > 0) && (aDomainType <= N)) {
+					// ds is the step size for each dimension.
+					vec<X, N> ds = (aUpperBound - aLowerBound);
+					for (std::size_t i = 0; i < N; i++) {
+						ds[i] /= aElementCount[i] - 1;
+					}
 
-				// Generate the field values based on the domain type.
-				for (std::ptrdiff_t i = 0; i < this->size(); i++) {
-					// This is to generate numerical dimensions along each axis, which can be used for numerical functions.
-					// ds is the step which will be used to generate the value at each sample point in the domain.
-					vec<std::size_t, N> Index = this->convert_to_dimensional_index(i);
-					(*this)[i] = ds[aDomainType - 1] * Index[aDomainType - 1] + aLowerBound[aDomainType - 1];
+					// Generate the field values based on the domain type.
+					for (std::ptrdiff_t i = 0; i < this->size(); i++) {
+						// This is to generate numerical dimensions along each axis, which can be used for numerical functions.
+						// ds is the step which will be used to generate the value at each sample point in the domain.
+						vec<std::size_t, N> Index = this->convert_to_dimensional_index(i);
+						(*this)[i] = ds[aDomainType - 1] * Index[aDomainType - 1] + aLowerBound[aDomainType - 1];
+					}
 				}
 			}
 		}
 
-		// Access f(x) = y. Uses interpolation.
+		// Evaluates an expression into a new field on the expression's domain.
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		field(const field_expression<E>& aExpression) : field() {
+			this->assign(aExpression);
+		}
+
+		// Access f(x) = y. Uses interpolation, returns Y() outside of the domain.
+		// Use a sampler directly when sampling many points.
 		Y operator()(const vec<X, N>& aX) const {
-			Y ReturnValue = Y();
-			bool InsideBounds = true;
-			for (std::size_t i = 0; i < N; i++) {
-				InsideBounds &= (aX[i] >= LowerBound[i]) && (aX[i] <= UpperBound[i]);
-			}
-			if (!InsideBounds) return ReturnValue;
-			std::array<vec<std::size_t, N>, power_of_two(N)> NeighbourIndices;
-			std::array<vec<X, N>, power_of_two(N)> SamplePositions;
-			std::array<Y, power_of_two(N)> SamplePoints;
+			if (this->size() == 0) return Y();
+			return sampler(*this, sampler::ZERO)(aX);
+		}
 
-			// ds is the step size for each dimension.
-			vec<X, N> ds = (UpperBound - LowerBound);
-			for (std::size_t i = 0; i < N; i++) {
-				ds[i] /= ElementCount[i] - 1;
-			}
+		// Single dimension access.
+		Y operator()(const X& aX) {
+			return (*this)(vec<X, 1>{aX});
+		}
 
-			// Determine Lower Nearest Neighbour.
-			for (std::size_t i = 0; i < N; i++) {
-				// ds = (X2 - X1) / (N - 1)
-				// i = ((X - X1) / ds) + 1
-				NeighbourIndices[0][i] = std::floor((aX[i] - LowerBound[i]) / ds[i]);
+		// ------------------------- Sampler ------------------------- //
+
+		// Precomputed interpolation state for repeated lookups into a field. Strides,
+		// inverse step sizes and the border policy are resolved once at construction,
+		// so each sample is a floor, 2^N weighted loads and no bounds checks beyond the
+		// border fix up. The sampler references the field, so the field must not be
+		// reshaped while the sampler is in use.
+		class sampler {
+		public:
+
+			enum border : int {
+				CLAMP,		// Positions outside the domain use the nearest edge value.
+				WRAP,		// Positions outside the domain wrap around periodically.
+				ZERO,		// Positions outside the domain sample to Y().
+			};
+
+			const field*						Field;
+			border								Border;
+			vec<X, N>							LowerBound;
+			vec<X, N>							UpperBound;
+			vec<X, N>							InverseStep;
+			std::array<std::ptrdiff_t, N>		Count;
+			std::array<std::ptrdiff_t, N>		Stride;
+
+			sampler(const field& aField, border aBorder = ZERO) : Field(&aField), Border(aBorder), LowerBound(aField.LowerBound), UpperBound(aField.UpperBound) {
+				std::ptrdiff_t Product = 1;
+				for (std::size_t i = 0; i < N; i++) {
+					Count[i] = aField.ElementCount[i];
+					Stride[i] = Product;
+					Product *= Count[i];
+					// Degenerate axes collapse to their only sample.
+					InverseStep[i] = (Count[i] > 1) && (UpperBound[i] != LowerBound[i]) ? (X)(Count[i] - 1) / (UpperBound[i] - LowerBound[i]) : X();
+				}
 			}
 
-			// Generate list of neighboring points with contain aX.
-			for (std::size_t i = 1; i < power_of_two(N); i++) {
-				NeighbourIndices[i] = NeighbourIndices[0];
-				for (std::size_t j = 0; j < N; j++) {
-					if (i & (1 << j)) {
-						NeighbourIndices[i][j]++;
+			// Multilinear interpolation at aX.
+			Y operator()(const vec<X, N>& aX) const {
+				std::array<std::ptrdiff_t, 2 * N> Offset;
+				std::array<X, 2 * N> Weight;
+
+				if (Border == ZERO) {
+					for (std::size_t i = 0; i < N; i++) {
+						if ((aX[i] < LowerBound[i]) || (aX[i] > UpperBound[i])) return Y();
 					}
 				}
-			}
 
-			// Load Sample Positions & Sample Points to stack memory.
-			for (std::size_t i = 0; i < power_of_two(N); i++) {
-				SamplePositions[i] = convert_index_to_position(NeighbourIndices[i]);
-				if ((NeighbourIndices[i] >= vec<std::size_t, N>()) && (NeighbourIndices[i] < ElementCount)) {
-					size_t GlobalIndex = this->convert_to_global_index(NeighbourIndices[i]);
-					SamplePoints[i] = (*this)[GlobalIndex];
-				} else {
-					SamplePoints[i] = Y();
+				// Resolve the two neighbouring indices and weights along each axis.
+				for (std::size_t i = 0; i < N; i++) {
+					X U = (aX[i] - LowerBound[i]) * InverseStep[i];
+					X Floor = std::floor(U);
+					X T = U - Floor;
+					std::ptrdiff_t I0 = (std::ptrdiff_t)Floor;
+					std::ptrdiff_t I1 = I0 + 1;
+					switch (Border) {
+					case CLAMP:
+						I0 = std::min(std::max(I0, std::ptrdiff_t(0)), Count[i] - 1);
+						I1 = std::min(std::max(I1, std::ptrdiff_t(0)), Count[i] - 1);
+						break;
+					case WRAP:
+						I0 = ((I0 % Count[i]) + Count[i]) % Count[i];
+						I1 = ((I1 % Count[i]) + Count[i]) % Count[i];
+						break;
+					default:
+						// Inside the domain only the upper edge can round past the last sample.
+						I0 = std::min(I0, Count[i] - 1);
+						I1 = std::min(I1, Count[i] - 1);
+						break;
+					}
+					Offset[2 * i + 0] = I0 * Stride[i];
+					Offset[2 * i + 1] = I1 * Stride[i];
+					Weight[2 * i + 0] = X(1) - T;
+					Weight[2 * i + 1] = T;
 				}
+
+				// Accumulate the 2^N corners of the enclosing cell.
+				const Y* Data = Field->data();
+				Y Out = Y();
+				for (std::size_t c = 0; c < power_of_two(N); c++) {
+					std::ptrdiff_t Index = 0;
+					X W = X(1);
+					for (std::size_t i = 0; i < N; i++) {
+						std::size_t Bit = (c >> i) & 1;
+						Index += Offset[2 * i + Bit];
+						W *= Weight[2 * i + Bit];
+					}
+					Out += Data[Index] * W;
+				}
+				return Out;
 			}
 
-			// Iteratively reduce the problem dimensionality.
-        	std::size_t CurrentPoints = power_of_two(N);
-        	for (std::size_t Dim = 0; Dim < N; ++Dim) {
-        	    std::size_t Step = CurrentPoints / 2;
-        	    for (std::size_t i = 0; i < Step; ++i) {
-        	        X Denominator = SamplePositions[2 * i + 1][Dim] - SamplePositions[2 * i][Dim];
+			// Samples aCount positions from aIn into aOut, in parallel.
+			void sample(const vec<X, N>* aIn, Y* aOut, std::size_t aCount) const {
+				if (Field->size() == 0) {
+					throw std::runtime_error("field::sampler::sample(): Cannot sample an empty field.");
+				}
+				#pragma omp parallel for schedule(static)
+				for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aCount; i++) {
+					aOut[i] = (*this)(aIn[i]);
+				}
+			}
 
-        	        // Check for zero denominator to avoid division by zero.
-        	        if (std::fabs(Denominator) < std::numeric_limits<X>::epsilon()) {
-        	            SamplePoints[i] = SamplePoints[2 * i]; // Use the first point if they are effectively the same.
-        	        } else {
-        	            X T = (aX[Dim] - SamplePositions[2 * i][Dim]) / Denominator;
-        	            SamplePoints[i] = SamplePoints[2 * i] * (1 - T) + SamplePoints[2 * i + 1] * T;
-        	        }
+			std::vector<Y> sample(const std::vector<vec<X, N>>& aIn) const {
+				std::vector<Y> Out(aIn.size());
+				this->sample(aIn.data(), Out.data(), aIn.size());
+				return Out;
+			}
 
-        	        // Update sample positions for the next round.
-        	        SamplePositions[i] = SamplePositions[2 * i]; // Keep track of updated positions.
-        	    }
+		};
 
-        	    // Halve the number of points for the next dimension.
-        	    CurrentPoints /= 2;
-        	}
+		// ------------------------- Expression Interface ------------------------- //
 
-			return SamplePoints[0];
+		field_domain<X, N> domain() const {
+			field_domain<X, N> Out;
+			Out.ElementCount = ElementCount;
+			Out.LowerBound = LowerBound;
+			Out.UpperBound = UpperBound;
+			return Out;
 		}
 
-		// Single dimension access.
-		Y operator()(const X& aX) {
-			return (*this)(vec<X, 1>{aX});
+		bool aligned() const {
+			return true;
 		}
 
-		// Determines the union bounds of the two fields.
-		field<X, N, Y> operator|(const field<X, N, Y>& aRhs) const {
-			field<X, N, Y> Out;
-			for (std::size_t i = 0; i < N; i++) {
-				Out.LowerBound[i] 	= std::min(this->LowerBound[i], aRhs.LowerBound[i]);
-				Out.UpperBound[i] 	= std::max(this->UpperBound[i], aRhs.UpperBound[i]);
-				Out.ElementCount[i] = std::max(this->ElementCount[i], aRhs.ElementCount[i]);
-			}
-			std::size_t ElementCountTotal = 1;
-			for (std::size_t i = 0; i < N; i++) {
-				ElementCountTotal *= Out.ElementCount[i];
-			}
-			Out.resize(ElementCountTotal, Y());
-			return Out;
+		Y sample(const vec<X, N>& aX) const {
+			return (*this)(aX);
 		}
 
-		// Determines the intersection bounds of the two fields.
-		field<X, N, Y> operator&(const field<X, N, Y>& aRhs) const {
-			field<X, N, Y> Out;
-			for (std::size_t i = 0; i < N; i++) {
-				Out.LowerBound[i] 	= std::max(this->LowerBound[i], aRhs.LowerBound[i]);
-				Out.UpperBound[i] 	= std::min(this->UpperBound[i], aRhs.UpperBound[i]);
-				Out.ElementCount[i] = std::max(this->ElementCount[i], aRhs.ElementCount[i]);
-			}
+		// Resizes the field to cover aDomain, existing values are not preserved.
+		void reshape(const field_domain<X, N>& aDomain) {
+			ElementCount = aDomain.ElementCount;
+			LowerBound = aDomain.LowerBound;
+			UpperBound = aDomain.UpperBound;
 			std::size_t ElementCountTotal = 1;
 			for (std::size_t i = 0; i < N; i++) {
-				ElementCountTotal *= Out.ElementCount[i];
+				ElementCountTotal *= ElementCount[i];
 			}
-			Out.resize(ElementCountTotal, Y());
-			return Out;
+			this->resize(ElementCountTotal);
 		}
 
-		field<X, N, Y> operator-() const {
-			field<X, N, Y> Out = *this;
-			for (std::size_t i = 0; i < N; i++) {
-				Out[i] = -(*this)[i];
+		// Evaluates an expression into this field in a single fused parallel pass.
+		template <typename E>
+		field<X, N, Y>& assign(const field_expression<E>& aExpression) {
+			const E& Expression = aExpression.derived();
+			if (Expression.aligned()) {
+				// Element wise reads at the written index, safe even if this field is an operand.
+				this->reshape(Expression.domain());
+				#pragma omp parallel for
+				for (std::ptrdiff_t i = 0; i < this->size(); i++) {
+					(*this)[i] = Expression[i];
+				}
 			}
-			return Out;
-		}
-
-		field<X, N, Y> operator+(const field<X, N, Y>& aRhs) const {
-			field<X, N, Y> Out = *this | aRhs;
-			#pragma omp parallel for
-			for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-				vec<std::size_t, N> Index = Out.convert_to_dimensional_index(i);
-				vec<X, N> Position = Out.convert_index_to_position(Index);
-				Out[i] = (*this)(Position) + aRhs(Position);
+			else {
+				// Operands are sampled at neighbouring points, so evaluate out of place.
+				field<X, N, Y> Out;
+				Out.reshape(Expression.domain());
+				#pragma omp parallel for
+				for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
+					Out[i] = Expression.sample(Out.convert_index_to_position(Out.convert_to_dimensional_index(i)));
+				}
+				*this = std::move(Out);
 			}
-			return Out;
+			return *this;
 		}
 
-		field<X, N, Y> operator-(const field<X, N, Y>& aRhs) const {
-			field<X, N, Y> Out = *this | aRhs;
-			#pragma omp parallel for
-			for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-				vec<std::size_t, N> Index = Out.convert_to_dimensional_index(i);
-				vec<X, N> Position = Out.convert_index_to_position(Index);
-				Out[i] = (*this)(Position) - aRhs(Position);
-			}
+		// Determines the union bounds of the two fields.
+		field<X, N, Y> operator|(const field<X, N, Y>& aRhs) const {
+			field<X, N, Y> Out;
+			Out.reshape(this->domain() | aRhs.domain());
 			return Out;
 		}
 
-		field<X, N, Y> operator*(const field<X, N, Y>& aRhs) const {
-			field<X, N, Y> Out = *this & aRhs;
-			#pragma omp parallel for
-			for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-				vec<std::size_t, N> Index = Out.convert_to_dimensional_index(i);
-				vec<X, N> Position = Out.convert_index_to_position(Index);
-				Out[i] = (*this)(Position) * aRhs(Position);
-			}
+		// Determines the intersection bounds of the two fields.
+		field<X, N, Y> operator&(const field<X, N, Y>& aRhs) const {
+			field<X, N, Y> Out;
+			Out.reshape(this->domain() & aRhs.domain());
 			return Out;
 		}
 
-		field<X, N, Y> operator/(const field<X, N, Y>& aRhs) const {
-			field<X, N, Y> Out = *this & aRhs;
-			#pragma omp parallel for
-			for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-				vec<std::size_t, N> Index = Out.convert_to_dimensional_index(i);
-				vec<X, N> Position = Out.convert_index_to_position(Index);
-				Out[i] = (*this)(Position) / aRhs(Position);
-			}
-			return Out;
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		field<X, N, Y>& operator=(const field_expression<E>& aRhs) {
+			return this->assign(aRhs);
 		}
 
 		field<X, N, Y>& operator=(const Y& aRhs) {
@@ -254,85 +402,40 @@ namespace geodesy::core::math {
 			return *this;
 		}
 
-		field<X, N, Y>& operator+=(const field<X, N, Y>& aRhs) {
-			(*this) = (*this) + aRhs;
-			return *this;
-		}
-
-		field<X, N, Y>& operator-=(const field<X, N, Y>& aRhs) {
-			(*this) = (*this) - aRhs;
-			return *this;
-		}
-
-		field<X, N, Y>& operator*=(const field<X, N, Y>& aRhs) {
-			(*this) = (*this) * aRhs;
-			return *this;
-		}
-
-		field<X, N, Y>& operator/=(const field<X, N, Y>& aRhs) {
-			(*this) = (*this) / aRhs;
-			return *this;
-		}
-
-		field<X, N, Y> operator+(const Y& aRhs) const {
-			field<X, N, Y> Out = *this;
-			#pragma omp parallel for
-			for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-				Out[i] = (*this)[i] + aRhs;
-			}
-			return Out;
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		field<X, N, Y>& operator+=(const field_expression<E>& aRhs) {
+			return this->assign(*this + aRhs.derived());
 		}
 
-		field<X, N, Y> operator-(const Y& aRhs) const {
-			field<X, N, Y> Out = *this;
-			#pragma omp parallel for
-			for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-				Out[i] = (*this)[i] - aRhs;
-			}
-			return Out;
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		field<X, N, Y>& operator-=(const field_expression<E>& aRhs) {
+			return this->assign(*this - aRhs.derived());
 		}
 
-		field<X, N, Y> operator*(const Y& aRhs) const {
-			field<X, N, Y> Out = *this;
-			#pragma omp parallel for
-			for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-				Out[i] = (*this)[i] * aRhs;
-			}
-			return Out;
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		field<X, N, Y>& operator*=(const field_expression<E>& aRhs) {
+			return this->assign(*this * aRhs.derived());
 		}
 
-		field<X, N, Y> operator/(const Y& aRhs) const {
-			// Check if aRhs is zero to avoid division by zero.
-			if (std::fabs(aRhs) < std::numeric_limits<Y>::epsilon()) {
-				throw std::runtime_error("Division by zero in field division.");
-			}
-			// Create a new field for the result.
-			field<X, N, Y> Out = *this;
-			#pragma omp parallel for
-			for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-				Out[i] = (*this)[i] / aRhs;
-			}
-			return Out;
+		template <typename E, typename = std::enable_if_t<is_field_expression_v<E>>>
+		field<X, N, Y>& operator/=(const field_expression<E>& aRhs) {
+			return this->assign(*this / aRhs.derived());
 		}
 
 		field<X, N, Y>& operator+=(const Y& aRhs) {
-			(*this) = (*this) + aRhs;
-			return *this;
+			return this->assign(*this + aRhs);
 		}
 
 		field<X, N, Y>& operator-=(const Y& aRhs) {
-			(*this) = (*this) - aRhs;
-			return *this;
+			return this->assign(*this - aRhs);
 		}
 
 		field<X, N, Y>& operator*=(const Y& aRhs) {
-			(*this) = (*this) * aRhs;
-			return *this;
+			return this->assign(*this * aRhs);
 		}
 
 		field<X, N, Y>& operator/=(const Y& aRhs) {
-			(*this) = (*this) / aRhs;
-			return *this;
+			return this->assign(*this / aRhs);
 		}
 
 		vec<std::size_t, N> convert_to_dimensional_index(std::size_t aIndex) const {
@@ -379,345 +482,567 @@ namespace geodesy::core::math {
 
 	};
 
-	template <typename X, std::size_t N, typename Y>
-	field<X, N, Y> operator+(const Y& aLhs, const field<X, N, Y>& aRhs) {
-		return aRhs + aLhs;
-	}
+	// ------------------------- Expression Nodes ------------------------- //
 
-	template <typename X, std::size_t N, typename Y>
-	field<X, N, Y> operator-(const Y& aLhs, const field<X, N, Y>& aRhs) {
-		return (-aRhs) + aLhs;
-	}
+	// Types that own their samples, expression nodes reference them instead of copying.
+	template <typename E>
+	struct is_field_storage : std::false_type {};
 
 	template <typename X, std::size_t N, typename Y>
-	field<X, N, Y> operator*(const Y& aLhs, const field<X, N, Y>& aRhs) {
-		return aRhs * aLhs;
-	}
+	struct is_field_storage<field<X, N, Y>> : std::true_type {};
 
-	template <typename X, std::size_t N, typename Y>
-	field<X, N, Y> operator/(const Y& aLhs, const field<X, N, Y>& aRhs) {
-		field<X, N, Y> Out = aRhs;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = aLhs / aRhs[i];
-		}
-		return Out;
-	}
+	// Fields are held by reference, intermediate nodes by value.
+	template <typename E>
+	using field_operand = std::conditional_t<is_field_storage<E>::value, const E&, const E>;
 
-	// ------------------------- Mathematical functions -------------------------
+	// Applies F element wise to one operand.
+	template <typename E, typename F>
+	struct field_unary : public field_expression<field_unary<E, F>> {
+		typedef typename E::domain_type domain_type;
+		typedef typename E::range_type range_type;
+		static constexpr std::size_t dimension_count = E::dimension_count;
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> sin(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::sin(Out[i]);
-		}
-		return Out;
-	}
+		field_operand<E> Operand;
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> cos(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::cos(Out[i]);
+		field_unary(const E& aOperand) : Operand(aOperand) {}
+
+		field_domain<domain_type, dimension_count> domain() const 	{ return Operand.domain(); }
+		bool aligned() const 										{ return Operand.aligned(); }
+		range_type operator[](std::size_t aIndex) const 			{ return F::apply(Operand[aIndex]); }
+		range_type sample(const vec<domain_type, dimension_count>& aX) const {
+			return F::apply(Operand.sample(aX));
 		}
-		return Out;
-	}
+	};
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> tan(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::tan(Out[i]);
+	// Applies F element wise to two operands. Combined grids are the union of
+	// both domains when Union is true, otherwise the intersection.
+	template <typename L, typename R, typename F, bool Union>
+	struct field_binary : public field_expression<field_binary<L, R, F, Union>> {
+		typedef typename L::domain_type domain_type;
+		typedef typename L::range_type range_type;
+		static constexpr std::size_t dimension_count = L::dimension_count;
+
+		field_operand<L> Lhs;
+		field_operand<R> Rhs;
+
+		field_binary(const L& aLhs, const R& aRhs) : Lhs(aLhs), Rhs(aRhs) {}
+
+		field_domain<domain_type, dimension_count> domain() const {
+			field_domain<domain_type, dimension_count> LD = Lhs.domain(), RD = Rhs.domain();
+			if (LD == RD) return LD;
+			return Union ? (LD | RD) : (LD & RD);
 		}
-		return Out;
-	}
+		bool aligned() const 										{ return Lhs.aligned() && Rhs.aligned() && (Lhs.domain() == Rhs.domain()); }
+		range_type operator[](std::size_t aIndex) const 			{ return F::apply(Lhs[aIndex], Rhs[aIndex]); }
+		range_type sample(const vec<domain_type, dimension_count>& aX) const {
+			return F::apply(Lhs.sample(aX), Rhs.sample(aX));
+		}
+	};
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> asin(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::asin(Out[i]);
+	// Applies F element wise between an operand and a constant. Scalars are applied
+	// per element directly, no resampling is involved.
+	template <typename E, typename F, bool ScalarLeft>
+	struct field_scalar : public field_expression<field_scalar<E, F, ScalarLeft>> {
+		typedef typename E::domain_type domain_type;
+		typedef typename E::range_type range_type;
+		static constexpr std::size_t dimension_count = E::dimension_count;
+
+		field_operand<E> Operand;
+		range_type Scalar;
+
+		field_scalar(const E& aOperand, const range_type& aScalar) : Operand(aOperand), Scalar(aScalar) {}
+
+		field_domain<domain_type, dimension_count> domain() const 	{ return Operand.domain(); }
+		bool aligned() const 										{ return Operand.aligned(); }
+		range_type operator[](std::size_t aIndex) const 			{ return apply(Operand[aIndex]); }
+		range_type sample(const vec<domain_type, dimension_count>& aX) const {
+			return apply(Operand.sample(aX));
 		}
-		return Out;
-	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> acos(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::acos(Out[i]);
+	private:
+
+		range_type apply(const range_type& aValue) const {
+			if constexpr (ScalarLeft) {
+				return F::apply(Scalar, aValue);
+			}
+			else {
+				return F::apply(aValue, Scalar);
+			}
 		}
-		return Out;
+	};
+
+	// ------------------------- Expression Operations ------------------------- //
+
+	namespace field_op {
+		struct negate 	{ template <typename T> static T apply(const T& aA) { return -aA; } };
+		struct add 		{ template <typename T> static T apply(const T& aA, const T& aB) { return aA + aB; } };
+		struct sub 		{ template <typename T> static T apply(const T& aA, const T& aB) { return aA - aB; } };
+		struct mul 		{ template <typename T> static T apply(const T& aA, const T& aB) { return aA * aB; } };
+		struct div 		{ template <typename T> static T apply(const T& aA, const T& aB) { return aA / aB; } };
+		struct sin 		{ template <typename T> static T apply(const T& aA) { return std::sin(aA); } };
+		struct cos 		{ template <typename T> static T apply(const T& aA) { return std::cos(aA); } };
+		struct tan 		{ template <typename T> static T apply(const T& aA) { return std::tan(aA); } };
+		struct asin 	{ template <typename T> static T apply(const T& aA) { return std::asin(aA); } };
+		struct acos 	{ template <typename T> static T apply(const T& aA) { return std::acos(aA); } };
+		struct atan 	{ template <typename T> static T apply(const T& aA) { return std::atan(aA); } };
+		struct sinh 	{ template <typename T> static T apply(const T& aA) { return std::sinh(aA); } };
+		struct cosh 	{ template <typename T> static T apply(const T& aA) { return std::cosh(aA); } };
+		struct tanh 	{ template <typename T> static T apply(const T& aA) { return std::tanh(aA); } };
+		struct asinh 	{ template <typename T> static T apply(const T& aA) { return std::asinh(aA); } };
+		struct acosh 	{ template <typename T> static T apply(const T& aA) { return std::acosh(aA); } };
+		struct atanh 	{ template <typename T> static T apply(const T& aA) { return std::atanh(aA); } };
+		struct exp 		{ template <typename T> static T apply(const T& aA) { return std::exp(aA); } };
+		struct log 		{ template <typename T> static T apply(const T& aA) { return aA > 0 ? std::log(aA) : T(); } };
+		struct sqrt 	{ template <typename T> static T apply(const T& aA) { return aA >= 0 ? std::sqrt(aA) : T(); } };
+		struct erf 		{ template <typename T> static T apply(const T& aA) { return std::erf(aA); } };
+		struct gamma 	{ template <typename T> static T apply(const T& aA) { return std::tgamma(aA); } };
+		struct abs 		{ template <typename T> static T apply(const T& aA) { return std::abs(aA); } };
+		struct pow 		{ template <typename T> static T apply(const T& aA, const T& aB) { return std::pow(aA, aB); } };
+		// Logarithm of aB in base aA.
+		struct logb 	{ template <typename T> static T apply(const T& aA, const T& aB) { return aB > 0 ? std::log(aB) / std::log(aA) : T(); } };
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> atan(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::atan(Out[i]);
-		}
-		return Out;
+	// Restricts overloads to field expressions, the scalar argument of mixed
+	// operations is taken from the expression's range type.
+	template <typename E, typename T = void>
+	using enable_if_field_expression = std::enable_if_t<is_field_expression_v<E>, T>;
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::negate> operator-(const E& aRhs) {
+		return field_unary<E, field_op::negate>(aRhs);
 	}
 
-	// Hyperbolic functions
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> sinh(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::sinh(Out[i]);
-		}
-		return Out;
+	template <typename L, typename R, typename = enable_if_field_expression<L>, typename = enable_if_field_expression<R>> inline
+	field_binary<L, R, field_op::add, true> operator+(const L& aLhs, const R& aRhs) {
+		return field_binary<L, R, field_op::add, true>(aLhs, aRhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> cosh(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::cosh(Out[i]);
-		}
-		return Out;
+	template <typename L, typename R, typename = enable_if_field_expression<L>, typename = enable_if_field_expression<R>> inline
+	field_binary<L, R, field_op::sub, true> operator-(const L& aLhs, const R& aRhs) {
+		return field_binary<L, R, field_op::sub, true>(aLhs, aRhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> tanh(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::tanh(Out[i]);
-		}
-		return Out;
+	template <typename L, typename R, typename = enable_if_field_expression<L>, typename = enable_if_field_expression<R>> inline
+	field_binary<L, R, field_op::mul, false> operator*(const L& aLhs, const R& aRhs) {
+		return field_binary<L, R, field_op::mul, false>(aLhs, aRhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> asinh(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::asinh(Out[i]);
-		}
-		return Out;
+	template <typename L, typename R, typename = enable_if_field_expression<L>, typename = enable_if_field_expression<R>> inline
+	field_binary<L, R, field_op::div, false> operator/(const L& aLhs, const R& aRhs) {
+		return field_binary<L, R, field_op::div, false>(aLhs, aRhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> acosh(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::acosh(Out[i]);
-		}
-		return Out;
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_scalar<E, field_op::add, false> operator+(const E& aLhs, const typename E::range_type& aRhs) {
+		return field_scalar<E, field_op::add, false>(aLhs, aRhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> atanh(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::atanh(Out[i]);
-		}
-		return Out;
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_scalar<E, field_op::sub, false> operator-(const E& aLhs, const typename E::range_type& aRhs) {
+		return field_scalar<E, field_op::sub, false>(aLhs, aRhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> exp(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::exp(Out[i]);
-		}
-		return Out;
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_scalar<E, field_op::mul, false> operator*(const E& aLhs, const typename E::range_type& aRhs) {
+		return field_scalar<E, field_op::mul, false>(aLhs, aRhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> log(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			if (Out[i] > 0) {
-				Out[i] = std::log(Out[i]);
-			} else {
-				Out[i] = Y();
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_scalar<E, field_op::div, false> operator/(const E& aLhs, const typename E::range_type& aRhs) {
+		// Check if aRhs is zero to avoid division by zero.
+		if constexpr (std::is_arithmetic_v<typename E::range_type>) {
+			if (std::fabs(aRhs) < std::numeric_limits<typename E::range_type>::epsilon()) {
+				throw std::runtime_error("Division by zero in field division.");
 			}
 		}
-		return Out;
+		return field_scalar<E, field_op::div, false>(aLhs, aRhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> pow(const field<X, N, Y>& aBase, const field<X, N, Y>& aExponent) {
-		field<X, N, Y> Out = aBase | aExponent;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			vec<std::size_t, N> Index = Out.convert_to_dimensional_index(i);
-			vec<X, N> Position = Out.convert_index_to_position(Index);
-			Out[i] = std::pow(aBase(Position), aExponent(Position));
-		}
-		return Out;
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_scalar<E, field_op::add, true> operator+(const typename E::range_type& aLhs, const E& aRhs) {
+		return field_scalar<E, field_op::add, true>(aRhs, aLhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> log(const field<X, N, Y>& aBase, const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aBase | aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			vec<std::size_t, N> Index = Out.convert_to_dimensional_index(i);
-			vec<X, N> Position = Out.convert_index_to_position(Index);
-			if (aInput(Position) > 0) {
-				Out[i] = std::log(aInput(Position)) / std::log(aBase(Position));
-			} else {
-				Out[i] = Y();
-			}
-		}
-		return Out;
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_scalar<E, field_op::sub, true> operator-(const typename E::range_type& aLhs, const E& aRhs) {
+		return field_scalar<E, field_op::sub, true>(aRhs, aLhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> sqrt(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			if (Out[i] >= 0) {
-				Out[i] = std::sqrt(Out[i]);
-			} else {
-				Out[i] = Y();
-			}
-		}
-		return Out;
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_scalar<E, field_op::mul, true> operator*(const typename E::range_type& aLhs, const E& aRhs) {
+		return field_scalar<E, field_op::mul, true>(aRhs, aLhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> erf(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::erf(Out[i]);
-		}
-		return Out;
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_scalar<E, field_op::div, true> operator/(const typename E::range_type& aLhs, const E& aRhs) {
+		return field_scalar<E, field_op::div, true>(aRhs, aLhs);
 	}
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> gamma(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::tgamma(Out[i]);
-		}
-		return Out;
+	// ------------------------- Mathematical functions -------------------------
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::sin> sin(const E& aInput) { return field_unary<E, field_op::sin>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::cos> cos(const E& aInput) { return field_unary<E, field_op::cos>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::tan> tan(const E& aInput) { return field_unary<E, field_op::tan>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::asin> asin(const E& aInput) { return field_unary<E, field_op::asin>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::acos> acos(const E& aInput) { return field_unary<E, field_op::acos>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::atan> atan(const E& aInput) { return field_unary<E, field_op::atan>(aInput); }
+
+	// Hyperbolic functions
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::sinh> sinh(const E& aInput) { return field_unary<E, field_op::sinh>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::cosh> cosh(const E& aInput) { return field_unary<E, field_op::cosh>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::tanh> tanh(const E& aInput) { return field_unary<E, field_op::tanh>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::asinh> asinh(const E& aInput) { return field_unary<E, field_op::asinh>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::acosh> acosh(const E& aInput) { return field_unary<E, field_op::acosh>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::atanh> atanh(const E& aInput) { return field_unary<E, field_op::atanh>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::exp> exp(const E& aInput) { return field_unary<E, field_op::exp>(aInput); }
+
+	// Non positive values map to zero.
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::log> log(const E& aInput) { return field_unary<E, field_op::log>(aInput); }
+
+	template <typename L, typename R, typename = enable_if_field_expression<L>, typename = enable_if_field_expression<R>> inline
+	field_binary<L, R, field_op::pow, true> pow(const L& aBase, const R& aExponent) {
+		return field_binary<L, R, field_op::pow, true>(aBase, aExponent);
+	}
+
+	template <typename L, typename R, typename = enable_if_field_expression<L>, typename = enable_if_field_expression<R>> inline
+	field_binary<L, R, field_op::logb, true> log(const L& aBase, const R& aInput) {
+		return field_binary<L, R, field_op::logb, true>(aBase, aInput);
 	}
 
+	// Negative values map to zero.
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::sqrt> sqrt(const E& aInput) { return field_unary<E, field_op::sqrt>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::erf> erf(const E& aInput) { return field_unary<E, field_op::erf>(aInput); }
+
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::gamma> gamma(const E& aInput) { return field_unary<E, field_op::gamma>(aInput); }
+
 	// ------------------------- Utility functions -------------------------
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> abs(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			Out[i] = std::abs(Out[i]);
-		}
-		return Out;
-	}
+	template <typename E, typename = enable_if_field_expression<E>> inline
+	field_unary<E, field_op::abs> abs(const E& aInput) { return field_unary<E, field_op::abs>(aInput); }
 
 	template <typename X, std::size_t N, typename Y> inline
 	field<X, N, Y> normalize(const field<X, N, Y>& aInput) {
-		field<X, N, Y> Out = aInput;
 		Y MaxValue = Y();
 		for (std::size_t i = 0; i < aInput.size(); i++) {
 			MaxValue = std::max(MaxValue, aInput[i]);
 		}
-		return Out / MaxValue;
+		return aInput / MaxValue;
 	}
 
 	// ------------------------- Differential operators -------------------------
 
-	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, vec<Y, N>> grad(const field<X, N, Y>& aF) {
-		field<X, N, vec<Y, N>> Out(aF.LowerBound, aF.UpperBound, aF.ElementCount);
-		vec<X, N> ds = (aF.UpperBound - aF.LowerBound);
+	// Finite difference settings for the differential operators below. Second
+	// derivatives always use the three point central difference, Difference only
+	// selects the first derivative scheme. Boundary decides what lies beyond the
+	// first and last sample of each axis.
+	struct stencil {
+
+		enum difference : int {
+			CENTRAL,		// (f[i+1] - f[i-1]) / 2h
+			FORWARD,		// (f[i+1] - f[i]) / h
+		};
+
+		enum boundary : int {
+			ONE_SIDED,		// Switch to a one sided difference at the edges.
+			CLAMP,			// Samples beyond the edge repeat the edge value.
+			WRAP,			// Samples beyond the edge wrap around periodically.
+			ZERO,			// Samples beyond the edge are Y().
+		};
+
+		// Approximate per core cache budget used to size the row tiles.
+		static constexpr std::size_t CacheSize = 256 * 1024;
+
+		difference		Difference;
+		boundary		Boundary;
+
+		stencil(difference aDifference = CENTRAL, boundary aBoundary = ONE_SIDED) : Difference(aDifference), Boundary(aBoundary) {}
+
+	};
+
+	// Resolved neighbourhood of one sample along one axis. Offsets are relative to
+	// the sample, masks zero out neighbours that fall outside a ZERO boundary.
+	template <typename X>
+	struct stencil_tap {
+		std::ptrdiff_t		Lo, Mid, Hi;
+		X					LoMask, HiMask;
+		X					Scale;
+	};
+
+	// Taps for d/dx, evaluated as (f[Hi] - f[Lo]) * Scale.
+	template <typename X> inline
+	stencil_tap<X> stencil_first_tap(std::size_t aIndex, std::size_t aCount, std::ptrdiff_t aStride, X aStep, const stencil& aStencil) {
+		// A single sample has no neighbours, the derivative along this axis is zero.
+		if (aCount < 2) return { 0, 0, 0, X(), X(), X() };
+		stencil_tap<X> Tap = { -aStride, 0, aStride, X(1), X(1), X() };
+		X Span = X(2);
+		if (aStencil.Difference == stencil::FORWARD) {
+			Tap.Lo = 0;
+			Span = X(1);
+		}
+		bool LoEdge = (Tap.Lo != 0) && (aIndex == 0);
+		bool HiEdge = (aIndex == aCount - 1);
+		std::ptrdiff_t Wrap = (std::ptrdiff_t)(aCount - 1) * aStride;
+		switch (aStencil.Boundary) {
+		case stencil::ONE_SIDED:
+			if (LoEdge) { Tap.Lo = 0; Span = X(1); }
+			if (HiEdge) { Tap.Lo = -aStride; Tap.Hi = 0; Span = X(1); }
+			break;
+		case stencil::CLAMP:
+			if (LoEdge) Tap.Lo = 0;
+			if (HiEdge) Tap.Hi = 0;
+			break;
+		case stencil::WRAP:
+			if (LoEdge) Tap.Lo = Wrap;
+			if (HiEdge) Tap.Hi = -Wrap;
+			break;
+		case stencil::ZERO:
+			if (LoEdge) { Tap.Lo = 0; Tap.LoMask = X(); }
+			if (HiEdge) { Tap.Hi = 0; Tap.HiMask = X(); }
+			break;
+		}
+		Tap.Scale = X(1) / (Span * aStep);
+		return Tap;
+	}
+
+	// Taps for d2/dx2, evaluated as (f[Hi] - 2 f[Mid] + f[Lo]) * Scale.
+	template <typename X> inline
+	stencil_tap<X> stencil_second_tap(std::size_t aIndex, std::size_t aCount, std::ptrdiff_t aStride, X aStep, const stencil& aStencil) {
+		// Too few samples for a second difference, it is zero along this axis.
+		if ((aCount < 2) || ((aStencil.Boundary == stencil::ONE_SIDED) && (aCount < 3))) return { 0, 0, 0, X(), X(), X() };
+		stencil_tap<X> Tap = { -aStride, 0, aStride, X(1), X(1), X() };
+		bool LoEdge = (aIndex == 0);
+		bool HiEdge = (aIndex == aCount - 1);
+		std::ptrdiff_t Wrap = (std::ptrdiff_t)(aCount - 1) * aStride;
+		switch (aStencil.Boundary) {
+		case stencil::ONE_SIDED:
+			// Reuse the second difference of the nearest interior sample.
+			if (LoEdge) { Tap.Lo = 0; Tap.Mid = aStride; Tap.Hi = 2 * aStride; }
+			if (HiEdge) { Tap.Lo = -2 * aStride; Tap.Mid = -aStride; Tap.Hi = 0; }
+			break;
+		case stencil::CLAMP:
+			if (LoEdge) Tap.Lo = 0;
+			if (HiEdge) Tap.Hi = 0;
+			break;
+		case stencil::WRAP:
+			if (LoEdge) Tap.Lo = Wrap;
+			if (HiEdge) Tap.Hi = -Wrap;
+			break;
+		case stencil::ZERO:
+			if (LoEdge) { Tap.Lo = 0; Tap.LoMask = X(); }
+			if (HiEdge) { Tap.Hi = 0; Tap.HiMask = X(); }
+			break;
+		}
+		Tap.Scale = X(1) / (aStep * aStep);
+		return Tap;
+	}
+
+	// Drives aKernel(GlobalIndex, Taps) over every sample of a grid. The grid is walked
+	// as rows along axis 0, rows along axis 1 are grouped into tiles sized so that the
+	// three planes a stencil touches stay resident in cache, and each tile streams
+	// through the remaining axes. Tiles (and slabs of the outer axes) are distributed
+	// over threads. Taps only change at the ends of a row, so the row interior runs
+	// with loop invariant offsets.
+	template <typename X, std::size_t N, typename F> inline
+	void stencil_apply(const field_domain<X, N>& aDomain, const stencil& aStencil, bool aSecondOrder, std::size_t aBytesPerSample, F aKernel) {
+		std::array<std::size_t, N> Count;
+		std::array<std::ptrdiff_t, N> Stride;
+		vec<X, N> Step;
+		std::ptrdiff_t Product = 1;
 		for (std::size_t i = 0; i < N; i++) {
-			ds[i] /= (aF.ElementCount[i] - 1);
+			Count[i] = aDomain.ElementCount[i];
+			Stride[i] = Product;
+			Product *= Count[i];
+			Step[i] = Count[i] > 1 ? (aDomain.UpperBound[i] - aDomain.LowerBound[i]) / (X)(Count[i] - 1) : X();
 		}
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			vec<std::size_t, N> k = Out.convert_to_dimensional_index(i);
-			for (std::size_t j = 0; j < N; j++) {
-				Y df = Y();
-				X dxj = 2.0 * ds[j];
-				if ((k[j] > 0) && (k[j] < (aF.ElementCount[j] - 1))) {
-					vec<std::size_t, N> k1 = k;
-					vec<std::size_t, N> k2 = k;
-					k1[j] -= 1;
-					k2[j] += 1;
-					df = aF(k2) - aF(k1);
+		if (Product == 0) return;
+
+		auto Tap = [&](std::size_t aAxis, std::size_t aIndex) -> stencil_tap<X> {
+			return aSecondOrder ?
+				stencil_second_tap<X>(aIndex, Count[aAxis], Stride[aAxis], Step[aAxis], aStencil) :
+				stencil_first_tap<X>(aIndex, Count[aAxis], Stride[aAxis], Step[aAxis], aStencil);
+		};
+
+		// Work decomposition: x segments (only split for 1D grids), axis 1 tiles, outer slabs.
+		const std::size_t RowLength 	= Count[0];
+		const std::size_t RowCount 		= N > 1 ? Count[1 % N] : 1;
+		const std::size_t OuterCount 	= (std::size_t)Product / (RowLength * RowCount);
+		const std::size_t TileRows 		= std::max<std::size_t>(1, stencil::CacheSize / std::max<std::size_t>(1, 3 * RowLength * aBytesPerSample));
+		const std::size_t TileCount 	= (RowCount + TileRows - 1) / TileRows;
+		const std::size_t Threads 		= (std::size_t)omp_get_max_threads();
+		const std::size_t SlabCount 	= std::min(OuterCount, std::max<std::size_t>(1, (4 * Threads + TileCount - 1) / TileCount));
+		const std::size_t SegmentLength = N > 1 ? RowLength : std::max<std::size_t>(4096, (RowLength + 4 * Threads - 1) / (4 * Threads));
+		const std::size_t SegmentCount 	= (RowLength + SegmentLength - 1) / SegmentLength;
+		const std::size_t WorkCount 	= SegmentCount * TileCount * SlabCount;
+
+		#pragma omp parallel for schedule(dynamic, 1)
+		for (std::ptrdiff_t w = 0; w < (std::ptrdiff_t)WorkCount; w++) {
+			const std::size_t Segment 	= (std::size_t)w % SegmentCount;
+			const std::size_t Tile 		= ((std::size_t)w / SegmentCount) % TileCount;
+			const std::size_t Slab 		= (std::size_t)w / (SegmentCount * TileCount);
+			const std::size_t X0 = Segment * SegmentLength, X1 = std::min(RowLength, X0 + SegmentLength);
+			const std::size_t R0 = Tile * TileRows, R1 = std::min(RowCount, R0 + TileRows);
+			const std::size_t O0 = (Slab * OuterCount) / SlabCount, O1 = ((Slab + 1) * OuterCount) / SlabCount;
+
+			std::array<stencil_tap<X>, N> First, Interior, Last;
+			First[0] 	= Tap(0, 0);
+			Interior[0] = Tap(0, RowLength > 2 ? 1 : 0);
+			Last[0] 	= Tap(0, RowLength - 1);
+			for (std::size_t o = O0; o < O1; o++) {
+				// Taps of the outer axes are constant across the whole plane.
+				std::size_t Remainder = o;
+				for (std::size_t j = 2; j < N; j++) {
+					First[j] = Interior[j] = Last[j] = Tap(j, Remainder % Count[j]);
+					Remainder /= Count[j];
+				}
+				for (std::size_t r = R0; r < R1; r++) {
+					if constexpr (N > 1) {
+						First[1] = Interior[1] = Last[1] = Tap(1, r);
+					}
+					const std::ptrdiff_t Base = (std::ptrdiff_t)(RowLength * (r + RowCount * o));
+					std::size_t Begin = X0, End = X1;
+					if (Begin == 0) {
+						aKernel(Base, First);
+						Begin = 1;
+					}
+					if ((End == RowLength) && (RowLength > 1)) {
+						aKernel(Base + (std::ptrdiff_t)RowLength - 1, Last);
+						End = RowLength - 1;
+					}
+					for (std::size_t x = Begin; x < End; x++) {
+						aKernel(Base + (std::ptrdiff_t)x, Interior);
+					}
 				}
-				Out[i][j] = df / dxj;
 			}
 		}
+	}
+
+	// (f[Hi] - f[Lo]) * Scale around aIndex.
+	template <typename X, typename Y> inline
+	Y stencil_first(const Y* aData, std::ptrdiff_t aIndex, const stencil_tap<X>& aTap) {
+		return (aData[aIndex + aTap.Hi] * aTap.HiMask - aData[aIndex + aTap.Lo] * aTap.LoMask) * aTap.Scale;
+	}
+
+	// (f[Hi] - 2 f[Mid] + f[Lo]) * Scale around aIndex.
+	template <typename X, typename Y> inline
+	Y stencil_second(const Y* aData, std::ptrdiff_t aIndex, const stencil_tap<X>& aTap) {
+		return (aData[aIndex + aTap.Hi] * aTap.HiMask - aData[aIndex + aTap.Mid] * X(2) + aData[aIndex + aTap.Lo] * aTap.LoMask) * aTap.Scale;
+	}
+
+	template <typename X, std::size_t N, typename Y> inline
+	void grad(const field<X, N, Y>& aF, field<X, N, vec<Y, N>>& aOut, const stencil& aStencil = stencil()) {
+		aOut.reshape(aF.domain());
+		const Y* F = aF.data();
+		vec<Y, N>* Out = aOut.data();
+		stencil_apply(aF.domain(), aStencil, false, sizeof(Y) + sizeof(vec<Y, N>), [=](std::ptrdiff_t i, const std::array<stencil_tap<X>, N>& aTap) {
+			for (std::size_t j = 0; j < N; j++) {
+				Out[i][j] = stencil_first(F, i, aTap[j]);
+			}
+		});
+	}
+
+	template <typename X, std::size_t N, typename Y> inline
+	field<X, N, vec<Y, N>> grad(const field<X, N, Y>& aF, const stencil& aStencil = stencil()) {
+		field<X, N, vec<Y, N>> Out;
+		grad(aF, Out, aStencil);
 		return Out;
 	}
 
 	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> div(const field<X, N, vec<Y, N>>& aF) {
-		field<X, N, Y> Out(aF.LowerBound, aF.UpperBound, aF.ElementCount);
-		vec<X, N> ds = (aF.UpperBound - aF.LowerBound);
-		for (std::size_t i = 0; i < N; i++) {
-			ds[i] /= (aF.ElementCount[i] - 1);
-		}
-		#pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			vec<std::size_t, N> k = Out.convert_to_dimensional_index(i);
-			Y divergence = Y();  // Fixed: Y instead of vec<Y, N>
+	void div(const field<X, N, vec<Y, N>>& aF, field<X, N, Y>& aOut, const stencil& aStencil = stencil()) {
+		aOut.reshape(aF.domain());
+		const vec<Y, N>* F = aF.data();
+		Y* Out = aOut.data();
+		stencil_apply(aF.domain(), aStencil, false, sizeof(vec<Y, N>) + sizeof(Y), [=](std::ptrdiff_t i, const std::array<stencil_tap<X>, N>& aTap) {
+			Y Divergence = Y();
 			for (std::size_t j = 0; j < N; j++) {
-				Y df = Y();  // Fixed: Y instead of vec<Y, N>
-				X dxj = 2.0 * ds[j];
-				if ((k[j] > 0) && (k[j] < (aF.ElementCount[j] - 1))) {
-					vec<std::size_t, N> k1 = k;
-					vec<std::size_t, N> k2 = k;
-					k1[j] -= 1;
-					k2[j] += 1;
-					df = aF(k2)[j] - aF(k1)[j];  // Get j-th component
-				}
-				divergence += df / dxj;  // Fixed: accumulate into divergence
+				const stencil_tap<X>& T = aTap[j];
+				Divergence += (F[i + T.Hi][j] * T.HiMask - F[i + T.Lo][j] * T.LoMask) * T.Scale;
 			}
-			Out[i] = divergence;  // Fixed: assign final divergence value
+			Out[i] = Divergence;
+		});
+	}
+
+	template <typename X, std::size_t N, typename Y> inline
+	field<X, N, Y> div(const field<X, N, vec<Y, N>>& aF, const stencil& aStencil = stencil()) {
+		field<X, N, Y> Out;
+		div(aF, Out, aStencil);
+		return Out;
+	}
+
+	template <typename X, typename Y> inline
+	void curl(const field<X, 3, vec<Y, 3>>& aF, field<X, 3, vec<Y, 3>>& aOut, const stencil& aStencil = stencil()) {
+		if (&aF == &aOut) {
+			throw std::invalid_argument("curl(): Output field must not alias the input field.");
 		}
+		aOut.reshape(aF.domain());
+		const vec<Y, 3>* F = aF.data();
+		vec<Y, 3>* Out = aOut.data();
+		stencil_apply(aF.domain(), aStencil, false, 2 * sizeof(vec<Y, 3>), [=](std::ptrdiff_t i, const std::array<stencil_tap<X>, 3>& aTap) {
+			// Jacobian column j holds d/dx_j of every component.
+			vec<Y, 3> D0 = stencil_first(F, i, aTap[0]);
+			vec<Y, 3> D1 = stencil_first(F, i, aTap[1]);
+			vec<Y, 3> D2 = stencil_first(F, i, aTap[2]);
+			Out[i] = vec<Y, 3>(D1[2] - D2[1], D2[0] - D0[2], D0[1] - D1[0]);
+		});
+	}
+
+	template <typename X, typename Y> inline
+	field<X, 3, vec<Y, 3>> curl(const field<X, 3, vec<Y, 3>>& aF, const stencil& aStencil = stencil()) {
+		field<X, 3, vec<Y, 3>> Out;
+		curl(aF, Out, aStencil);
 		return Out;
 	}
 
 	template <typename X, std::size_t N, typename Y> inline
-	field<X, N, Y> laplacian(const field<X, N, Y>& aF) {
-		field<X, N, Y> Out(aF.LowerBound, aF.UpperBound, aF.ElementCount);
-		vec<X, N> ds = (aF.UpperBound - aF.LowerBound);
-		for (std::size_t i = 0; i < N; i++) {
-			ds[i] /= (aF.ElementCount[i] - 1);
+	void laplacian(const field<X, N, Y>& aF, field<X, N, Y>& aOut, const stencil& aStencil = stencil()) {
+		if (&aF == &aOut) {
+			throw std::invalid_argument("laplacian(): Output field must not alias the input field.");
 		}
-		// #pragma omp parallel for
-		for (std::ptrdiff_t i = 0; i < Out.size(); i++) {
-			vec<std::size_t, N> k = Out.convert_to_dimensional_index(i);
+		aOut.reshape(aF.domain());
+		const Y* F = aF.data();
+		Y* Out = aOut.data();
+		stencil_apply(aF.domain(), aStencil, true, 2 * sizeof(Y), [=](std::ptrdiff_t i, const std::array<stencil_tap<X>, N>& aTap) {
+			Y Sum = Y();
 			for (std::size_t j = 0; j < N; j++) {
-				Y df = Y();
-				if ((k[j] > 0) && (k[j] < (aF.ElementCount[j] - 1))) {
-					vec<std::size_t, N> k1 = k;
-					vec<std::size_t, N> k2 = k;
-					k1[j] -= 1;
-					k2[j] += 1;
-					df = aF(k2) - aF(k) + aF(k1) - aF(k);
-					// Y fback = aF(k1);
-					// Y fmid = aF(k);
-					// fmid = 2.0f * fmid;
-					// Y ffront = aF(k2);
-					// df = ffront - fmid + fback;
-				}
-				Out[i] += df / (ds[j] * ds[j]);
+				Sum += stencil_second(F, i, aTap[j]);
 			}
-		}
+			Out[i] = Sum;
+		});
+	}
+
+	template <typename X, std::size_t N, typename Y> inline
+	field<X, N, Y> laplacian(const field<X, N, Y>& aF, const stencil& aStencil = stencil()) {
+		field<X, N, Y> Out;
+		laplacian(aF, Out, aStencil);
 		return Out;
 	}
 
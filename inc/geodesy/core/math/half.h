@@ -0,0 +1,215 @@
+#pragma once
+#ifndef GEODESY_CORE_MATH_HALF_H
+#define GEODESY_CORE_MATH_HALF_H
+
+// ------------------------------ half.h ------------------------------ //
+/*
+IEEE 754 binary16 storage type. half only stores data, arithmetic is done by
+implicitly converting to float, so vec<half, N> and friends behave like their
+float counterparts while occupying half the memory. This is intended for host
+copies of data that lives on the GPU in a 16 bit float format, such as vertex
+attributes, G-buffer targets and HDR images.
+
+Conversions round to nearest even and preserve infinities, NaN and subnormals.
+F16C (x86) or the aarch64 conversion instructions are used when the target
+allows them, otherwise an exact bit manipulation fallback is used. Use the
+bulk convert() overloads for large arrays.
+// Example usage:
+half h = 1.5f;
+float f = h * 2.0f;
+convert(HalfPixels.data(), FloatPixels.data(), FloatPixels.size());
+*/
+
+#include <cstdint>
+#include <cstring>
+#include "config.h"
+#include "simd.h"
+#include "vec.h"
+#include <omp.h>
+
+namespace geodesy::core::math {
+
+	// ------------------------- Scalar Conversions ------------------------- //
+
+	// Portable float -> binary16, round to nearest even.
+	inline std::uint16_t float_to_half_bits(float aValue) {
+	#if defined(GEODESY_MATH_SIMD_F16C)
+		return (std::uint16_t)_mm_cvtsi128_si32(_mm_cvtps_ph(_mm_set_ss(aValue), _MM_FROUND_TO_NEAREST_INT));
+	#else
+		std::uint32_t F;
+		std::memcpy(&F, &aValue, sizeof(F));
+		const std::uint32_t Sign = (F >> 16) & 0x8000u;
+		F &= 0x7FFFFFFFu;
+		if (F >= 0x47800000u) {
+			// Overflow to infinity, NaN stays a (quiet) NaN.
+			return (std::uint16_t)(Sign | (F > 0x7F800000u ? 0x7E00u : 0x7C00u));
+		}
+		if (F < 0x38800000u) {
+			// Result is subnormal or zero, let the float adder do the rounding.
+			float Value, Magic = 0.5f;
+			std::memcpy(&Value, &F, sizeof(Value));
+			Value += Magic;
+			std::uint32_t Bits;
+			std::memcpy(&Bits, &Value, sizeof(Bits));
+			return (std::uint16_t)(Sign | (Bits - 0x3F000000u));
+		}
+		// Normal range, rebias the exponent and round to nearest even.
+		const std::uint32_t MantissaOdd = (F >> 13) & 1u;
+		F += 0xC8000FFFu + MantissaOdd;
+		return (std::uint16_t)(Sign | (F >> 13));
+	#endif
+	}
+
+	// Portable binary16 -> float, exact.
+	inline float half_bits_to_float(std::uint16_t aBits) {
+	#if defined(GEODESY_MATH_SIMD_F16C)
+		return _mm_cvtss_f32(_mm_cvtph_ps(_mm_cvtsi32_si128(aBits)));
+	#else
+		const std::uint32_t Sign = (std::uint32_t)(aBits & 0x8000u) << 16;
+		const std::uint32_t Exponent = (aBits >> 10) & 0x1Fu;
+		const std::uint32_t Mantissa = aBits & 0x3FFu;
+		std::uint32_t F;
+		if (Exponent == 0) {
+			// Zero or subnormal, value is Mantissa * 2^-24.
+			float Value = (float)Mantissa * 5.9604644775390625e-8f;
+			std::memcpy(&F, &Value, sizeof(F));
+			F |= Sign;
+		}
+		else if (Exponent == 0x1Fu) {
+			F = Sign | 0x7F800000u | (Mantissa << 13);
+		}
+		else {
+			F = Sign | ((Exponent + 112u) << 23) | (Mantissa << 13);
+		}
+		float Out;
+		std::memcpy(&Out, &F, sizeof(Out));
+		return Out;
+	#endif
+	}
+
+	// ------------------------- half ------------------------- //
+
+	class half {
+	public:
+
+		std::uint16_t Bits;
+
+		half() : Bits(0) {}
+		half(float aValue) : Bits(float_to_half_bits(aValue)) {}
+		half(double aValue) : Bits(float_to_half_bits((float)aValue)) {}
+		half(int aValue) : Bits(float_to_half_bits((float)aValue)) {}
+
+		// Arithmetic and comparison happen in float.
+		operator float() const {
+			return half_bits_to_float(Bits);
+		}
+
+		half& operator+=(float aRhs) {
+			*this = half((float)*this + aRhs);
+			return *this;
+		}
+
+		half& operator-=(float aRhs) {
+			*this = half((float)*this - aRhs);
+			return *this;
+		}
+
+		half& operator*=(float aRhs) {
+			*this = half((float)*this * aRhs);
+			return *this;
+		}
+
+		half& operator/=(float aRhs) {
+			*this = half((float)*this / aRhs);
+			return *this;
+		}
+
+		static half from_bits(std::uint16_t aBits) {
+			half Out;
+			Out.Bits = aBits;
+			return Out;
+		}
+
+	};
+
+	static_assert(sizeof(half) == 2, "half must be 16 bits to match GPU formats.");
+
+	// ------------------------- Bulk Conversions ------------------------- //
+
+	// Elements per parallel task.
+	constexpr std::size_t HalfConversionChunk = 4096;
+
+	// Single threaded conversion of a contiguous range, vectorized when possible.
+	inline void convert_chunk(half* aOut, const float* aIn, std::size_t aCount) {
+		std::size_t i = 0;
+	#if defined(GEODESY_MATH_SIMD_F16C) && defined(GEODESY_MATH_SIMD_AVX)
+		for (; i + 8 <= aCount; i += 8) {
+			_mm_storeu_si128((__m128i*)(aOut + i), _mm256_cvtps_ph(_mm256_loadu_ps(aIn + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+	#elif defined(GEODESY_MATH_SIMD_F16C)
+		for (; i + 4 <= aCount; i += 4) {
+			_mm_storel_epi64((__m128i*)(aOut + i), _mm_cvtps_ph(_mm_loadu_ps(aIn + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+	#elif defined(GEODESY_MATH_SIMD_NEON_F16)
+		for (; i + 4 <= aCount; i += 4) {
+			vst1_u16((std::uint16_t*)(aOut + i), vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(aIn + i))));
+		}
+	#endif
+		for (; i < aCount; i++) {
+			aOut[i] = half(aIn[i]);
+		}
+	}
+
+	inline void convert_chunk(float* aOut, const half* aIn, std::size_t aCount) {
+		std::size_t i = 0;
+	#if defined(GEODESY_MATH_SIMD_F16C) && defined(GEODESY_MATH_SIMD_AVX)
+		for (; i + 8 <= aCount; i += 8) {
+			_mm256_storeu_ps(aOut + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(aIn + i))));
+		}
+	#elif defined(GEODESY_MATH_SIMD_F16C)
+		for (; i + 4 <= aCount; i += 4) {
+			_mm_storeu_ps(aOut + i, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(aIn + i))));
+		}
+	#elif defined(GEODESY_MATH_SIMD_NEON_F16)
+		for (; i + 4 <= aCount; i += 4) {
+			vst1q_f32(aOut + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16((const std::uint16_t*)(aIn + i)))));
+		}
+	#endif
+		for (; i < aCount; i++) {
+			aOut[i] = (float)aIn[i];
+		}
+	}
+
+	// Bulk float <-> half, split across threads for large arrays.
+	template <typename S, typename D> inline
+	void convert(D* aOut, const S* aIn, std::size_t aCount) {
+		static_assert(
+			(std::is_same_v<S, float> && std::is_same_v<D, half>) || (std::is_same_v<S, half> && std::is_same_v<D, float>),
+			"convert(): Only float <-> half conversions are supported."
+		);
+		const std::ptrdiff_t ChunkTotal = (std::ptrdiff_t)((aCount + HalfConversionChunk - 1) / HalfConversionChunk);
+		#pragma omp parallel for if(ChunkTotal > 4)
+		for (std::ptrdiff_t c = 0; c < ChunkTotal; c++) {
+			const std::size_t Start = (std::size_t)c * HalfConversionChunk;
+			convert_chunk(aOut + Start, aIn + Start, std::min(HalfConversionChunk, aCount - Start));
+		}
+	}
+
+	// Element wise conversions between full and half precision vectors.
+	template <std::size_t N> inline
+	vec<half, N> to_half(const vec<float, N>& aVector) {
+		vec<half, N> Out;
+		convert_chunk(Out.data(), aVector.data(), N);
+		return Out;
+	}
+
+	template <std::size_t N> inline
+	vec<float, N> to_float(const vec<half, N>& aVector) {
+		vec<float, N> Out;
+		convert_chunk(Out.data(), aVector.data(), N);
+		return Out;
+	}
+
+}
+
+#endif // !GEODESY_CORE_MATH_HALF_H
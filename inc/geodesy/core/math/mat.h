@@ -7,6 +7,7 @@
 #include "complex.h"
 #include "quaternion.h"
 #include "vec.h"
+#include "simd.h"
 
 namespace geodesy::core::math {
 
@@ -206,6 +207,29 @@ namespace geodesy::core::math {
 
 	};
 
+#if defined(GEODESY_MATH_SIMD)
+
+	// -------------------- SIMD Specializations -------------------- //
+	// Transforms are almost exclusively mat<float, 4, 4>, these replace the
+	// generic loops with the kernels in simd.h. Results are bit-for-bit
+	// identical to the generic templates.
+
+	template <> inline
+	vec<float, 4> mat<float, 4, 4>::operator*(const vec<float, 4>& aRhs) const {
+		vec<float, 4> Out;
+		simd::mat4_mul_vec4(Out.data(), this->data(), aRhs.data());
+		return Out;
+	}
+
+	template <> template <> inline
+	mat<float, 4, 4> mat<float, 4, 4>::operator*<4>(const mat<float, 4, 4>& aRhs) const {
+		mat<float, 4, 4> Out;
+		simd::mat4_mul(Out.data(), this->data(), aRhs.data());
+		return Out;
+	}
+
+#endif
+
 	template<typename T, std::size_t M, std::size_t N> inline
 	mat<T, M, N> operator*(const T& aLhs, const mat<T, M, N>& aRhs) {
 		return aRhs * aLhs;
@@ -315,6 +339,180 @@ namespace geodesy::core::math {
 		return I;                                                    // now A⁻¹
 	}
 
+	/*======================================================================
+	 |  Closed form 3x3 adjugate  (constexpr)
+	 *====================================================================*/
+	// adjugate(A) * A = determinant(A) * I, no pivoting or division involved.
+	template<typename T> inline
+	constexpr mat<T,3,3> adjugate(const mat<T,3,3>& A) {
+		mat<T,3,3> Out{};
+		Out(0,0) = A(1,1) * A(2,2) - A(1,2) * A(2,1);
+		Out(0,1) = A(0,2) * A(2,1) - A(0,1) * A(2,2);
+		Out(0,2) = A(0,1) * A(1,2) - A(0,2) * A(1,1);
+		Out(1,0) = A(1,2) * A(2,0) - A(1,0) * A(2,2);
+		Out(1,1) = A(0,0) * A(2,2) - A(0,2) * A(2,0);
+		Out(1,2) = A(0,2) * A(1,0) - A(0,0) * A(1,2);
+		Out(2,0) = A(1,0) * A(2,1) - A(1,1) * A(2,0);
+		Out(2,1) = A(0,1) * A(2,0) - A(0,0) * A(2,1);
+		Out(2,2) = A(0,0) * A(1,1) - A(0,1) * A(1,0);
+		return Out;
+	}
+
+	/*======================================================================
+	 |  Inverse of a 3x3 via its adjugate  (constexpr)
+	 *====================================================================*/
+	template<typename T> inline
+	constexpr mat<T,3,3> inverse3(const mat<T,3,3>& A) {
+		const mat<T,3,3> Adj = adjugate(A);
+		const T Det = A(0,0) * Adj(0,0) + A(0,1) * Adj(1,0) + A(0,2) * Adj(2,0);
+		if ((Det < std::numeric_limits<T>::min()) && (Det > -std::numeric_limits<T>::min()))
+			throw std::domain_error("inverse3(): singular matrix");
+		return Adj * (T{1} / Det);
+	}
+
+	/*======================================================================
+	 |  Inverse of a rigid transform  (constexpr)
+	 *====================================================================*/
+	// Assumes the upper 3x3 is a pure rotation and the bottom row is (0,0,0,1).
+	//tex:
+	// $$ \begin{bmatrix} R & t \\ 0 & 1 \end{bmatrix}^{-1} = \begin{bmatrix} R^{T} & -R^{T}t \\ 0 & 1 \end{bmatrix} $$
+	template<typename T> inline
+	constexpr mat<T,4,4> inverse_rigid(const mat<T,4,4>& A) {
+		mat<T,4,4> Out{};
+		for (std::size_t i = 0; i < 3; ++i) {
+			for (std::size_t j = 0; j < 3; ++j) {
+				Out(i,j) = A(j,i);
+			}
+		}
+		for (std::size_t i = 0; i < 3; ++i) {
+			Out(i,3) = -(Out(i,0) * A(0,3) + Out(i,1) * A(1,3) + Out(i,2) * A(2,3));
+		}
+		Out(3,3) = T{1};
+		return Out;
+	}
+
+	/*======================================================================
+	 |  Inverse of an affine transform  (constexpr)
+	 *====================================================================*/
+	// Assumes the bottom row is (0,0,0,1), the upper 3x3 may contain scale and shear.
+	//tex:
+	// $$ \begin{bmatrix} A & t \\ 0 & 1 \end{bmatrix}^{-1} = \begin{bmatrix} A^{-1} & -A^{-1}t \\ 0 & 1 \end{bmatrix} $$
+	template<typename T> inline
+	constexpr mat<T,4,4> inverse_affine(const mat<T,4,4>& A) {
+		const mat<T,3,3> Inv = inverse3(A.minor(3,3));
+		mat<T,4,4> Out{};
+		for (std::size_t i = 0; i < 3; ++i) {
+			for (std::size_t j = 0; j < 3; ++j) {
+				Out(i,j) = Inv(i,j);
+			}
+		}
+		for (std::size_t i = 0; i < 3; ++i) {
+			Out(i,3) = -(Inv(i,0) * A(0,3) + Inv(i,1) * A(1,3) + Inv(i,2) * A(2,3));
+		}
+		Out(3,3) = T{1};
+		return Out;
+	}
+
+	/*======================================================================
+	 |  Normal matrix  (constexpr)
+	 *====================================================================*/
+	// Inverse transpose of the upper 3x3, maps surface normals under the transform.
+	template<typename T, std::size_t N> inline
+	constexpr mat<T,3,3> normal_matrix(const mat<T,N,N>& A) {
+		static_assert(N >= 3, "normal_matrix(): Matrix must be at least 3x3.");
+		mat<T,3,3> Linear{};
+		for (std::size_t i = 0; i < 3; ++i)
+			for (std::size_t j = 0; j < 3; ++j)
+				Linear(i,j) = A(i,j);
+		return transpose(inverse3(Linear));
+	}
+
+	/*======================================================================
+	 |  Symmetric 3x3 eigen decomposition  (cyclic Jacobi)
+	 *====================================================================*/
+	// A = V * diag(aValues) * V^T for symmetric A. Eigenvalues are sorted in
+	// descending order and aVectors holds the matching unit eigenvectors as
+	// columns, forming a right handed basis. Used for principal axes of
+	// inertia tensors and covariance matrices.
+	template<typename T> inline
+	void eigen_symmetric(const mat<T,3,3>& aMatrix, vec<T,3>& aValues, mat<T,3,3>& aVectors) {
+		mat<T,3,3> A = aMatrix;
+		mat<T,3,3> V{};
+		for (std::size_t i = 0; i < 3; ++i) V(i,i) = T{1};
+
+		for (std::size_t Sweep = 0; Sweep < 32; ++Sweep) {
+			const T OffDiagonal = A(0,1) * A(0,1) + A(0,2) * A(0,2) + A(1,2) * A(1,2);
+			const T Diagonal = A(0,0) * A(0,0) + A(1,1) * A(1,1) + A(2,2) * A(2,2);
+			if (OffDiagonal <= std::numeric_limits<T>::epsilon() * std::numeric_limits<T>::epsilon() * Diagonal) break;
+			for (std::size_t p = 0; p < 2; ++p) {
+				for (std::size_t q = p + 1; q < 3; ++q) {
+					const T Apq = A(p,q);
+					if (Apq == T{0}) continue;
+					// Rotation angle which annihilates A(p,q).
+					const T Theta = (A(q,q) - A(p,p)) / (T{2} * Apq);
+					const T t = (Theta >= T{0} ? T{1} : T{-1}) / (std::abs(Theta) + std::sqrt(Theta * Theta + T{1}));
+					const T c = T{1} / std::sqrt(t * t + T{1});
+					const T s = t * c;
+					for (std::size_t k = 0; k < 3; ++k) {
+						const T Akp = A(k,p), Akq = A(k,q);
+						A(k,p) = c * Akp - s * Akq;
+						A(k,q) = s * Akp + c * Akq;
+					}
+					for (std::size_t k = 0; k < 3; ++k) {
+						const T Apk = A(p,k), Aqk = A(q,k);
+						A(p,k) = c * Apk - s * Aqk;
+						A(q,k) = s * Apk + c * Aqk;
+					}
+					for (std::size_t k = 0; k < 3; ++k) {
+						const T Vkp = V(k,p), Vkq = V(k,q);
+						V(k,p) = c * Vkp - s * Vkq;
+						V(k,q) = s * Vkp + c * Vkq;
+					}
+				}
+			}
+		}
+
+		// Sort eigenpairs in descending order.
+		std::array<std::size_t, 3> Order = { 0, 1, 2 };
+		std::sort(Order.begin(), Order.end(), [&](std::size_t aI, std::size_t aJ) { return A(aI,aI) > A(aJ,aJ); });
+		for (std::size_t j = 0; j < 3; ++j) {
+			aValues[j] = A(Order[j],Order[j]);
+			for (std::size_t i = 0; i < 3; ++i) {
+				aVectors(i,j) = V(i,Order[j]);
+			}
+		}
+		// Keep the basis right handed.
+		if (determinant(aVectors) < T{0}) {
+			for (std::size_t i = 0; i < 3; ++i) aVectors(i,2) = -aVectors(i,2);
+		}
+	}
+
+	/*======================================================================
+	 |  Polar decomposition  (Higham iteration)
+	 *====================================================================*/
+	// A = R * S with R orthogonal and S symmetric positive semi-definite. R is
+	// the nearest rotation (or reflection, if det(A) < 0) to A, and S carries
+	// the scale and shear. Throws if A is singular.
+	//tex:
+	// $$ R_{k+1} = \frac{1}{2} \left( R_{k} + R_{k}^{-T} \right) $$
+	template<typename T> inline
+	void polar(const mat<T,3,3>& aMatrix, mat<T,3,3>& aRotation, mat<T,3,3>& aStretch) {
+		mat<T,3,3> R = aMatrix;
+		for (std::size_t Iteration = 0; Iteration < 32; ++Iteration) {
+			const mat<T,3,3> Next = (R + transpose(inverse3(R))) * T(0.5);
+			T Change = T{0}, Norm = T{0};
+			for (std::size_t i = 0; i < 9; ++i) {
+				Change += (Next[i] - R[i]) * (Next[i] - R[i]);
+				Norm += Next[i] * Next[i];
+			}
+			R = Next;
+			if (Change <= T(16) * std::numeric_limits<T>::epsilon() * std::numeric_limits<T>::epsilon() * Norm) break;
+		}
+		const mat<T,3,3> S = transpose(R) * aMatrix;
+		aRotation = R;
+		aStretch = (S + transpose(S)) * T(0.5);
+	}
+
 	// Generates orthographic projection matrix for Geodesy → Vulkan NDC
 	template <typename T> inline
 	mat<T, 4, 4> orthographic(T aDeltaX, T aDeltaY, T aNear, T aFar) {
@@ -0,0 +1,649 @@
+#pragma once
+#ifndef GEODESY_CORE_MATH_MULTIGRID_H
+#define GEODESY_CORE_MATH_MULTIGRID_H
+
+// ------------------------------ multigrid.h ------------------------------ //
+/*
+Geometric multigrid solver for Poisson type problems on scalar fields,
+
+	Alpha * u + Beta * laplacian(u) = f
+
+which covers pressure projection (Alpha = 0, Beta = 1), implicit heat diffusion and
+heightfield smoothing (Alpha = 1, Beta = -k * dt). The operator uses the same three
+point second difference as laplacian(), with the boundary given by stencil::boundary,
+ZERO is a homogeneous Dirichlet boundary, CLAMP a zero flux Neumann boundary and WRAP
+is periodic. The operator must be definite, so Alpha and Beta may not share a sign.
+
+The solver builds a hierarchy of grids by halving every axis until it reaches a few
+samples, then runs V-cycles of red-black Gauss-Seidel smoothing, full weighting
+restriction and linear prolongation, with the coarsest grid solved by conjugate
+gradient. Each V-cycle reduces the residual by roughly a constant factor regardless of
+the grid size. If cycles stop converging, or the grid can not be coarsened, it falls
+back to plain conjugate gradient. The hierarchy is allocated once per domain, so keep
+the solver around when solving every frame.
+
+With Neumann or periodic boundaries and Alpha = 0 the solution is only defined up to a
+constant, the mean of f is ignored and the returned solution has zero mean.
+// Example usage:
+multigrid<float, 3, float> Pressure(Divergence.domain(), stencil::CLAMP);
+auto Report = Pressure.solve(P, Divergence, 1e-4f);
+*/
+
+#include <cmath>
+#include <array>
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "field.h"
+#include <omp.h>
+
+namespace geodesy::core::math {
+
+	template <typename X, std::size_t N, typename Y>
+	class multigrid {
+	public:
+
+		static_assert(std::is_floating_point_v<Y>, "multigrid: Only scalar fields are supported.");
+
+		// Axes stop being halved once they reach this many samples.
+		static constexpr std::size_t CoarsestCount 		= 4;
+		// Levels below this many samples run single threaded.
+		static constexpr std::size_t ParallelThreshold 	= 16384;
+
+		struct report {
+			std::size_t		Iterations;		// V-cycles plus conjugate gradient iterations.
+			Y				Residual;		// Final ||f - A u|| / ||f||.
+			bool			Converged;		// Tolerance reached, or the rounding floor of Y which fine float grids can hit first.
+			bool			Fallback;		// Conjugate gradient was used on the fine grid.
+		};
+
+		// Off diagonal neighbours and diagonal weight of one sample along one axis.
+		struct coupling {
+			std::ptrdiff_t		Lo, Hi;
+			Y					WLo, WHi, WMid;
+		};
+
+		struct level {
+			vec<std::size_t, N>							Count;
+			vec<X, N>									Step;
+			std::array<bool, N>							Coarsened;		// Axes halved relative to the finer level.
+			vec<X, N>									WallLo, WallHi;	// Distance from the first and last sample to the boundary.
+			std::array<Y, N>							GhostLo, GhostHi;	// Value beyond the edge as a multiple of the edge sample.
+			std::size_t									Size;
+			std::array<std::vector<coupling>, N>		Coupling;		// Per axis, per sample index.
+			std::vector<Y, aligned_allocator<Y>>		U, F, R, P, Q;
+		};
+
+		field_domain<X, N>			Domain;
+		stencil::boundary			Boundary;
+		Y							Alpha, Beta;
+		std::size_t					PreSmooth;
+		std::size_t					PostSmooth;
+		Y							StagnationRate;			// V-cycles converging slower than this hand over to conjugate gradient.
+		std::size_t					MaxFallbackIterations;
+		std::vector<level>			Level;
+
+		multigrid(const field_domain<X, N>& aDomain, stencil::boundary aBoundary = stencil::ZERO, Y aAlpha = Y(0), Y aBeta = Y(1)) {
+			if (aBoundary == stencil::ONE_SIDED) {
+				throw std::invalid_argument("multigrid: One sided boundaries do not define a solvable system, use ZERO, CLAMP or WRAP.");
+			}
+			if ((aAlpha * aBeta > Y(0)) || ((aAlpha == Y(0)) && (aBeta == Y(0)))) {
+				throw std::domain_error("multigrid: Alpha * u + Beta * laplacian(u) is not definite, Alpha and Beta must not share a sign.");
+			}
+			for (std::size_t i = 0; i < N; i++) {
+				if (aDomain.ElementCount[i] < 2) {
+					throw std::invalid_argument("multigrid: Every axis needs at least two samples.");
+				}
+			}
+			this->Domain 					= aDomain;
+			this->Boundary 					= aBoundary;
+			this->Alpha 					= aAlpha;
+			this->Beta 						= aBeta;
+			this->PreSmooth 				= 2;
+			this->PostSmooth 				= 2;
+			this->StagnationRate 			= Y(0.8);
+			this->MaxFallbackIterations 	= 4096;
+
+			// Fine grid, then halve every axis until all are down to a few samples. Coarse samples sit at the
+			// centre of the pair of fine samples they cover, the last one covers three if the count is odd.
+			// This moves the boundary relative to the edge samples, which the Dirichlet ghosts account for.
+			// Periodic axes have no boundary to move, odd ones stretch the coarse step to keep the period.
+			level Fine;
+			for (std::size_t i = 0; i < N; i++) {
+				Fine.Count[i] 		= aDomain.ElementCount[i];
+				Fine.Step[i] 		= (aDomain.UpperBound[i] - aDomain.LowerBound[i]) / (X)(aDomain.ElementCount[i] - 1);
+				Fine.Coarsened[i] 	= false;
+				Fine.WallLo[i] 		= Fine.Step[i];
+				Fine.WallHi[i] 		= Fine.Step[i];
+			}
+			this->push_level(std::move(Fine));
+			while (true) {
+				const level& Finer = Level.back();
+				// Axes are halved together, halving some but not others degrades the smoother.
+				bool Halve = false;
+				for (std::size_t i = 0; i < N; i++) {
+					Halve = Halve || (Finer.Count[i] > CoarsestCount);
+				}
+				if (!Halve) break;
+				level Coarse;
+				for (std::size_t i = 0; i < N; i++) {
+					const bool Odd 		= (Finer.Count[i] % 2 == 1);
+					const X Stretch 	= ((Boundary == stencil::WRAP) && Odd) ? (X)Finer.Count[i] / (X)(Finer.Count[i] / 2) : X(2);
+					Coarse.Coarsened[i] = (Finer.Count[i] > CoarsestCount);
+					Coarse.Count[i] 	= Coarse.Coarsened[i] ? Finer.Count[i] / 2 : Finer.Count[i];
+					Coarse.Step[i] 		= Coarse.Coarsened[i] ? Finer.Step[i] * Stretch : Finer.Step[i];
+					Coarse.WallLo[i] 	= Coarse.Coarsened[i] ? Finer.WallLo[i] + Finer.Step[i] / X(2) : Finer.WallLo[i];
+					Coarse.WallHi[i] 	= Coarse.Coarsened[i] ? Finer.WallHi[i] + Finer.Step[i] * (Odd ? X(1.5) : X(0.5)) : Finer.WallHi[i];
+				}
+				this->push_level(std::move(Coarse));
+			}
+		}
+
+		field_domain<X, N> domain() const {
+			return Domain;
+		}
+
+		// True if the operator has a null space of constant fields.
+		bool singular() const {
+			return (Alpha == Y(0)) && (Boundary != stencil::ZERO);
+		}
+
+		// Solves A u = f to a relative residual of aTolerance, aU is used as the initial guess.
+		report solve(field<X, N, Y>& aU, const field<X, N, Y>& aF, Y aTolerance = Y(1e-4), std::size_t aMaxCycles = 32) {
+			if (aF.domain() != Domain) {
+				throw std::invalid_argument("multigrid::solve(): Right hand side does not match the solver domain.");
+			}
+			if (aU.domain() != Domain) {
+				aU.reshape(Domain);
+				aU = Y();
+			}
+
+			level& L = Level[0];
+			Y* U = aU.data();
+			const Y* F = aF.data();
+			if (this->singular()) {
+				L.F.assign(aF.begin(), aF.end());
+				this->remove_mean(L, L.F.data());
+				F = L.F.data();
+			}
+
+			report Report = { 0, Y(0), true, false };
+			const double NormF = std::sqrt(this->dot(L, F, F));
+			if (NormF == 0.0) {
+				aU = Y();
+				return Report;
+			}
+			const double Target = aTolerance * NormF;
+			double Norm = std::sqrt(this->residual(L, U, F, L.R.data()));
+
+			const bool Smoothable = (Level.size() > 1);
+			if (Smoothable) {
+				while ((Norm > Target) && (Report.Iterations < aMaxCycles)) {
+					this->vcycle(0, U, F);
+					double Next = std::sqrt(this->residual(L, U, F, L.R.data()));
+					Report.Iterations++;
+					bool Stalled = (Next > StagnationRate * Norm);
+					Norm = Next;
+					if (Stalled) break;
+				}
+			}
+
+			// Cycles that stall at the rounding error of evaluating A u have converged as far as Y allows,
+			// on fine float grids this can lie above the requested tolerance.
+			const double Floor = (Smoothable && (Norm > Target)) ? this->rounding_floor(L, U) : 0.0;
+			if (Norm > std::max(Target, Floor)) {
+				Report.Fallback = true;
+				Report.Iterations += this->conjugate_gradient(L, U, F, Target, MaxFallbackIterations);
+				Norm = std::sqrt(this->residual(L, U, F, L.R.data()));
+			}
+
+			if (this->singular()) {
+				this->remove_mean(L, U);
+			}
+			Report.Residual 	= (Y)(Norm / NormF);
+			Report.Converged 	= (Norm <= std::max(Target, Floor));
+			return Report;
+		}
+
+		// Solves with conjugate gradient only, mainly useful for comparison.
+		report solve_conjugate_gradient(field<X, N, Y>& aU, const field<X, N, Y>& aF, Y aTolerance = Y(1e-4)) {
+			return this->solve(aU, aF, aTolerance, 0);
+		}
+
+		// aOut = Alpha * aU + Beta * laplacian(aU) with the solver's boundary.
+		void apply(const field<X, N, Y>& aU, field<X, N, Y>& aOut) const {
+			if (aU.domain() != Domain) {
+				throw std::invalid_argument("multigrid::apply(): Field does not match the solver domain.");
+			}
+			aOut.reshape(Domain);
+			this->apply(Level[0], aU.data(), aOut.data());
+		}
+
+	private:
+
+		void push_level(level&& aLevel) {
+			level& L = Level.emplace_back(std::move(aLevel));
+			stencil Stencil(stencil::CENTRAL, Boundary);
+			L.Size = 1;
+			for (std::size_t i = 0; i < N; i++) {
+				// Dirichlet ghosts extrapolate linearly to zero at the wall, Neumann ghosts repeat the edge.
+				L.GhostLo[i] = (Boundary == stencil::ZERO) ? (Y)(X(1) - L.Step[i] / L.WallLo[i]) : Y(1);
+				L.GhostHi[i] = (Boundary == stencil::ZERO) ? (Y)(X(1) - L.Step[i] / L.WallHi[i]) : Y(1);
+				L.Coupling[i].resize(L.Count[i]);
+				for (std::size_t j = 0; j < L.Count[i]; j++) {
+					stencil_tap<X> T = stencil_second_tap<X>(j, L.Count[i], (std::ptrdiff_t)L.Size, L.Step[i], Stencil);
+					coupling& C = L.Coupling[i][j];
+					// Taps that land on the sample itself are edges, their ghost folds into the diagonal.
+					C.Lo 	= T.Lo;
+					C.Hi 	= T.Hi;
+					C.WLo 	= (T.Lo != 0) ? (Y)T.Scale : Y(0);
+					C.WHi 	= (T.Hi != 0) ? (Y)T.Scale : Y(0);
+					C.WMid 	= (Y)T.Scale * (Y(-2) + ((T.Lo == 0) ? L.GhostLo[i] : Y(0)) + ((T.Hi == 0) ? L.GhostHi[i] : Y(0)));
+				}
+				L.Size *= L.Count[i];
+			}
+			L.R.resize(L.Size);
+			if (Level.size() > 1) {
+				L.U.resize(L.Size);
+				L.F.resize(L.Size);
+			}
+		}
+
+		// Runs aRow(Base, Coupling, Index) for every row along axis 0 and sums its results.
+		// Coupling holds copies for axes 1 to N - 1, Index the row's coordinates on those axes.
+		template <typename F>
+		double for_each_row(const level& aLevel, F aRow, bool aParallel = true) const {
+			const std::ptrdiff_t RowCount = (std::ptrdiff_t)(aLevel.Size / aLevel.Count[0]);
+			double Sum = 0.0;
+			#pragma omp parallel for schedule(static) reduction(+:Sum) if (aParallel && (aLevel.Size > ParallelThreshold))
+			for (std::ptrdiff_t r = 0; r < RowCount; r++) {
+				std::array<coupling, N> C;
+				vec<std::size_t, N> Index;
+				std::size_t Remainder = (std::size_t)r;
+				Index[0] = 0;
+				for (std::size_t j = 1; j < N; j++) {
+					Index[j] = Remainder % aLevel.Count[j];
+					Remainder /= aLevel.Count[j];
+					C[j] = aLevel.Coupling[j][Index[j]];
+				}
+				Sum += aRow((std::ptrdiff_t)(r * aLevel.Count[0]), C, Index);
+			}
+			return Sum;
+		}
+
+		// Operator row of one sample, A u = Diagonal * u + sum of Weight * neighbour.
+		struct point_stencil {
+			std::array<std::ptrdiff_t, 2 * N>	Offset;
+			std::array<Y, 2 * N>				Weight;
+			Y									Diagonal;
+			Y									InverseDiagonal;
+		};
+
+		point_stencil make_point(const std::array<coupling, N>& aC) const {
+			point_stencil P;
+			Y Mid = Y(0);
+			for (std::size_t j = 0; j < N; j++) {
+				P.Offset[2 * j + 0] = aC[j].Lo;
+				P.Offset[2 * j + 1] = aC[j].Hi;
+				P.Weight[2 * j + 0] = Beta * aC[j].WLo;
+				P.Weight[2 * j + 1] = Beta * aC[j].WHi;
+				Mid += aC[j].WMid;
+			}
+			P.Diagonal = Alpha + Beta * Mid;
+			P.InverseDiagonal = Y(1) / P.Diagonal;
+			return P;
+		}
+
+		static Y neighbours(const Y* aU, std::size_t aIndex, const point_stencil& aP) {
+			Y Sum = Y(0);
+			for (std::size_t k = 0; k < 2 * N; k++) {
+				Sum += aP.Weight[k] * aU[(std::ptrdiff_t)aIndex + aP.Offset[k]];
+			}
+			return Sum;
+		}
+
+		// Visits x = aBegin, aBegin + aStride, ... of one row as aPoint(x, Stencil). Only the two edge
+		// samples differ along axis 0, so the interior runs on a single precomputed stencil.
+		template <typename F>
+		void sweep_row(const level& aLevel, std::array<coupling, N> aC, std::size_t aBegin, std::size_t aStride, F aPoint) const {
+			const std::size_t Length = aLevel.Count[0];
+			std::size_t x = aBegin;
+			if (x == 0) {
+				aC[0] = aLevel.Coupling[0][0];
+				aPoint(x, this->make_point(aC));
+				x += aStride;
+			}
+			aC[0] = aLevel.Coupling[0][Length > 2 ? 1 : 0];
+			const point_stencil Interior = this->make_point(aC);
+			for (; x < Length - 1; x += aStride) {
+				aPoint(x, Interior);
+			}
+			if (x == Length - 1) {
+				aC[0] = aLevel.Coupling[0][Length - 1];
+				aPoint(x, this->make_point(aC));
+			}
+		}
+
+		// True if the last and first samples of an axis neighbour each other with the same colour.
+		bool seam(const level& aLevel, std::size_t aAxis) const {
+			return (Boundary == stencil::WRAP) && (aLevel.Count[aAxis] % 2 == 1);
+		}
+
+		// One Gauss-Seidel sweep over the samples of one colour. Odd periodic axes can not be
+		// coloured red-black, along axis 0 a row is swept in order anyway, along the other axes
+		// the last row meets a row of its own colour across the wrap, so those seam rows are
+		// swept afterwards on one thread.
+		void smooth(const level& aLevel, Y* aU, const Y* aF, std::size_t aColour) const {
+			bool Seam = false, SeamPass = false;
+			for (std::size_t j = 1; j < N; j++) Seam = Seam || this->seam(aLevel, j);
+			auto Row = [&](std::ptrdiff_t aBase, const std::array<coupling, N>& aC, const vec<std::size_t, N>& aIndex) -> double {
+				std::size_t Parity = aColour;
+				bool OnSeam = false;
+				for (std::size_t j = 1; j < N; j++) {
+					Parity += aIndex[j];
+					OnSeam = OnSeam || (this->seam(aLevel, j) && (aIndex[j] == aLevel.Count[j] - 1));
+				}
+				if (OnSeam != SeamPass) return 0.0;
+				Y* U = aU + aBase;
+				const Y* F = aF + aBase;
+				this->sweep_row(aLevel, aC, Parity & 1, 2, [&](std::size_t x, const point_stencil& P) {
+					U[x] = (F[x] - neighbours(U, x, P)) * P.InverseDiagonal;
+				});
+				return 0.0;
+			};
+			this->for_each_row(aLevel, Row);
+			if (Seam) {
+				SeamPass = true;
+				this->for_each_row(aLevel, Row, false);
+			}
+		}
+
+		// aOut = A aU.
+		void apply(const level& aLevel, const Y* aU, Y* aOut) const {
+			this->for_each_row(aLevel, [&](std::ptrdiff_t aBase, const std::array<coupling, N>& aC, const vec<std::size_t, N>&) -> double {
+				const Y* U = aU + aBase;
+				Y* Out = aOut + aBase;
+				this->sweep_row(aLevel, aC, 0, 1, [&](std::size_t x, const point_stencil& P) {
+					Out[x] = P.Diagonal * U[x] + neighbours(U, x, P);
+				});
+				return 0.0;
+			});
+		}
+
+		// aR = aF - A aU, returns ||aR||^2.
+		double residual(const level& aLevel, const Y* aU, const Y* aF, Y* aR) const {
+			return this->for_each_row(aLevel, [&](std::ptrdiff_t aBase, const std::array<coupling, N>& aC, const vec<std::size_t, N>&) -> double {
+				const Y* U = aU + aBase;
+				const Y* F = aF + aBase;
+				Y* R = aR + aBase;
+				// Rows are short, summing them in Y keeps the loop vectorizable.
+				Y Sum = Y(0);
+				this->sweep_row(aLevel, aC, 0, 1, [&](std::size_t x, const point_stencil& P) {
+					const Y Value = F[x] - (P.Diagonal * U[x] + neighbours(U, x, P));
+					R[x] = Value;
+					Sum += Value * Value;
+				});
+				return (double)Sum;
+			});
+		}
+
+		// Size of the rounding error in A aU, the residual can not be driven much below this.
+		double rounding_floor(const level& aLevel, const Y* aU) const {
+			double Sum = this->for_each_row(aLevel, [&](std::ptrdiff_t aBase, const std::array<coupling, N>& aC, const vec<std::size_t, N>&) -> double {
+				const Y* U = aU + aBase;
+				double RowSum = 0.0;
+				this->sweep_row(aLevel, aC, 0, 1, [&](std::size_t x, const point_stencil& P) {
+					double Term = std::abs((double)P.Diagonal * U[x]);
+					for (std::size_t k = 0; k < 2 * N; k++) {
+						Term += std::abs((double)P.Weight[k] * U[(std::ptrdiff_t)x + P.Offset[k]]);
+					}
+					RowSum += Term * Term;
+				});
+				return RowSum;
+			});
+			return std::numeric_limits<Y>::epsilon() * std::sqrt(Sum);
+		}
+
+		// Fine samples covered by coarse sample aIndex along one axis.
+		static std::size_t child_count(const level& aFine, const level& aCoarse, std::size_t aAxis, std::size_t aIndex) {
+			if (!aCoarse.Coarsened[aAxis]) return 1;
+			return ((aIndex == aCoarse.Count[aAxis] - 1) && (aFine.Count[aAxis] % 2 == 1)) ? 3 : 2;
+		}
+
+		// Coarse value is the average of the fine samples it covers.
+		void restrict_residual(const level& aFine, const Y* aR, const level& aCoarse, Y* aF) const {
+			const std::size_t Length = aCoarse.Count[0];
+			const std::size_t FineLength = aFine.Count[0];
+			this->for_each_row(aCoarse, [&](std::ptrdiff_t aBase, const std::array<coupling, N>&, const vec<std::size_t, N>& aIndex) -> double {
+				// Fine rows covered by this coarse row, and their share of the average.
+				std::array<const Y*, integer_power(3, N - 1)> Row;
+				std::array<Y, integer_power(3, N - 1)> Weight;
+				std::size_t RowCount = 0;
+				for (std::size_t m = 0; m < integer_power(3, N - 1); m++) {
+					std::size_t Offset = 0, Stride = FineLength, Digits = m;
+					Y W = Y(1);
+					bool Inside = true;
+					for (std::size_t j = 1; j < N; j++) {
+						const std::size_t Child = Digits % 3;
+						const std::size_t Children = child_count(aFine, aCoarse, j, aIndex[j]);
+						Digits /= 3;
+						Inside = Inside && (Child < Children);
+						Offset += ((aCoarse.Coarsened[j] ? 2 * aIndex[j] : aIndex[j]) + Child) * Stride;
+						Stride *= aFine.Count[j];
+						W /= (Y)Children;
+					}
+					if (!Inside) continue;
+					Row[RowCount] = aR + Offset;
+					Weight[RowCount] = W;
+					RowCount++;
+				}
+				Y* F = aF + aBase;
+				if (aCoarse.Coarsened[0]) {
+					const std::size_t Pairs = (FineLength % 2 == 1) ? Length - 1 : Length;
+					for (std::size_t x = 0; x < Pairs; x++) {
+						Y Sum = Y(0);
+						for (std::size_t k = 0; k < RowCount; k++) Sum += Weight[k] * (Row[k][2 * x] + Row[k][2 * x + 1]);
+						F[x] = Sum * Y(0.5);
+					}
+					if (Pairs < Length) {
+						Y Sum = Y(0);
+						for (std::size_t k = 0; k < RowCount; k++) Sum += Weight[k] * (Row[k][FineLength - 3] + Row[k][FineLength - 2] + Row[k][FineLength - 1]);
+						F[Length - 1] = Sum / Y(3);
+					}
+				}
+				else {
+					for (std::size_t x = 0; x < Length; x++) {
+						Y Sum = Y(0);
+						for (std::size_t k = 0; k < RowCount; k++) Sum += Weight[k] * Row[k][x];
+						F[x] = Sum;
+					}
+				}
+				return 0.0;
+			});
+		}
+
+		// Coarse sample and weight pair a fine sample interpolates from along one axis.
+		struct interpolant {
+			std::size_t		I0, I1;
+			Y				W0, W1;
+		};
+
+		// Linear interpolation between the two nearest coarse samples, ghosts stand in beyond the edges.
+		interpolant interpolate(const level& aFine, const level& aCoarse, std::size_t aAxis, std::size_t aIndex) const {
+			if (!aCoarse.Coarsened[aAxis]) {
+				return { aIndex, aIndex, Y(1), Y(0) };
+			}
+			const std::ptrdiff_t Count = (std::ptrdiff_t)aCoarse.Count[aAxis];
+			const bool Odd = (aIndex % 2 == 1);
+			std::ptrdiff_t I0 = Odd ? (std::ptrdiff_t)(aIndex / 2) : (std::ptrdiff_t)(aIndex / 2) - 1;
+			std::ptrdiff_t I1 = I0 + 1;
+			interpolant Out = { 0, 0, Odd ? Y(0.75) : Y(0.25), Odd ? Y(0.25) : Y(0.75) };
+			if (this->seam(aFine, aAxis)) {
+				// Coarse samples sit at 2 c + 1/2 in fine samples, except the last which is centred
+				// on the three it covers. Weights follow the distances, periodically continued.
+				const std::ptrdiff_t FineCount = (std::ptrdiff_t)aFine.Count[aAxis];
+				auto Centre = [&](std::ptrdiff_t aI) -> Y {
+					const std::ptrdiff_t Wrapped = (aI + Count) % Count;
+					const Y Base = (Wrapped == Count - 1) ? (Y)(FineCount - 2) : (Y)(2 * Wrapped) + Y(0.5);
+					return Base + (Y)((aI - Wrapped) / Count * FineCount);
+				};
+				Out.W1 = ((Y)aIndex - Centre(I0)) / (Centre(I1) - Centre(I0));
+				Out.W0 = Y(1) - Out.W1;
+			}
+			auto Resolve = [&](std::ptrdiff_t aI, Y& aW) -> std::size_t {
+				if (aI < 0) {
+					if (Boundary == stencil::WRAP) return (std::size_t)(aI + Count);
+					aW *= aCoarse.GhostLo[aAxis];
+					return 0;
+				}
+				if (aI >= Count) {
+					if (Boundary == stencil::WRAP) return (std::size_t)(aI - Count);
+					aW *= aCoarse.GhostHi[aAxis];
+					return (std::size_t)(Count - 1);
+				}
+				return (std::size_t)aI;
+			};
+			Out.I0 = Resolve(I0, Out.W0);
+			Out.I1 = Resolve(I1, Out.W1);
+			return Out;
+		}
+
+		// aU += linear interpolation of the coarse correction aE.
+		void prolong_correction(const level& aCoarse, const Y* aE, const level& aFine, Y* aU) const {
+			const std::size_t Length = aFine.Count[0];
+			std::vector<interpolant> Column(Length);
+			for (std::size_t x = 0; x < Length; x++) {
+				Column[x] = this->interpolate(aFine, aCoarse, 0, x);
+			}
+			this->for_each_row(aFine, [&](std::ptrdiff_t aBase, const std::array<coupling, N>&, const vec<std::size_t, N>& aIndex) -> double {
+				// Coarse rows this fine row interpolates from, with their weights.
+				std::array<interpolant, N> I;
+				for (std::size_t j = 1; j < N; j++) {
+					I[j] = this->interpolate(aFine, aCoarse, j, aIndex[j]);
+				}
+				std::array<const Y*, power_of_two(N - 1)> Row;
+				std::array<Y, power_of_two(N - 1)> Weight;
+				for (std::size_t m = 0; m < power_of_two(N - 1); m++) {
+					std::size_t Offset = 0, Stride = aCoarse.Count[0];
+					Weight[m] = Y(1);
+					for (std::size_t j = 1; j < N; j++) {
+						bool Bit = (m >> (j - 1)) & 1;
+						Offset += (Bit ? I[j].I1 : I[j].I0) * Stride;
+						Weight[m] *= Bit ? I[j].W1 : I[j].W0;
+						Stride *= aCoarse.Count[j];
+					}
+					Row[m] = aE + Offset;
+				}
+				Y* U = aU + aBase;
+				for (std::size_t x = 0; x < Length; x++) {
+					const interpolant& C = Column[x];
+					Y Sum = Y(0);
+					for (std::size_t m = 0; m < power_of_two(N - 1); m++) {
+						Sum += Weight[m] * (C.W0 * Row[m][C.I0] + C.W1 * Row[m][C.I1]);
+					}
+					U[x] += Sum;
+				}
+				return 0.0;
+			});
+		}
+
+		void vcycle(std::size_t aLevel, Y* aU, const Y* aF) {
+			level& L = Level[aLevel];
+			if (aLevel + 1 == Level.size()) {
+				const double Norm = std::sqrt(this->dot(L, aF, aF));
+				this->conjugate_gradient(L, aU, aF, 1e-3 * Norm, 2 * L.Size);
+				return;
+			}
+			for (std::size_t s = 0; s < PreSmooth; s++) {
+				this->smooth(L, aU, aF, 0);
+				this->smooth(L, aU, aF, 1);
+			}
+			this->residual(L, aU, aF, L.R.data());
+			level& C = Level[aLevel + 1];
+			this->restrict_residual(L, L.R.data(), C, C.F.data());
+			if (this->singular()) {
+				this->remove_mean(C, C.F.data());
+			}
+			std::fill(C.U.begin(), C.U.end(), Y(0));
+			this->vcycle(aLevel + 1, C.U.data(), C.F.data());
+			// Constants are invisible to a singular operator, keep them out of the correction.
+			if (this->singular()) {
+				this->remove_mean(C, C.U.data());
+			}
+			this->prolong_correction(C, C.U.data(), L, aU);
+			// Reverse colour order keeps the cycle symmetric.
+			for (std::size_t s = 0; s < PostSmooth; s++) {
+				this->smooth(L, aU, aF, 1);
+				this->smooth(L, aU, aF, 0);
+			}
+		}
+
+		double dot(const level& aLevel, const Y* aA, const Y* aB) const {
+			double Sum = 0.0;
+			#pragma omp parallel for schedule(static) reduction(+:Sum) if (aLevel.Size > ParallelThreshold)
+			for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aLevel.Size; i++) {
+				Sum += (double)aA[i] * (double)aB[i];
+			}
+			return Sum;
+		}
+
+		void remove_mean(const level& aLevel, Y* aU) const {
+			double Sum = 0.0;
+			#pragma omp parallel for schedule(static) reduction(+:Sum) if (aLevel.Size > ParallelThreshold)
+			for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aLevel.Size; i++) {
+				Sum += aU[i];
+			}
+			const Y Mean = (Y)(Sum / (double)aLevel.Size);
+			#pragma omp parallel for schedule(static) if (aLevel.Size > ParallelThreshold)
+			for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aLevel.Size; i++) {
+				aU[i] -= Mean;
+			}
+		}
+
+		// Conjugate gradient until ||f - A u|| <= aTarget, returns the iteration count.
+		std::size_t conjugate_gradient(level& aLevel, Y* aU, const Y* aF, double aTarget, std::size_t aMaxIterations) {
+			const std::ptrdiff_t Size = (std::ptrdiff_t)aLevel.Size;
+			aLevel.P.resize(aLevel.Size);
+			aLevel.Q.resize(aLevel.Size);
+			Y* R = aLevel.R.data();
+			Y* P = aLevel.P.data();
+			Y* Q = aLevel.Q.data();
+			double RR = this->residual(aLevel, aU, aF, R);
+			std::copy(R, R + Size, P);
+			std::size_t Iteration = 0;
+			while ((std::sqrt(RR) > aTarget) && (Iteration < aMaxIterations)) {
+				this->apply(aLevel, P, Q);
+				const double PQ = this->dot(aLevel, P, Q);
+				if (PQ == 0.0) break;
+				const Y A = (Y)(RR / PQ);
+				double Next = 0.0;
+				#pragma omp parallel for schedule(static) reduction(+:Next) if (aLevel.Size > ParallelThreshold)
+				for (std::ptrdiff_t i = 0; i < Size; i++) {
+					aU[i] += A * P[i];
+					R[i] -= A * Q[i];
+					Next += (double)R[i] * (double)R[i];
+				}
+				const Y B = (Y)(Next / RR);
+				#pragma omp parallel for schedule(static) if (aLevel.Size > ParallelThreshold)
+				for (std::ptrdiff_t i = 0; i < Size; i++) {
+					P[i] = R[i] + B * P[i];
+				}
+				RR = Next;
+				Iteration++;
+			}
+			return Iteration;
+		}
+
+	};
+
+	// Solves laplacian(u) = f once, build a multigrid directly to reuse it across solves.
+	template <typename X, std::size_t N, typename Y> inline
+	typename multigrid<X, N, Y>::report poisson(field<X, N, Y>& aU, const field<X, N, Y>& aF, stencil::boundary aBoundary = stencil::ZERO, Y aTolerance = Y(1e-4)) {
+		multigrid<X, N, Y> Solver(aF.domain(), aBoundary);
+		return Solver.solve(aU, aF, aTolerance);
+	}
+
+}
+
+#endif // !GEODESY_CORE_MATH_MULTIGRID_H
@@ -5,6 +5,7 @@
 #include "config.h"
 #include "type.h"
 #include "constants.h"
+#include "simd.h"
 
 //tex:
 // A quaternion<T> can be writtin in the mathematical form.
@@ -250,6 +251,18 @@ namespace geodesy::core::math {
 
 	};
 
+#if defined(GEODESY_MATH_SIMD)
+
+	// Vectorized Hamilton product, bit-for-bit identical to the generic template.
+	template <> inline
+	quaternion<float> quaternion<float>::operator*(const quaternion<float>& aRhs) const {
+		quaternion<float> Out;
+		simd::quat_mul(Out.data(), this->data(), aRhs.data());
+		return Out;
+	}
+
+#endif
+
 	// -------------------- External Functions --------------------
 
 	template <typename T> inline 
@@ -277,6 +290,85 @@ namespace geodesy::core::math {
 		return aArg / abs(aArg);
 	}
 
+	// Normalized linear interpolation along the shortest arc. With aSlerpCorrection the
+	// factor is first warped by a cubic fit of the slerp angle error, which keeps every
+	// component within ~4e-4 of slerp (~2e-5 for the small arcs between keyframes)
+	// without any trigonometry.
+	template <typename T> inline
+	quaternion<T> nlerp(const quaternion<T>& aFrom, const quaternion<T>& aTo, T aFactor, bool aSlerpCorrection = false) {
+		T Dot = T(0);
+		Dot += aFrom[0] * aTo[0];
+		Dot += aFrom[1] * aTo[1];
+		Dot += aFrom[2] * aTo[2];
+		Dot += aFrom[3] * aTo[3];
+		quaternion<T> To = std::signbit(Dot) ? -aTo : aTo;
+		T t = aFactor;
+		if (aSlerpCorrection) {
+			const T d = std::abs(Dot);
+			const T A = T(1.0904) + d * (T(-3.2452) + d * (T(3.55645) - d * T(1.43519)));
+			const T B = T(0.848013) + d * (T(-1.06021) + d * T(0.215638));
+			const T k = A * (t - T(0.5)) * (t - T(0.5)) + B;
+			t = t + t * (t - T(0.5)) * (t - T(1)) * k;
+		}
+		quaternion<T> Out;
+		T Length = T(0);
+		for (std::size_t i = 0; i < 4; i++) {
+			Out[i] = aFrom[i] + (To[i] - aFrom[i]) * t;
+		}
+		for (std::size_t i = 0; i < 4; i++) {
+			Length += Out[i] * Out[i];
+		}
+		Length = std::sqrt(Length);
+		for (std::size_t i = 0; i < 4; i++) {
+			Out[i] = Out[i] / Length;
+		}
+		return Out;
+	}
+
+	// Exact spherical linear interpolation along the shortest arc.
+	template <typename T> inline
+	quaternion<T> slerp(const quaternion<T>& aFrom, const quaternion<T>& aTo, T aFactor) {
+		T CosTheta = aFrom[0] * aTo[0] + aFrom[1] * aTo[1] + aFrom[2] * aTo[2] + aFrom[3] * aTo[3];
+		quaternion<T> To = aTo;
+		if (CosTheta < T(0)) {
+			To = -To;
+			CosTheta = -CosTheta;
+		}
+		if (CosTheta > T(0.9995)) {
+			// Nearly parallel, sin(Theta) is ill conditioned.
+			return nlerp(aFrom, To, aFactor);
+		}
+		T Theta = std::acos(CosTheta);
+		return (std::sin((T(1) - aFactor) * Theta) * aFrom + std::sin(aFactor * Theta) * To) / std::sin(Theta);
+	}
+
+	// Batched nlerp over arrays of key pairs with a factor per element, intended
+	// for sampling every rotation channel of a skeleton in one pass.
+	template <typename T> inline
+	void nlerp(quaternion<T>* aOut, const quaternion<T>* aFrom, const quaternion<T>* aTo, const T* aFactor, std::size_t aCount, bool aSlerpCorrection = false) {
+		for (std::size_t i = 0; i < aCount; i++) {
+			aOut[i] = nlerp(aFrom[i], aTo[i], aFactor[i], aSlerpCorrection);
+		}
+	}
+
+#if defined(GEODESY_MATH_SIMD)
+
+	// Four quaternions per iteration in lane transposed form, bit-for-bit identical to the scalar nlerp.
+	template <> inline
+	void nlerp<float>(quaternion<float>* aOut, const quaternion<float>* aFrom, const quaternion<float>* aTo, const float* aFactor, std::size_t aCount, bool aSlerpCorrection) {
+		static_assert(sizeof(quaternion<float>) == 4 * sizeof(float), "quaternion<float> must be tightly packed.");
+		const std::size_t Body = aCount - (aCount % 4);
+		std::size_t i = 0;
+		for (; i < Body; i += 4) {
+			simd::quat_nlerp4(aOut[i].data(), aFrom[i].data(), aTo[i].data(), aFactor + i, aSlerpCorrection);
+		}
+		for (; i < aCount; i++) {
+			aOut[i] = nlerp(aFrom[i], aTo[i], aFactor[i], aSlerpCorrection);
+		}
+	}
+
+#endif
+
 	template <typename T> inline 
 	quaternion<T> exp(const quaternion<T>& aArg) {
 		quaternion<T> u = quaternion<T>(0.0, aArg[1], aArg[2], aArg[3]);
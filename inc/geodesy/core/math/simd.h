@@ -0,0 +1,336 @@
+#pragma once
+#ifndef GEODESY_CORE_MATH_SIMD_H
+#define GEODESY_CORE_MATH_SIMD_H
+
+// ------------------------------ simd.h ------------------------------ //
+/*
+Compile time selection of the vector instruction set used by the float
+specializations of vec, mat and quaternion. The instruction set is picked
+from what the compiler is allowed to emit for the target, so no runtime
+dispatch happens. Define GEODESY_MATH_DISABLE_SIMD to force the generic
+scalar templates everywhere.
+
+Every kernel in here evaluates its products and sums in exactly the same
+order as the generic scalar templates, and never uses fused multiply-add,
+so results are bit-for-bit identical to the scalar path.
+*/
+
+#include <cstdint>
+#include <cstring>
+
+#include "config.h"
+
+#if !defined(GEODESY_MATH_DISABLE_SIMD)
+	#if defined(__AVX2__) || defined(__AVX__)
+		#define GEODESY_MATH_SIMD_AVX
+		#define GEODESY_MATH_SIMD_SSE
+	#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+		#define GEODESY_MATH_SIMD_SSE
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+		#define GEODESY_MATH_SIMD_NEON
+	#endif
+#endif
+
+#if defined(GEODESY_MATH_SIMD_SSE) || defined(GEODESY_MATH_SIMD_NEON)
+	#define GEODESY_MATH_SIMD
+#endif
+
+// Hardware float <-> half conversion. MSVC has no __F16C__ macro, but implies it with /arch:AVX2.
+#if !defined(GEODESY_MATH_DISABLE_SIMD)
+	#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+		#define GEODESY_MATH_SIMD_F16C
+	#elif defined(GEODESY_MATH_SIMD_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+		#define GEODESY_MATH_SIMD_NEON_F16
+	#endif
+#endif
+
+#if defined(GEODESY_MATH_SIMD_AVX) || defined(GEODESY_MATH_SIMD_F16C)
+	#include <immintrin.h>
+#elif defined(GEODESY_MATH_SIMD_SSE)
+	#include <emmintrin.h>
+#elif defined(GEODESY_MATH_SIMD_NEON)
+	#include <arm_neon.h>
+#endif
+
+namespace geodesy::core::math::simd {
+
+#if defined(GEODESY_MATH_SIMD)
+
+	// Name of the instruction set selected at compile time.
+	constexpr const char* name() {
+	#if defined(GEODESY_MATH_SIMD_AVX)
+		return "AVX";
+	#elif defined(GEODESY_MATH_SIMD_SSE)
+		return "SSE2";
+	#else
+		return "NEON";
+	#endif
+	}
+
+	// ------------------------- 4 Wide Register Abstraction ------------------------- //
+
+#if defined(GEODESY_MATH_SIMD_SSE)
+
+	typedef __m128 float4;
+
+	inline float4 load(const float* aPtr) 						{ return _mm_loadu_ps(aPtr); }
+	inline void store(float* aPtr, float4 aV) 					{ _mm_storeu_ps(aPtr, aV); }
+	inline float4 zero() 										{ return _mm_setzero_ps(); }
+	inline float4 splat(float aS) 								{ return _mm_set1_ps(aS); }
+	inline float4 set(float aX, float aY, float aZ, float aW) 	{ return _mm_set_ps(aW, aZ, aY, aX); }
+	inline float4 add(float4 aA, float4 aB) 					{ return _mm_add_ps(aA, aB); }
+	inline float4 sub(float4 aA, float4 aB) 					{ return _mm_sub_ps(aA, aB); }
+	inline float4 mul(float4 aA, float4 aB) 					{ return _mm_mul_ps(aA, aB); }
+	inline float4 div(float4 aA, float4 aB) 					{ return _mm_div_ps(aA, aB); }
+	// Flips the sign bit of each lane where the mask lane is -0.0f.
+	inline float4 flip(float4 aA, float4 aSignMask) 			{ return _mm_xor_ps(aA, aSignMask); }
+
+	inline float4 sqrt(float4 aA) 								{ return _mm_sqrt_ps(aA); }
+	// Isolates the sign bit of each lane, feed into flip() for copysign style selection.
+	inline float4 sign(float4 aA) 								{ return _mm_and_ps(aA, _mm_set1_ps(-0.0f)); }
+	inline float lane(float4 aV, int aI) {
+		alignas(16) float Out[4];
+		_mm_store_ps(Out, aV);
+		return Out[aI];
+	}
+
+	// Lane permutation, out = { v[A], v[B], v[C], v[D] }
+	template <int A, int B, int C, int D>
+	inline float4 shuffle(float4 aV) { return _mm_shuffle_ps(aV, aV, _MM_SHUFFLE(D, C, B, A)); }
+
+	// 4x4 transpose, converts four AoS quaternions into { w, x, y, z } lane registers and back.
+	inline void transpose(float4& aA, float4& aB, float4& aC, float4& aD) { _MM_TRANSPOSE4_PS(aA, aB, aC, aD); }
+
+	inline float4 min(float4 aA, float4 aB) 					{ return _mm_min_ps(aA, aB); }
+	inline float4 max(float4 aA, float4 aB) 					{ return _mm_max_ps(aA, aB); }
+	// Lane wise aA <= aB as a bit mask, bit i set for lane i.
+	inline int less_equal(float4 aA, float4 aB) 				{ return _mm_movemask_ps(_mm_cmple_ps(aA, aB)); }
+	// Four unsigned bytes widened to floats.
+	inline float4 widen(const uint8_t* aPtr) {
+		int Word;
+		std::memcpy(&Word, aPtr, 4);
+		const __m128i Zero = _mm_setzero_si128();
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(Word), Zero), Zero));
+	}
+
+#elif defined(GEODESY_MATH_SIMD_NEON)
+
+	typedef float32x4_t float4;
+
+	inline float4 load(const float* aPtr) 						{ return vld1q_f32(aPtr); }
+	inline void store(float* aPtr, float4 aV) 					{ vst1q_f32(aPtr, aV); }
+	inline float4 zero() 										{ return vdupq_n_f32(0.0f); }
+	inline float4 splat(float aS) 								{ return vdupq_n_f32(aS); }
+	inline float4 set(float aX, float aY, float aZ, float aW) 	{ const float V[4] = { aX, aY, aZ, aW }; return vld1q_f32(V); }
+	inline float4 add(float4 aA, float4 aB) 					{ return vaddq_f32(aA, aB); }
+	inline float4 sub(float4 aA, float4 aB) 					{ return vsubq_f32(aA, aB); }
+	// vmulq is used instead of vfmaq on purpose, fused results would differ from scalar.
+	inline float4 mul(float4 aA, float4 aB) 					{ return vmulq_f32(aA, aB); }
+	inline float4 div(float4 aA, float4 aB) {
+	#if defined(__aarch64__) || defined(_M_ARM64)
+		return vdivq_f32(aA, aB);
+	#else
+		float A[4], B[4];
+		vst1q_f32(A, aA); vst1q_f32(B, aB);
+		for (int i = 0; i < 4; i++) A[i] /= B[i];
+		return vld1q_f32(A);
+	#endif
+	}
+	inline float4 flip(float4 aA, float4 aSignMask) {
+		return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(aA), vreinterpretq_u32_f32(aSignMask)));
+	}
+	inline float lane(float4 aV, int aI) {
+		float Out[4];
+		vst1q_f32(Out, aV);
+		return Out[aI];
+	}
+
+	inline float4 sqrt(float4 aA) {
+	#if defined(__aarch64__) || defined(_M_ARM64)
+		return vsqrtq_f32(aA);
+	#else
+		float A[4];
+		vst1q_f32(A, aA);
+		for (int i = 0; i < 4; i++) A[i] = std::sqrt(A[i]);
+		return vld1q_f32(A);
+	#endif
+	}
+	inline float4 sign(float4 aA) {
+		return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(aA), vdupq_n_u32(0x80000000u)));
+	}
+
+	template <int A, int B, int C, int D>
+	inline float4 shuffle(float4 aV) {
+		float In[4], Out[4];
+		vst1q_f32(In, aV);
+		Out[0] = In[A]; Out[1] = In[B]; Out[2] = In[C]; Out[3] = In[D];
+		return vld1q_f32(Out);
+	}
+
+	inline void transpose(float4& aA, float4& aB, float4& aC, float4& aD) {
+		const float32x4x2_t AB = vtrnq_f32(aA, aB);
+		const float32x4x2_t CD = vtrnq_f32(aC, aD);
+		aA = vcombine_f32(vget_low_f32(AB.val[0]), vget_low_f32(CD.val[0]));
+		aB = vcombine_f32(vget_low_f32(AB.val[1]), vget_low_f32(CD.val[1]));
+		aC = vcombine_f32(vget_high_f32(AB.val[0]), vget_high_f32(CD.val[0]));
+		aD = vcombine_f32(vget_high_f32(AB.val[1]), vget_high_f32(CD.val[1]));
+	}
+
+	inline float4 min(float4 aA, float4 aB) 					{ return vminq_f32(aA, aB); }
+	inline float4 max(float4 aA, float4 aB) 					{ return vmaxq_f32(aA, aB); }
+	inline int less_equal(float4 aA, float4 aB) {
+		const uint32x4_t Mask = vcleq_f32(aA, aB);
+		return (int)((vgetq_lane_u32(Mask, 0) & 1u) | (vgetq_lane_u32(Mask, 1) & 2u) | (vgetq_lane_u32(Mask, 2) & 4u) | (vgetq_lane_u32(Mask, 3) & 8u));
+	}
+	inline float4 widen(const uint8_t* aPtr) {
+		uint32_t Word;
+		std::memcpy(&Word, aPtr, 4);
+		const uint8x8_t Bytes = vreinterpret_u8_u32(vdup_n_u32(Word));
+		return vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(Bytes))));
+	}
+
+#endif
+
+	// ------------------------- Kernels ------------------------- //
+
+	// Column-major 4x4 product. Each output column is accumulated as
+	// ((((0 + A0*b0) + A1*b1) + A2*b2) + A3*b3), the same order as the
+	// generic triple loop in mat::operator*.
+	inline void mat4_mul(float* aOut, const float* aLhs, const float* aRhs) {
+	#if defined(GEODESY_MATH_SIMD_AVX)
+		// Two output columns per iteration in a single 256 bit register.
+		const __m256 C0 = _mm256_broadcast_ps((const __m128*)(aLhs + 0));
+		const __m256 C1 = _mm256_broadcast_ps((const __m128*)(aLhs + 4));
+		const __m256 C2 = _mm256_broadcast_ps((const __m128*)(aLhs + 8));
+		const __m256 C3 = _mm256_broadcast_ps((const __m128*)(aLhs + 12));
+		for (int j = 0; j < 4; j += 2) {
+			const float* B0 = aRhs + 4 * j;
+			const float* B1 = aRhs + 4 * (j + 1);
+			__m256 R = _mm256_setzero_ps();
+			R = _mm256_add_ps(R, _mm256_mul_ps(C0, _mm256_setr_ps(B0[0], B0[0], B0[0], B0[0], B1[0], B1[0], B1[0], B1[0])));
+			R = _mm256_add_ps(R, _mm256_mul_ps(C1, _mm256_setr_ps(B0[1], B0[1], B0[1], B0[1], B1[1], B1[1], B1[1], B1[1])));
+			R = _mm256_add_ps(R, _mm256_mul_ps(C2, _mm256_setr_ps(B0[2], B0[2], B0[2], B0[2], B1[2], B1[2], B1[2], B1[2])));
+			R = _mm256_add_ps(R, _mm256_mul_ps(C3, _mm256_setr_ps(B0[3], B0[3], B0[3], B0[3], B1[3], B1[3], B1[3], B1[3])));
+			_mm256_storeu_ps(aOut + 4 * j, R);
+		}
+	#else
+		const float4 C0 = load(aLhs + 0);
+		const float4 C1 = load(aLhs + 4);
+		const float4 C2 = load(aLhs + 8);
+		const float4 C3 = load(aLhs + 12);
+		for (int j = 0; j < 4; j++) {
+			const float* B = aRhs + 4 * j;
+			float4 R = zero();
+			R = add(R, mul(C0, splat(B[0])));
+			R = add(R, mul(C1, splat(B[1])));
+			R = add(R, mul(C2, splat(B[2])));
+			R = add(R, mul(C3, splat(B[3])));
+			store(aOut + 4 * j, R);
+		}
+	#endif
+	}
+
+	// Column-major 4x4 matrix times 4 vector.
+	inline void mat4_mul_vec4(float* aOut, const float* aLhs, const float* aRhs) {
+		float4 R = zero();
+		R = add(R, mul(load(aLhs + 0), splat(aRhs[0])));
+		R = add(R, mul(load(aLhs + 4), splat(aRhs[1])));
+		R = add(R, mul(load(aLhs + 8), splat(aRhs[2])));
+		R = add(R, mul(load(aLhs + 12), splat(aRhs[3])));
+		store(aOut, R);
+	}
+
+	// Products are done wide and stored once, the sum is done lane by lane
+	// to preserve the summation order of vec::operator*.
+	inline float dot4(const float* aLhs, const float* aRhs) {
+		float P[4];
+		store(P, mul(load(aLhs), load(aRhs)));
+		float Out = 0.0f;
+		Out += P[0];
+		Out += P[1];
+		Out += P[2];
+		Out += P[3];
+		return Out;
+	}
+
+	inline void scale4(float* aOut, const float* aIn, float aDivisor) {
+		store(aOut, div(load(aIn), splat(aDivisor)));
+	}
+
+	inline void cross3(float* aOut, const float* aLhs, const float* aRhs) {
+		const float4 A = set(aLhs[0], aLhs[1], aLhs[2], 0.0f);
+		const float4 B = set(aRhs[0], aRhs[1], aRhs[2], 0.0f);
+		const float4 R = sub(
+			mul(shuffle<1, 2, 0, 3>(A), shuffle<2, 0, 1, 3>(B)),
+			mul(shuffle<2, 0, 1, 3>(A), shuffle<1, 2, 0, 3>(B))
+		);
+		float Out[4];
+		store(Out, R);
+		aOut[0] = Out[0];
+		aOut[1] = Out[1];
+		aOut[2] = Out[2];
+	}
+
+	// Hamilton product, storage order { w, x, y, z }. The four terms are
+	// accumulated left to right with the signs folded into the products,
+	// matching quaternion::operator*.
+	inline void quat_mul(float* aOut, const float* aLhs, const float* aRhs) {
+		const float N = -0.0f, P = 0.0f;
+		const float4 R = load(aRhs);
+		float4 Out = mul(splat(aLhs[0]), R);
+		Out = add(Out, flip(mul(splat(aLhs[1]), shuffle<1, 0, 3, 2>(R)), set(N, P, N, P)));
+		Out = add(Out, flip(mul(splat(aLhs[2]), shuffle<2, 3, 0, 1>(R)), set(N, P, P, N)));
+		Out = add(Out, flip(mul(splat(aLhs[3]), shuffle<3, 2, 1, 0>(R)), set(N, N, P, P)));
+		store(aOut, Out);
+	}
+
+	// Four normalized lerps at once, storage order { w, x, y, z } per quaternion.
+	// Mirrors the scalar math::nlerp operation for operation.
+	inline void quat_nlerp4(float* aOut, const float* aFrom, const float* aTo, const float* aFactor, bool aSlerpCorrection) {
+		float4 W1 = load(aFrom + 0), X1 = load(aFrom + 4), Y1 = load(aFrom + 8), Z1 = load(aFrom + 12);
+		float4 W2 = load(aTo + 0), X2 = load(aTo + 4), Y2 = load(aTo + 8), Z2 = load(aTo + 12);
+		transpose(W1, X1, Y1, Z1);
+		transpose(W2, X2, Y2, Z2);
+		float4 Dot = zero();
+		Dot = add(Dot, mul(W1, W2));
+		Dot = add(Dot, mul(X1, X2));
+		Dot = add(Dot, mul(Y1, Y2));
+		Dot = add(Dot, mul(Z1, Z2));
+		// Shortest arc, negate the target where the dot product is negative.
+		const float4 Sign = sign(Dot);
+		W2 = flip(W2, Sign); X2 = flip(X2, Sign); Y2 = flip(Y2, Sign); Z2 = flip(Z2, Sign);
+		float4 t = load(aFactor);
+		if (aSlerpCorrection) {
+			const float4 d = flip(Dot, Sign);
+			const float4 Half = splat(0.5f);
+			const float4 A = add(splat(1.0904f), mul(d, add(splat(-3.2452f), mul(d, sub(splat(3.55645f), mul(d, splat(1.43519f)))))));
+			const float4 B = add(splat(0.848013f), mul(d, add(splat(-1.06021f), mul(d, splat(0.215638f)))));
+			const float4 k = add(mul(mul(A, sub(t, Half)), sub(t, Half)), B);
+			t = add(t, mul(mul(mul(t, sub(t, Half)), sub(t, splat(1.0f))), k));
+		}
+		W1 = add(W1, mul(sub(W2, W1), t));
+		X1 = add(X1, mul(sub(X2, X1), t));
+		Y1 = add(Y1, mul(sub(Y2, Y1), t));
+		Z1 = add(Z1, mul(sub(Z2, Z1), t));
+		float4 Length = zero();
+		Length = add(Length, mul(W1, W1));
+		Length = add(Length, mul(X1, X1));
+		Length = add(Length, mul(Y1, Y1));
+		Length = add(Length, mul(Z1, Z1));
+		Length = sqrt(Length);
+		W1 = div(W1, Length); X1 = div(X1, Length); Y1 = div(Y1, Length); Z1 = div(Z1, Length);
+		transpose(W1, X1, Y1, Z1);
+		store(aOut + 0, W1); store(aOut + 4, X1); store(aOut + 8, Y1); store(aOut + 12, Z1);
+	}
+
+#else
+
+	constexpr const char* name() {
+		return "Scalar";
+	}
+
+#endif
+
+}
+
+#endif // !GEODESY_CORE_MATH_SIMD_H
@@ -9,7 +9,6 @@ typedef unsigned int uint;
 
 //typedef char byte;
 
-//typedef ushort half;
 //typedef float;
 //typedef double;
 
@@ -5,6 +5,7 @@
 #include "config.h"
 #include "complex.h"
 #include "quaternion.h"
+#include "simd.h"
 
 namespace geodesy::core::math {
 
@@ -146,6 +147,25 @@ namespace geodesy::core::math {
 
 	};
 
+#if defined(GEODESY_MATH_SIMD)
+
+	// -------------------- SIMD Specializations -------------------- //
+
+	template <> inline
+	vec<float, 4> vec<float, 4>::operator/(const float& aRhs) const {
+		vec<float, 4> Out;
+		simd::scale4(Out.data(), this->data(), aRhs);
+		return Out;
+	}
+
+	// Dot product, length() and normalize() for vec<float, 4> route through this.
+	template <> inline
+	float vec<float, 4>::operator*(const vec<float, 4>& aRhs) const {
+		return simd::dot4(this->data(), aRhs.data());
+	}
+
+#endif
+
 	template<typename T, std::size_t N> inline
 	vec<T, N> operator*(const T& aLhs, const vec<T, N>& aRhs) {
 		return aRhs * aLhs;
@@ -166,6 +186,25 @@ namespace geodesy::core::math {
 		return aVector / length(aVector);
 	}
 
+	template<typename T, std::size_t N> inline
+	vec<T, N> lerp(const vec<T, N>& aFrom, const vec<T, N>& aTo, T aFactor) {
+		vec<T, N> Out;
+		for (std::size_t i = 0; i < N; i++) {
+			Out[i] = aFrom[i] + (aTo[i] - aFrom[i]) * aFactor;
+		}
+		return Out;
+	}
+
+	// Batched lerp over arrays of key pairs with a factor per element.
+	template<typename T, std::size_t N> inline
+	void lerp(vec<T, N>* aOut, const vec<T, N>* aFrom, const vec<T, N>* aTo, const T* aFactor, std::size_t aCount) {
+		for (std::size_t i = 0; i < aCount; i++) {
+			for (std::size_t j = 0; j < N; j++) {
+				aOut[i][j] = aFrom[i][j] + (aTo[i][j] - aFrom[i][j]) * aFactor[i];
+			}
+		}
+	}
+
 	template<typename T> inline 
 	vec<T, 3> operator^(const vec<T, 3>& aLhs, const vec<T, 3>& aRhs) {
 		return vec<T, 3>(
@@ -175,6 +214,17 @@ namespace geodesy::core::math {
 		);
 	}
 
+#if defined(GEODESY_MATH_SIMD)
+
+	template <> inline
+	vec<float, 3> operator^(const vec<float, 3>& aLhs, const vec<float, 3>& aRhs) {
+		vec<float, 3> Out;
+		simd::cross3(Out.data(), aLhs.data(), aRhs.data());
+		return Out;
+	}
+
+#endif
+
 	template <typename T> inline
 	quaternion<T> rotation(T aAngle, vec<T, 3> aNormalizedAxis) {
 		// Create Rotator Quaternion.
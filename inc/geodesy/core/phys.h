@@ -5,6 +5,15 @@
 #include "phys/mesh.h"
 #include "phys/animation.h"
 #include "phys/force.h"
+#include "phys/dynamics.h"
 #include "phys/node.h"
+#include "phys/collision.h"
+#include "phys/narrow_phase.h"
+#include "phys/solver.h"
+#include "phys/convex_hull.h"
+#include "phys/spatial_hash.h"
+#include "phys/bvh.h"
+#include "phys/continuous.h"
+#include "phys/snapshot.h"
 
 #endif // !GEODESY_CORE_PHYS_H
\ No newline at end of file
@@ -16,23 +16,40 @@ struct aiAnimation;
 
 namespace geodesy::core::phys {
 
+	// Forward declaration of the node class.
+	class node;
+
 	class animation {
 	public:
 
-		// Template Code for Keyframe Animation
+		// Template Code for Keyframe Animation, key times and values are kept in separate arrays so
+		// a key search only walks the times.
 		template <typename T>
-		struct key {
-			double		Time; 		// Time in Ticks
-			T			Value;
-			key() : Time(0.0), Value() {}
+		struct channel {
+			std::vector<double>		Time; 		// Time in Ticks, ascending
+			std::vector<T>			Value;
+			std::size_t size() const { return Time.size(); }
+		};
+
+		// Keys a playback last sampled a node's channels at. Sampling starts from them and steps
+		// forward, as playback time mostly does, seeks and loops fall back to a binary search.
+		// A stale cursor only costs the search, never changes the result.
+		struct cursor {
+			uint32_t				Position;
+			uint32_t				Rotation;
+			uint32_t				Scaling;
+			cursor() : Position(0), Rotation(0), Scaling(0) {}
 		};
 
 		// Determines transform override based on time, for a singular node.
 		struct node {
-			std::vector<key<math::vec<float, 3>>> 		PositionKey;
-			std::vector<key<math::quaternion<float>>> 	RotationKey;
-			std::vector<key<math::vec<float, 3>>> 		ScalingKey;
-			math::mat<float, 4, 4> operator[](double aTime) const; // Expects Time in Ticks
+			std::string 								Name;		// Identifier of the node it animates.
+			channel<math::vec<float, 3>> 				PositionKey;
+			channel<math::quaternion<float>> 			RotationKey;
+			channel<math::vec<float, 3>> 				ScalingKey;
+			math::affine<float> operator[](double aTime) const; // Expects Time in Ticks
+			// Same as operator[], starting the key search from and updating a playback's cursor.
+			math::affine<float> sample(double aTime, cursor& aCursor) const;
 			bool exists() const;
 		};
 
@@ -43,7 +60,7 @@ namespace geodesy::core::phys {
 		double 								Start;
 		double 								Stop;
 		double 								TicksPerSecond;			// Conversion Factor for Ticks to Seconds
-		std::map<std::string, node> 		NodeAnimMap;
+		std::vector<node> 					Track;					// Node channels, in node order once compiled.
 		std::map<std::string, mesh> 		MeshAnimMap;
 
 		animation();
@@ -51,25 +68,21 @@ namespace geodesy::core::phys {
 
 		const node& operator[](std::string aNodeName) const;
 
+		// Orders the node channels by the position of their node in a linearized hierarchy, so a node
+		// finds its channel at Track[Index] with no name lookup. Nodes without one get an empty channel,
+		// channels without a node are dropped.
+		void compile(const std::vector<phys::node*>& aNodeList);
+
+		// Samples many node channels at the same time in batches, e.g. a whole skeleton.
+		// Null entries and missing channels take the same defaults as node::operator[].
+		static void sample(const std::vector<const node*>& aNode, double aTime, std::vector<math::affine<float>>& aTransform);
+
 	};
 
-	// Calculates the full transformation matrix from position, rotation, and scale states.
+	// Calculates the full transformation from position, rotation, and scale states.
 	template <typename T> inline
-	math::mat<T, 4, 4> calculate_transform(math::vec<T, 3> aPosition, math::quaternion<T> aOrientation, math::vec<T, 3> aScale) {
-		math::mat<T, 4, 4> Translation = {
-			1.0f, 		0.0f, 		0.0f, 			aPosition[0],
-			0.0f, 		1.0f, 		0.0f, 			aPosition[1],
-			0.0f, 		0.0f, 		1.0f, 			aPosition[2],
-			0.0f, 		0.0f, 		0.0f, 			1.0f
-		};
-		math::mat<T, 4, 4> Orientation = math::mat<T, 4, 4>(aOrientation);
-		math::mat<T, 4, 4> Scale = {
-			aScale[0], 	0.0f, 		0.0f, 			0.0f,
-			0.0f, 		aScale[1], 	0.0f, 			0.0f,
-			0.0f, 		0.0f, 		aScale[2], 		0.0f,
-			0.0f, 		0.0f, 		0.0f, 			1.0f
-		};
-		return Translation * Orientation * Scale;
+	math::affine<T> calculate_transform(math::vec<T, 3> aPosition, math::quaternion<T> aOrientation, math::vec<T, 3> aScale) {
+		return math::affine<T>(aPosition, aOrientation, aScale);
 	}
 
 }
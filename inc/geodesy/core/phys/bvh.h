@@ -0,0 +1,181 @@
+#pragma once
+#ifndef GEODESY_CORE_PHYS_BVH_H
+#define GEODESY_CORE_PHYS_BVH_H
+
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Include include config.
+#include "../../config.h"
+// Include include math.
+#include "../math.h"
+// Include physics mesh.
+#include "mesh.h"
+// Include bounding boxes.
+#include "collision.h"
+
+namespace geodesy::core::phys {
+
+	// Forward declaration of the node class.
+	class node;
+
+	namespace collision {
+
+		// Points along a ray are Origin + t * Direction for t in [0, Length], distances are in
+		// multiples of Direction so it need not be unit length.
+		struct ray {
+			math::vec<float, 3>					Origin;
+			math::vec<float, 3>					Direction;
+			float								Length;
+
+			ray();
+			ray(const math::vec<float, 3>& aOrigin, const math::vec<float, 3>& aDirection, float aLength = std::numeric_limits<float>::max());
+		};
+
+		struct hit {
+			static constexpr uint32_t null = UINT32_MAX;
+
+			float								Distance;		// t of the hit, infinity when nothing was hit.
+			uint32_t							Triangle;		// Index of the triangle in the mesh's index order.
+			uint32_t							Instance;		// Index into instance_bvh::Instance, null for a single mesh.
+			float								U;				// Barycentric weight of the triangle's second corner.
+			float								V;				// Barycentric weight of the third corner.
+
+			hit();
+			bool found() const;
+		};
+
+		/*
+		Four wide bounding volume hierarchy over a set of boxes, the core shared by the triangle
+		and instance hierarchies. Every volume is one cache line holding the boxes of its four
+		children, quantized to 8 bits inside the volume's own box, so a traversal step is a
+		single line fetch and a ray is tested against all four children at once with SIMD.
+		Quantization always rounds outward, children only ever grow by a step.
+
+		The build is top down with binned surface area heuristic splits along the axis where the
+		item centers spread the most, up to three binary splits make the four children of a
+		volume. Large subtrees are built as parallel tasks. Past a depth the splits fall back to
+		the median, which bounds the depth for any input.
+		*/
+		class bvh {
+		public:
+
+			static constexpr uint32_t null		= UINT32_MAX;
+			static constexpr uint32_t leaf		= 0x80000000u;	// Child flag, count - 1 in bits 28 to 30, first item below.
+			static constexpr uint32_t MaxLeaf	= 8;
+
+			struct alignas(64) volume {
+				float							Origin[3];
+				float							Step[3];		// Length of one quantization step per axis.
+				uint8_t							Min[3][4];		// Child c spans Origin + Min[k][c] * Step to Origin + Max[k][c] * Step along axis k.
+				uint8_t							Max[3][4];
+				uint32_t						Child[4];		// Volume index, leaf item range, or null.
+			};
+
+			uint32_t							LeafSize;		// Most items in a leaf.
+			aabb								Bounds;
+			std::vector<volume>					Volume;			// Volume[0] is the root.
+			std::vector<uint32_t>				Item;			// Source index of each leaf slot.
+
+			bvh();
+
+			// Builds the hierarchy over item boxes, leaves hold at most aLeafSize items.
+			void build(const std::vector<aabb>& aBox, uint32_t aLeafSize = 4);
+			bool empty() const;
+			std::size_t memory() const;
+			// Appends the source index of every item in a leaf overlapping aBounds, a superset of
+			// the items whose own boxes overlap it.
+			void query(const aabb& aBounds, std::vector<uint32_t>& aItem) const;
+
+		};
+
+		/*
+		Triangle hierarchy of a mesh in mesh space, for picking, line of sight and occlusion
+		queries on the CPU. Triangles are stored in leaf order with an edge form that the ray
+		test reads directly. Rays are traced one at a time, testing four children per step, or
+		in packets of 16 where the children are decoded once per packet and tested against four
+		rays per instruction. Packets pay off for coherent rays, such as those of one camera or
+		light, and are formed in the order the rays are given. A packet whose rays head into
+		different octants is traced one ray at a time. Batches of packets run in parallel.
+		Skinned meshes are traced in their bind pose.
+		// Example usage:
+		collision::triangle_bvh Tree(*Mesh);
+		collision::hit Hit = Tree.intersect(collision::ray(Eye, Forward));
+		std::vector<collision::hit> Hit = Tree.intersect(RayList);
+		std::vector<uint32_t> Touching = Tree.overlap(Center, Radius);
+		*/
+		class triangle_bvh : public bvh {
+		public:
+
+			struct triangle {
+				float							Corner[3];		// First corner.
+				float							Edge[2][3];		// Second and third corners relative to the first.
+				uint32_t						Index;			// Index of the triangle in the mesh's index order.
+			};
+
+			std::vector<triangle>				Triangle;		// In leaf slot order.
+
+			triangle_bvh();
+			triangle_bvh(const mesh& aMesh, uint32_t aLeafSize = 4);
+
+			// Closest hit along a ray.
+			hit intersect(const ray& aRay) const;
+			// Whether anything is hit along a ray, stops at the first hit found.
+			bool occluded(const ray& aRay) const;
+			// Closest hits of a batch of rays, traced in packets.
+			std::vector<hit> intersect(const std::vector<ray>& aRay) const;
+			// 1 for each ray of a batch that hits anything.
+			std::vector<uint8_t> occluded(const std::vector<ray>& aRay) const;
+			// Triangles touching a sphere.
+			std::vector<uint32_t> overlap(const math::vec<float, 3>& aCenter, float aRadius) const;
+
+		};
+
+		/*
+		Hierarchy over placed triangle hierarchies, the CPU side counterpart of a top level
+		acceleration structure. Instances share their mesh hierarchies, a query reaching an
+		instance carries the ray into mesh space through the inverse transform, where distances
+		along the ray stay the same. Rebuilt whenever the instances move.
+		// Example usage:
+		collision::instance_bvh Scene;
+		Scene.build(InstanceList);
+		collision::hit Hit = Scene.intersect(collision::ray(Eye, Forward));
+		node* Picked = Hit.found() ? Scene.Instance[Hit.Instance].Node : nullptr;
+		*/
+		class instance_bvh : public bvh {
+		public:
+
+			struct instance {
+				std::shared_ptr<triangle_bvh>	Mesh;
+				math::affine<float>				Transform;		// Mesh space to world space.
+				math::affine<float>				Inverse;		// World space to mesh space, set by build().
+				node*							Node;			// Owner, for callers to map hits back.
+
+				instance();
+				instance(std::shared_ptr<triangle_bvh> aMesh, const math::affine<float>& aTransform, node* aNode = nullptr);
+			};
+
+			std::vector<instance>				Instance;		// In the order given to build().
+
+			instance_bvh();
+
+			// Builds over the instances with a non empty mesh hierarchy and an invertible transform,
+			// the others are kept but never hit.
+			void build(const std::vector<instance>& aInstance);
+
+			hit intersect(const ray& aRay) const;
+			bool occluded(const ray& aRay) const;
+			std::vector<hit> intersect(const std::vector<ray>& aRay) const;
+			std::vector<uint8_t> occluded(const std::vector<ray>& aRay) const;
+			// Instance and triangle index of every triangle touching a world space sphere.
+			std::vector<std::pair<uint32_t, uint32_t>> overlap(const math::vec<float, 3>& aCenter, float aRadius) const;
+
+		};
+
+	}
+
+}
+
+#endif // !GEODESY_CORE_PHYS_BVH_H
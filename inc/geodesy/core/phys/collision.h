@@ -2,14 +2,282 @@
 #ifndef GEODESY_CORE_PHYS_COLLISION_H
 #define GEODESY_CORE_PHYS_COLLISION_H
 
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+// Include include config.
+#include "../../config.h"
+// Include include math.
+#include "../math.h"
+// Include physics mesh.
+#include "mesh.h"
+
 namespace geodesy::core::phys {
 
-    // Forward declaration of the node class.
-    class node;
+	// Forward declaration of the node class.
+	class node;
+
+	namespace collision {
+
+		// Axis aligned bounding box in world space.
+		struct aabb {
+			math::vec<float, 3>		Min;
+			math::vec<float, 3>		Max;
+
+			// Empty box, Min > Max so that merging anything into it yields the other box.
+			aabb();
+			aabb(const math::vec<float, 3>& aMin, const math::vec<float, 3>& aMax);
+
+			bool overlaps(const aabb& aRhs) const {
+				return (Min[0] <= aRhs.Max[0]) && (aRhs.Min[0] <= Max[0])
+					&& (Min[1] <= aRhs.Max[1]) && (aRhs.Min[1] <= Max[1])
+					&& (Min[2] <= aRhs.Max[2]) && (aRhs.Min[2] <= Max[2]);
+			}
+
+			bool contains(const aabb& aRhs) const {
+				return (Min[0] <= aRhs.Min[0]) && (aRhs.Max[0] <= Max[0])
+					&& (Min[1] <= aRhs.Min[1]) && (aRhs.Max[1] <= Max[1])
+					&& (Min[2] <= aRhs.Min[2]) && (aRhs.Max[2] <= Max[2]);
+			}
+
+			// Half the surface area, proportional to the probability of a random ray or box hitting it.
+			float area() const {
+				float dx = Max[0] - Min[0], dy = Max[1] - Min[1], dz = Max[2] - Min[2];
+				return dx * dy + dy * dz + dz * dx;
+			}
+
+			math::vec<float, 3> center() const {
+				return (Min + Max) * 0.5f;
+			}
+
+		};
+
+		inline aabb merge(const aabb& aLhs, const aabb& aRhs) {
+			aabb Out;
+			for (std::size_t i = 0; i < 3; i++) {
+				Out.Min[i] = std::min(aLhs.Min[i], aRhs.Min[i]);
+				Out.Max[i] = std::max(aLhs.Max[i], aRhs.Max[i]);
+			}
+			return Out;
+		}
+
+		// World space box around a mesh placed by a transform, the overlap of the boxes around
+		// its mapped axis aligned box, oriented box and sphere. Meshes whose bounds were never
+		// computed fall back to the sphere about the center of mass.
+		aabb bounds(const mesh& aMesh, const math::affine<float>& aTransform);
+
+		// World space bounds of a node's collision mesh under GlobalTransform. The node must
+		// carry a CollisionMesh.
+		aabb bounds(const node* aNode);
+
+		/*
+		Common interface of the broad phase methods a stage can pick from. update() brings the
+		structure in line with the stage's node list, then pair generation is divided into
+		work_count() independent work items, so a caller can hand contiguous ranges of items to
+		its own threads. Concatenating the ranges in order gives the same pairs as find_pairs().
+		// Example usage:
+		std::shared_ptr<collision::broad_phase> BroadPhase = collision::broad_phase::create(collision::broad_phase::SWEEP_AND_PRUNE);
+		BroadPhase->update(Stage->NodeCache);
+		std::vector<std::pair<node*, node*>> Pair = BroadPhase->find_pairs();
+		*/
+		class broad_phase {
+		public:
+
+			enum method {
+				DYNAMIC_TREE,			// Best for scattered or incoherent motion.
+				SWEEP_AND_PRUNE,		// Best for many bodies moving coherently.
+			};
+
+			static std::shared_ptr<broad_phase> create(method aMethod);
+
+			virtual ~broad_phase();
+
+			// Synchronizes with a node list, nodes with a CollisionMesh are inserted or moved to
+			// their current bounds, entries whose nodes are no longer listed are removed.
+			virtual void update(const std::vector<node*>& aNodeList) = 0;
+			virtual std::size_t size() const = 0;
+
+			virtual std::size_t work_count() const = 0;
+			// Appends the pairs of work items [aStart, aStart + aCount) to aPair.
+			virtual void find_pairs(std::size_t aStart, std::size_t aCount, std::vector<std::pair<node*, node*>>& aPair) const = 0;
+			// Every distinct pair of nodes whose bounds overlap, generated in parallel.
+			std::vector<std::pair<node*, node*>> find_pairs() const;
+
+		};
+
+		/*
+		Dynamic bounding volume hierarchy used as the broad phase. Every node carrying a
+		CollisionMesh owns one leaf, the leaf stores a fattened copy of the node's bounds
+		so that small motions do not touch the tree at all. When a node leaves its fat box
+		the leaf is removed and reinserted, the sibling is chosen by the surface area cost
+		of the enlarged ancestors, and the path back to the root is rebalanced by tree
+		rotations so the height stays logarithmic no matter the insertion order.
+
+		Pairs are found by colliding the tree against itself, the top of that traversal is
+		split into independent subtree pairs which are the work items. Candidates are checked
+		against their tight boxes, so fattening only costs traversal, never false pairs.
+		Nodes sharing a root belong to the same object and are never paired.
+		// Example usage:
+		collision::dynamic_tree Tree;
+		Tree.update(Stage->NodeCache);
+		std::vector<std::pair<node*, node*>> Pair = Tree.find_pairs();
+		Tree.query(collision::aabb(Lo, Hi), [&](node* aNode) { ... return true; });
+		*/
+		class dynamic_tree : public broad_phase {
+		public:
+
+			static constexpr int null = -1;
+
+			struct volume {
+				aabb		Box;		// Fattened bounds for leaves, union of children otherwise.
+				int			Parent;		// Next free volume while on the free list.
+				int			Left;		// null for leaves.
+				int			Right;
+				int			Height;		// 0 for leaves, -1 while on the free list.
+				node*		Owner;		// Node owning the leaf.
+				bool is_leaf() const { return Left == null; }
+			};
+
+			float								Margin;			// [m] Fattening applied to every side of a leaf.
+			float								Prediction;		// Multiple of the last displacement the fat box is stretched by.
+			int									Root;
+			int									FreeList;
+			std::size_t							LeafCount;
+			std::size_t							Stamp;			// Increments once per update(), marks leaves still present.
+			std::vector<volume>					Volume;
+			std::vector<aabb>					Tight;			// Exact bounds per leaf, indexed like Volume.
+			std::vector<std::size_t>			Seen;			// Stamp of the last update() each leaf was present in.
+			std::unordered_map<node*, int>		Proxy;			// Leaf owned by each node.
+			std::vector<std::pair<node*, int>>	Order;			// Node list of the last update() and its leaves, spares the lookup while the list is unchanged.
+
+			dynamic_tree(float aMargin = 0.1f, float aPrediction = 4.0f);
+
+			// Adds a node with the given bounds, returns its leaf.
+			int insert(node* aNode, const aabb& aBounds);
+			// Removes a node's leaf, does nothing if the node is not in the tree.
+			void remove(node* aNode);
+			// Updates the bounds of a node, returns true if the leaf had to be reinserted.
+			bool move(node* aNode, const aabb& aBounds, const math::vec<float, 3>& aDisplacement);
+			void update(const std::vector<node*>& aNodeList) override;
+			std::size_t size() const override;
+
+			std::size_t work_count() const override;
+			void find_pairs(std::size_t aStart, std::size_t aCount, std::vector<std::pair<node*, node*>>& aPair) const override;
+			using broad_phase::find_pairs;
+
+			// Calls aCallback(node*) for every leaf whose fat box overlaps aBounds, traversal stops
+			// early if the callback returns false.
+			template <typename F>
+			void query(const aabb& aBounds, F&& aCallback) const {
+				if (Root == null) return;
+				// Balanced trees stay well within the local stack, degenerate ones spill to the heap.
+				int Local[64];
+				std::vector<int> Spill;
+				int* Stack = Local;
+				std::size_t Capacity = 64;
+				std::size_t Top = 0;
+				Stack[Top++] = Root;
+				while (Top > 0) {
+					const volume& V = Volume[Stack[--Top]];
+					if (!V.Box.overlaps(aBounds)) continue;
+					if (V.is_leaf()) {
+						if (!aCallback(V.Owner)) return;
+						continue;
+					}
+					if (Top + 2 > Capacity) {
+						if (Stack == Local) Spill.assign(Local, Local + Top);
+						Capacity *= 2;
+						Spill.resize(Capacity);
+						Stack = Spill.data();
+					}
+					Stack[Top++] = V.Left;
+					Stack[Top++] = V.Right;
+				}
+			}
+
+			int height() const;
+			// Sum of internal node areas over the root area, lower is a tighter tree.
+			float area_ratio() const;
+
+		private:
+
+			typedef std::pair<int, int> task;
+
+			std::vector<task>					Task;			// Top of the self collision traversal, split by update().
+
+			int allocate();
+			void release(int aIndex);
+			void insert_leaf(int aLeaf);
+			void remove_leaf(int aLeaf);
+			int balance(int aIndex);
+			void refit(int aIndex);
+			void split(std::vector<task>& aTask) const;
+			void reset_task();
+			int expand(const task& aTask, task* aChild) const;
+
+		};
+
+		/*
+		Incremental sweep and prune. Each axis keeps a persistent array of box endpoints in
+		SoA form, a value array and a handle array holding the proxy index and whether the
+		endpoint is a min or a max. Every update rewrites the values in place and restores the
+		order with an insertion sort, which is close to linear when bodies move coherently
+		between steps. Large batches of new bodies fall back to a full sort.
+
+		The single axis variant only sorts the chosen axis. The multi-axis variant keeps all
+		three sorted and sweeps along the axis where the body centers are most spread out,
+		which produces the fewest candidates on that axis, so a scene that changes shape
+		simply changes the sweep axis. Pairs come from scanning forward from each min endpoint
+		to the matching max and testing the other two axes of every body opened in between.
+		Each endpoint of the sweep axis is one work item.
+		// Example usage:
+		collision::sweep_and_prune SAP(collision::sweep_and_prune::ALL);
+		SAP.update(Stage->NodeCache);
+		std::vector<std::pair<node*, node*>> Pair = SAP.find_pairs();
+		*/
+		class sweep_and_prune : public broad_phase {
+		public:
+
+			enum axis : int {
+				X,
+				Y,
+				Z,
+				ALL,			// Multi-axis, sorts all three and picks the sweep axis per update.
+			};
+
+			static constexpr uint32_t null = UINT32_MAX;
+
+			int									Axis;
+			int									SweepAxis;		// Axis pairs were generated along in the last update().
+			std::size_t							Stamp;
+			std::vector<node*>					Owner;			// Per proxy, nullptr while the proxy is free.
+			std::vector<aabb>					Box;			// Per proxy, world bounds.
+			std::vector<std::size_t>			Seen;			// Per proxy, stamp of the last update() it was listed in.
+			std::vector<uint32_t>				FreeList;
+			std::vector<float>					Value[3];		// Per axis, sorted endpoint values.
+			std::vector<uint32_t>				Handle[3];		// Per axis, proxy << 1 | 1 for max endpoints.
+			std::vector<float>					Cross[4];		// Per sweep endpoint, min and max on the two other axes.
+			std::unordered_map<node*, uint32_t> Proxy;
+			std::vector<std::pair<node*, uint32_t>> Order;		// Node list of the last update() and its proxies.
+
+			sweep_and_prune(int aAxis = ALL);
+
+			void update(const std::vector<node*>& aNodeList) override;
+			std::size_t size() const override;
+
+			std::size_t work_count() const override;
+			void find_pairs(std::size_t aStart, std::size_t aCount, std::vector<std::pair<node*, node*>>& aPair) const override;
+			using broad_phase::find_pairs;
+
+		private:
+
+			void sort(int aAxis, bool aFull);
+
+		};
 
-    // Collision detection function.
-    // bool detect_collision(const node& a, const node& b);
+	}
 
-} // namespace geodesy::core::phys
+}
 
-#endif // !GEODESY_CORE_PHYS_COLLISION_H
\ No newline at end of file
+#endif // !GEODESY_CORE_PHYS_COLLISION_H
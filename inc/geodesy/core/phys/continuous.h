@@ -0,0 +1,117 @@
+#pragma once
+#ifndef GEODESY_CORE_PHYS_CONTINUOUS_H
+#define GEODESY_CORE_PHYS_CONTINUOUS_H
+
+#include <unordered_map>
+#include <vector>
+
+// Include include config.
+#include "../../config.h"
+// Include include math.
+#include "../math.h"
+// Include bounding boxes.
+#include "collision.h"
+// Include hulls and GJK.
+#include "narrow_phase.h"
+// Include static hierarchy.
+#include "bvh.h"
+
+namespace geodesy::core::phys {
+
+	// Forward declaration of the node class.
+	class node;
+
+	namespace collision {
+
+		// Motion of a placed hull over one step. The root of its hierarchy moves from one pose to
+		// another, linearly in position and at a constant rate in orientation, and the hull follows
+		// through its fixed placement relative to the root. A motionless placement has equal poses.
+		struct motion {
+			math::vec<float, 3>					Start;			// [m] Root position at t = 0.
+			math::vec<float, 3>					End;			// [m] Root position at t = 1.
+			math::quaternion<float>				StartOrientation;
+			math::quaternion<float>				EndOrientation;
+			math::vec<float, 3>					Scale;			// Root scale, constant over the step.
+			math::affine<float>					Offset;			// Hull space to root space.
+			float								Angle;			// [rad] Rotation of the root over the step.
+			float								Reach;			// [m] Furthest hull point from the root origin.
+
+			motion();
+			// Motionless at aTransform.
+			motion(const math::affine<float>& aTransform);
+
+			// Hull space to world space at a time in [0, 1].
+			math::affine<float> at(float aTime) const;
+		};
+
+		// Earliest time in [0, 1] at which two spheres moving linearly touch, false if they never
+		// do. Spheres overlapping at the start touch at 0.
+		bool sweep(const math::vec<float, 3>& aStartA, const math::vec<float, 3>& aEndA, float aRadiusA, const math::vec<float, 3>& aStartB, const math::vec<float, 3>& aEndB, float aRadiusB, float& aTime);
+
+		// Conservative advancement of two moving hulls from aTime. Each iteration measures their
+		// distance with GJK and advances time by the distance over a bound on the closing speed
+		// along the normal, so the hulls never pass through each other, until they are within
+		// aSeparation. On a hit aTime is the time of impact. False if they part, if the step ends
+		// first, or if they overlap at aTime.
+		bool time_of_impact(const hull& aA, const motion& aMotionA, const hull& aB, const motion& aMotionB, float aSeparation, int aMaxIteration, float& aTime);
+
+		/*
+		Continuous collision detection for fast bodies. A stage running discrete steps misses
+		any contact a body skips over within one step, so each step the start poses of the awake
+		DYNAMIC roots are recorded before the solver moves them, and afterwards every collision
+		node that moved further than its bounding radius is swept from its start pose to its end
+		pose against everything near its path. Fast nodes are tested against the other fast
+		nodes along both motions and against the rest at their end poses.
+
+		Candidates come from a hierarchy over the swept bounds. Each pair is first tested as two
+		bounding spheres moving along straight lines, padded for rotation, which rejects most
+		pairs and otherwise gives the earliest time the hulls can touch. Conservative advancement
+		on the hulls goes on from there. A body that hits anything is moved back along its path
+		to its earliest time of impact, keeping its momentum, and stops Separation short of the
+		surface, inside the narrow phase margin, so the next step's speculative contacts take over.
+		Pairs already within the margin at the start are left to those contacts. Fast nodes are
+		swept in parallel.
+		// Example usage:
+		collision::continuous Continuous;
+		Continuous.begin(Stage->NodeCache);
+		Solver.update(Dynamics, Stage->NodeCache, Contact, DeltaTime);
+		Continuous.update(Stage->NodeCache, NarrowPhase);
+		*/
+		class continuous {
+		public:
+
+			struct pose {
+				math::vec<float, 3>				Position;
+				math::quaternion<float>			Orientation;
+			};
+
+			float								Threshold;		// Motion over bounding radius above which a node is swept.
+			float								Separation;		// [m] Gap left at an impact, below the narrow phase margin.
+			int									MaxIteration;	// Advancement steps per pair.
+			std::vector<node*>					Body;			// Roots whose start poses were recorded.
+			std::vector<pose>					Start;			// Start pose of each root in Body.
+			std::unordered_map<node*, uint32_t> Index;			// Body index of each root.
+
+			// Frame state, rebuilt by update().
+			std::vector<node*>					Collider;		// Nodes with a collision mesh.
+			std::vector<motion>					Motion;			// Of each collider, motionless unless it is fast.
+			std::vector<uint32_t>				Fast;			// Colliders that are swept.
+			std::vector<float>					Impact;			// Earliest time of impact of each fast collider, 1 for none.
+			bvh									Tree;			// Over the swept bounds of the colliders.
+
+			continuous(float aThreshold = 1.0f, float aSeparation = 0.01f, int aMaxIteration = 32);
+
+			// Records the start poses of the awake DYNAMIC roots of a list, before they are moved.
+			void begin(const std::vector<node*>& aNodeList);
+			// Sweeps the fast colliders of a list from their recorded start poses to their current
+			// ones and moves back the roots that hit anything. Hulls come from and are added to the
+			// narrow phase's cache. Returns how many roots were moved back.
+			int update(const std::vector<node*>& aNodeList, narrow_phase& aNarrowPhase);
+
+		};
+
+	}
+
+}
+
+#endif // !GEODESY_CORE_PHYS_CONTINUOUS_H
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef GEODESY_CORE_PHYS_CONVEX_HULL_H
+#define GEODESY_CORE_PHYS_CONVEX_HULL_H
+
+#include <memory>
+
+// Include include config.
+#include "../../config.h"
+// Include include math.
+#include "../math.h"
+// Include physics mesh.
+#include "mesh.h"
+
+namespace geodesy::core::phys::collision {
+
+	/*
+	Collision meshes generated from render meshes. A render mesh is first simplified by vertex
+	clustering, every vertex is snapped to a uniform grid cell and each occupied cell keeps the
+	mean of its vertices, triangles that collapse are dropped. QuickHull then builds the convex
+	hull of the clustered points. With Decompose set, meshes whose vertices sit deeper inside
+	their hull than the concavity tolerance are split recursively by a plane through their
+	centroid, along whichever principal axis gives the smallest total hull volume, and each
+	piece gets its own hull.
+	// Example usage:
+	collision::hull_create_info CreateInfo;
+	CreateInfo.Decompose = true;
+	collision::hull_report Report;
+	std::vector<std::shared_ptr<phys::mesh>> Piece = collision::collision_mesh(*Mesh, CreateInfo, &Report);
+	*/
+
+	struct hull_create_info {
+		int				Resolution;			// Clustering cells along the longest side of the mesh, 0 disables clustering.
+		int				MaxVertex;			// Upper bound on vertices per hull, 0 for the exact hull.
+		bool			Decompose;			// Split concave meshes into several convex pieces.
+		int				MaxPiece;			// Upper bound on pieces per mesh.
+		float			Concavity;			// Tolerated depth of a vertex inside its hull, relative to the mesh diagonal.
+		hull_create_info();
+	};
+
+	// Vertex counts before and after, accumulates over several meshes.
+	struct hull_report {
+		std::size_t		SourceVertex;		// Vertices of the render meshes.
+		std::size_t		ClusteredVertex;	// Vertices left after clustering.
+		std::size_t		HullVertex;			// Vertices over all generated hulls.
+		std::size_t		HullCount;
+		hull_report();
+		// Fraction of source vertices removed, 0 if nothing was processed.
+		float reduction() const;
+		hull_report& operator+=(const hull_report& aRhs);
+	};
+
+	// Vertex clustering on a grid of aResolution cells along the longest side of the mesh.
+	// Only positions and triangle topology are kept.
+	mesh simplify(const mesh& aMesh, int aResolution);
+
+	// QuickHull. Returns a triangle mesh of the hull with outward winding. Coplanar input gives
+	// a flat hull, input spanning less than a plane gives the extreme points without triangles.
+	// With aMaxVertex the hull is grown from the farthest points first and stops at that many
+	// vertices.
+	std::shared_ptr<mesh> convex_hull(const std::vector<math::vec<float, 3>>& aPoint, int aMaxVertex = 0);
+	std::shared_ptr<mesh> convex_hull(const mesh& aMesh, int aMaxVertex = 0);
+
+	// Convex pieces covering a mesh, a single hull unless aCreateInfo.Decompose is set.
+	std::vector<std::shared_ptr<mesh>> collision_mesh(const mesh& aMesh, const hull_create_info& aCreateInfo, hull_report* aReport = nullptr);
+
+}
+
+#endif // !GEODESY_CORE_PHYS_CONVEX_HULL_H
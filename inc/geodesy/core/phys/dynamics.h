@@ -0,0 +1,109 @@
+#pragma once
+#ifndef GEODESY_CORE_PHYS_DYNAMICS_H
+#define GEODESY_CORE_PHYS_DYNAMICS_H
+
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+// Include include config.
+#include "../../config.h"
+// Include include math.
+#include "../math.h"
+// Include force.
+#include "force.h"
+
+namespace geodesy::core::phys {
+
+	// Forward declaration of the node class.
+	class node;
+
+	/*
+	Rigid body dynamics of every DYNAMIC root node in a list. Each step the bodies are gathered
+	into structure of arrays, one float stream per component, so the integration loops run over
+	contiguous memory and split evenly across threads. Node state is momentum based, so a substep
+	first adds the impulse of gravity and the applied forces to the linear and angular momentum,
+	then advances position with the new velocity and orientation with the new angular velocity,
+	semi-implicit Euler. Angular velocity comes from the body space inverse inertia rotated into
+	world space. Frame time is consumed in fixed substeps, the remainder carries into the next
+	frame. Afterwards the state is scattered back to the nodes.
+
+	Forces are held constant over the whole frame and applied at a world space point, a force
+	off the body's origin adds torque. Bodies rotate about their node origin. Sleeping nodes are
+	left out until a force or a solver wakes them.
+	// Example usage:
+	phys::dynamics Dynamics;
+	Dynamics.apply(Node, { Node->Position, { 0.0f, 0.0f, 50.0f } });
+	Dynamics.update(Stage->NodeCache, DeltaTime);
+	*/
+	class dynamics {
+	public:
+
+		// Body state in structure of arrays, index i of every stream belongs to Node[i].
+		struct body_array {
+			std::vector<node*>					Node;
+			std::vector<float>					InverseMass;			// [1/kg] 0 for infinite mass.
+			std::vector<float>					GravityMass;			// [kg] Mass gravity acts on, 0 when disabled.
+			std::vector<float>					InverseInertia[6];		// [1/(kg*m^2)] Body space, symmetric, xx yy zz xy xz yz.
+			std::vector<float>					Position[3];			// [m]
+			std::vector<float>					Orientation[4];			// w x y z
+			std::vector<float>					LinearMomentum[3];		// [kg*m/s]
+			std::vector<float>					AngularMomentum[3];		// [kg*m^2/s]
+			std::vector<float>					Force[3];				// [N] Applied this frame.
+			std::vector<float>					Torque[3];				// [N*m] Applied this frame, about the body origin.
+
+			void resize(std::size_t aCount);
+			std::size_t size() const;
+		};
+
+		math::vec<float, 3>										Gravity;		// [m/s^2]
+		double													Substep;		// [s] Fixed integration step.
+		int														MaxSubstep;		// Substeps per frame before time is dropped.
+		double													Accumulator;	// [s] Frame time not yet integrated.
+		body_array												Body;
+		std::unordered_map<node*, uint32_t>						Index;			// Body index of each gathered node.
+		std::unordered_map<node*, std::vector<force>>			AppliedForce;	// Forces on a node over the next frame, cleared by update().
+
+		dynamics(double aSubstep = 1.0 / 120.0, int aMaxSubstep = 8);
+
+		// Queues a force on a node for the next frame, waking it.
+		void apply(node* aNode, const force& aForce);
+
+		// Loads the awake DYNAMIC root nodes of a list into Body, and the queued forces into Force and Torque.
+		void gather(const std::vector<node*>& aNodeList);
+		// Momentum update of one substep, gravity plus the applied force and torque.
+		void integrate_momentum(float aDeltaTime);
+		// Position and orientation update of one substep from the current momentum.
+		void integrate_position(float aDeltaTime);
+		// Runs the whole substeps that fit into the accumulated time, returns how many. aConstraint(float)
+		// is called between the momentum and position updates of each substep with the substep length,
+		// that is where velocity constraints are solved.
+		template <typename F>
+		int step(double aDeltaTime, F&& aConstraint) {
+			this->Accumulator += aDeltaTime;
+			int Count = 0;
+			while ((this->Accumulator >= this->Substep) && (Count < this->MaxSubstep)) {
+				this->integrate_momentum((float)this->Substep);
+				aConstraint((float)this->Substep);
+				this->integrate_position((float)this->Substep);
+				this->Accumulator -= this->Substep;
+				Count++;
+			}
+			// Falling behind, drop the time that could not be simulated rather than snowball.
+			if (this->Accumulator >= this->Substep) {
+				this->Accumulator = std::fmod(this->Accumulator, this->Substep);
+			}
+			return Count;
+		}
+		int step(double aDeltaTime);
+		// Writes the body state back to the nodes, along with their CurrentTransform.
+		void scatter();
+
+		// Gathers, steps and scatters, then clears the queued forces. Returns the substep count.
+		int update(const std::vector<node*>& aNodeList, double aDeltaTime);
+
+	};
+
+}
+
+#endif // !GEODESY_CORE_PHYS_DYNAMICS_H
@@ -7,6 +7,11 @@
 
 namespace geodesy::core::phys {
 
+	namespace collision {
+		// Forward declaration of the triangle hierarchy.
+		class triangle_bvh;
+	}
+
     class mesh {
 	public:
 
@@ -54,13 +59,31 @@ namespace geodesy::core::phys {
 			math::mat<float, 4, 4>			Offset;
 		};
 		
+		// Bounding volumes of the vertices in mesh space, computed once by bounding_volume() when
+		// the mesh is loaded. The sphere is Ritter's, grown until it holds every vertex. The
+		// oriented box lies along the principal axes of the vertices, unless the axis aligned
+		// box is smaller, whose axes it then takes.
+		struct bounds {
+			math::vec<float, 3>				Min;				// Axis aligned box.
+			math::vec<float, 3>				Max;
+			math::vec<float, 3>				Center;				// Sphere.
+			float							Radius;				// Negative until computed.
+			math::vec<float, 3>				BoxCenter;			// Oriented box.
+			math::mat<float, 3, 3>			BoxAxis;			// Unit axes in the columns.
+			math::vec<float, 3>				BoxExtent;			// Half lengths along the axes.
+			bounds();
+			bool empty() const;
+		};
+
 		// Host Memory Objects
 		std::string 					Name;
 		float 							Mass;
 		math::vec<float, 3> 			CenterOfMass;
 		math::vec<float, 3> 			BoundingRadius;
+		bounds 							Bounds;
 		std::vector<vertex> 			Vertex;
 		topology 						Topology;
+		std::shared_ptr<collision::triangle_bvh> BVH;		// Triangle hierarchy for CPU ray and overlap queries, built at load.
 
 		mesh();
 
@@ -70,6 +93,7 @@ namespace geodesy::core::phys {
 		// Calculates various properties of the mesh.
 		math::vec<float, 3> center_of_mass() const;
 		math::vec<float, 3> bounding_radius() const;
+		bounds bounding_volume() const;
 
 	};
 
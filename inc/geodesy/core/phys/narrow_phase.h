@@ -0,0 +1,148 @@
+#pragma once
+#ifndef GEODESY_CORE_PHYS_NARROW_PHASE_H
+#define GEODESY_CORE_PHYS_NARROW_PHASE_H
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+// Include include config.
+#include "../../config.h"
+// Include include math.
+#include "../math.h"
+// Include physics mesh.
+#include "mesh.h"
+
+namespace geodesy::core::phys {
+
+	// Forward declaration of the node class.
+	class node;
+
+	namespace collision {
+
+		/*
+		Support mapping of a collision mesh. Vertices with equal positions are welded so the
+		triangle topology gives a connected edge graph. On a convex mesh the support point of
+		any direction can then be found by hill climbing the graph from the last support point,
+		which touches a handful of vertices when the direction changes little between calls.
+		Meshes that fail the convexity check use an exhaustive scan, which makes GJK work on
+		their convex hull.
+		*/
+		struct hull {
+			std::vector<math::vec<float, 3>>	Vertex;			// Welded mesh space positions.
+			std::vector<uint32_t>				Offset;			// Neighbours of vertex i are Neighbour[Offset[i], Offset[i + 1]).
+			std::vector<uint32_t>				Neighbour;
+			bool								Convex;			// Hill climbing is only exact on a convex edge graph.
+
+			hull();
+			hull(const mesh& aMesh);
+
+			// Index of the vertex furthest along aDirection, starting the climb from aStart.
+			uint32_t support(const math::vec<float, 3>& aDirection, uint32_t aStart = 0) const;
+			// Vertices within aTolerance of the support value along aDirection, the face, edge or
+			// vertex the hull touches with. At most aCapacity are written to aFeature, returns the count.
+			uint32_t feature(const math::vec<float, 3>& aDirection, float aTolerance, uint32_t aStart, uint32_t* aFeature, uint32_t aCapacity) const;
+		};
+
+		// Vertex indices of the last GJK simplex of a pair, used to warm start the next step.
+		struct simplex {
+			int									Count;
+			uint32_t							IndexA[4];
+			uint32_t							IndexB[4];
+			simplex();
+		};
+
+		// Closest points of two hulls, or their deepest points when they overlap.
+		struct proximity {
+			bool								Intersecting;
+			float								Distance;		// [m] 0 when intersecting.
+			float								Depth;			// [m] Penetration depth, -Distance when separated.
+			math::vec<float, 3>					PointA;			// World space point on A.
+			math::vec<float, 3>					PointB;			// World space point on B.
+			math::vec<float, 3>					Normal;			// Unit normal from A to B.
+		};
+
+		struct contact {
+			math::vec<float, 3>					LocalA;			// Point on A in A's node space, persists across steps.
+			math::vec<float, 3>					LocalB;			// Point on B in B's node space.
+			math::vec<float, 3>					PositionA;		// World space points, refreshed every step.
+			math::vec<float, 3>					PositionB;
+			math::vec<float, 3>					Normal;			// Unit normal from A to B.
+			float								Depth;			// [m] Penetration, negative while separated within the margin.
+			float								Impulse[3];		// [N*s] Normal and two friction impulses of the last solve, warm starts the next.
+			contact();
+		};
+
+		// Up to four contact points between two nodes, accumulated over steps.
+		struct manifold {
+			node*								A;
+			node*								B;
+			int									Count;
+			contact								Point[4];
+			manifold();
+		};
+
+		// GJK on the Minkowski difference of two placed hulls. The simplex is read as a warm
+		// start and replaced by the final one.
+		proximity gjk(const hull& aA, const math::affine<float>& aTransformA, const hull& aB, const math::affine<float>& aTransformB, simplex& aSimplex);
+		// Expanding polytope penetration depth, starting from the simplex of an intersecting GJK
+		// query. Returns false if no polytope enclosing the origin could be built, which only
+		// happens for touching or degenerate hulls.
+		bool epa(const hull& aA, const math::affine<float>& aTransformA, const hull& aB, const math::affine<float>& aTransformB, const simplex& aSimplex, proximity& aResult);
+
+		/*
+		Narrow phase over the pairs of a broad phase. Each pair runs GJK warm started from the
+		simplex it ended with last step, and EPA when the hulls overlap. When the features along
+		the normal are a face and a face or edge, the incident one is clipped to the reference
+		face and the whole patch becomes the manifold at once, so resting boxes stand on four
+		points from the first step. Otherwise the resulting point is merged into a persistent
+		manifold kept in each node's local space, stale points are dropped once they separate
+		past the margin or slide past the breaking distance, and at most four are kept, the
+		deepest plus those spanning the largest area. Either way points keep the impulses of the
+		cached points they land on. Hulls are built once per mesh and shared. The pairs of a
+		batch are independent and run in parallel.
+		// Example usage:
+		collision::narrow_phase NarrowPhase;
+		std::vector<collision::manifold> Contact = NarrowPhase.collide(BroadPhase->find_pairs());
+		*/
+		class narrow_phase {
+		public:
+
+			struct pair_hash {
+				std::size_t operator()(const std::pair<node*, node*>& aPair) const {
+					return std::hash<node*>()(aPair.first) ^ (std::hash<node*>()(aPair.second) * 0x9E3779B97F4A7C15ull);
+				}
+			};
+
+			struct pair_state {
+				simplex							Simplex;
+				manifold						Manifold;
+				std::size_t						Seen;
+			};
+
+			float																		Margin;			// [m] Contacts are kept while separated by less than this.
+			float																		Breaking;		// [m] Tangential drift after which a cached point is dropped.
+			std::size_t																	Stamp;
+			std::unordered_map<const mesh*, std::shared_ptr<hull>>						Hull;
+			std::unordered_map<std::pair<node*, node*>, pair_state, pair_hash>			State;
+
+			narrow_phase(float aMargin = 0.02f, float aBreaking = 0.02f);
+
+			// Builds the hulls of the collision meshes of a node list not seen before, in parallel
+			// since large meshes dominate. They are read from Hull afterwards.
+			void build(const std::vector<node*>& aNodeList);
+
+			// Manifolds of every pair in contact, in the order of the pairs. A manifold's A is the
+			// lower addressed node so it stays the same whichever order a broad phase reports.
+			std::vector<manifold> collide(const std::vector<std::pair<node*, node*>>& aPair);
+			// Copies the impulses a solver left on the manifolds of the last collide() back into the
+			// cached points, so they warm start the next step.
+			void store(const std::vector<manifold>& aManifold);
+
+		};
+
+	}
+
+}
+
+#endif // !GEODESY_CORE_PHYS_NARROW_PHASE_H
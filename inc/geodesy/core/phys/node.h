@@ -46,21 +46,27 @@ namespace geodesy::core::phys {
 		node*                   				Root;       		// Root node in hierarchy
 		node*                   				Parent;     		// Parent node in hierarchy
 		std::vector<node*> 						Child;      		// Child nodes in hierarchy
+		size_t 									TreeIndex;			// Position in the root's linearized hierarchy
 		
 		// Node Data
 		std::string             				Identifier; 		// Node identifier
 		int 									Type;       		// Node type
+		motion 									MotionType;			// How the node moves in world space
+		bool 									GravityEnabled;		// Gravity acts on DYNAMIC nodes
+		bool 									Sleeping;			// Skipped by the rigid body update until woken
+		float 									IdleTime;			// [s] Time spent at rest
 		float									Mass;				// Kilogram			[kg]
 		math::mat<float, 3, 3>					InertiaTensor;		// Inertia Tensor	[kg*m^2]
 		math::vec<float, 3>						Position;			// Meter			[m]
 		math::quaternion<float>					Orientation;		// Quaternion		[Dimensionless]
 		math::vec<float, 3> 					Scale;				// Scaling Factor	[Dimensionless]
-		math::mat<float, 4, 4> 					DefaultTransform; 	// Node transformation matrix
-		math::mat<float, 4, 4> 					CurrentTransform;   // Final Node Transform each frame after physics and animation
-		math::mat<float, 4, 4> 					GlobalTransform;    // Node Transform to World Space.
+		math::affine<float> 					DefaultTransform; 	// Node transformation matrix
+		math::affine<float> 					CurrentTransform;   // Final Node Transform each frame after physics and animation
+		math::affine<float> 					GlobalTransform;    // Node Transform to World Space.
 		math::vec<float, 3>						LinearMomentum;		// Linear Momentum	[kg*m/s]
 		math::vec<float, 3>						AngularMomentum;	// Angular Momentum [kg*m/s]
 		std::shared_ptr<phys::mesh>				CollisionMesh;		// Mesh Data
+		std::vector<animation::cursor>			AnimationCursor;	// Keys each clip of the root's model last sampled
 		
 		node();
 		~node();
@@ -69,7 +75,7 @@ namespace geodesy::core::phys {
 		size_t node_count() const;
 
 		// For this node, it will calculate the model transform for a node at a particular time.
-		math::mat<float, 4, 4> transform() const;
+		math::affine<float> transform() const;
 
 		// Returns the node with the given name in the hierarchy. Will return
 		// nullptr if the node is not found in the hierarchy.
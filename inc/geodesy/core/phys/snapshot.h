@@ -0,0 +1,122 @@
+#pragma once
+#ifndef GEODESY_CORE_PHYS_SNAPSHOT_H
+#define GEODESY_CORE_PHYS_SNAPSHOT_H
+
+#include <utility>
+#include <vector>
+
+// Include include config.
+#include "../../config.h"
+// Include include math.
+#include "../math.h"
+// Include rigid body state.
+#include "dynamics.h"
+// Include contact cache.
+#include "narrow_phase.h"
+// Include joints.
+#include "solver.h"
+
+namespace geodesy::core::phys {
+
+	// Forward declaration of the node class.
+	class node;
+
+	/*
+	Ring buffer of the recent physics states of a node list, for rolling a stage back a few
+	frames and simulating forward again, as networked and replay sessions do. Only the nodes
+	that can move are kept, those that are not STATIC or belong to a root that is not. Each of
+	them is copied into a flat record of trivially copyable fields, its pose, momenta, sleep
+	state and global transform, and a frame of records sits next to the last in one buffer
+	allocated up front, so a save or restore is one pass over the nodes with no allocation.
+	Roots get their CurrentTransform back from their pose, other nodes recompute theirs from
+	the animation every step.
+
+	Alongside go the stage time, which drives animation, the time the rigid body update has
+	yet to integrate, the warm start state of the contact cache and joints, without which
+	a resimulated step would not start from the same impulses, and the poses the solver
+	compares static and animated nodes against to decide whether they wake sleeping bodies. Contacts are cut down to what
+	the narrow phase reads back, the simplex of each pair and the local points, normals and
+	impulses of its manifold. Forces and animation weights are inputs, the caller applies
+	them again while resimulating.
+
+	A change in the node list drops the saved frames, older states would not line up with it.
+	// Example usage:
+	phys::snapshot History(64);
+	History.save(Stage->NodeCache, Stage->Time, DeltaTime, Dynamics, Solver, NarrowPhase);
+	Stage->Time = History.restore(8, Dynamics, Solver, NarrowPhase);
+	*/
+	class snapshot {
+	public:
+
+		// State of one node.
+		struct state {
+			math::vec<float, 3>						Position;
+			math::quaternion<float>					Orientation;
+			math::vec<float, 3>						Scale;
+			math::vec<float, 3>						LinearMomentum;
+			math::vec<float, 3>						AngularMomentum;
+			float									IdleTime;
+			uint32_t								Sleeping;
+			math::affine<float>						GlobalTransform;
+		};
+
+		// A cached pair of the narrow phase, its points are Point[First] to Point[First + Count - 1].
+		struct pair {
+			node*									A;
+			node*									B;
+			collision::simplex						Simplex;
+			uint32_t								First;
+			int										Count;
+		};
+
+		// A cached contact point, world space values are refreshed from it by the next collide().
+		struct point {
+			math::vec<float, 3>						LocalA;
+			math::vec<float, 3>						LocalB;
+			math::vec<float, 3>						Normal;
+			float									Impulse[3];
+		};
+
+		// Everything else a frame needs, the containers keep their capacity as the ring wraps.
+		struct frame {
+			double									Time;			// [s] Stage time.
+			double									DeltaTime;		// [s] Length of the step that ended in this frame.
+			double									Accumulator;	// [s] Time the rigid body update carried over.
+			std::size_t								Stamp;			// Step count of the contact cache.
+			std::vector<pair>						Pair;
+			std::vector<point>						Point;
+			std::vector<math::vec<float, 3>>		JointImpulse;
+			std::vector<std::pair<const node*, math::affine<float>>>	Kinematic;		// The solver's poses of the nodes it does not simulate.
+			frame();
+		};
+
+		std::size_t									Capacity;		// Frames kept.
+		std::vector<node*>							Node;			// Nodes whose state is kept.
+		std::vector<state>							State;			// Capacity frames of Node.size() records each.
+		std::vector<frame>							Frame;
+		std::size_t									Head;			// Slot the next save writes.
+		std::size_t									Count;			// Frames held, the newest in the slot before Head.
+
+		snapshot(std::size_t aCapacity = 0);
+
+		// Sets the number of frames kept, dropping the saved ones.
+		void reserve(std::size_t aCapacity);
+		// Frames held.
+		std::size_t size() const;
+		// Bytes held by the buffers.
+		std::size_t memory() const;
+		// Saved frame aBack frames before the newest.
+		const frame& operator[](std::size_t aBack) const;
+
+		// Saves the state of a node list at the end of a step as the newest frame, overwriting the
+		// oldest once the ring is full.
+		void save(const std::vector<node*>& aNodeList, double aTime, double aDeltaTime, const dynamics& aDynamics, const solver& aSolver, const collision::narrow_phase& aNarrowPhase);
+		// Writes the frame aBack frames before the newest back to the nodes and the rigid body, joint
+		// and contact state, and drops the frames after it. Returns its stage time.
+		double restore(std::size_t aBack, dynamics& aDynamics, solver& aSolver, collision::narrow_phase& aNarrowPhase);
+
+	};
+
+}
+
+#endif // !GEODESY_CORE_PHYS_SNAPSHOT_H
@@ -0,0 +1,147 @@
+#pragma once
+#ifndef GEODESY_CORE_PHYS_SOLVER_H
+#define GEODESY_CORE_PHYS_SOLVER_H
+
+#include <unordered_map>
+#include <vector>
+
+// Include include config.
+#include "../../config.h"
+// Include include math.
+#include "../math.h"
+// Include rigid body state.
+#include "dynamics.h"
+// Include contact manifolds.
+#include "narrow_phase.h"
+
+namespace geodesy::core::phys {
+
+	// Forward declaration of the node class.
+	class node;
+
+	/*
+	Sequential impulse solver for contacts and ball joints between the bodies of a dynamics
+	system. Every contact point gives a non penetration row along the normal, with Baumgarte
+	stabilization past the slop and a restitution target for fast impacts, plus two friction
+	rows bounded by the normal impulse. Points still apart within the narrow phase margin are
+	speculative, they only stop the bodies from closing more than the gap in one substep. Joints pin an anchor on one body to an anchor on the
+	other. Rows are relaxed Gauss-Seidel style, warm started from the impulses of the previous
+	substep, and across frames from the impulses kept on the manifold points.
+
+	Bodies linked through constraints form islands, found with union-find each frame. Islands
+	share no bodies so they are solved in parallel, and an island whose bodies all stay under
+	the sleep velocities for SleepTime goes to sleep as a whole. Sleeping bodies are skipped by
+	the dynamics update and by the solver until an awake body or a moving node that is not
+	simulated touches them, or a force is applied.
+	Static, animated and sleeping nodes act as bodies of infinite mass.
+	// Example usage:
+	phys::solver Solver;
+	Solver.Joint.push_back(phys::solver::joint(Door, Frame, Hinge));
+	Solver.update(Dynamics, Stage->NodeCache, Contact, DeltaTime);
+	NarrowPhase.store(Contact);
+	*/
+	class solver {
+	public:
+
+		// Ball joint, keeps an anchor fixed in A's frame on top of one fixed in B's frame.
+		struct joint {
+			node*								A;
+			node*								B;				// nullptr pins A to the world.
+			math::vec<float, 3>					LocalA;			// [m] Anchor in the frame of A's root.
+			math::vec<float, 3>					LocalB;			// [m] Anchor in the frame of B's root, world space without B.
+			math::vec<float, 3>					Impulse;		// [N*s] Last substep's impulse, warm starts the next.
+			joint();
+			// Joint at a world space point, both anchors are taken from the current poses.
+			joint(node* aA, node* aB, const math::vec<float, 3>& aPoint);
+		};
+
+		// A body taking part in constraints this frame.
+		struct body {
+			int									Index;			// Into dynamics::body_array.
+			float								InverseMass;
+			math::mat<float, 3, 3>				InverseInertia;	// World space, refreshed every substep.
+			math::vec<float, 3>					LinearVelocity;
+			math::vec<float, 3>					AngularVelocity;
+			math::vec<float, 3>					LinearImpulse;	// [N*s] Applied this substep, added to the momenta afterwards.
+			math::vec<float, 3>					AngularImpulse;
+		};
+
+		// One contact point, bodies are indices into Solved, -1 for an infinite mass body.
+		struct contact_row {
+			int									A;
+			int									B;
+			int									Manifold;
+			int									Point;
+			math::vec<float, 3>					AnchorA;		// Frame of A's body, world space without A.
+			math::vec<float, 3>					AnchorB;
+			math::vec<float, 3>					Normal;			// From A to B.
+			math::vec<float, 3>					Tangent[2];
+			math::vec<float, 3>					OffsetA;		// [m] Anchor relative to the body origin, this substep.
+			math::vec<float, 3>					OffsetB;
+			float								Mass[3];		// Effective mass of the normal and friction rows.
+			float								Bias;			// [m/s] Separation velocity target, this substep.
+			float								Bounce;			// [m/s] Restitution target, fixed for the frame.
+			float								Impulse[3];
+		};
+
+		struct joint_row {
+			int									A;
+			int									B;
+			int									Joint;
+			math::vec<float, 3>					OffsetA;
+			math::vec<float, 3>					OffsetB;
+			math::mat<float, 3, 3>				Mass;			// Inverse of the effective mass matrix.
+			math::vec<float, 3>					Bias;
+			math::vec<float, 3>					Impulse;
+		};
+
+		int										Iteration;		// Velocity iterations per substep.
+		float									Friction;		// Coulomb coefficient shared by every contact.
+		float									Restitution;
+		float									BounceThreshold;// [m/s] Approach speed below which contacts do not bounce.
+		float									Baumgarte;		// Fraction of the penetration removed per substep.
+		float									Slop;			// [m] Penetration left alone, keeps resting contacts persistent.
+		float									MaxBias;		// [m/s] Cap on the stabilization velocity.
+		float									SleepLinear;	// [m/s]
+		float									SleepAngular;	// [rad/s]
+		float									SleepTime;		// [s] Rest time before an island sleeps.
+		std::vector<joint>						Joint;
+		std::unordered_map<const node*, math::affine<float>>	Kinematic;	// GlobalTransform of each collision node not simulated, as of the previous step.
+
+		// Frame state, rebuilt by prepare().
+		std::vector<body>						Solved;
+		std::vector<contact_row>				ContactRow;
+		std::vector<joint_row>					JointRow;
+		std::vector<int>						Parent;			// Union-find over dynamics bodies.
+		std::vector<int>						Slot;			// Solved index of each dynamics body, -1 if unconstrained.
+		std::vector<std::size_t>				IslandStart;	// Island i owns Order[IslandStart[i], IslandStart[i + 1]).
+		std::vector<int>						Order;			// Rows sorted by island, joints as -1 - index.
+
+		solver();
+
+		// Wakes sleeping bodies touching awake dynamic bodies or static and animated nodes that moved
+		// since the previous step, through whole chains of contacts.
+		void wake(const std::vector<collision::manifold>& aContact);
+		// Keeps the GlobalTransform of every collision node that is not simulated for the next wake().
+		void record(const std::vector<node*>& aNodeList);
+		// Builds rows and islands over the gathered bodies.
+		void prepare(dynamics& aDynamics, const std::vector<collision::manifold>& aContact);
+		// Solves every island for one substep and adds the impulses to the body momenta.
+		void solve(dynamics& aDynamics, float aDeltaTime);
+		// Leaves the impulses on the manifold points and puts resting islands to sleep.
+		void finish(dynamics& aDynamics, std::vector<collision::manifold>& aContact, double aElapsed);
+
+		// The whole frame, wake, gather, substeps of momentum, constraints and position, scatter,
+		// finish. Returns the substep count.
+		int update(dynamics& aDynamics, const std::vector<node*>& aNodeList, std::vector<collision::manifold>& aContact, double aDeltaTime);
+
+	private:
+
+		int find(int aIndex);
+		void solve_island(dynamics& aDynamics, std::size_t aIsland, float aDeltaTime);
+
+	};
+
+}
+
+#endif // !GEODESY_CORE_PHYS_SOLVER_H
@@ -0,0 +1,172 @@
+#pragma once
+#ifndef GEODESY_CORE_PHYS_SPATIAL_HASH_H
+#define GEODESY_CORE_PHYS_SPATIAL_HASH_H
+
+#include <cmath>
+#include <vector>
+
+// Include include config.
+#include "../../config.h"
+// Include include math.
+#include "../math.h"
+// Include bounding boxes.
+#include "collision.h"
+
+namespace geodesy::core::phys {
+
+	// Forward declaration of the node class.
+	class node;
+
+	/*
+	Uniform grid over points for proximity queries, with the cells hashed into a table of
+	buckets so the grid is unbounded and its memory follows the point count. A build is a
+	counting sort of the points by bucket, each thread counts and scatters its own slice of the
+	input so the sorted order is the same for any thread count. The sorted positions are kept
+	in structure of arrays, the points of a bucket are contiguous and a query streams through
+	them. Different cells may share a bucket, that only adds candidates since queries test the
+	position of every point they visit.
+
+	A radius query no larger than the cell size visits 27 cells. Results are point indices into
+	the input of the last build.
+	// Example usage:
+	phys::spatial_hash Grid(0.5f);
+	Grid.build(Particle);
+	Grid.query(Center, 0.5f, [&](uint32_t aIndex, float aDistance2) { ... return true; });
+	Grid.neighbours(0.5f, Offset, Neighbour);
+	*/
+	class spatial_hash {
+	public:
+
+		float									CellSize;		// [m]
+		float									InverseCellSize;
+		uint32_t								Mask;			// Bucket count minus one, a power of two.
+		std::vector<float>						Position[3];	// [m] Points sorted by bucket.
+		std::vector<uint32_t>					Index;			// Input index of each sorted point.
+		std::vector<uint32_t>					Start;			// Bucket b owns sorted points [Start[b], Start[b + 1]).
+		std::vector<uint32_t>					Bucket;			// Bucket of each input point, scratch of build().
+		std::vector<uint32_t>					Histogram;		// Per thread bucket counts, scratch of build().
+		std::vector<float>						Input[3];		// Gathered node positions, scratch of build().
+
+		spatial_hash(float aCellSize = 1.0f);
+
+		// Sorts aCount points given as three coordinate streams into the grid.
+		void build(const float* aX, const float* aY, const float* aZ, std::size_t aCount);
+		void build(const std::vector<math::vec<float, 3>>& aPoint);
+		// Points at the global origin of each node, indices follow the list.
+		void build(const std::vector<node*>& aNodeList);
+		std::size_t size() const;
+
+		int cell(float aCoordinate) const {
+			return (int)std::floor(aCoordinate * this->InverseCellSize);
+		}
+
+		// Cells are hashed in blocks of 8^3, in Morton order within a block, so neighbouring cells
+		// land in nearby buckets and queries over coherent points stay in cache.
+		uint32_t hash(int aX, int aY, int aZ) const {
+			const uint32_t Block = ((uint32_t)(aX >> 3) * 73856093u) ^ ((uint32_t)(aY >> 3) * 19349663u) ^ ((uint32_t)(aZ >> 3) * 83492791u);
+			const uint32_t x = aX & 7, y = aY & 7, z = aZ & 7;
+			const uint32_t Local = (x & 1) | ((x & 2) << 2) | ((x & 4) << 4) | ((y & 1) << 1) | ((y & 2) << 3) | ((y & 4) << 5) | ((z & 1) << 2) | ((z & 2) << 4) | ((z & 4) << 6);
+			return ((Block << 9) | Local) & this->Mask;
+		}
+
+		// Calls aCallback(uint32_t aSorted) once for each sorted point in the cells [aLow, aHigh],
+		// and possibly for points of other cells sharing their buckets, so the callback tests the
+		// points itself. Stops early and returns false once the callback does.
+		template <typename F>
+		bool visit(const int* aLow, const int* aHigh, F&& aCallback) const {
+			if (this->size() == 0) return true;
+			const double Cells = (double)(aHigh[0] - aLow[0] + 1) * (double)(aHigh[1] - aLow[1] + 1) * (double)(aHigh[2] - aLow[2] + 1);
+			if (Cells <= 64.0) {
+				// Small ranges visit every distinct bucket once, in memory order.
+				uint32_t Visit[64];
+				int n = 0;
+				for (int z = aLow[2]; z <= aHigh[2]; z++) {
+					for (int y = aLow[1]; y <= aHigh[1]; y++) {
+						for (int x = aLow[0]; x <= aHigh[0]; x++) {
+							const uint32_t b = this->hash(x, y, z);
+							int i = n++;
+							for (; (i > 0) && (Visit[i - 1] > b); i--) Visit[i] = Visit[i - 1];
+							Visit[i] = b;
+						}
+					}
+				}
+				for (int i = 0; i < n; i++) {
+					if ((i > 0) && (Visit[i] == Visit[i - 1])) continue;
+					for (uint32_t s = this->Start[Visit[i]]; s < this->Start[Visit[i] + 1]; s++) {
+						if (!aCallback(s)) return false;
+					}
+				}
+				return true;
+			}
+			// A range covering more cells than there are points is cheaper to scan whole.
+			if (Cells > (double)this->size()) {
+				for (uint32_t s = 0; s < this->size(); s++) {
+					if (!aCallback(s)) return false;
+				}
+				return true;
+			}
+			// Otherwise cell by cell, skipping the points of other cells so none is seen twice.
+			for (int z = aLow[2]; z <= aHigh[2]; z++) {
+				for (int y = aLow[1]; y <= aHigh[1]; y++) {
+					for (int x = aLow[0]; x <= aHigh[0]; x++) {
+						const uint32_t b = this->hash(x, y, z);
+						for (uint32_t s = this->Start[b]; s < this->Start[b + 1]; s++) {
+							if ((this->cell(this->Position[0][s]) != x) || (this->cell(this->Position[1][s]) != y) || (this->cell(this->Position[2][s]) != z)) continue;
+							if (!aCallback(s)) return false;
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		// Calls aCallback(uint32_t aIndex, float aDistance2) for every point within aRadius of
+		// aCenter, stops early if the callback returns false.
+		template <typename F>
+		void query(const math::vec<float, 3>& aCenter, float aRadius, F&& aCallback) const {
+			int Low[3], High[3];
+			for (int k = 0; k < 3; k++) {
+				Low[k] = this->cell(aCenter[k] - aRadius);
+				High[k] = this->cell(aCenter[k] + aRadius);
+			}
+			const float Radius2 = aRadius * aRadius;
+			this->visit(Low, High, [&](uint32_t s) {
+				const float dx = this->Position[0][s] - aCenter[0], dy = this->Position[1][s] - aCenter[1], dz = this->Position[2][s] - aCenter[2];
+				const float Distance2 = dx * dx + dy * dy + dz * dz;
+				return Distance2 > Radius2 ? true : (bool)aCallback(this->Index[s], Distance2);
+			});
+		}
+
+		// Calls aCallback(uint32_t aIndex) for every point inside aBounds, stops early if the
+		// callback returns false.
+		template <typename F>
+		void query(const collision::aabb& aBounds, F&& aCallback) const {
+			int Low[3], High[3];
+			for (int k = 0; k < 3; k++) {
+				Low[k] = this->cell(aBounds.Min[k]);
+				High[k] = this->cell(aBounds.Max[k]);
+			}
+			if ((Low[0] > High[0]) || (Low[1] > High[1]) || (Low[2] > High[2])) return;
+			this->visit(Low, High, [&](uint32_t s) {
+				for (int k = 0; k < 3; k++) {
+					if ((this->Position[k][s] < aBounds.Min[k]) || (this->Position[k][s] > aBounds.Max[k])) return true;
+				}
+				return (bool)aCallback(this->Index[s]);
+			});
+		}
+
+		// Indices of the points within aRadius of aCenter, in grid order.
+		std::vector<uint32_t> query(const math::vec<float, 3>& aCenter, float aRadius) const;
+		// Indices of the points inside aBounds, in grid order.
+		std::vector<uint32_t> query(const collision::aabb& aBounds) const;
+
+		// Neighbour lists of every point in compressed rows, Neighbour[Offset[i], Offset[i + 1])
+		// are the points within aRadius of point i, itself excluded. Built in parallel over the
+		// sorted points, so neighbouring queries hit the same buckets.
+		void neighbours(float aRadius, std::vector<uint32_t>& aOffset, std::vector<uint32_t>& aNeighbour) const;
+
+	};
+
+}
+
+#endif // !GEODESY_CORE_PHYS_SPATIAL_HASH_H
@@ -28,7 +28,7 @@ namespace geodesy::core::util {
 			CHAR,
 			SHORT,
 			INT,
-			//HALF,
+			HALF,
 			FLOAT,
 			DOUBLE,
 			// Vector Types
@@ -50,9 +50,9 @@ namespace geodesy::core::util {
 			INT2,
 			INT3,
 			INT4,
-			//HALF2,
-			//HALF3,
-			//HALF4,
+			HALF2,
+			HALF3,
+			HALF4,
 			FLOAT2,
 			FLOAT3,
 			FLOAT4,
@@ -130,6 +130,11 @@ namespace geodesy::runtime {
 		std::vector<core::gfx::mesh::instance*> 									TotalMeshInstance;
 		std::map<subject*, std::shared_ptr<renderer>>								Renderer;
 
+		// * Object Bounds
+		core::phys::collision::aabb													WorldBounds;		// All mesh instances in world space.
+		std::vector<core::phys::collision::aabb>									InstanceBounds;		// Of each mesh instance in TotalMeshInstance.
+		std::vector<core::math::affine<float>>										InstanceTransform;	// GlobalTransform each instance was bounded at.
+
 		object(std::shared_ptr<core::gpu::context> aContext, stage* aStage, creator* aCreator);
 		~object();
 
@@ -149,6 +154,10 @@ namespace geodesy::runtime {
 		) override;
 		virtual std::vector<std::shared_ptr<draw_call>> draw(subject* aSubject);
 
+		// Rebounds the mesh instances whose node's GlobalTransform changed since the last call from
+		// their meshes' cached bounds, and WorldBounds with them. Returns true if anything moved.
+		bool update_bounds();
+
 	protected:
 
 		core::math::vec<float, 3> InputVelocity;
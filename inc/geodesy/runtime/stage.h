@@ -5,6 +5,7 @@
 #define MAX_STAGE_MATERIALS 32
 #define MAX_STAGE_LIGHTS 192
 
+#include <functional>
 #include <memory>
 
 #include "../config.h"
@@ -72,6 +73,7 @@ namespace geodesy::runtime {
 		struct creator {
 			std::string 							Name;
 			uint32_t								RTTIID;
+			core::phys::collision::broad_phase::method	BroadPhase;
 			std::vector<object::creator*> 			ObjectCreationList;
 			creator();
 		};
@@ -98,6 +100,16 @@ namespace geodesy::runtime {
 		double														Time;
 		std::vector<core::phys::node*>								NodeCache; // This is a list of all nodes in the stage, used for updating.
 		std::map<std::string, std::shared_ptr<object>> 				ObjectLookup;
+		std::shared_ptr<core::phys::collision::broad_phase>			BroadPhase;
+		std::vector<std::pair<core::phys::node*, core::phys::node*>>	CollisionPair; // Overlapping pairs found by the broad phase this step.
+		core::phys::collision::narrow_phase							NarrowPhase;
+		std::vector<core::phys::collision::manifold>				Contact; // Contact manifolds of the pairs found touching this step.
+		core::phys::dynamics										Dynamics; // Rigid body state of the DYNAMIC objects.
+		core::phys::solver											Solver; // Contact and joint constraints between them.
+		core::phys::collision::continuous							Continuous; // Sweeps fast bodies against their surroundings after the solver.
+		core::phys::spatial_hash									SpatialHash; // Global origins of NodeCache in a uniform grid, for proximity queries.
+		core::phys::collision::instance_bvh							SceneBVH; // Mesh instances in world space for CPU ray queries, the host side counterpart of the TLAS.
+		core::phys::snapshot										History; // Physics state of the last frames for rollback, off until reserve() gives it a capacity.
 
 		// ! ----- Stage Device Memory ----- ! //
 		std::shared_ptr<core::gpu::context> 						Context;
@@ -116,6 +128,13 @@ namespace geodesy::runtime {
 		void build_scene_geometry();
 
 		virtual void update(double aDeltaTime);
+		// Rolls the physics state back aFrameCount frames and steps forward again over the same frame
+		// times. aInput(i) is called before replayed step i, oldest first, to apply corrected inputs.
+		void resimulate(size_t aFrameCount, const std::function<void(size_t)>& aInput = nullptr);
+		// Physics and animation of one frame, up to the global transforms.
+		void step(double aDeltaTime);
+		// Brings the proximity queries and device memory up to date with the nodes.
+		void publish();
 		virtual core::gpu::submission_batch render();
 		std::vector<std::shared_ptr<object::draw_call>> post_processing(subject* aSubject);
 
@@ -99,8 +99,8 @@ namespace geodesy::bltn::obj {
 		auto Mesh = aObject->Model->Mesh[MeshInstance->MeshIndex];
 		auto Material = aObject->Model->Material[MeshInstance->MaterialIndex];
 		auto Node = MeshInstance->Parent;
-		// Get mesh instance world position center.
-		math::vec<float, 3> MeshPosition = Node->GlobalTransform.minor(3,3) * math::vec<float, 3>(0.0f, 0.0f, 0.0f);
+		// Get mesh instance world position center, the same point update() measures distance from.
+		math::vec<float, 3> MeshPosition = Node->GlobalTransform.transform_point(!Mesh->Bounds.empty() ? Mesh->Bounds.Center : Mesh->CenterOfMass);
 		// Get transparency mode for draw call data structure.
 		this->TransparencyMode = (material::transparency)Material->UniformData.Transparency;
 		// Set rendering priority.
@@ -169,15 +169,20 @@ namespace geodesy::bltn::obj {
 		auto Mesh = aObject->Model->Mesh[MeshInstance->MeshIndex];
 		auto Material = aObject->Model->Material[MeshInstance->MaterialIndex];
 		auto Node = MeshInstance->Parent;
-		math::mat<float, 3, 3> MeshTransform = Node->GlobalTransform.minor(3,3);
-		// Transform Mesh Center of Mass to world space.
-		math::vec<float, 3> MeshPosition = MeshTransform*Mesh->CenterOfMass;
-		// Transform Vertex Extrema to world space.
-		math::vec<float, 3> MeshBoundingRadius = MeshTransform*(Mesh->BoundingRadius + Mesh->CenterOfMass);
+		const math::affine<float>& MeshTransform = Node->GlobalTransform;
+		// Transform the cached bounding sphere center to world space, meshes without cached bounds
+		// fall back to the sphere about their center of mass.
+		bool Cached = !Mesh->Bounds.empty();
+		math::vec<float, 3> MeshPosition = MeshTransform.transform_point(Cached ? Mesh->Bounds.Center : Mesh->CenterOfMass);
 		// Calculate the distance from the camera to the mesh instance.
 		float Distance = math::length(MeshPosition - aCamera3D->Position);
-		// Calculate the world space radius of the mesh instance.
-		float Radius = math::length(MeshBoundingRadius - MeshPosition);
+		// Calculate the world space radius of the mesh instance, scaled by the largest axis of the transform.
+		float Scale = 0.0f;
+		for (size_t i = 0; i < 3; i++) {
+			math::vec<float, 3> Axis = { MeshTransform.Linear(0, i), MeshTransform.Linear(1, i), MeshTransform.Linear(2, i) };
+			Scale = std::max(Scale, math::length(Axis));
+		}
+		float Radius = (Cached ? Mesh->Bounds.Radius : math::length(Mesh->BoundingRadius)) * Scale;
 		// TODO: Check if bounding radius is inside the camera frustum.
 		// Calculate Rendering Priority.
 		switch(this->TransparencyMode) {
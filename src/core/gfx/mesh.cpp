@@ -126,11 +126,11 @@ namespace geodesy::core::gfx {
 
 		// Use Host node hierarchy to generate the bone transforms. Device Hierarchy not complete yet.
 		uniform_data MeshInstanceUBOData = uniform_data(this);
-		MeshInstanceUBOData.Transform = aInstance.Parent->transform();
+		MeshInstanceUBOData.Transform = math::mat<float, 4, 4>(aInstance.Parent->transform());
 		for (size_t i = 0; i < this->Bone.size(); i++) {
 			phys::node* Bone = aInstance.Root->find(this->Bone[i].Name);
 			if (Bone != nullptr) {
-				MeshInstanceUBOData.BoneTransform[i] = Bone->transform();
+				MeshInstanceUBOData.BoneTransform[i] = math::mat<float, 4, 4>(Bone->transform());
 			}
 		}
 		this->UniformBuffer = Context->create_buffer(UBCI, sizeof(uniform_data), &MeshInstanceUBOData);
@@ -248,6 +248,7 @@ namespace geodesy::core::gfx {
 		// Calculate properties of the mesh.
 		this->CenterOfMass = this->center_of_mass();
 		this->BoundingRadius = this->bounding_radius();
+		this->Bounds = this->bounding_volume();
 	}
 	
 	mesh::mesh(std::shared_ptr<gpu::context> aContext, std::shared_ptr<mesh> aMesh) {
@@ -256,6 +257,8 @@ namespace geodesy::core::gfx {
 		this->Mass = aMesh->Mass;
 		this->CenterOfMass = aMesh->CenterOfMass;
 		this->BoundingRadius = aMesh->BoundingRadius;
+		this->Bounds = aMesh->Bounds;
+		this->BVH = aMesh->BVH;
 		this->Context = aContext;
 		if ((aContext != nullptr) && (aMesh != nullptr)) {
 			// Vertex Buffer Creation Info
@@ -289,4 +292,29 @@ namespace geodesy::core::gfx {
 		}
 	}
 
+	std::vector<mesh::packed_vertex> mesh::pack(const std::vector<vertex>& aVertex) {
+		std::vector<packed_vertex> Packed(aVertex.size());
+		#pragma omp parallel for if(aVertex.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aVertex.size(); i++) {
+			const vertex& V = aVertex[i];
+			// Gather the half precision attributes so they convert in one vectorized pass.
+			float Full[20] = {
+				V.Normal[0], 				V.Normal[1], 				V.Normal[2], 				0.0f,
+				V.Tangent[0], 				V.Tangent[1], 				V.Tangent[2], 				0.0f,
+				V.Bitangent[0], 			V.Bitangent[1], 			V.Bitangent[2], 			0.0f,
+				V.TextureCoordinate[0], 	V.TextureCoordinate[1], 	V.TextureCoordinate[2], 	0.0f,
+				V.Color[0], 				V.Color[1], 				V.Color[2], 				V.Color[3]
+			};
+			math::half Half[20];
+			math::convert_chunk(Half, Full, 20);
+			Packed[i].Position = V.Position;
+			std::copy(Half + 0, Half + 4, Packed[i].Normal.begin());
+			std::copy(Half + 4, Half + 8, Packed[i].Tangent.begin());
+			std::copy(Half + 8, Half + 12, Packed[i].Bitangent.begin());
+			std::copy(Half + 12, Half + 16, Packed[i].TextureCoordinate.begin());
+			std::copy(Half + 16, Half + 20, Packed[i].Color.begin());
+		}
+		return Packed;
+	}
+
 }
@@ -83,7 +83,43 @@ namespace geodesy::core::gfx {
 		this->Time = 0.0;
 	}
 
-	model::model(std::string aFilePath, file::manager* aFileManager) : file(aFilePath) {
+	// Gives every node carrying mesh instances the collision pieces of its meshes. Several
+	// instances share one hull around all of them, decomposed pieces become child nodes so
+	// each keeps a single CollisionMesh.
+	static void assign_collision_mesh(gfx::node* aNode, const std::vector<std::vector<std::shared_ptr<phys::mesh>>>& aCollisionMesh, const phys::collision::hull_create_info& aHullCreateInfo) {
+		std::vector<std::shared_ptr<phys::mesh>> Piece;
+		for (const mesh::instance& MI : aNode->MeshInstance) {
+			if ((MI.MeshIndex < 0) || (MI.MeshIndex >= (int)aCollisionMesh.size())) continue;
+			Piece.insert(Piece.end(), aCollisionMesh[MI.MeshIndex].begin(), aCollisionMesh[MI.MeshIndex].end());
+		}
+		if (Piece.size() == 0) return;
+		if (Piece.size() == 1) {
+			aNode->CollisionMesh = Piece[0];
+		}
+		else if (!aHullCreateInfo.Decompose) {
+			std::vector<math::vec<float, 3>> Point;
+			float Mass = 0.0f;
+			for (const auto& P : Piece) {
+				for (const auto& V : P->Vertex) Point.push_back(V.Position);
+				Mass += P->Mass;
+			}
+			aNode->CollisionMesh = phys::collision::convex_hull(Point, aHullCreateInfo.MaxVertex);
+			aNode->CollisionMesh->Name = aNode->Identifier + "_hull";
+			aNode->CollisionMesh->Mass = Mass;
+		}
+		else {
+			for (const auto& P : Piece) {
+				gfx::node* Child = new gfx::node();
+				Child->Identifier = P->Name;
+				Child->Root = aNode->Root;
+				Child->Parent = aNode;
+				Child->CollisionMesh = P;
+				aNode->Child.push_back(Child);
+			}
+		}
+	}
+
+	model::model(std::string aFilePath, file::manager* aFileManager, const phys::collision::hull_create_info& aHullCreateInfo) : file(aFilePath) {
 		this->Time = 0.0;
 		if (aFilePath.length() == 0) return;
 		const aiScene *Scene = ModelImporter->ReadFile(aFilePath, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices | aiProcess_CalcTangentSpace);
@@ -107,16 +143,40 @@ namespace geodesy::core::gfx {
 		// Check if root node has meshes, and choose node constructor.
 		this->Hierarchy = std::shared_ptr<gfx::node>(new gfx::node(Scene, Scene->mRootNode));
 
-		// Load animation tracks.
+		// Cleaner way to load meshes.
+		this->Mesh = std::vector<std::shared_ptr<mesh>>(Scene->mNumMeshes);
+		for (size_t i = 0; i < this->Mesh.size(); i++) {
+			this->Mesh[i] = std::shared_ptr<mesh>(new mesh(Scene->mMeshes[i]));
+		}
+
+		// Simplified convex hulls for collision, one mesh per thread.
+		this->CollisionMesh = std::vector<std::vector<std::shared_ptr<phys::mesh>>>(this->Mesh.size());
+		std::vector<phys::collision::hull_report> Report(this->Mesh.size());
+		#pragma omp parallel for schedule(dynamic)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)this->Mesh.size(); i++) {
+			this->CollisionMesh[i] = phys::collision::collision_mesh(*this->Mesh[i], aHullCreateInfo, &Report[i]);
+		}
+		for (const phys::collision::hull_report& R : Report) {
+			this->CollisionReport += R;
+		}
+		std::vector<phys::node*> LinearHierarchy = this->Hierarchy->linearize();
+		for (phys::node* N : LinearHierarchy) {
+			assign_collision_mesh((gfx::node*)N, this->CollisionMesh, aHullCreateInfo);
+		}
+
+		// Load animation tracks, compiled to the order of the linearized hierarchy which every
+		// object built from this model shares. Decomposed hull pieces join the hierarchy above,
+		// so it is linearized again to match the final node order.
+		LinearHierarchy = this->Hierarchy->linearize();
 		this->Animation = std::vector<phys::animation>(Scene->mNumAnimations);
 		for (size_t i = 0; i < this->Animation.size(); i++) {
 			this->Animation[i] = phys::animation(Scene->mAnimations[i]);
+			this->Animation[i].compile(LinearHierarchy);
 		}
 
-		// Cleaner way to load meshes.
-		this->Mesh = std::vector<std::shared_ptr<mesh>>(Scene->mNumMeshes);
-		for (size_t i = 0; i < this->Mesh.size(); i++) {
-			this->Mesh[i] = std::shared_ptr<mesh>(new mesh(Scene->mMeshes[i]));
+		// Triangle hierarchies for CPU ray queries, each build is parallel on its own.
+		for (std::size_t i = 0; i < this->Mesh.size(); i++) {
+			this->Mesh[i]->BVH = std::make_shared<phys::collision::triangle_bvh>(*this->Mesh[i]);
 		}
 
 		// Load in materials for the model.
@@ -205,6 +265,10 @@ namespace geodesy::core::gfx {
 		// Load node animations.
 		this->Animation = aModel->Animation;
 
+		// Collision meshes stay in host memory and are shared with the host model.
+		this->CollisionMesh = aModel->CollisionMesh;
+		this->CollisionReport = aModel->CollisionReport;
+
 		// Load meshes into GPU memory.
 		this->Mesh = std::vector<std::shared_ptr<gfx::mesh>>(aModel->Mesh.size());
 		for (std::size_t i = 0; i < aModel->Mesh.size(); i++) {
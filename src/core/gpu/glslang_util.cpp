@@ -132,9 +132,9 @@ namespace geodesy::core::gpu {
 			case glslang::TBasicType::EbtDouble:
 				ID = type::id::DOUBLE;
 				break;
-				//case glslang::TBasicType::EbtFloat16:
-				//	ID = type::id::HALF;
-				//	break;
+			case glslang::TBasicType::EbtFloat16:
+				ID = type::id::HALF;
+				break;
 			case glslang::TBasicType::EbtInt8:
 				ID = type::id::CHAR;
 				break;
@@ -123,6 +123,7 @@ namespace geodesy::core::gpu {
 		case util::type::id::CHAR:			return image::format::R8_SINT;
 		case util::type::id::SHORT:			return image::format::R16_SINT;
 		case util::type::id::INT:			return image::format::R32_SINT;
+		case util::type::id::HALF:			return image::format::R16_SFLOAT;
 		case util::type::id::FLOAT:			return image::format::R32_SFLOAT;
 		case util::type::id::DOUBLE:		return image::format::R64_SFLOAT;
 			// Vector Types.
@@ -144,6 +145,9 @@ namespace geodesy::core::gpu {
 		case util::type::id::INT2:			return image::format::R32G32_SINT;
 		case util::type::id::INT3:			return image::format::R32G32B32_SINT;
 		case util::type::id::INT4:			return image::format::R32G32B32A32_SINT;
+		case util::type::id::HALF2:			return image::format::R16G16_SFLOAT;
+		case util::type::id::HALF3:			return image::format::R16G16B16_SFLOAT;
+		case util::type::id::HALF4:			return image::format::R16G16B16A16_SFLOAT;
 		case util::type::id::FLOAT2:		return image::format::R32G32_SFLOAT;
 		case util::type::id::FLOAT3:		return image::format::R32G32B32_SFLOAT;
 		case util::type::id::FLOAT4:		return image::format::R32G32B32A32_SFLOAT;
@@ -257,13 +261,13 @@ namespace geodesy::core::gpu {
 		case VK_FORMAT_R16_UINT: return 16;
 		case VK_FORMAT_R16_SINT: return 16;
 		case VK_FORMAT_R16_SFLOAT: return 16;
-		case VK_FORMAT_R16G16_UNORM: return 16;
-		case VK_FORMAT_R16G16_SNORM: return 16;
-		case VK_FORMAT_R16G16_USCALED: return 16;
-		case VK_FORMAT_R16G16_SSCALED: return 16;
-		case VK_FORMAT_R16G16_UINT: return 16;
-		case VK_FORMAT_R16G16_SINT: return 16;
-		case VK_FORMAT_R16G16_SFLOAT: return 16;
+		case VK_FORMAT_R16G16_UNORM: return 32;
+		case VK_FORMAT_R16G16_SNORM: return 32;
+		case VK_FORMAT_R16G16_USCALED: return 32;
+		case VK_FORMAT_R16G16_SSCALED: return 32;
+		case VK_FORMAT_R16G16_UINT: return 32;
+		case VK_FORMAT_R16G16_SINT: return 32;
+		case VK_FORMAT_R16G16_SFLOAT: return 32;
 		case VK_FORMAT_R16G16B16_UNORM: return 48;
 		case VK_FORMAT_R16G16B16_SNORM: return 48;
 		case VK_FORMAT_R16G16B16_USCALED: return 48;
@@ -1454,6 +1458,54 @@ namespace geodesy::core::gpu {
 		return TransparencyType;
 	}
 
+	// Bits per channel of the plain float formats, 0 for anything else.
+	static size_t float_channel_width(int aFormat) {
+		switch (aFormat) {
+		default: return 0;
+		case VK_FORMAT_R16_SFLOAT:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R16G16B16_SFLOAT:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			return 16;
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_R32G32_SFLOAT:
+		case VK_FORMAT_R32G32B32_SFLOAT:
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return 32;
+		}
+	}
+
+	void image::convert(format aFormat) {
+		size_t SourceWidth = float_channel_width(this->CreateInfo.format);
+		size_t TargetWidth = float_channel_width(aFormat);
+		if ((SourceWidth == 0) || (TargetWidth == 0) || (channel_count(this->CreateInfo.format) != channel_count(aFormat))) {
+			throw std::runtime_error("image::convert(): Only float <-> half formats with matching channel counts are supported.");
+		}
+		if (SourceWidth == TargetWidth) return;
+		if (this->HostData == NULL) {
+			throw std::runtime_error("image::convert(): No host data to convert.");
+		}
+
+		size_t ElementCount = (this->HostSize * 8) / SourceWidth;
+		size_t NewHostSize = (ElementCount * TargetWidth) / 8;
+		void* NewHostData = malloc(NewHostSize);
+		if (NewHostData == NULL) {
+			throw std::runtime_error("image::convert(): Failed to allocate host memory.");
+		}
+		if (TargetWidth == 16) {
+			math::convert((math::half*)NewHostData, (const float*)this->HostData, ElementCount);
+		}
+		else {
+			math::convert((float*)NewHostData, (const math::half*)this->HostData, ElementCount);
+		}
+
+		// HostData is always released through stbi_image_free, which is free().
+		stbi_image_free(this->HostData);
+		this->HostData 				= NewHostData;
+		this->HostSize 				= NewHostSize;
+		this->CreateInfo.format 	= (VkFormat)aFormat;
+	}
+
 	void image::clear() {
 		if (Context != nullptr) {
 			if (View != VK_NULL_HANDLE) {
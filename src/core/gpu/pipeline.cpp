@@ -409,6 +409,16 @@ namespace geodesy::core::gpu {
 		}
 	}
 
+	void pipeline::rasterizer::bind(uint32_t aBindingIndex, size_t aVertexStride, uint32_t aLocationIndex, size_t aVertexOffset, image::format aFormat, input_rate aInputRate) {
+		this->bind(aBindingIndex, aVertexStride, aLocationIndex, aVertexOffset, aInputRate);
+		for (attribute& Attribute : this->VertexAttribute) {
+			if (aLocationIndex == Attribute.Description.location) {
+				Attribute.Description.format			= (VkFormat)aFormat;
+				break;
+			}
+		}
+	}
+
 	void pipeline::rasterizer::attach(uint32_t aAttachmentIndex, std::shared_ptr<image> aAttachmentImage, image::layout aImageLayout) {
 		// TODO: Maybe check that image sample count matches rasterizer sample count?
 		this->attach(aAttachmentIndex, (image::format)aAttachmentImage->CreateInfo.format, aImageLayout);
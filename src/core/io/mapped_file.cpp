@@ -0,0 +1,118 @@
+#include <geodesy/core/io/mapped_file.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(_WIN32) || defined(_WIN64)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace geodesy::core::io {
+
+	size_t mapped_file::page_size() {
+#if defined(_WIN32) || defined(_WIN64)
+		SYSTEM_INFO Info;
+		GetSystemInfo(&Info);
+		return Info.dwPageSize;
+#else
+		return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+	}
+
+	mapped_file::mapped_file() {
+		this->Path 				= "";
+		this->Size 				= 0;
+		this->Data 				= NULL;
+		this->Handle 			= NULL;
+		this->MappingHandle 	= NULL;
+	}
+
+	mapped_file::mapped_file(std::string aPath, size_t aSize) : mapped_file() {
+		if (aSize == 0) {
+			throw std::invalid_argument("mapped_file: Size must be non zero.");
+		}
+		this->Path = aPath;
+		this->Size = aSize;
+#if defined(_WIN32) || defined(_WIN64)
+		HANDLE File = CreateFileA(aPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (File == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("mapped_file: Failed to create " + aPath);
+		}
+		HANDLE Mapping = CreateFileMappingA(File, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)aSize >> 32), (DWORD)(aSize & 0xFFFFFFFFull), NULL);
+		if (Mapping == NULL) {
+			CloseHandle(File);
+			throw std::runtime_error("mapped_file: Failed to map " + aPath);
+		}
+		this->Data = MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, aSize);
+		if (this->Data == NULL) {
+			CloseHandle(Mapping);
+			CloseHandle(File);
+			throw std::runtime_error("mapped_file: Failed to map " + aPath);
+		}
+		this->Handle 			= (void*)File;
+		this->MappingHandle 	= (void*)Mapping;
+#else
+		int File = open(aPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+		if (File < 0) {
+			throw std::runtime_error("mapped_file: Failed to create " + aPath);
+		}
+		// Extends the file without writing, untouched pages stay sparse on disk.
+		if (ftruncate(File, (off_t)aSize) != 0) {
+			close(File);
+			std::remove(aPath.c_str());
+			throw std::runtime_error("mapped_file: Failed to size " + aPath);
+		}
+		void* Map = mmap(NULL, aSize, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+		if (Map == MAP_FAILED) {
+			close(File);
+			std::remove(aPath.c_str());
+			throw std::runtime_error("mapped_file: Failed to map " + aPath);
+		}
+		this->Data 		= Map;
+		this->Handle 	= (void*)(intptr_t)(File + 1);		// Offset so descriptor 0 is not NULL.
+#endif
+	}
+
+	mapped_file::~mapped_file() {
+		if (this->Data == NULL) return;
+#if defined(_WIN32) || defined(_WIN64)
+		UnmapViewOfFile(this->Data);
+		CloseHandle((HANDLE)this->MappingHandle);
+		CloseHandle((HANDLE)this->Handle);
+#else
+		munmap(this->Data, this->Size);
+		close((int)((intptr_t)this->Handle - 1));
+#endif
+		std::remove(this->Path.c_str());
+	}
+
+	void mapped_file::flush(size_t aOffset, size_t aSize) {
+		if ((this->Data == NULL) || (aSize == 0)) return;
+#if defined(_WIN32) || defined(_WIN64)
+		FlushViewOfFile((char*)this->Data + aOffset, aSize);
+#else
+		msync((char*)this->Data + aOffset, aSize, MS_ASYNC);
+#endif
+	}
+
+	void mapped_file::release(size_t aOffset, size_t aSize) {
+		if ((this->Data == NULL) || (aSize == 0)) return;
+		this->flush(aOffset, aSize);
+#if defined(_WIN32) || defined(_WIN64)
+		// Unlocking pages that are not locked trims them from the working set.
+		VirtualUnlock((char*)this->Data + aOffset, aSize);
+#else
+		// Shared file pages keep their contents, later access faults them back in from the file.
+		madvise((char*)this->Data + aOffset, aSize, MADV_DONTNEED);
+#endif
+	}
+
+}
@@ -1,8 +1,12 @@
 #include <geodesy/core/phys/animation.h>
 
+#include <geodesy/core/phys/node.h>
+
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
 
 #include <geodesy/core/math.h>
 
@@ -17,134 +21,110 @@ namespace geodesy::core::phys {
 
 	using namespace math;
 
-	// This template function finds keys in a keyframe animation.
+	// Finds the key at or before aTime in a channel of at least two keys, where the first key is
+	// before aTime and the last is after it. The search starts from aCursor and steps forward a few
+	// keys, as it does when playback time advances by one frame, otherwise it binary searches.
 	template <typename T> inline
-	std::pair<animation::key<T>, animation::key<T>> find_value_pair(const std::vector<animation::key<T>>& aKey, double aTime) {
-		animation::key<T> Key1, Key2;
-		switch (aKey.size()) {
-		default:
-			break;
-		case 0:
-			return std::pair<animation::key<T>, animation::key<T>>(Key1, Key2);
-		case 1:
-			return std::pair<animation::key<T>, animation::key<T>>(aKey[0], aKey[0]);
-		case 2:
-			return std::pair<animation::key<T>, animation::key<T>>(aKey[0], aKey[1]);
-		}
-		// Check if aTime is in bounds.
-		if ((aTime < aKey[0].Time) || (aTime > aKey[aKey.size() - 1].Time)) {
-			if (aTime < aKey[0].Time) {
-				// If time is less than first key, return first key twice.
-				Key1 = aKey[0];
-				Key2 = aKey[0];
-			} else {
-				// If time is greater than last key, return last key twice.
-				Key1 = aKey[aKey.size() - 1];
-				Key2 = aKey[aKey.size() - 1];
-			}
-			return std::pair<animation::key<T>, animation::key<T>>(Key1, Key2);
-		}
-		// Get middle index from key vector.
-		size_t LeftIndex = 0;
-		size_t RightIndex = (aKey.size() - 1);
-		// Binary search.
-		while (true) {
-			size_t MiddleIndex = (LeftIndex + RightIndex) >> 1;
-			double KeyTime = aKey[MiddleIndex].Time;
-			// Check if two keys are found.
-			if ((aTime >= aKey[MiddleIndex].Time) && (aTime <= aKey[MiddleIndex + 1].Time)) {
-				// Two Keys found, exit loop.
-				Key1 = aKey[MiddleIndex];
-				Key2 = aKey[MiddleIndex + 1];
-				break;
-			}
-			else if ((aTime < aKey[MiddleIndex].Time) && (aTime < aKey[MiddleIndex + 1].Time)) {
-				// If the time is less than the key time.
-				RightIndex = MiddleIndex;
-			}
-			else if ((aTime > aKey[MiddleIndex].Time) && (aTime > aKey[MiddleIndex + 1].Time)) {
-				LeftIndex = MiddleIndex;
-			}
-			else {
-				break;
+	size_t find_key(const animation::channel<T>& aKey, double aTime, uint32_t& aCursor) {
+		const size_t Last = aKey.Time.size() - 1;
+		size_t Index = aCursor;
+		if ((Index < Last) && (aKey.Time[Index] <= aTime)) {
+			for (int Step = 0; (Step < 4) && (Index < Last); Step++, Index++) {
+				if (aTime < aKey.Time[Index + 1]) {
+					aCursor = (uint32_t)Index;
+					return Index;
+				}
 			}
 		}
-		return std::pair<animation::key<T>, animation::key<T>>(Key1, Key2);
+		Index = std::upper_bound(aKey.Time.begin(), aKey.Time.end(), aTime) - aKey.Time.begin() - 1;
+		Index = std::min(Index, Last - 1);
+		aCursor = (uint32_t)Index;
+		return Index;
 	}
 
-	template<typename T> inline
-	float interpolation_factor(std::pair<animation::key<T>, animation::key<T>> aKeyPair, double aTime) {
-		if (aKeyPair.first.Time == aKeyPair.second.Time) {
-			return 0.0f;
-		} else {
-			return (aTime - aKeyPair.first.Time) / (aKeyPair.second.Time - aKeyPair.first.Time);
+	// Resolves the key pair and interpolation factor of a single channel at aTime. Out of bounds
+	// times repeat the first or last key.
+	template <typename T> inline
+	void gather_channel(const animation::channel<T>& aKey, double aTime, const T& aDefault, uint32_t& aCursor, T& aFrom, T& aTo, float& aFactor) {
+		const size_t Count = aKey.size();
+		aFactor = 0.0f;
+		if (Count == 0) {
+			aFrom = aDefault;
+			aTo = aDefault;
+			return;
 		}
+		if ((Count == 1) || (aTime <= aKey.Time.front())) {
+			aFrom = aKey.Value.front();
+			aTo = aFrom;
+			return;
+		}
+		if (aTime >= aKey.Time.back()) {
+			aFrom = aKey.Value.back();
+			aTo = aFrom;
+			return;
+		}
+		size_t Index = find_key(aKey, aTime, aCursor);
+		aFrom = aKey.Value[Index];
+		aTo = aKey.Value[Index + 1];
+		aFactor = (float)((aTime - aKey.Time[Index]) / (aKey.Time[Index + 1] - aKey.Time[Index]));
 	}
 
-	mat<float, 4, 4> animation::node::operator[](double aTime) const {
-		vec<float, 3> Tf;
-		quaternion<float> Qf;
-		vec<float, 3> Sf;
+	affine<float> animation::node::operator[](double aTime) const {
+		cursor Cursor;
+		return this->sample(aTime, Cursor);
+	}
+
+	affine<float> animation::node::sample(double aTime, cursor& aCursor) const {
+		vec<float, 3> Tf, T0, T1;
+		quaternion<float> Qf, Q0, Q1;
+		vec<float, 3> Sf, S0, S1;
+		float p;
 
 		// Calculates interpolated translation matrix
-		if (this->PositionKey.size() > 0) {
-			std::pair<key<vec<float, 3>>, key<vec<float, 3>>> TP = find_value_pair(this->PositionKey, aTime);
-			if ((aTime >= this->PositionKey.front().Time) && (aTime <= this->PositionKey.back().Time)) {
-				// Time exists in key frame set.
-				float p = interpolation_factor(TP, aTime);
-				Tf = (1.0f - p) * TP.first.Value + p * TP.second.Value;
-			}
-			else {
-				// Out of bounds, use first or last key.
-				Tf = TP.first.Value;
-			}
-		}
+		gather_channel(this->PositionKey, aTime, Tf, aCursor.Position, T0, T1, p);
+		Tf = (1.0f - p) * T0 + p * T1;
 
-		// Calculates interpolated quaternion.
-		if (this->RotationKey.size() > 0){
-			std::pair<key<quaternion<float>>, key<quaternion<float>>> RP = find_value_pair(this->RotationKey, aTime);
-			if ((aTime >= this->RotationKey.front().Time) || (aTime <= this->RotationKey.back().Time)) {
-				float p = interpolation_factor(RP, aTime);
-				quaternion<float> Q1 = RP.first.Value;
-				quaternion<float> Q2 = RP.second.Value;
-				float CosTheta = Q1[0]*Q2[0] + Q1[1]*Q2[1] + Q1[2]*Q2[2] + Q1[3]*Q2[3];
-				if (CosTheta < 0.0f) {
-					Q2 = -Q2;  // Negate Q2 for shorter path
-					CosTheta = -CosTheta;
-				}
-				if (std::abs(CosTheta) > 0.999f) {
-					// Cartesian LERP.
-					Qf = (1.0f - p) * Q1 + p * Q2;
-				}
-				else {
-					// Spherical LERP.
-					float Theta = std::acos(CosTheta);
-					Qf = ((std::sin((1.0f - p) * Theta) * Q1 + std::sin(p * Theta) * Q2) / std::sin(Theta));
-				}
-			}
-			else {
-				// Out of bounds, use first or last key.
-				Qf = RP.first.Value;
-			}
-		}
+		// Calculates interpolated quaternion, slerp corrected nlerp avoids acos/sin per key.
+		gather_channel(this->RotationKey, aTime, Qf, aCursor.Rotation, Q0, Q1, p);
+		Qf = this->RotationKey.size() > 0 ? nlerp(Q0, Q1, p, true) : Q0;
 
 		// Calculates interpolated scaling matrix
-		if (this->ScalingKey.size() > 0) {
-			std::pair<key<vec<float, 3>>, key<vec<float, 3>>> SP = find_value_pair(this->ScalingKey, aTime);
-			if ((aTime < this->ScalingKey.front().Time) || (aTime > this->ScalingKey.back().Time)) {
-				float p = interpolation_factor(SP, aTime);
-				Sf = (1.0f - p) * SP.first.Value + p * SP.second.Value;
-			}
-			else {
-				// Out of bounds, use first or last key.
-				Sf = SP.first.Value;				
-			}
-		}
+		gather_channel(this->ScalingKey, aTime, Sf, aCursor.Scaling, S0, S1, p);
+		Sf = (1.0f - p) * S0 + p * S1;
 
 		// Order matters, scaling is applied first, then the object is rotated, then translated.
 		return calculate_transform(Tf, Qf, Sf);
 	}
 
+	void animation::sample(const std::vector<const node*>& aNode, double aTime, std::vector<affine<float>>& aTransform) {
+		size_t Count = aNode.size();
+		std::vector<vec<float, 3>> PositionFrom(Count), PositionTo(Count), Position(Count);
+		std::vector<quaternion<float>> RotationFrom(Count), RotationTo(Count), Rotation(Count);
+		std::vector<vec<float, 3>> ScalingFrom(Count), ScalingTo(Count), Scaling(Count);
+		std::vector<float> PositionFactor(Count), RotationFactor(Count), ScalingFactor(Count);
+
+		// Key search per channel, the interpolation itself is done below in batches.
+		static const node EmptyNode;
+		const vec<float, 3> Zero = { 0.0f, 0.0f, 0.0f };
+		const quaternion<float> Identity = { 1.0f, 0.0f, 0.0f, 0.0f };
+		for (size_t i = 0; i < Count; i++) {
+			const node& Node = (aNode[i] != nullptr) ? *aNode[i] : EmptyNode;
+			cursor Cursor;
+			gather_channel(Node.PositionKey, aTime, Zero, Cursor.Position, PositionFrom[i], PositionTo[i], PositionFactor[i]);
+			gather_channel(Node.RotationKey, aTime, Identity, Cursor.Rotation, RotationFrom[i], RotationTo[i], RotationFactor[i]);
+			gather_channel(Node.ScalingKey, aTime, Zero, Cursor.Scaling, ScalingFrom[i], ScalingTo[i], ScalingFactor[i]);
+		}
+
+		lerp(Position.data(), PositionFrom.data(), PositionTo.data(), PositionFactor.data(), Count);
+		nlerp(Rotation.data(), RotationFrom.data(), RotationTo.data(), RotationFactor.data(), Count, true);
+		lerp(Scaling.data(), ScalingFrom.data(), ScalingTo.data(), ScalingFactor.data(), Count);
+
+		aTransform.resize(Count);
+		for (size_t i = 0; i < Count; i++) {
+			aTransform[i] = calculate_transform(Position[i], Rotation[i], Scaling[i]);
+		}
+	}
+
 	bool animation::node::exists() const {
 		return (PositionKey.size() > 0) || (RotationKey.size() > 0) || (ScalingKey.size() > 0);
 	}
@@ -159,17 +139,18 @@ namespace geodesy::core::phys {
 	animation::animation(const aiAnimation* aAnimation) {
 		this->Name 				= aAnimation->mName.C_Str();
 		this->TicksPerSecond 	= aAnimation->mTicksPerSecond;
+		this->Track = std::vector<animation::node>(aAnimation->mNumChannels);
 		for (uint i = 0; i < aAnimation->mNumChannels; i++) {
 			aiNodeAnim* RNA = aAnimation->mChannels[i];
-			std::string NodeName = RNA->mNodeName.C_Str();
-			this->NodeAnimMap[NodeName] = animation::node();
-			animation::node& LNA = this->NodeAnimMap[NodeName];
+			animation::node& LNA = this->Track[i];
+			LNA.Name = RNA->mNodeName.C_Str();
 
 			// Get Position Keys, size vector, then fill with data.
-			LNA.PositionKey = std::vector<animation::key<math::vec<float, 3>>>(RNA->mNumPositionKeys);
+			LNA.PositionKey.Time.resize(RNA->mNumPositionKeys);
+			LNA.PositionKey.Value.resize(RNA->mNumPositionKeys);
 			for (uint j = 0; j < RNA->mNumPositionKeys; j++) {
-				LNA.PositionKey[j].Time = RNA->mPositionKeys[j].mTime;
-				LNA.PositionKey[j].Value = {
+				LNA.PositionKey.Time[j] = RNA->mPositionKeys[j].mTime;
+				LNA.PositionKey.Value[j] = {
 					RNA->mPositionKeys[j].mValue.x,
 					RNA->mPositionKeys[j].mValue.y,
 					RNA->mPositionKeys[j].mValue.z
@@ -177,10 +158,11 @@ namespace geodesy::core::phys {
 			}
 
 			// Get Rotation Keys, size vector, then fill with data.
-			LNA.RotationKey = std::vector<animation::key<math::quaternion<float>>>(RNA->mNumRotationKeys);
+			LNA.RotationKey.Time.resize(RNA->mNumRotationKeys);
+			LNA.RotationKey.Value.resize(RNA->mNumRotationKeys);
 			for (uint j = 0; j < RNA->mNumRotationKeys; j++) {
-				LNA.RotationKey[j].Time = RNA->mRotationKeys[j].mTime;
-				LNA.RotationKey[j].Value = {
+				LNA.RotationKey.Time[j] = RNA->mRotationKeys[j].mTime;
+				LNA.RotationKey.Value[j] = {
 					RNA->mRotationKeys[j].mValue.w,
 					RNA->mRotationKeys[j].mValue.x,
 					RNA->mRotationKeys[j].mValue.y,
@@ -189,10 +171,11 @@ namespace geodesy::core::phys {
 			}
 
 			// Get Scaling Keys, size vector, then fill with data.
-			LNA.ScalingKey = std::vector<animation::key<math::vec<float, 3>>>(RNA->mNumScalingKeys);
+			LNA.ScalingKey.Time.resize(RNA->mNumScalingKeys);
+			LNA.ScalingKey.Value.resize(RNA->mNumScalingKeys);
 			for (uint j = 0; j < RNA->mNumScalingKeys; j++) {
-				LNA.ScalingKey[j].Time = RNA->mScalingKeys[j].mTime;
-				LNA.ScalingKey[j].Value = {
+				LNA.ScalingKey.Time[j] = RNA->mScalingKeys[j].mTime;
+				LNA.ScalingKey.Value[j] = {
 					RNA->mScalingKeys[j].mValue.x,
 					RNA->mScalingKeys[j].mValue.y,
 					RNA->mScalingKeys[j].mValue.z
@@ -202,29 +185,45 @@ namespace geodesy::core::phys {
 		// Acquire absolute start and stop times.
 		this->Start = std::numeric_limits<double>::max();
 		this->Stop = std::numeric_limits<double>::lowest();
-		for (const auto& [NodeName, NodeAnim] : this->NodeAnimMap) {
+		for (const animation::node& NodeAnim : this->Track) {
 			if (NodeAnim.PositionKey.size() > 0) {
-				this->Start = std::min(this->Start, NodeAnim.PositionKey.front().Time);
-				this->Stop = std::max(this->Stop, NodeAnim.PositionKey.back().Time);
+				this->Start = std::min(this->Start, NodeAnim.PositionKey.Time.front());
+				this->Stop = std::max(this->Stop, NodeAnim.PositionKey.Time.back());
 			}
 			if (NodeAnim.RotationKey.size() > 0) {
-				this->Start = std::min(this->Start, NodeAnim.RotationKey.front().Time);
-				this->Stop = std::max(this->Stop, NodeAnim.RotationKey.back().Time);
+				this->Start = std::min(this->Start, NodeAnim.RotationKey.Time.front());
+				this->Stop = std::max(this->Stop, NodeAnim.RotationKey.Time.back());
 			}
 			if (NodeAnim.ScalingKey.size() > 0) {
-				this->Start = std::min(this->Start, NodeAnim.ScalingKey.front().Time);
-				this->Stop = std::max(this->Stop, NodeAnim.ScalingKey.back().Time);
+				this->Start = std::min(this->Start, NodeAnim.ScalingKey.Time.front());
+				this->Stop = std::max(this->Stop, NodeAnim.ScalingKey.Time.back());
 			}
 		}
 	}
 
 	const animation::node& animation::operator[](std::string aNodeName) const {
-		auto it = NodeAnimMap.find(aNodeName);
-    	if (it == NodeAnimMap.end()) {
-    	    static const animation::node EmptyNodeAnim;  // Static empty node animation to return if not found
-    	    return EmptyNodeAnim;
-    	}
-    	return it->second;
+		for (const animation::node& NodeAnim : this->Track) {
+			if (NodeAnim.Name == aNodeName) return NodeAnim;
+		}
+		static const animation::node EmptyNodeAnim;  // Static empty node animation to return if not found
+		return EmptyNodeAnim;
+	}
+
+	void animation::compile(const std::vector<phys::node*>& aNodeList) {
+		// Later channels of the same node override earlier ones.
+		std::unordered_map<std::string, size_t> Channel;
+		for (size_t i = 0; i < this->Track.size(); i++) {
+			Channel[this->Track[i].Name] = i;
+		}
+		std::vector<animation::node> Compiled(aNodeList.size());
+		for (size_t i = 0; i < aNodeList.size(); i++) {
+			auto It = Channel.find(aNodeList[i]->Identifier);
+			if (It == Channel.end()) continue;
+			Compiled[i] = std::move(this->Track[It->second]);
+			// A node listed twice gets the channel once.
+			Channel.erase(It);
+		}
+		this->Track.swap(Compiled);
 	}
 
 }
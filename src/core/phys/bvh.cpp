@@ -0,0 +1,1086 @@
+#include <geodesy/core/phys/bvh.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+#include <omp.h>
+
+namespace geodesy::core::phys::collision {
+
+	// Traversal stack depth, the build bounds the hierarchy depth well below a third of this.
+	static constexpr int StackSize = 320;
+	// Binary splits past this depth use the median instead of the surface area heuristic.
+	static constexpr int MedianDepth = 64;
+	static constexpr int Bins = 12;
+	// Rays per packet, four groups of four lanes.
+	static constexpr int PacketSize = 16;
+
+	ray::ray() {
+		this->Origin		= math::vec<float, 3>(0.0f, 0.0f, 0.0f);
+		this->Direction		= math::vec<float, 3>(0.0f, 0.0f, 1.0f);
+		this->Length		= std::numeric_limits<float>::max();
+	}
+
+	ray::ray(const math::vec<float, 3>& aOrigin, const math::vec<float, 3>& aDirection, float aLength) {
+		this->Origin		= aOrigin;
+		this->Direction		= aDirection;
+		this->Length		= aLength;
+	}
+
+	hit::hit() {
+		this->Distance		= std::numeric_limits<float>::infinity();
+		this->Triangle		= null;
+		this->Instance		= null;
+		this->U				= 0.0f;
+		this->V				= 0.0f;
+	}
+
+	bool hit::found() const {
+		return this->Distance < std::numeric_limits<float>::infinity();
+	}
+
+	// ------------------------- Build ------------------------- //
+
+	// Items are moved rather than indexed while building, so every pass reads them in order.
+	// Index and Pad fill the fourth lanes, so each corner loads as one vector.
+	struct build_item {
+		float								Min[3];
+		uint32_t							Index;
+		float								Max[3];
+		float								Pad;
+	};
+
+	// Bounds accumulated over items, the fourth lanes are unused.
+	struct build_box {
+		float								Min[4];
+		float								Max[4];
+
+		build_box() {
+			for (int k = 0; k < 4; k++) {
+				Min[k] = std::numeric_limits<float>::max();
+				Max[k] = -std::numeric_limits<float>::max();
+			}
+		}
+
+		float area() const {
+			const float dx = Max[0] - Min[0], dy = Max[1] - Min[1], dz = Max[2] - Min[2];
+			return dx * dy + dy * dz + dz * dx;
+		}
+	};
+
+	static void grow(build_box& aBox, const float* aMin, const float* aMax) {
+#if defined(GEODESY_MATH_SIMD)
+		using namespace math::simd;
+		store(aBox.Min, min(load(aBox.Min), load(aMin)));
+		store(aBox.Max, max(load(aBox.Max), load(aMax)));
+#else
+		for (int k = 0; k < 3; k++) {
+			aBox.Min[k] = std::min(aBox.Min[k], aMin[k]);
+			aBox.Max[k] = std::max(aBox.Max[k], aMax[k]);
+		}
+#endif
+	}
+
+	// Centroids are kept doubled, Min + Max, which orders and bins them the same.
+	static void grow_center(build_box& aCenters, const build_item& aItem) {
+#if defined(GEODESY_MATH_SIMD)
+		using namespace math::simd;
+		const float4 Center = add(load(aItem.Min), load(aItem.Max));
+		store(aCenters.Min, min(load(aCenters.Min), Center));
+		store(aCenters.Max, max(load(aCenters.Max), Center));
+#else
+		for (int k = 0; k < 3; k++) {
+			const float Center = aItem.Min[k] + aItem.Max[k];
+			aCenters.Min[k] = std::min(aCenters.Min[k], Center);
+			aCenters.Max[k] = std::max(aCenters.Max[k], Center);
+		}
+#endif
+	}
+
+	struct build_context {
+		build_item*							Item;
+		bvh::volume*						Volume;
+		std::atomic<uint32_t>				Count;
+		uint32_t							LeafSize;
+	};
+
+	// Items [First, Last) with the bounds of their boxes and of their doubled centroids.
+	struct build_range {
+		uint32_t							First;
+		uint32_t							Last;
+		int									Depth;
+		build_box							Box;
+		build_box							Centers;
+	};
+
+	// Moves the items of a range that aLeft selects to its front and bounds both sides in the
+	// same pass, returns the second side.
+	template <typename F>
+	static build_range partition(build_context* aContext, build_range& aRange, F&& aLeft) {
+		build_item* Item = aContext->Item;
+		build_range Right;
+		Right.Depth = aRange.Depth;
+		Right.Last = aRange.Last;
+		build_box LeftBox, LeftCenters;
+		uint32_t i = aRange.First, j = aRange.Last;
+		while (i < j) {
+			const build_item& I = Item[i];
+			if (aLeft(I)) {
+				grow(LeftBox, I.Min, I.Max);
+				grow_center(LeftCenters, I);
+				i++;
+			}
+			else {
+				grow(Right.Box, I.Min, I.Max);
+				grow_center(Right.Centers, I);
+				std::swap(Item[i], Item[--j]);
+			}
+		}
+		Right.First = i;
+		aRange.Last = i;
+		aRange.Box = LeftBox;
+		aRange.Centers = LeftCenters;
+		return Right;
+	}
+
+	// Splits a range in two by the cheapest binned plane across the axis where the centroids
+	// spread the most, the range keeps the first half and the second is returned.
+	static build_range split(build_context* aContext, build_range& aRange) {
+		build_item* Item = aContext->Item;
+		const build_box& Centers = aRange.Centers;
+		aRange.Depth++;
+		int Axis = 0;
+		for (int k = 1; k < 3; k++) {
+			if (Centers.Max[k] - Centers.Min[k] > Centers.Max[Axis] - Centers.Min[Axis]) Axis = k;
+		}
+
+		if ((aRange.Depth <= MedianDepth) && (Centers.Max[Axis] > Centers.Min[Axis])) {
+			const float Low = Centers.Min[Axis], Scale = (float)Bins / (Centers.Max[Axis] - Low);
+			uint32_t Count[Bins] = {};
+			build_box Box[Bins];
+			for (uint32_t i = aRange.First; i < aRange.Last; i++) {
+				const build_item& I = Item[i];
+				const int b = std::min((int)((I.Min[Axis] + I.Max[Axis] - Low) * Scale), Bins - 1);
+				Count[b]++;
+				grow(Box[b], I.Min, I.Max);
+			}
+			// Cost of a plane before bin b, items times half area on either side.
+			float RightArea[Bins];
+			uint32_t RightCount[Bins];
+			build_box Accumulated;
+			uint32_t n = 0;
+			for (int b = Bins - 1; b > 0; b--) {
+				grow(Accumulated, Box[b].Min, Box[b].Max);
+				n += Count[b];
+				RightArea[b] = n > 0 ? Accumulated.area() : 0.0f;
+				RightCount[b] = n;
+			}
+			float BestCost = std::numeric_limits<float>::max();
+			int BestBin = -1;
+			Accumulated = build_box();
+			n = 0;
+			for (int b = 0; b < Bins - 1; b++) {
+				grow(Accumulated, Box[b].Min, Box[b].Max);
+				n += Count[b];
+				if ((n == 0) || (RightCount[b + 1] == 0)) continue;
+				const float Cost = (float)n * Accumulated.area() + (float)RightCount[b + 1] * RightArea[b + 1];
+				if (Cost < BestCost) {
+					BestCost = Cost;
+					BestBin = b + 1;
+				}
+			}
+			if (BestBin > 0) {
+				return partition(aContext, aRange, [&](const build_item& aItem) {
+					return std::min((int)((aItem.Min[Axis] + aItem.Max[Axis] - Low) * Scale), Bins - 1) < BestBin;
+				});
+			}
+		}
+
+		// Median split, in place when all centroids coincide since no plane separates them.
+		const uint32_t Middle = aRange.First + (aRange.Last - aRange.First) / 2;
+		if (Centers.Max[Axis] > Centers.Min[Axis]) {
+			std::nth_element(Item + aRange.First, Item + Middle, Item + aRange.Last, [&](const build_item& aLhs, const build_item& aRhs) {
+				return aLhs.Min[Axis] + aLhs.Max[Axis] < aRhs.Min[Axis] + aRhs.Max[Axis];
+			});
+		}
+		uint32_t Position = aRange.First;
+		return partition(aContext, aRange, [&](const build_item&) { return Position++ < Middle; });
+	}
+
+	// Quantizes child boxes into a volume, rounding outward so a decoded box always contains the
+	// exact one.
+	static void quantize(bvh::volume& aVolume, const build_range* aChild, const uint32_t* aCode, int aCount) {
+		build_box Box;
+		for (int c = 0; c < aCount; c++) {
+			grow(Box, aChild[c].Box.Min, aChild[c].Box.Max);
+		}
+		for (int k = 0; k < 3; k++) {
+			const float Origin = Box.Min[k];
+			float Step = (Box.Max[k] - Origin) / 255.0f;
+			while (Origin + 255.0f * Step < Box.Max[k]) {
+				Step = std::nextafter(Step, std::numeric_limits<float>::max());
+			}
+			aVolume.Origin[k] = Origin;
+			aVolume.Step[k] = Step;
+			for (int c = 0; c < 4; c++) {
+				float Low = 0.0f, High = 0.0f;
+				if ((c < aCount) && (Step > 0.0f)) {
+					const build_box& Child = aChild[c].Box;
+					Low = std::min(std::max(std::floor((Child.Min[k] - Origin) / Step), 0.0f), 255.0f);
+					High = std::min(std::max(std::ceil((Child.Max[k] - Origin) / Step), 0.0f), 255.0f);
+					while ((Low > 0.0f) && (Origin + Low * Step > Child.Min[k])) Low -= 1.0f;
+					while ((High < 255.0f) && (Origin + High * Step < Child.Max[k])) High += 1.0f;
+				}
+				aVolume.Min[k][c] = (uint8_t)Low;
+				aVolume.Max[k][c] = (uint8_t)High;
+			}
+		}
+		for (int c = 0; c < 4; c++) {
+			aVolume.Child[c] = c < aCount ? aCode[c] : bvh::null;
+		}
+	}
+
+	// Fills a volume with up to four children made of a range, the largest part is split until
+	// there are four or all are leaves, then the internal children recurse.
+	static void subdivide(build_context* aContext, uint32_t aVolume, const build_range& aRange) {
+		build_range Child[4] = { aRange };
+		int Count = 1;
+		while (Count < 4) {
+			int Largest = -1;
+			for (int c = 0; c < Count; c++) {
+				const uint32_t n = Child[c].Last - Child[c].First;
+				if ((n > aContext->LeafSize) && ((Largest < 0) || (n > Child[Largest].Last - Child[Largest].First))) Largest = c;
+			}
+			if (Largest < 0) break;
+			Child[Count++] = split(aContext, Child[Largest]);
+		}
+
+		uint32_t Code[4];
+		for (int c = 0; c < Count; c++) {
+			const uint32_t n = Child[c].Last - Child[c].First;
+			Code[c] = n <= aContext->LeafSize ? bvh::leaf | ((n - 1) << 28) | Child[c].First : aContext->Count.fetch_add(1);
+		}
+		quantize(aContext->Volume[aVolume], Child, Code, Count);
+
+		for (int c = 0; c < Count; c++) {
+			if (Code[c] & bvh::leaf) continue;
+			const uint32_t Volume = Code[c];
+			const build_range Range = Child[c];
+			if (Range.Last - Range.First > 4096) {
+				#pragma omp task firstprivate(aContext, Volume, Range)
+				subdivide(aContext, Volume, Range);
+			}
+			else {
+				subdivide(aContext, Volume, Range);
+			}
+		}
+	}
+
+	bvh::bvh() {
+		this->LeafSize = 4;
+	}
+
+	void bvh::build(const std::vector<aabb>& aBox, uint32_t aLeafSize) {
+		this->LeafSize = std::max(1u, std::min(aLeafSize, MaxLeaf));
+		const std::size_t Count = aBox.size();
+		if (Count >= (1u << 28)) {
+			throw std::length_error("collision::bvh: more items than a leaf can address.");
+		}
+		this->Bounds = aabb();
+		this->Volume.clear();
+		this->Item.resize(Count);
+		if (Count == 0) return;
+
+		std::vector<build_item> Item(Count);
+		build_range Root;
+		Root.First = 0;
+		Root.Last = (uint32_t)Count;
+		Root.Depth = 0;
+		for (std::size_t i = 0; i < Count; i++) {
+			for (int k = 0; k < 3; k++) {
+				Item[i].Min[k] = aBox[i].Min[k];
+				Item[i].Max[k] = aBox[i].Max[k];
+			}
+			Item[i].Index = (uint32_t)i;
+			Item[i].Pad = 0.0f;
+			grow(Root.Box, Item[i].Min, Item[i].Max);
+			grow_center(Root.Centers, Item[i]);
+		}
+		this->Bounds = aabb(math::vec<float, 3>(Root.Box.Min[0], Root.Box.Min[1], Root.Box.Min[2]), math::vec<float, 3>(Root.Box.Max[0], Root.Box.Max[1], Root.Box.Max[2]));
+
+		// Every volume past the root has at least two children, so there are fewer than items.
+		this->Volume.resize(Count);
+		build_context Context;
+		Context.Item		= Item.data();
+		Context.Volume		= this->Volume.data();
+		Context.Count		= 1;
+		Context.LeafSize	= this->LeafSize;
+		if (Count > 4096) {
+			#pragma omp parallel
+			#pragma omp single
+			subdivide(&Context, 0, Root);
+		}
+		else {
+			subdivide(&Context, 0, Root);
+		}
+		this->Volume.resize(Context.Count);
+		for (std::size_t i = 0; i < Count; i++) {
+			this->Item[i] = Item[i].Index;
+		}
+	}
+
+	bool bvh::empty() const {
+		return this->Volume.empty();
+	}
+
+	std::size_t bvh::memory() const {
+		return this->Volume.size() * sizeof(volume) + this->Item.size() * sizeof(uint32_t);
+	}
+
+	// ------------------------- Traversal ------------------------- //
+
+	// A ray with its reciprocal direction. Zero components become tiny ones so a slab never
+	// multiplies zero by infinity.
+	struct ray_state {
+		float								Origin[3];
+		float								Direction[3];
+		float								Inverse[3];
+		float								Far;
+	};
+
+	static float reciprocal(float aValue) {
+		return 1.0f / (aValue != 0.0f ? aValue : std::copysign(1e-30f, aValue));
+	}
+
+	static ray_state prepare(const math::vec<float, 3>& aOrigin, const math::vec<float, 3>& aDirection, float aFar) {
+		ray_state R;
+		for (int k = 0; k < 3; k++) {
+			R.Origin[k] = aOrigin[k];
+			R.Direction[k] = aDirection[k];
+			R.Inverse[k] = reciprocal(aDirection[k]);
+		}
+		R.Far = aFar;
+		return R;
+	}
+
+	// The same ray in the space of an instance, distances along it are unchanged.
+	static ray_state prepare(const ray_state& aRay, const math::affine<float>& aInverse) {
+		const math::vec<float, 3> Origin(aRay.Origin[0], aRay.Origin[1], aRay.Origin[2]);
+		const math::vec<float, 3> Direction(aRay.Direction[0], aRay.Direction[1], aRay.Direction[2]);
+		return prepare(aInverse.transform_point(Origin), aInverse.transform_vector(Direction), aRay.Far);
+	}
+
+	// Child boxes of a volume, child c spans Low[k][c] to High[k][c].
+	static void decode(const bvh::volume& aVolume, float aLow[3][4], float aHigh[3][4]) {
+#if defined(GEODESY_MATH_SIMD)
+		using namespace math::simd;
+		for (int k = 0; k < 3; k++) {
+			const float4 Origin = splat(aVolume.Origin[k]), Step = splat(aVolume.Step[k]);
+			store(aLow[k], add(Origin, mul(widen(aVolume.Min[k]), Step)));
+			store(aHigh[k], add(Origin, mul(widen(aVolume.Max[k]), Step)));
+		}
+#else
+		for (int k = 0; k < 3; k++) {
+			for (int c = 0; c < 4; c++) {
+				aLow[k][c] = aVolume.Origin[k] + (float)aVolume.Min[k][c] * aVolume.Step[k];
+				aHigh[k][c] = aVolume.Origin[k] + (float)aVolume.Max[k][c] * aVolume.Step[k];
+			}
+		}
+#endif
+	}
+
+	static int occupied(const bvh::volume& aVolume) {
+		int Mask = 0;
+		for (int c = 0; c < 4; c++) {
+			Mask |= (aVolume.Child[c] != bvh::null) << c;
+		}
+		return Mask;
+	}
+
+	// Entry distances of a ray into the four children of a volume, bit c is set when child c
+	// is entered before the ray's far distance.
+	static int slab(const bvh::volume& aVolume, const ray_state& aRay, float* aNear) {
+#if defined(GEODESY_MATH_SIMD)
+		using namespace math::simd;
+		float4 Near = zero(), Far = splat(aRay.Far);
+		for (int k = 0; k < 3; k++) {
+			const float4 Origin = splat(aVolume.Origin[k]), Step = splat(aVolume.Step[k]);
+			const float4 RayOrigin = splat(aRay.Origin[k]), Inverse = splat(aRay.Inverse[k]);
+			const float4 T0 = mul(sub(add(Origin, mul(widen(aVolume.Min[k]), Step)), RayOrigin), Inverse);
+			const float4 T1 = mul(sub(add(Origin, mul(widen(aVolume.Max[k]), Step)), RayOrigin), Inverse);
+			Near = max(Near, min(T0, T1));
+			Far = min(Far, max(T0, T1));
+		}
+		store(aNear, Near);
+		return less_equal(Near, Far) & occupied(aVolume);
+#else
+		float Low[3][4], High[3][4];
+		decode(aVolume, Low, High);
+		int Mask = 0;
+		for (int c = 0; c < 4; c++) {
+			float Near = 0.0f, Far = aRay.Far;
+			for (int k = 0; k < 3; k++) {
+				const float T0 = (Low[k][c] - aRay.Origin[k]) * aRay.Inverse[k];
+				const float T1 = (High[k][c] - aRay.Origin[k]) * aRay.Inverse[k];
+				Near = std::max(Near, std::min(T0, T1));
+				Far = std::min(Far, std::max(T0, T1));
+			}
+			aNear[c] = Near;
+			Mask |= (Near <= Far) << c;
+		}
+		return Mask & occupied(aVolume);
+#endif
+	}
+
+	// Depth first over the children a ray enters, nearest first. aLeaf(aFirst, aCount) tests the
+	// items of a leaf, lowering aRay.Far on hits, and returns true to end the traversal.
+	template <typename L>
+	static void trace(const bvh& aTree, ray_state& aRay, L&& aLeaf) {
+		if (aTree.empty()) return;
+		struct entry {
+			uint32_t	Code;
+			float		Near;
+		};
+		entry Stack[StackSize];
+		int Top = 0;
+		Stack[Top++] = { 0, 0.0f };
+		while (Top > 0) {
+			const entry E = Stack[--Top];
+			if (E.Near > aRay.Far) continue;
+			if (E.Code & bvh::leaf) {
+				if (aLeaf(E.Code & 0x0FFFFFFFu, ((E.Code >> 28) & 7u) + 1)) return;
+				continue;
+			}
+			const bvh::volume& V = aTree.Volume[E.Code];
+			float Near[4];
+			const int Mask = slab(V, aRay, Near);
+			entry Hit[4];
+			int n = 0;
+			for (int c = 0; c < 4; c++) {
+				if (!((Mask >> c) & 1)) continue;
+				int i = n++;
+				for (; (i > 0) && (Hit[i - 1].Near < Near[c]); i--) Hit[i] = Hit[i - 1];
+				Hit[i] = { V.Child[c], Near[c] };
+			}
+			for (int i = 0; i < n; i++) Stack[Top++] = Hit[i];
+		}
+	}
+
+	// Two sided Moller-Trumbore, true with the distance and barycentrics of a hit in [0, aFar).
+	static bool intersect(const triangle_bvh::triangle& aTriangle, const float* aOrigin, const float* aDirection, float aFar, float& aDistance, float& aU, float& aV) {
+		const float* E1 = aTriangle.Edge[0];
+		const float* E2 = aTriangle.Edge[1];
+		const float P[3] = { aDirection[1] * E2[2] - aDirection[2] * E2[1], aDirection[2] * E2[0] - aDirection[0] * E2[2], aDirection[0] * E2[1] - aDirection[1] * E2[0] };
+		const float Determinant = E1[0] * P[0] + E1[1] * P[1] + E1[2] * P[2];
+		if (Determinant == 0.0f) return false;
+		const float Inverse = 1.0f / Determinant;
+		const float T[3] = { aOrigin[0] - aTriangle.Corner[0], aOrigin[1] - aTriangle.Corner[1], aOrigin[2] - aTriangle.Corner[2] };
+		const float U = (T[0] * P[0] + T[1] * P[1] + T[2] * P[2]) * Inverse;
+		if ((U < 0.0f) || (U > 1.0f)) return false;
+		const float Q[3] = { T[1] * E1[2] - T[2] * E1[1], T[2] * E1[0] - T[0] * E1[2], T[0] * E1[1] - T[1] * E1[0] };
+		const float V = (aDirection[0] * Q[0] + aDirection[1] * Q[1] + aDirection[2] * Q[2]) * Inverse;
+		if ((V < 0.0f) || (U + V > 1.0f)) return false;
+		const float Distance = (E2[0] * Q[0] + E2[1] * Q[1] + E2[2] * Q[2]) * Inverse;
+		if ((Distance < 0.0f) || (Distance >= aFar)) return false;
+		aDistance = Distance;
+		aU = U;
+		aV = V;
+		return true;
+	}
+
+	static void closest(const triangle_bvh& aMesh, ray_state& aRay, hit& aHit, uint32_t aInstance) {
+		trace(aMesh, aRay, [&](uint32_t aFirst, uint32_t aCount) {
+			for (uint32_t i = aFirst; i < aFirst + aCount; i++) {
+				float Distance, U, V;
+				if (!intersect(aMesh.Triangle[i], aRay.Origin, aRay.Direction, aRay.Far, Distance, U, V)) continue;
+				aRay.Far = Distance;
+				aHit.Distance = Distance;
+				aHit.Triangle = aMesh.Triangle[i].Index;
+				aHit.Instance = aInstance;
+				aHit.U = U;
+				aHit.V = V;
+			}
+			return false;
+		});
+	}
+
+	static bool any(const triangle_bvh& aMesh, ray_state aRay) {
+		bool Found = false;
+		trace(aMesh, aRay, [&](uint32_t aFirst, uint32_t aCount) {
+			for (uint32_t i = aFirst; i < aFirst + aCount; i++) {
+				float Distance, U, V;
+				if (intersect(aMesh.Triangle[i], aRay.Origin, aRay.Direction, aRay.Far, Distance, U, V)) return Found = true;
+			}
+			return false;
+		});
+		return Found;
+	}
+
+	// ------------------------- Packets ------------------------- //
+
+	struct packet {
+		alignas(16) float					Origin[3][PacketSize];
+		alignas(16) float					Direction[3][PacketSize];
+		alignas(16) float					Inverse[3][PacketSize];
+		alignas(16) float					Far[PacketSize];
+		uint32_t							Live;			// Lanes holding a ray.
+	};
+
+	static void gather(packet& aPacket, const ray* aRay, int aCount) {
+		aPacket.Live = (1u << aCount) - 1u;
+		for (int r = 0; r < PacketSize; r++) {
+			const ray_state R = r < aCount ? prepare(aRay[r].Origin, aRay[r].Direction, aRay[r].Length) : prepare(math::vec<float, 3>(0.0f, 0.0f, 0.0f), math::vec<float, 3>(1.0f, 1.0f, 1.0f), -1.0f);
+			for (int k = 0; k < 3; k++) {
+				aPacket.Origin[k][r] = R.Origin[k];
+				aPacket.Direction[k][r] = R.Direction[k];
+				aPacket.Inverse[k][r] = R.Inverse[k];
+			}
+			aPacket.Far[r] = R.Far;
+		}
+	}
+
+	// Whether rays travel into the same octant, packets of rays that do not diverge through the
+	// hierarchy and are traced one at a time instead.
+	static bool coherent(const ray* aRay, int aCount) {
+		for (int r = 1; r < aCount; r++) {
+			for (int k = 0; k < 3; k++) {
+				if (std::signbit(aRay[r].Direction[k]) != std::signbit(aRay[0].Direction[k])) return false;
+			}
+		}
+		return true;
+	}
+
+	// Lanes of aMask whose rays enter child c of decoded boxes before their far distance.
+	static uint32_t slab(const packet& aPacket, uint32_t aMask, const float aLow[3][4], const float aHigh[3][4], int aChild) {
+		uint32_t Out = 0;
+		for (int g = 0; g < PacketSize; g += 4) {
+			if (((aMask >> g) & 0xFu) == 0) continue;
+#if defined(GEODESY_MATH_SIMD)
+			using namespace math::simd;
+			float4 Near = zero(), Far = load(aPacket.Far + g);
+			for (int k = 0; k < 3; k++) {
+				const float4 RayOrigin = load(aPacket.Origin[k] + g), Inverse = load(aPacket.Inverse[k] + g);
+				const float4 T0 = mul(sub(splat(aLow[k][aChild]), RayOrigin), Inverse);
+				const float4 T1 = mul(sub(splat(aHigh[k][aChild]), RayOrigin), Inverse);
+				Near = max(Near, min(T0, T1));
+				Far = min(Far, max(T0, T1));
+			}
+			Out |= (uint32_t)less_equal(Near, Far) << g;
+#else
+			for (int r = g; r < g + 4; r++) {
+				float Near = 0.0f, Far = aPacket.Far[r];
+				for (int k = 0; k < 3; k++) {
+					const float T0 = (aLow[k][aChild] - aPacket.Origin[k][r]) * aPacket.Inverse[k][r];
+					const float T1 = (aHigh[k][aChild] - aPacket.Origin[k][r]) * aPacket.Inverse[k][r];
+					Near = std::max(Near, std::min(T0, T1));
+					Far = std::min(Far, std::max(T0, T1));
+				}
+				Out |= (uint32_t)(Near <= Far) << r;
+			}
+#endif
+		}
+		return Out & aMask;
+	}
+
+	// Depth first over the children any live ray of the packet enters, ordered along the
+	// direction of the first live ray. aLeaf(aFirst, aCount, aMask) tests the lanes of aMask and
+	// returns the lanes that are done, which are dropped from the rest of the traversal.
+	template <typename L>
+	static void trace(const bvh& aTree, const packet& aPacket, L&& aLeaf) {
+		if (aTree.empty() || (aPacket.Live == 0)) return;
+		struct entry {
+			uint32_t	Code;
+			uint32_t	Mask;
+		};
+		entry Stack[StackSize];
+		int Top = 0;
+		Stack[Top++] = { 0, aPacket.Live };
+		uint32_t Done = 0;
+		int Lead = 0;
+		while (!((aPacket.Live >> Lead) & 1u)) Lead++;
+		const float Lx = aPacket.Direction[0][Lead], Ly = aPacket.Direction[1][Lead], Lz = aPacket.Direction[2][Lead];
+		while (Top > 0) {
+			const entry E = Stack[--Top];
+			const uint32_t Mask = E.Mask & ~Done;
+			if (Mask == 0) continue;
+			if (E.Code & bvh::leaf) {
+				Done |= aLeaf(E.Code & 0x0FFFFFFFu, ((E.Code >> 28) & 7u) + 1, Mask);
+				if (Done == aPacket.Live) return;
+				continue;
+			}
+			const bvh::volume& V = aTree.Volume[E.Code];
+			float Low[3][4], High[3][4];
+			decode(V, Low, High);
+			entry Hit[4];
+			float Key[4];
+			int n = 0;
+			for (int c = 0; c < 4; c++) {
+				if (V.Child[c] == bvh::null) continue;
+				const uint32_t ChildMask = slab(aPacket, Mask, Low, High, c);
+				if (ChildMask == 0) continue;
+				const float Along = (Low[0][c] + High[0][c]) * Lx + (Low[1][c] + High[1][c]) * Ly + (Low[2][c] + High[2][c]) * Lz;
+				int i = n++;
+				for (; (i > 0) && (Key[i - 1] < Along); i--) {
+					Hit[i] = Hit[i - 1];
+					Key[i] = Key[i - 1];
+				}
+				Hit[i] = { V.Child[c], ChildMask };
+				Key[i] = Along;
+			}
+			for (int i = 0; i < n; i++) Stack[Top++] = Hit[i];
+		}
+	}
+
+	static void closest(const triangle_bvh& aMesh, packet& aPacket, hit* aHit, uint32_t aInstance) {
+		trace(aMesh, aPacket, [&](uint32_t aFirst, uint32_t aCount, uint32_t aMask) {
+			for (uint32_t Lanes = aMask; Lanes != 0; Lanes &= Lanes - 1) {
+				int r = 0;
+				while (!((Lanes >> r) & 1u)) r++;
+				const float Origin[3] = { aPacket.Origin[0][r], aPacket.Origin[1][r], aPacket.Origin[2][r] };
+				const float Direction[3] = { aPacket.Direction[0][r], aPacket.Direction[1][r], aPacket.Direction[2][r] };
+				for (uint32_t i = aFirst; i < aFirst + aCount; i++) {
+					float Distance, U, V;
+					if (!intersect(aMesh.Triangle[i], Origin, Direction, aPacket.Far[r], Distance, U, V)) continue;
+					aPacket.Far[r] = Distance;
+					aHit[r].Distance = Distance;
+					aHit[r].Triangle = aMesh.Triangle[i].Index;
+					aHit[r].Instance = aInstance;
+					aHit[r].U = U;
+					aHit[r].V = V;
+				}
+			}
+			return 0u;
+		});
+	}
+
+	// Lanes of the packet whose rays hit anything.
+	static uint32_t any(const triangle_bvh& aMesh, const packet& aPacket) {
+		uint32_t Blocked = 0;
+		trace(aMesh, aPacket, [&](uint32_t aFirst, uint32_t aCount, uint32_t aMask) {
+			for (uint32_t Lanes = aMask; Lanes != 0; Lanes &= Lanes - 1) {
+				int r = 0;
+				while (!((Lanes >> r) & 1u)) r++;
+				const float Origin[3] = { aPacket.Origin[0][r], aPacket.Origin[1][r], aPacket.Origin[2][r] };
+				const float Direction[3] = { aPacket.Direction[0][r], aPacket.Direction[1][r], aPacket.Direction[2][r] };
+				for (uint32_t i = aFirst; i < aFirst + aCount; i++) {
+					float Distance, U, V;
+					if (intersect(aMesh.Triangle[i], Origin, Direction, aPacket.Far[r], Distance, U, V)) {
+						Blocked |= 1u << r;
+						break;
+					}
+				}
+			}
+			return Blocked;
+		});
+		return Blocked;
+	}
+
+	// The lanes of aMask carried into the space of an instance.
+	static void transform(const packet& aPacket, uint32_t aMask, const math::affine<float>& aInverse, packet& aOut) {
+		aOut.Live = aMask;
+		for (uint32_t Lanes = aMask; Lanes != 0; Lanes &= Lanes - 1) {
+			int r = 0;
+			while (!((Lanes >> r) & 1u)) r++;
+			ray_state R;
+			for (int k = 0; k < 3; k++) {
+				R.Origin[k] = aPacket.Origin[k][r];
+				R.Direction[k] = aPacket.Direction[k][r];
+			}
+			R.Far = aPacket.Far[r];
+			const ray_state Local = prepare(R, aInverse);
+			for (int k = 0; k < 3; k++) {
+				aOut.Origin[k][r] = Local.Origin[k];
+				aOut.Direction[k][r] = Local.Direction[k];
+				aOut.Inverse[k][r] = Local.Inverse[k];
+			}
+			aOut.Far[r] = Local.Far;
+		}
+	}
+
+	// ------------------------- Overlap ------------------------- //
+
+	// Children of a volume whose boxes come within the radius of a point.
+	static int sphere(const bvh::volume& aVolume, const math::vec<float, 3>& aCenter, float aRadius2) {
+		float Low[3][4], High[3][4];
+		decode(aVolume, Low, High);
+#if defined(GEODESY_MATH_SIMD)
+		using namespace math::simd;
+		float4 Distance2 = zero();
+		for (int k = 0; k < 3; k++) {
+			const float4 C = splat(aCenter[k]);
+			const float4 Gap = max(max(sub(load(Low[k]), C), sub(C, load(High[k]))), zero());
+			Distance2 = add(Distance2, mul(Gap, Gap));
+		}
+		return less_equal(Distance2, splat(aRadius2)) & occupied(aVolume);
+#else
+		int Mask = 0;
+		for (int c = 0; c < 4; c++) {
+			float Distance2 = 0.0f;
+			for (int k = 0; k < 3; k++) {
+				const float Gap = std::max(std::max(Low[k][c] - aCenter[k], aCenter[k] - High[k][c]), 0.0f);
+				Distance2 += Gap * Gap;
+			}
+			Mask |= (Distance2 <= aRadius2) << c;
+		}
+		return Mask & occupied(aVolume);
+#endif
+	}
+
+	// Children of a volume overlapping a box.
+	static int box(const bvh::volume& aVolume, const aabb& aBox) {
+		float Low[3][4], High[3][4];
+		decode(aVolume, Low, High);
+		int Mask = occupied(aVolume);
+		for (int c = 0; c < 4; c++) {
+			for (int k = 0; k < 3; k++) {
+				if ((Low[k][c] > aBox.Max[k]) || (High[k][c] < aBox.Min[k])) Mask &= ~(1 << c);
+			}
+		}
+		return Mask;
+	}
+
+	// Visits the leaves under the children aTest(volume) selects, aLeaf(aFirst, aCount).
+	template <typename T, typename L>
+	static void overlap(const bvh& aTree, T&& aTest, L&& aLeaf) {
+		if (aTree.empty()) return;
+		uint32_t Stack[StackSize];
+		int Top = 0;
+		Stack[Top++] = 0;
+		while (Top > 0) {
+			const uint32_t Code = Stack[--Top];
+			if (Code & bvh::leaf) {
+				aLeaf(Code & 0x0FFFFFFFu, ((Code >> 28) & 7u) + 1);
+				continue;
+			}
+			const bvh::volume& V = aTree.Volume[Code];
+			const int Mask = aTest(V);
+			for (int c = 0; c < 4; c++) {
+				if ((Mask >> c) & 1) Stack[Top++] = V.Child[c];
+			}
+		}
+	}
+
+	// Closest point of a triangle to a point, by the Voronoi regions of its features.
+	static math::vec<float, 3> closest_point(const math::vec<float, 3>& aA, const math::vec<float, 3>& aAB, const math::vec<float, 3>& aAC, const math::vec<float, 3>& aPoint) {
+		const math::vec<float, 3> AP = aPoint - aA;
+		const float d1 = aAB * AP, d2 = aAC * AP;
+		if ((d1 <= 0.0f) && (d2 <= 0.0f)) return aA;
+		const math::vec<float, 3> BP = AP - aAB;
+		const float d3 = aAB * BP, d4 = aAC * BP;
+		if ((d3 >= 0.0f) && (d4 <= d3)) return aA + aAB;
+		const float vc = d1 * d4 - d3 * d2;
+		if ((vc <= 0.0f) && (d1 >= 0.0f) && (d3 <= 0.0f)) return aA + aAB * (d1 / (d1 - d3));
+		const math::vec<float, 3> CP = AP - aAC;
+		const float d5 = aAB * CP, d6 = aAC * CP;
+		if ((d6 >= 0.0f) && (d5 <= d6)) return aA + aAC;
+		const float vb = d5 * d2 - d1 * d6;
+		if ((vb <= 0.0f) && (d2 >= 0.0f) && (d6 <= 0.0f)) return aA + aAC * (d2 / (d2 - d6));
+		const float va = d3 * d6 - d5 * d4;
+		if ((va <= 0.0f) && ((d4 - d3) >= 0.0f) && ((d5 - d6) >= 0.0f)) return aA + aAB + (aAC - aAB) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		const float Denominator = 1.0f / (va + vb + vc);
+		return aA + aAB * (vb * Denominator) + aAC * (vc * Denominator);
+	}
+
+	static bool touches(const math::vec<float, 3>& aA, const math::vec<float, 3>& aAB, const math::vec<float, 3>& aAC, const math::vec<float, 3>& aCenter, float aRadius2) {
+		const math::vec<float, 3> Gap = closest_point(aA, aAB, aAC, aCenter) - aCenter;
+		return Gap * Gap <= aRadius2;
+	}
+
+	void bvh::query(const aabb& aBounds, std::vector<uint32_t>& aItem) const {
+		collision::overlap(*this, [&](const volume& aVolume) { return box(aVolume, aBounds); }, [&](uint32_t aFirst, uint32_t aCount) {
+			for (uint32_t s = aFirst; s < aFirst + aCount; s++) {
+				aItem.push_back(this->Item[s]);
+			}
+		});
+	}
+
+	// ------------------------- Triangle Hierarchy ------------------------- //
+
+	// Triangle corners of a mesh, implied by vertex order when it carries no index data.
+	static std::vector<uint32_t> triangle_list(const mesh& aMesh) {
+		std::vector<uint32_t> Corner;
+		if (aMesh.Topology.Primitive != mesh::TRIANGLE) return Corner;
+		if (aMesh.Topology.Data32.size() > 0) {
+			Corner.assign(aMesh.Topology.Data32.begin(), aMesh.Topology.Data32.end());
+		}
+		else if (aMesh.Topology.Data16.size() > 0) {
+			Corner.assign(aMesh.Topology.Data16.begin(), aMesh.Topology.Data16.end());
+		}
+		else {
+			Corner.resize(aMesh.Vertex.size() - aMesh.Vertex.size() % 3);
+			for (uint32_t i = 0; i < Corner.size(); i++) Corner[i] = i;
+		}
+		Corner.resize(Corner.size() - Corner.size() % 3);
+		for (uint32_t C : Corner) {
+			if (C >= aMesh.Vertex.size()) return std::vector<uint32_t>();
+		}
+		return Corner;
+	}
+
+	triangle_bvh::triangle_bvh() {}
+
+	triangle_bvh::triangle_bvh(const mesh& aMesh, uint32_t aLeafSize) {
+		const std::vector<uint32_t> Corner = triangle_list(aMesh);
+		const std::size_t Count = Corner.size() / 3;
+		std::vector<aabb> Box(Count);
+		#pragma omp parallel for if(Count > 16384)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)Count; i++) {
+			for (int j = 0; j < 3; j++) {
+				const math::vec<float, 3>& P = aMesh.Vertex[Corner[3 * i + j]].Position;
+				Box[i] = merge(Box[i], aabb(P, P));
+			}
+		}
+		this->build(Box, aLeafSize);
+
+		this->Triangle.resize(Count);
+		#pragma omp parallel for if(Count > 16384)
+		for (std::ptrdiff_t s = 0; s < (std::ptrdiff_t)Count; s++) {
+			const uint32_t i = this->Item[s];
+			const math::vec<float, 3>& A = aMesh.Vertex[Corner[3 * i + 0]].Position;
+			const math::vec<float, 3>& B = aMesh.Vertex[Corner[3 * i + 1]].Position;
+			const math::vec<float, 3>& C = aMesh.Vertex[Corner[3 * i + 2]].Position;
+			triangle& T = this->Triangle[s];
+			for (int k = 0; k < 3; k++) {
+				T.Corner[k] = A[k];
+				T.Edge[0][k] = B[k] - A[k];
+				T.Edge[1][k] = C[k] - A[k];
+			}
+			T.Index = i;
+		}
+	}
+
+	hit triangle_bvh::intersect(const ray& aRay) const {
+		hit Hit;
+		ray_state R = prepare(aRay.Origin, aRay.Direction, aRay.Length);
+		closest(*this, R, Hit, hit::null);
+		return Hit;
+	}
+
+	bool triangle_bvh::occluded(const ray& aRay) const {
+		return any(*this, prepare(aRay.Origin, aRay.Direction, aRay.Length));
+	}
+
+	std::vector<hit> triangle_bvh::intersect(const std::vector<ray>& aRay) const {
+		std::vector<hit> Hit(aRay.size());
+		const std::ptrdiff_t PacketCount = (aRay.size() + PacketSize - 1) / PacketSize;
+		#pragma omp parallel for schedule(dynamic, 4) if(PacketCount > 4)
+		for (std::ptrdiff_t p = 0; p < PacketCount; p++) {
+			packet P;
+			const int Count = (int)std::min<std::size_t>(PacketSize, aRay.size() - p * PacketSize);
+			if (!coherent(&aRay[p * PacketSize], Count)) {
+				for (int r = 0; r < Count; r++) {
+					Hit[p * PacketSize + r] = this->intersect(aRay[p * PacketSize + r]);
+				}
+				continue;
+			}
+			gather(P, &aRay[p * PacketSize], Count);
+			closest(*this, P, &Hit[p * PacketSize], hit::null);
+		}
+		return Hit;
+	}
+
+	std::vector<uint8_t> triangle_bvh::occluded(const std::vector<ray>& aRay) const {
+		std::vector<uint8_t> Blocked(aRay.size());
+		const std::ptrdiff_t PacketCount = (aRay.size() + PacketSize - 1) / PacketSize;
+		#pragma omp parallel for schedule(dynamic, 4) if(PacketCount > 4)
+		for (std::ptrdiff_t p = 0; p < PacketCount; p++) {
+			packet P;
+			const int Count = (int)std::min<std::size_t>(PacketSize, aRay.size() - p * PacketSize);
+			if (!coherent(&aRay[p * PacketSize], Count)) {
+				for (int r = 0; r < Count; r++) {
+					Blocked[p * PacketSize + r] = this->occluded(aRay[p * PacketSize + r]);
+				}
+				continue;
+			}
+			gather(P, &aRay[p * PacketSize], Count);
+			const uint32_t Mask = any(*this, P);
+			for (int r = 0; r < Count; r++) {
+				Blocked[p * PacketSize + r] = (Mask >> r) & 1u;
+			}
+		}
+		return Blocked;
+	}
+
+	std::vector<uint32_t> triangle_bvh::overlap(const math::vec<float, 3>& aCenter, float aRadius) const {
+		std::vector<uint32_t> Found;
+		const float Radius2 = aRadius * aRadius;
+		collision::overlap(*this, [&](const volume& aVolume) { return sphere(aVolume, aCenter, Radius2); }, [&](uint32_t aFirst, uint32_t aCount) {
+			for (uint32_t i = aFirst; i < aFirst + aCount; i++) {
+				const triangle& T = this->Triangle[i];
+				const math::vec<float, 3> A(T.Corner[0], T.Corner[1], T.Corner[2]);
+				const math::vec<float, 3> AB(T.Edge[0][0], T.Edge[0][1], T.Edge[0][2]);
+				const math::vec<float, 3> AC(T.Edge[1][0], T.Edge[1][1], T.Edge[1][2]);
+				if (touches(A, AB, AC, aCenter, Radius2)) Found.push_back(T.Index);
+			}
+		});
+		return Found;
+	}
+
+	// ------------------------- Instance Hierarchy ------------------------- //
+
+	instance_bvh::instance::instance() {
+		this->Node = nullptr;
+	}
+
+	instance_bvh::instance::instance(std::shared_ptr<triangle_bvh> aMesh, const math::affine<float>& aTransform, node* aNode) {
+		this->Mesh			= aMesh;
+		this->Transform		= aTransform;
+		this->Node			= aNode;
+	}
+
+	instance_bvh::instance_bvh() {
+		this->LeafSize = 2;
+	}
+
+	void instance_bvh::build(const std::vector<instance>& aInstance) {
+		this->Instance = aInstance;
+		// Only placeable instances go into the hierarchy, Item maps its slots back to Instance.
+		std::vector<uint32_t> Placed;
+		std::vector<aabb> Box;
+		for (uint32_t i = 0; i < this->Instance.size(); i++) {
+			instance& I = this->Instance[i];
+			if ((I.Mesh == nullptr) || I.Mesh->empty()) continue;
+			const math::mat<float, 3, 3>& L = I.Transform.Linear;
+			const math::mat<float, 3, 3> Adjugate = math::adjugate(L);
+			const float Determinant = L(0, 0) * Adjugate(0, 0) + L(0, 1) * Adjugate(1, 0) + L(0, 2) * Adjugate(2, 0);
+			if (std::abs(Determinant) <= std::numeric_limits<float>::min()) continue;
+			I.Inverse.Linear = Adjugate * (1.0f / Determinant);
+			I.Inverse.Translation = -(I.Inverse.Linear * I.Transform.Translation);
+			// World box of the mesh box, each axis spans the absolute row of the map over the half extent.
+			const aabb& Local = I.Mesh->Bounds;
+			const math::vec<float, 3> Center = I.Transform.transform_point(Local.center());
+			const math::vec<float, 3> Half = (Local.Max - Local.Min) * 0.5f;
+			math::vec<float, 3> Extent;
+			for (int r = 0; r < 3; r++) {
+				Extent[r] = std::abs(L(r, 0)) * Half[0] + std::abs(L(r, 1)) * Half[1] + std::abs(L(r, 2)) * Half[2];
+			}
+			Placed.push_back(i);
+			Box.push_back(aabb(Center - Extent, Center + Extent));
+		}
+		bvh::build(Box, this->LeafSize);
+		for (uint32_t& S : this->Item) {
+			S = Placed[S];
+		}
+	}
+
+	hit instance_bvh::intersect(const ray& aRay) const {
+		hit Hit;
+		ray_state R = prepare(aRay.Origin, aRay.Direction, aRay.Length);
+		trace(*this, R, [&](uint32_t aFirst, uint32_t aCount) {
+			for (uint32_t s = aFirst; s < aFirst + aCount; s++) {
+				const instance& I = this->Instance[this->Item[s]];
+				ray_state Local = prepare(R, I.Inverse);
+				closest(*I.Mesh, Local, Hit, this->Item[s]);
+				R.Far = Local.Far;
+			}
+			return false;
+		});
+		return Hit;
+	}
+
+	bool instance_bvh::occluded(const ray& aRay) const {
+		bool Found = false;
+		ray_state R = prepare(aRay.Origin, aRay.Direction, aRay.Length);
+		trace(*this, R, [&](uint32_t aFirst, uint32_t aCount) {
+			for (uint32_t s = aFirst; s < aFirst + aCount; s++) {
+				const instance& I = this->Instance[this->Item[s]];
+				if (any(*I.Mesh, prepare(R, I.Inverse))) return Found = true;
+			}
+			return false;
+		});
+		return Found;
+	}
+
+	std::vector<hit> instance_bvh::intersect(const std::vector<ray>& aRay) const {
+		std::vector<hit> Hit(aRay.size());
+		const std::ptrdiff_t PacketCount = (aRay.size() + PacketSize - 1) / PacketSize;
+		#pragma omp parallel for schedule(dynamic, 4) if(PacketCount > 4)
+		for (std::ptrdiff_t p = 0; p < PacketCount; p++) {
+			packet P, Local;
+			const int Count = (int)std::min<std::size_t>(PacketSize, aRay.size() - p * PacketSize);
+			if (!coherent(&aRay[p * PacketSize], Count)) {
+				for (int r = 0; r < Count; r++) {
+					Hit[p * PacketSize + r] = this->intersect(aRay[p * PacketSize + r]);
+				}
+				continue;
+			}
+			gather(P, &aRay[p * PacketSize], Count);
+			hit* PacketHit = &Hit[p * PacketSize];
+			trace(*this, P, [&](uint32_t aFirst, uint32_t aCount, uint32_t aMask) {
+				for (uint32_t s = aFirst; s < aFirst + aCount; s++) {
+					const instance& I = this->Instance[this->Item[s]];
+					transform(P, aMask, I.Inverse, Local);
+					closest(*I.Mesh, Local, PacketHit, this->Item[s]);
+					for (int r = 0; r < PacketSize; r++) {
+						if ((aMask >> r) & 1u) P.Far[r] = Local.Far[r];
+					}
+				}
+				return 0u;
+			});
+		}
+		return Hit;
+	}
+
+	std::vector<uint8_t> instance_bvh::occluded(const std::vector<ray>& aRay) const {
+		std::vector<uint8_t> Blocked(aRay.size());
+		const std::ptrdiff_t PacketCount = (aRay.size() + PacketSize - 1) / PacketSize;
+		#pragma omp parallel for schedule(dynamic, 4) if(PacketCount > 4)
+		for (std::ptrdiff_t p = 0; p < PacketCount; p++) {
+			packet P, Local;
+			const int Count = (int)std::min<std::size_t>(PacketSize, aRay.size() - p * PacketSize);
+			if (!coherent(&aRay[p * PacketSize], Count)) {
+				for (int r = 0; r < Count; r++) {
+					Blocked[p * PacketSize + r] = this->occluded(aRay[p * PacketSize + r]);
+				}
+				continue;
+			}
+			gather(P, &aRay[p * PacketSize], Count);
+			uint32_t Mask = 0;
+			trace(*this, P, [&](uint32_t aFirst, uint32_t aCount, uint32_t aMask) {
+				for (uint32_t s = aFirst; (s < aFirst + aCount) && (aMask & ~Mask); s++) {
+					const instance& I = this->Instance[this->Item[s]];
+					transform(P, aMask & ~Mask, I.Inverse, Local);
+					Mask |= any(*I.Mesh, Local);
+				}
+				return Mask;
+			});
+			for (int r = 0; r < Count; r++) {
+				Blocked[p * PacketSize + r] = (Mask >> r) & 1u;
+			}
+		}
+		return Blocked;
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> instance_bvh::overlap(const math::vec<float, 3>& aCenter, float aRadius) const {
+		std::vector<std::pair<uint32_t, uint32_t>> Found;
+		const float Radius2 = aRadius * aRadius;
+		collision::overlap(*this, [&](const volume& aVolume) { return sphere(aVolume, aCenter, Radius2); }, [&](uint32_t aFirst, uint32_t aCount) {
+			for (uint32_t s = aFirst; s < aFirst + aCount; s++) {
+				const uint32_t Index = this->Item[s];
+				const instance& I = this->Instance[Index];
+				// The sphere's box carried into mesh space selects candidates, which are tested
+				// exactly in world space since a scaled sphere is no longer one.
+				const math::vec<float, 3> Center = I.Inverse.transform_point(aCenter);
+				math::vec<float, 3> Extent;
+				for (int r = 0; r < 3; r++) {
+					Extent[r] = (std::abs(I.Inverse.Linear(r, 0)) + std::abs(I.Inverse.Linear(r, 1)) + std::abs(I.Inverse.Linear(r, 2))) * aRadius;
+				}
+				const aabb Local(Center - Extent, Center + Extent);
+				const triangle_bvh& Mesh = *I.Mesh;
+				collision::overlap(Mesh, [&](const volume& aVolume) { return box(aVolume, Local); }, [&](uint32_t aTriangle, uint32_t aTriangleCount) {
+					for (uint32_t t = aTriangle; t < aTriangle + aTriangleCount; t++) {
+						const triangle_bvh::triangle& T = Mesh.Triangle[t];
+						const math::vec<float, 3> A = I.Transform.transform_point(math::vec<float, 3>(T.Corner[0], T.Corner[1], T.Corner[2]));
+						const math::vec<float, 3> AB = I.Transform.Linear * math::vec<float, 3>(T.Edge[0][0], T.Edge[0][1], T.Edge[0][2]);
+						const math::vec<float, 3> AC = I.Transform.Linear * math::vec<float, 3>(T.Edge[1][0], T.Edge[1][1], T.Edge[1][2]);
+						if (touches(A, AB, AC, aCenter, Radius2)) Found.emplace_back(Index, T.Index);
+					}
+				});
+			}
+		});
+		return Found;
+	}
+
+}
@@ -1,11 +1,726 @@
 #include <geodesy/core/phys/collision.h>
 
-namespace geodesy::core::phys {
-    
-    // Collision detection function.
-    // bool detect_collision(const node& a, const node& b) {
-    //     // Implement collision detection logic here.
-    //     return false;
-    // }
-    
-} // namespace geodesy::core::phys
+#include <geodesy/core/phys/node.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <omp.h>
+
+namespace geodesy::core::phys::collision {
+
+	aabb::aabb() {
+		this->Min = math::vec<float, 3>( std::numeric_limits<float>::max(),		std::numeric_limits<float>::max(),	std::numeric_limits<float>::max());
+		this->Max = math::vec<float, 3>(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+	}
+
+	aabb::aabb(const math::vec<float, 3>& aMin, const math::vec<float, 3>& aMax) {
+		this->Min = aMin;
+		this->Max = aMax;
+	}
+
+	// Box around a box centered at aCenter, with half extents aExtent along the columns of aLinear.
+	static aabb place(const math::vec<float, 3>& aCenter, const math::mat<float, 3, 3>& aLinear, const math::vec<float, 3>& aExtent) {
+		math::vec<float, 3> Half;
+		for (std::size_t i = 0; i < 3; i++) {
+			Half[i] = std::abs(aLinear(i, 0)) * aExtent[0] + std::abs(aLinear(i, 1)) * aExtent[1] + std::abs(aLinear(i, 2)) * aExtent[2];
+		}
+		return aabb(aCenter - Half, aCenter + Half);
+	}
+
+	aabb bounds(const mesh& aMesh, const math::affine<float>& aTransform) {
+		const mesh::bounds& B = aMesh.Bounds;
+		math::vec<float, 3> Center = aTransform.transform_point(B.empty() ? aMesh.CenterOfMass : B.Center);
+		float Radius = B.empty() ? math::length(aMesh.BoundingRadius) : B.Radius;
+		// A sphere under a linear map spans the length of each row of the map along that axis.
+		math::vec<float, 3> Extent;
+		for (std::size_t i = 0; i < 3; i++) {
+			float Row = 0.0f;
+			for (std::size_t j = 0; j < 3; j++) {
+				Row += aTransform.Linear(i, j) * aTransform.Linear(i, j);
+			}
+			Extent[i] = Radius * std::sqrt(Row);
+		}
+		aabb Out(Center - Extent, Center + Extent);
+		if (B.empty()) return Out;
+
+		// Each volume bounds the mesh, so does the overlap of their boxes.
+		const aabb Box[2] = {
+			place(aTransform.transform_point((B.Min + B.Max) * 0.5f), aTransform.Linear, (B.Max - B.Min) * 0.5f),
+			place(aTransform.transform_point(B.BoxCenter), aTransform.Linear * B.BoxAxis, B.BoxExtent)
+		};
+		for (const aabb& A : Box) {
+			for (std::size_t i = 0; i < 3; i++) {
+				Out.Min[i] = std::max(Out.Min[i], A.Min[i]);
+				Out.Max[i] = std::min(Out.Max[i], A.Max[i]);
+			}
+		}
+		return Out;
+	}
+
+	aabb bounds(const node* aNode) {
+		return bounds(*aNode->CollisionMesh, aNode->GlobalTransform);
+	}
+
+	// Enlarges bounds by the margin on every side and by the predicted motion along the displacement.
+	static aabb fatten(const aabb& aBounds, const math::vec<float, 3>& aDisplacement, float aMargin, float aPrediction) {
+		aabb Out = aBounds;
+		for (std::size_t i = 0; i < 3; i++) {
+			float Reach = aDisplacement[i] * aPrediction;
+			Out.Min[i] -= aMargin - std::min(Reach, 0.0f);
+			Out.Max[i] += aMargin + std::max(Reach, 0.0f);
+		}
+		return Out;
+	}
+
+	std::shared_ptr<broad_phase> broad_phase::create(method aMethod) {
+		switch (aMethod) {
+		case DYNAMIC_TREE:			return std::make_shared<dynamic_tree>();
+		case SWEEP_AND_PRUNE:		return std::make_shared<sweep_and_prune>();
+		default:					throw std::invalid_argument("collision::broad_phase: unknown broad phase method.");
+		}
+	}
+
+	broad_phase::~broad_phase() {}
+
+	std::vector<std::pair<node*, node*>> broad_phase::find_pairs() const {
+		// A few contiguous runs of work items per thread, each with its own list, so uneven items
+		// still balance and the result is the same as a serial pass.
+		const std::size_t Count = this->work_count();
+		const std::size_t RunCount = std::max<std::size_t>(1, std::min<std::size_t>(Count, 4 * (std::size_t)omp_get_max_threads()));
+		std::vector<std::vector<std::pair<node*, node*>>> Local(RunCount);
+		#pragma omp parallel for schedule(dynamic) if(this->size() > 1024)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)RunCount; i++) {
+			std::size_t Start = (Count * i) / RunCount;
+			std::size_t End = (Count * (i + 1)) / RunCount;
+			this->find_pairs(Start, End - Start, Local[i]);
+		}
+
+		std::size_t Total = 0;
+		for (const auto& L : Local) Total += L.size();
+		std::vector<std::pair<node*, node*>> Pair;
+		Pair.reserve(Total);
+		for (const auto& L : Local) Pair.insert(Pair.end(), L.begin(), L.end());
+		return Pair;
+	}
+
+	dynamic_tree::dynamic_tree(float aMargin, float aPrediction) {
+		this->Margin		= aMargin;
+		this->Prediction	= aPrediction;
+		this->Root			= null;
+		this->FreeList		= null;
+		this->LeafCount		= 0;
+		this->Stamp			= 0;
+	}
+
+	int dynamic_tree::insert(node* aNode, const aabb& aBounds) {
+		auto It = this->Proxy.find(aNode);
+		if (It != this->Proxy.end()) {
+			this->move(aNode, aBounds, math::vec<float, 3>(0.0f, 0.0f, 0.0f));
+			return It->second;
+		}
+		int Leaf = this->allocate();
+		this->Volume[Leaf].Owner	= aNode;
+		this->Volume[Leaf].Box		= fatten(aBounds, math::vec<float, 3>(0.0f, 0.0f, 0.0f), this->Margin, this->Prediction);
+		this->Volume[Leaf].Height	= 0;
+		this->Tight[Leaf]			= aBounds;
+		this->Seen[Leaf]			= this->Stamp;
+		this->insert_leaf(Leaf);
+		this->Proxy[aNode] = Leaf;
+		this->LeafCount++;
+		this->reset_task();
+		return Leaf;
+	}
+
+	void dynamic_tree::remove(node* aNode) {
+		auto It = this->Proxy.find(aNode);
+		if (It == this->Proxy.end()) return;
+		int Leaf = It->second;
+		this->Proxy.erase(It);
+		this->remove_leaf(Leaf);
+		this->release(Leaf);
+		this->LeafCount--;
+		this->reset_task();
+	}
+
+	bool dynamic_tree::move(node* aNode, const aabb& aBounds, const math::vec<float, 3>& aDisplacement) {
+		auto It = this->Proxy.find(aNode);
+		if (It == this->Proxy.end()) {
+			this->insert(aNode, aBounds);
+			return true;
+		}
+		int Leaf = It->second;
+		aabb Fat = fatten(aBounds, aDisplacement, this->Margin, this->Prediction);
+		this->Tight[Leaf] = aBounds;
+		// Keep the leaf while it still encloses the node, unless it has grown stale after fast motion.
+		if (this->Volume[Leaf].Box.contains(aBounds) && (this->Volume[Leaf].Box.area() <= 4.0f * Fat.area())) {
+			return false;
+		}
+		this->remove_leaf(Leaf);
+		this->Volume[Leaf].Box = Fat;
+		this->insert_leaf(Leaf);
+		this->reset_task();
+		return true;
+	}
+
+	void dynamic_tree::update(const std::vector<node*>& aNodeList) {
+		this->Stamp++;
+
+		// Only nodes with collision geometry take part.
+		std::vector<node*> Body;
+		Body.reserve(aNodeList.size());
+		for (node* N : aNodeList) {
+			if ((N != nullptr) && (N->CollisionMesh != nullptr)) {
+				Body.push_back(N);
+			}
+		}
+
+		// Bounds and containment tests are independent per node, only the tree edits are serial.
+		std::vector<aabb> Bounds(Body.size());
+		std::vector<int> Leaf(Body.size(), null);
+		std::vector<char> Dirty(Body.size(), 0);
+		#pragma omp parallel for if(Body.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)Body.size(); i++) {
+			Bounds[i] = bounds(Body[i]);
+			int L = null;
+			if ((i < (std::ptrdiff_t)this->Order.size()) && (this->Order[i].first == Body[i])) {
+				L = this->Order[i].second;
+			}
+			else {
+				auto It = this->Proxy.find(Body[i]);
+				if (It == this->Proxy.end()) continue;
+				L = It->second;
+			}
+			const aabb& Fat = this->Volume[L].Box;
+			Leaf[i] = L;
+			this->Seen[L] = this->Stamp;
+			if (Fat.contains(Bounds[i]) && (Fat.area() <= 4.0f * fatten(Bounds[i], Bounds[i].center() - this->Tight[L].center(), this->Margin, this->Prediction).area())) {
+				this->Tight[L] = Bounds[i];
+			}
+			else {
+				Dirty[i] = 1;
+			}
+		}
+
+		for (std::size_t i = 0; i < Body.size(); i++) {
+			if (Leaf[i] == null) {
+				this->insert(Body[i], Bounds[i]);
+			}
+			else if (Dirty[i]) {
+				this->move(Body[i], Bounds[i], Bounds[i].center() - this->Tight[Leaf[i]].center());
+			}
+		}
+
+		// Leaves not seen this step belong to nodes that no longer exist, their owners are not touched.
+		for (std::size_t i = 0; i < this->Volume.size(); i++) {
+			if ((this->Volume[i].Height == 0) && (this->Seen[i] != this->Stamp)) {
+				this->remove(this->Volume[i].Owner);
+			}
+		}
+
+		this->Order.resize(Body.size());
+		for (std::size_t i = 0; i < Body.size(); i++) {
+			this->Order[i] = { Body[i], Leaf[i] == null ? this->Proxy[Body[i]] : Leaf[i] };
+		}
+
+		// The tree is final for this step, split its traversal once for every find_pairs() call.
+		this->split(this->Task);
+	}
+
+	std::size_t dynamic_tree::work_count() const {
+		return this->Task.size();
+	}
+
+	void dynamic_tree::find_pairs(std::size_t aStart, std::size_t aCount, std::vector<std::pair<node*, node*>>& aPair) const {
+		std::vector<task> Stack;
+		Stack.reserve(128);
+		task Child[3];
+		for (std::size_t t = aStart; t < std::min(aStart + aCount, this->Task.size()); t++) {
+			Stack.push_back(this->Task[t]);
+			while (!Stack.empty()) {
+				const task T = Stack.back();
+				Stack.pop_back();
+				int ChildCount = this->expand(T, Child);
+				if (ChildCount >= 0) {
+					Stack.insert(Stack.end(), Child, Child + ChildCount);
+					continue;
+				}
+				const volume& A = this->Volume[T.first];
+				const volume& B = this->Volume[T.second];
+				if (this->Tight[T.first].overlaps(this->Tight[T.second]) && (A.Owner->Root != B.Owner->Root)) {
+					aPair.emplace_back(A.Owner, B.Owner);
+				}
+			}
+		}
+	}
+
+	// The tree is collided against itself, a task (A, B) covers the overlapping leaf pairs between
+	// subtrees A and B, and (A, A) those within A. This visits each overlapping pair of subtrees
+	// once instead of querying every leaf from the root. The top of the traversal is expanded until
+	// there are enough tasks to share out, the split only depends on the tree so the pairs come out
+	// in the same order for any thread count.
+	void dynamic_tree::split(std::vector<task>& aTask) const {
+		aTask.clear();
+		if (this->Root == null) return;
+		aTask.emplace_back(this->Root, this->Root);
+		const std::size_t TaskTarget = 256;
+		bool Split = true;
+		task Child[3];
+		while (Split && (aTask.size() < TaskTarget)) {
+			Split = false;
+			std::vector<task> Next;
+			Next.reserve(3 * aTask.size());
+			for (const task& T : aTask) {
+				int ChildCount = this->expand(T, Child);
+				if (ChildCount < 0) {
+					Next.push_back(T);
+				}
+				else {
+					Next.insert(Next.end(), Child, Child + ChildCount);
+					Split |= ChildCount > 0;
+				}
+			}
+			aTask.swap(Next);
+		}
+	}
+
+	// Edits outside update() leave a single task over the whole tree, which is valid for any tree
+	// but not shared out between threads until the next update() splits it.
+	void dynamic_tree::reset_task() {
+		this->Task.clear();
+		if (this->Root != null) this->Task.emplace_back(this->Root, this->Root);
+	}
+
+	// Writes the subtasks of a task and returns their count, or -1 if the task is a pair of leaves
+	// whose fat boxes overlap.
+	int dynamic_tree::expand(const task& aTask, task* aChild) const {
+		const volume& A = this->Volume[aTask.first];
+		const volume& B = this->Volume[aTask.second];
+		if (aTask.first == aTask.second) {
+			if (A.is_leaf()) return 0;
+			aChild[0] = task(A.Left, A.Left);
+			aChild[1] = task(A.Right, A.Right);
+			aChild[2] = task(A.Left, A.Right);
+			return 3;
+		}
+		if (!A.Box.overlaps(B.Box)) return 0;
+		if (A.is_leaf() && B.is_leaf()) return -1;
+		// Descend into the larger of the two so the boxes being compared stay similar in size.
+		if (B.is_leaf() || (!A.is_leaf() && (A.Box.area() > B.Box.area()))) {
+			aChild[0] = task(A.Left, aTask.second);
+			aChild[1] = task(A.Right, aTask.second);
+		}
+		else {
+			aChild[0] = task(aTask.first, B.Left);
+			aChild[1] = task(aTask.first, B.Right);
+		}
+		return 2;
+	}
+
+	std::size_t dynamic_tree::size() const {
+		return this->LeafCount;
+	}
+
+	int dynamic_tree::height() const {
+		return this->Root == null ? 0 : this->Volume[this->Root].Height;
+	}
+
+	float dynamic_tree::area_ratio() const {
+		if (this->Root == null) return 0.0f;
+		float Total = 0.0f;
+		for (const volume& V : this->Volume) {
+			if (V.Height > 0) Total += V.Box.area();
+		}
+		return Total / this->Volume[this->Root].Box.area();
+	}
+
+	int dynamic_tree::allocate() {
+		if (this->FreeList == null) {
+			this->Volume.emplace_back();
+			this->Tight.emplace_back();
+			this->Seen.push_back(0);
+			this->FreeList = (int)this->Volume.size() - 1;
+			this->Volume[this->FreeList].Parent = null;
+		}
+		int Index = this->FreeList;
+		this->FreeList = this->Volume[Index].Parent;
+		volume& V = this->Volume[Index];
+		V.Parent	= null;
+		V.Left		= null;
+		V.Right		= null;
+		V.Height	= 0;
+		V.Owner		= nullptr;
+		return Index;
+	}
+
+	void dynamic_tree::release(int aIndex) {
+		this->Volume[aIndex].Parent = this->FreeList;
+		this->Volume[aIndex].Height = -1;
+		this->Volume[aIndex].Owner = nullptr;
+		this->FreeList = aIndex;
+	}
+
+	void dynamic_tree::insert_leaf(int aLeaf) {
+		if (this->Root == null) {
+			this->Root = aLeaf;
+			this->Volume[aLeaf].Parent = null;
+			return;
+		}
+
+		// Descend toward the sibling that minimizes the area added to the tree, stopping
+		// once pairing with the current volume is cheaper than going deeper.
+		const aabb Box = this->Volume[aLeaf].Box;
+		int Index = this->Root;
+		while (!this->Volume[Index].is_leaf()) {
+			const volume& V = this->Volume[Index];
+			float Area = V.Box.area();
+			float CombinedArea = merge(V.Box, Box).area();
+			float Cost = 2.0f * CombinedArea;
+			float InheritanceCost = 2.0f * (CombinedArea - Area);
+			float ChildCost[2];
+			int Child[2] = { V.Left, V.Right };
+			for (int k = 0; k < 2; k++) {
+				const volume& C = this->Volume[Child[k]];
+				ChildCost[k] = merge(C.Box, Box).area() + InheritanceCost;
+				if (!C.is_leaf()) ChildCost[k] -= C.Box.area();
+			}
+			if ((Cost < ChildCost[0]) && (Cost < ChildCost[1])) break;
+			Index = ChildCost[0] < ChildCost[1] ? Child[0] : Child[1];
+		}
+		const int Sibling = Index;
+
+		// Splice a new parent between the sibling and its old parent.
+		const int OldParent = this->Volume[Sibling].Parent;
+		const int NewParent = this->allocate();
+		this->Volume[NewParent].Parent	= OldParent;
+		this->Volume[NewParent].Box		= merge(Box, this->Volume[Sibling].Box);
+		this->Volume[NewParent].Height	= this->Volume[Sibling].Height + 1;
+		this->Volume[NewParent].Left	= Sibling;
+		this->Volume[NewParent].Right	= aLeaf;
+		this->Volume[Sibling].Parent	= NewParent;
+		this->Volume[aLeaf].Parent		= NewParent;
+		if (OldParent == null) {
+			this->Root = NewParent;
+		}
+		else if (this->Volume[OldParent].Left == Sibling) {
+			this->Volume[OldParent].Left = NewParent;
+		}
+		else {
+			this->Volume[OldParent].Right = NewParent;
+		}
+
+		this->refit(this->Volume[aLeaf].Parent);
+	}
+
+	void dynamic_tree::remove_leaf(int aLeaf) {
+		if (aLeaf == this->Root) {
+			this->Root = null;
+			return;
+		}
+
+		// The parent is dropped and the sibling takes its place.
+		const int Parent = this->Volume[aLeaf].Parent;
+		const int GrandParent = this->Volume[Parent].Parent;
+		const int Sibling = this->Volume[Parent].Left == aLeaf ? this->Volume[Parent].Right : this->Volume[Parent].Left;
+		this->Volume[Sibling].Parent = GrandParent;
+		if (GrandParent == null) {
+			this->Root = Sibling;
+		}
+		else {
+			if (this->Volume[GrandParent].Left == Parent) {
+				this->Volume[GrandParent].Left = Sibling;
+			}
+			else {
+				this->Volume[GrandParent].Right = Sibling;
+			}
+			this->refit(GrandParent);
+		}
+		this->release(Parent);
+		this->Volume[aLeaf].Parent = null;
+	}
+
+	// Walks to the root rebalancing and recomputing heights and boxes.
+	void dynamic_tree::refit(int aIndex) {
+		while (aIndex != null) {
+			aIndex = this->balance(aIndex);
+			volume& V = this->Volume[aIndex];
+			const volume& L = this->Volume[V.Left];
+			const volume& R = this->Volume[V.Right];
+			V.Height = 1 + std::max(L.Height, R.Height);
+			V.Box = merge(L.Box, R.Box);
+			aIndex = V.Parent;
+		}
+	}
+
+	// If the subtree at aIndex is unbalanced by more than one level, the taller child is rotated
+	// up to take its place. Returns the index now at the top of the subtree.
+	int dynamic_tree::balance(int aIndex) {
+		const int A = aIndex;
+		if (this->Volume[A].is_leaf() || (this->Volume[A].Height < 2)) return A;
+
+		const int B = this->Volume[A].Left;
+		const int C = this->Volume[A].Right;
+		const int Skew = this->Volume[C].Height - this->Volume[B].Height;
+		if ((Skew >= -1) && (Skew <= 1)) return A;
+
+		// Up is the child rotated above A, Stay is A's other child.
+		const bool RotateRight = Skew > 1;
+		const int Up = RotateRight ? C : B;
+		const int Stay = RotateRight ? B : C;
+		const int F = this->Volume[Up].Left;
+		const int G = this->Volume[Up].Right;
+
+		// Up replaces A under A's parent, and A becomes a child of Up.
+		this->Volume[Up].Left = A;
+		this->Volume[Up].Parent = this->Volume[A].Parent;
+		this->Volume[A].Parent = Up;
+		const int P = this->Volume[Up].Parent;
+		if (P == null) {
+			this->Root = Up;
+		}
+		else if (this->Volume[P].Left == A) {
+			this->Volume[P].Left = Up;
+		}
+		else {
+			this->Volume[P].Right = Up;
+		}
+
+		// Up keeps its taller grandchild, the shorter one moves into the slot Up vacated in A.
+		const int Keep = this->Volume[F].Height > this->Volume[G].Height ? F : G;
+		const int Give = Keep == F ? G : F;
+		this->Volume[Up].Right = Keep;
+		if (RotateRight) {
+			this->Volume[A].Right = Give;
+		}
+		else {
+			this->Volume[A].Left = Give;
+		}
+		this->Volume[Give].Parent = A;
+
+		this->Volume[A].Box = merge(this->Volume[Stay].Box, this->Volume[Give].Box);
+		this->Volume[A].Height = 1 + std::max(this->Volume[Stay].Height, this->Volume[Give].Height);
+		this->Volume[Up].Box = merge(this->Volume[A].Box, this->Volume[Keep].Box);
+		this->Volume[Up].Height = 1 + std::max(this->Volume[A].Height, this->Volume[Keep].Height);
+		return Up;
+	}
+
+	sweep_and_prune::sweep_and_prune(int aAxis) {
+		if ((aAxis < X) || (aAxis > ALL)) {
+			throw std::invalid_argument("collision::sweep_and_prune: axis must be X, Y, Z or ALL.");
+		}
+		this->Axis			= aAxis;
+		this->SweepAxis		= aAxis == ALL ? X : aAxis;
+		this->Stamp			= 0;
+	}
+
+	void sweep_and_prune::update(const std::vector<node*>& aNodeList) {
+		this->Stamp++;
+		const int AxisStart = this->Axis == ALL ? X : this->Axis;
+		const int AxisEnd = this->Axis == ALL ? Z : this->Axis;
+
+		std::vector<node*> Body;
+		Body.reserve(aNodeList.size());
+		for (node* N : aNodeList) {
+			if ((N != nullptr) && (N->CollisionMesh != nullptr)) {
+				Body.push_back(N);
+			}
+		}
+
+		// Refresh the bounds of known proxies in parallel.
+		std::vector<uint32_t> Index(Body.size(), null);
+		std::vector<aabb> Bounds(Body.size());
+		#pragma omp parallel for if(Body.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)Body.size(); i++) {
+			Bounds[i] = bounds(Body[i]);
+			uint32_t P = null;
+			if ((i < (std::ptrdiff_t)this->Order.size()) && (this->Order[i].first == Body[i])) {
+				P = this->Order[i].second;
+			}
+			else {
+				auto It = this->Proxy.find(Body[i]);
+				if (It == this->Proxy.end()) continue;
+				P = It->second;
+			}
+			Index[i] = P;
+			this->Box[P] = Bounds[i];
+			this->Seen[P] = this->Stamp;
+		}
+
+		// New nodes get a proxy and two endpoints per sorted axis, the values are written below.
+		std::size_t Inserted = 0;
+		for (std::size_t i = 0; i < Body.size(); i++) {
+			if (Index[i] != null) continue;
+			auto It = this->Proxy.find(Body[i]);
+			if (It != this->Proxy.end()) {
+				Index[i] = It->second;
+				continue;
+			}
+			uint32_t P;
+			if (this->FreeList.size() > 0) {
+				P = this->FreeList.back();
+				this->FreeList.pop_back();
+			}
+			else {
+				P = (uint32_t)this->Owner.size();
+				this->Owner.push_back(nullptr);
+				this->Box.emplace_back();
+				this->Seen.push_back(0);
+			}
+			this->Owner[P] = Body[i];
+			this->Box[P] = Bounds[i];
+			this->Seen[P] = this->Stamp;
+			this->Proxy[Body[i]] = P;
+			Index[i] = P;
+			for (int a = AxisStart; a <= AxisEnd; a++) {
+				this->Value[a].push_back(0.0f);
+				this->Value[a].push_back(0.0f);
+				this->Handle[a].push_back(P << 1);
+				this->Handle[a].push_back((P << 1) | 1);
+			}
+			Inserted++;
+		}
+
+		// Proxies not listed this step belong to nodes that no longer exist, their endpoints are
+		// dropped without disturbing the order of the rest.
+		std::size_t Removed = 0;
+		for (uint32_t P = 0; P < (uint32_t)this->Owner.size(); P++) {
+			if ((this->Owner[P] != nullptr) && (this->Seen[P] != this->Stamp)) {
+				this->Proxy.erase(this->Owner[P]);
+				this->Owner[P] = nullptr;
+				this->FreeList.push_back(P);
+				Removed++;
+			}
+		}
+
+		#pragma omp parallel for if(AxisEnd > AxisStart)
+		for (int a = AxisStart; a <= AxisEnd; a++) {
+			std::vector<float>& V = this->Value[a];
+			std::vector<uint32_t>& H = this->Handle[a];
+			if (Removed > 0) {
+				std::size_t Kept = 0;
+				for (std::size_t k = 0; k < H.size(); k++) {
+					if (this->Owner[H[k] >> 1] != nullptr) {
+						H[Kept++] = H[k];
+					}
+				}
+				H.resize(Kept);
+				V.resize(Kept);
+			}
+			for (std::size_t k = 0; k < H.size(); k++) {
+				const aabb& B = this->Box[H[k] >> 1];
+				V[k] = (H[k] & 1) ? B.Max[a] : B.Min[a];
+			}
+			// Insertion sort is only worth it while the array is nearly in order.
+			this->sort(a, Inserted > 64);
+		}
+
+		// The multi-axis variant sweeps along the axis with the largest spread of centers.
+		if (this->Axis == ALL) {
+			double Sum[3] = { 0.0, 0.0, 0.0 };
+			double SumSquare[3] = { 0.0, 0.0, 0.0 };
+			for (std::size_t i = 0; i < Body.size(); i++) {
+				math::vec<float, 3> C = Bounds[i].center();
+				for (int a = X; a <= Z; a++) {
+					Sum[a] += C[a];
+					SumSquare[a] += (double)C[a] * C[a];
+				}
+			}
+			double Best = -1.0;
+			for (int a = X; a <= Z; a++) {
+				double Variance = SumSquare[a] - Sum[a] * Sum[a] / std::max<double>(1.0, (double)Body.size());
+				if (Variance > Best) {
+					Best = Variance;
+					this->SweepAxis = a;
+				}
+			}
+		}
+
+		// Copy the other two axes of each body into sweep order so the pair scan streams through
+		// memory instead of gathering boxes. Max endpoints get an empty range and never match.
+		const std::vector<uint32_t>& H = this->Handle[this->SweepAxis];
+		const int U = (this->SweepAxis + 1) % 3;
+		const int W = (this->SweepAxis + 2) % 3;
+		for (int c = 0; c < 4; c++) {
+			this->Cross[c].resize(H.size());
+		}
+		#pragma omp parallel for if(H.size() > 8192)
+		for (std::ptrdiff_t k = 0; k < (std::ptrdiff_t)H.size(); k++) {
+			const aabb& B = this->Box[H[k] >> 1];
+			const bool Open = (H[k] & 1) == 0;
+			this->Cross[0][k] = Open ? B.Min[U] : std::numeric_limits<float>::max();
+			this->Cross[1][k] = Open ? B.Max[U] : -std::numeric_limits<float>::max();
+			this->Cross[2][k] = Open ? B.Min[W] : std::numeric_limits<float>::max();
+			this->Cross[3][k] = Open ? B.Max[W] : -std::numeric_limits<float>::max();
+		}
+
+		this->Order.resize(Body.size());
+		for (std::size_t i = 0; i < Body.size(); i++) {
+			this->Order[i] = { Body[i], Index[i] };
+		}
+	}
+
+	std::size_t sweep_and_prune::size() const {
+		return this->Proxy.size();
+	}
+
+	std::size_t sweep_and_prune::work_count() const {
+		return this->Handle[this->SweepAxis].size();
+	}
+
+	void sweep_and_prune::find_pairs(std::size_t aStart, std::size_t aCount, std::vector<std::pair<node*, node*>>& aPair) const {
+		const std::vector<uint32_t>& H = this->Handle[this->SweepAxis];
+		const float* MinU = this->Cross[0].data();
+		const float* MaxU = this->Cross[1].data();
+		const float* MinW = this->Cross[2].data();
+		const float* MaxW = this->Cross[3].data();
+		const std::size_t End = std::min(aStart + aCount, H.size());
+		for (std::size_t k = aStart; k < End; k++) {
+			if (H[k] & 1) continue;
+			// Every min met before this body's own max opens a body overlapping it on the sweep axis.
+			const uint32_t Close = H[k] | 1;
+			node* Owner = this->Owner[H[k] >> 1];
+			for (std::size_t m = k + 1; (m < H.size()) && (H[m] != Close); m++) {
+				if ((MinU[k] <= MaxU[m]) & (MinU[m] <= MaxU[k]) & (MinW[k] <= MaxW[m]) & (MinW[m] <= MaxW[k])) {
+					node* Other = this->Owner[H[m] >> 1];
+					if (Other->Root != Owner->Root) {
+						aPair.emplace_back(Owner, Other);
+					}
+				}
+			}
+		}
+	}
+
+	// Endpoints are ordered by value, with mins ahead of maxes at equal values so touching boxes overlap.
+	void sweep_and_prune::sort(int aAxis, bool aFull) {
+		std::vector<float>& V = this->Value[aAxis];
+		std::vector<uint32_t>& H = this->Handle[aAxis];
+		if (aFull) {
+			std::vector<std::pair<float, uint32_t>> Endpoint(V.size());
+			for (std::size_t k = 0; k < V.size(); k++) {
+				Endpoint[k] = { V[k], H[k] };
+			}
+			std::sort(Endpoint.begin(), Endpoint.end(), [](const std::pair<float, uint32_t>& aLhs, const std::pair<float, uint32_t>& aRhs) {
+				return (aLhs.first < aRhs.first) || ((aLhs.first == aRhs.first) && ((aLhs.second & 1) < (aRhs.second & 1)));
+			});
+			for (std::size_t k = 0; k < V.size(); k++) {
+				V[k] = Endpoint[k].first;
+				H[k] = Endpoint[k].second;
+			}
+			return;
+		}
+		for (std::size_t i = 1; i < V.size(); i++) {
+			const float Key = V[i];
+			const uint32_t Tag = H[i];
+			std::size_t j = i;
+			while ((j > 0) && ((V[j - 1] > Key) || ((V[j - 1] == Key) && ((H[j - 1] & 1) > (Tag & 1))))) {
+				V[j] = V[j - 1];
+				H[j] = H[j - 1];
+				j--;
+			}
+			V[j] = Key;
+			H[j] = Tag;
+		}
+	}
+
+}
@@ -0,0 +1,251 @@
+#include <geodesy/core/phys/continuous.h>
+
+#include <geodesy/core/phys/node.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <omp.h>
+
+namespace geodesy::core::phys::collision {
+
+	motion::motion() {
+		this->Start				= math::vec<float, 3>(0.0f, 0.0f, 0.0f);
+		this->End				= math::vec<float, 3>(0.0f, 0.0f, 0.0f);
+		this->StartOrientation	= math::quaternion<float>(1.0f, 0.0f, 0.0f, 0.0f);
+		this->EndOrientation	= math::quaternion<float>(1.0f, 0.0f, 0.0f, 0.0f);
+		this->Scale				= math::vec<float, 3>(1.0f, 1.0f, 1.0f);
+		this->Angle				= 0.0f;
+		this->Reach				= 0.0f;
+	}
+
+	motion::motion(const math::affine<float>& aTransform) : motion() {
+		this->Offset = aTransform;
+	}
+
+	math::affine<float> motion::at(float aTime) const {
+		if (this->Angle == 0.0f) {
+			return math::affine<float>(this->Start + (this->End - this->Start) * aTime, this->StartOrientation, this->Scale) * this->Offset;
+		}
+		return math::affine<float>(this->Start + (this->End - this->Start) * aTime, math::slerp(this->StartOrientation, this->EndOrientation, aTime), this->Scale) * this->Offset;
+	}
+
+	bool sweep(const math::vec<float, 3>& aStartA, const math::vec<float, 3>& aEndA, float aRadiusA, const math::vec<float, 3>& aStartB, const math::vec<float, 3>& aEndB, float aRadiusB, float& aTime) {
+		//tex:
+		// $$ |\vec{p} + t \vec{v}|^{2} = (r_{A} + r_{B})^{2} $$
+		const math::vec<float, 3> p = aStartB - aStartA;
+		const math::vec<float, 3> v = (aEndB - aStartB) - (aEndA - aStartA);
+		const float Radius = aRadiusA + aRadiusB;
+		const float c = p * p - Radius * Radius;
+		if (c <= 0.0f) {
+			aTime = 0.0f;
+			return true;
+		}
+		const float a = v * v, b = p * v;
+		if ((a <= 0.0f) || (b >= 0.0f)) return false;
+		const float Discriminant = b * b - a * c;
+		if (Discriminant < 0.0f) return false;
+		const float t = (-b - std::sqrt(Discriminant)) / a;
+		if (t > 1.0f) return false;
+		aTime = std::max(t, 0.0f);
+		return true;
+	}
+
+	bool time_of_impact(const hull& aA, const motion& aMotionA, const hull& aB, const motion& aMotionB, float aSeparation, int aMaxIteration, float& aTime) {
+		const math::vec<float, 3> Relative = (aMotionA.End - aMotionA.Start) - (aMotionB.End - aMotionB.Start);
+		// Rotation moves no hull point further than the root's angle times its reach.
+		const float Spin = aMotionA.Angle * aMotionA.Reach + aMotionB.Angle * aMotionB.Reach;
+		simplex Simplex;
+		float Time = aTime;
+		for (int i = 0; i < aMaxIteration; i++) {
+			const proximity Result = gjk(aA, aMotionA.at(Time), aB, aMotionB.at(Time), Simplex);
+			// Only reachable through rounding, the last separated time stands.
+			if (Result.Intersecting) {
+				if (i == 0) return false;
+				break;
+			}
+			if (Result.Distance <= aSeparation) break;
+			const float Closing = Relative * Result.Normal + Spin;
+			if (Closing <= 0.0f) return false;
+			const float Next = Time + (Result.Distance - aSeparation) / Closing;
+			if (Next >= 1.0f) return false;
+			// Out of iterations the hulls are still apart, stopping short of the surface is safe.
+			if (i + 1 == aMaxIteration) break;
+			Time = Next;
+		}
+		aTime = Time;
+		return true;
+	}
+
+	// Largest factor a linear map stretches a length by, bounded by its largest row norm times
+	// the square root of three.
+	static float stretch(const math::mat<float, 3, 3>& aLinear) {
+		float Largest = 0.0f;
+		for (std::size_t i = 0; i < 3; i++) {
+			float Row = 0.0f;
+			for (std::size_t j = 0; j < 3; j++) {
+				Row += aLinear(i, j) * aLinear(i, j);
+			}
+			Largest = std::max(Largest, Row);
+		}
+		return std::sqrt(3.0f * Largest);
+	}
+
+	static aabb sphere_bounds(const math::vec<float, 3>& aCenter, float aRadius) {
+		const math::vec<float, 3> Extent(aRadius, aRadius, aRadius);
+		return aabb(aCenter - Extent, aCenter + Extent);
+	}
+
+	continuous::continuous(float aThreshold, float aSeparation, int aMaxIteration) {
+		this->Threshold			= aThreshold;
+		this->Separation		= aSeparation;
+		this->MaxIteration		= aMaxIteration;
+	}
+
+	void continuous::begin(const std::vector<node*>& aNodeList) {
+		std::vector<node*> Listed;
+		Listed.reserve(this->Body.size());
+		for (node* N : aNodeList) {
+			if ((N->Root == N) && (N->MotionType == node::motion::DYNAMIC) && !N->Sleeping) {
+				Listed.push_back(N);
+			}
+		}
+		if (Listed != this->Body) {
+			this->Body.swap(Listed);
+			this->Index.clear();
+			this->Index.reserve(this->Body.size());
+			for (std::size_t i = 0; i < this->Body.size(); i++) {
+				this->Index[this->Body[i]] = (uint32_t)i;
+			}
+		}
+		this->Start.resize(this->Body.size());
+		for (std::size_t i = 0; i < this->Body.size(); i++) {
+			this->Start[i].Position = this->Body[i]->Position;
+			this->Start[i].Orientation = this->Body[i]->Orientation;
+		}
+	}
+
+	int continuous::update(const std::vector<node*>& aNodeList, narrow_phase& aNarrowPhase) {
+		this->Collider.clear();
+		this->Fast.clear();
+		this->Impact.clear();
+		for (node* N : aNodeList) {
+			if ((N->CollisionMesh != nullptr) && (N->CollisionMesh->Vertex.size() > 0)) {
+				this->Collider.push_back(N);
+			}
+		}
+		this->Motion.resize(this->Collider.size());
+
+		// Colliders of recorded roots follow their root's path, GlobalTransform still holds the
+		// start of the step. The rest stay where they are.
+		std::vector<float> Radius(this->Collider.size());
+		std::vector<math::vec<float, 3>> Center(this->Collider.size()), Finish(this->Collider.size());
+		std::vector<aabb> Box(this->Collider.size());
+		std::vector<uint8_t> Swept(this->Collider.size(), 0);
+		#pragma omp parallel for if(this->Collider.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)this->Collider.size(); i++) {
+			const node* N = this->Collider[i];
+			const mesh& Mesh = *N->CollisionMesh;
+			Radius[i] = math::length(Mesh.BoundingRadius) * stretch(N->GlobalTransform.Linear);
+			Center[i] = N->GlobalTransform.transform_point(Mesh.CenterOfMass);
+			motion& M = this->Motion[i];
+			auto Recorded = this->Index.find(N->Root);
+			if ((Recorded == this->Index.end()) || (N->Root->MotionType != node::motion::DYNAMIC)) {
+				M = motion(N->GlobalTransform);
+				Finish[i] = Center[i];
+				Box[i] = sphere_bounds(Center[i], Radius[i]);
+				continue;
+			}
+			const pose& P = this->Start[Recorded->second];
+			const node* R = N->Root;
+			M.Start = P.Position;
+			M.End = R->Position;
+			M.StartOrientation = P.Orientation;
+			M.EndOrientation = R->Orientation;
+			M.Scale = R->Scale;
+			M.Offset = math::inverse(math::affine<float>(P.Position, P.Orientation, R->Scale)) * N->GlobalTransform;
+			const float Dot = std::abs(P.Orientation[0] * R->Orientation[0] + P.Orientation[1] * R->Orientation[1] + P.Orientation[2] * R->Orientation[2] + P.Orientation[3] * R->Orientation[3]);
+			M.Angle = 2.0f * std::acos(std::min(Dot, 1.0f));
+			const float Arm = math::length(Center[i] - P.Position);
+			M.Reach = Arm + Radius[i];
+			Finish[i] = M.at(1.0f).transform_point(Mesh.CenterOfMass);
+			const float Travel = math::length(M.End - M.Start) + M.Angle * M.Reach;
+			if (Travel > this->Threshold * Radius[i]) {
+				// The center strays from the straight line by no more than its arm times the angle.
+				Swept[i] = 1;
+				Radius[i] += Arm * M.Angle;
+				Box[i] = merge(sphere_bounds(Center[i], Radius[i]), sphere_bounds(Finish[i], Radius[i]));
+			}
+			else {
+				// Slow colliders are only met where they end up.
+				M = motion(M.at(1.0f));
+				Center[i] = Finish[i];
+				Box[i] = sphere_bounds(Center[i], Radius[i]);
+			}
+		}
+		for (uint32_t i = 0; i < this->Collider.size(); i++) {
+			if (Swept[i]) this->Fast.push_back(i);
+		}
+		if (this->Fast.empty()) return 0;
+
+		aNarrowPhase.build(this->Collider);
+		this->Tree.build(Box);
+
+		this->Impact.assign(this->Fast.size(), 1.0f);
+		#pragma omp parallel for schedule(dynamic, 4) if(this->Fast.size() > 16)
+		for (std::ptrdiff_t f = 0; f < (std::ptrdiff_t)this->Fast.size(); f++) {
+			const uint32_t i = this->Fast[f];
+			const node* A = this->Collider[i];
+			const hull& HullA = *aNarrowPhase.Hull.at(A->CollisionMesh.get());
+			std::vector<uint32_t> Candidate;
+			this->Tree.query(Box[i], Candidate);
+			float Earliest = 1.0f;
+			for (uint32_t j : Candidate) {
+				const node* B = this->Collider[j];
+				if ((B->Root == A->Root) || !Box[i].overlaps(Box[j])) continue;
+				// Bounding spheres first, the hulls cannot touch before their spheres do.
+				float Time = 0.0f;
+				if (!sweep(Center[i], Finish[i], Radius[i], Center[j], Swept[j] ? Finish[j] : Center[j], Radius[j], Time)) continue;
+				if (Time >= Earliest) continue;
+				const hull& HullB = *aNarrowPhase.Hull.at(B->CollisionMesh.get());
+				if (Time == 0.0f) {
+					// Pairs already within the margin have contacts of their own, which hold unless
+					// the step carried one hull clean through the other, as a spinning body can do
+					// past a single contact point. Such a pair ends up apart on the far side and
+					// the body keeps its start pose.
+					simplex Simplex;
+					const proximity Before = gjk(HullA, this->Motion[i].at(0.0f), HullB, this->Motion[j].at(0.0f), Simplex);
+					if (Before.Intersecting) continue;
+					if (Before.Distance <= aNarrowPhase.Margin) {
+						const proximity After = gjk(HullA, this->Motion[i].at(1.0f), HullB, this->Motion[j].at(1.0f), Simplex);
+						if (!After.Intersecting && (After.Normal * Before.Normal < 0.0f)) Earliest = 0.0f;
+						continue;
+					}
+				}
+				if (time_of_impact(HullA, this->Motion[i], HullB, this->Motion[j], this->Separation, this->MaxIteration, Time)) {
+					Earliest = std::min(Earliest, Time);
+				}
+			}
+			this->Impact[f] = Earliest;
+		}
+
+		// A root stops at the earliest impact of any of its colliders.
+		std::vector<float> Stop(this->Body.size(), 1.0f);
+		for (std::size_t f = 0; f < this->Fast.size(); f++) {
+			float& S = Stop[this->Index[this->Collider[this->Fast[f]]->Root]];
+			S = std::min(S, this->Impact[f]);
+		}
+		int Count = 0;
+		for (std::size_t b = 0; b < this->Body.size(); b++) {
+			if (Stop[b] >= 1.0f) continue;
+			node* R = this->Body[b];
+			const pose& P = this->Start[b];
+			R->Position = P.Position + (R->Position - P.Position) * Stop[b];
+			R->Orientation = math::slerp(P.Orientation, R->Orientation, Stop[b]);
+			R->CurrentTransform = calculate_transform(R->Position, R->Orientation, R->Scale);
+			Count++;
+		}
+		return Count;
+	}
+
+}
@@ -0,0 +1,685 @@
+#include <geodesy/core/phys/convex_hull.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+#include <omp.h>
+
+namespace geodesy::core::phys::collision {
+
+	// Hull construction runs in double, the orientation tests on float data are too close to
+	// the rounding error otherwise.
+	typedef math::vec<double, 3> dvec;
+
+	static dvec widen(const math::vec<float, 3>& aVector) {
+		return dvec(aVector[0], aVector[1], aVector[2]);
+	}
+
+	static math::vec<float, 3> narrow(const dvec& aVector) {
+		return math::vec<float, 3>((float)aVector[0], (float)aVector[1], (float)aVector[2]);
+	}
+
+	hull_create_info::hull_create_info() {
+		this->Resolution		= 64;
+		this->MaxVertex			= 64;
+		this->Decompose			= false;
+		this->MaxPiece			= 16;
+		this->Concavity			= 0.02f;
+	}
+
+	hull_report::hull_report() {
+		this->SourceVertex		= 0;
+		this->ClusteredVertex	= 0;
+		this->HullVertex		= 0;
+		this->HullCount			= 0;
+	}
+
+	float hull_report::reduction() const {
+		if (this->SourceVertex == 0) return 0.0f;
+		return 1.0f - (float)this->HullVertex / (float)this->SourceVertex;
+	}
+
+	hull_report& hull_report::operator+=(const hull_report& aRhs) {
+		this->SourceVertex		+= aRhs.SourceVertex;
+		this->ClusteredVertex	+= aRhs.ClusteredVertex;
+		this->HullVertex		+= aRhs.HullVertex;
+		this->HullCount			+= aRhs.HullCount;
+		return *this;
+	}
+
+	// Triangle corners of a mesh, implied by vertex order when it carries no index data.
+	static std::vector<uint32_t> triangle_list(const mesh& aMesh) {
+		std::vector<uint32_t> Corner;
+		if (aMesh.Topology.Primitive != mesh::TRIANGLE) return Corner;
+		if (aMesh.Topology.Data32.size() > 0) {
+			Corner.assign(aMesh.Topology.Data32.begin(), aMesh.Topology.Data32.end());
+		}
+		else if (aMesh.Topology.Data16.size() > 0) {
+			Corner.assign(aMesh.Topology.Data16.begin(), aMesh.Topology.Data16.end());
+		}
+		else {
+			Corner.resize(aMesh.Vertex.size() - aMesh.Vertex.size() % 3);
+			for (uint32_t i = 0; i < Corner.size(); i++) Corner[i] = i;
+		}
+		Corner.resize(Corner.size() - Corner.size() % 3);
+		for (uint32_t C : Corner) {
+			if (C >= aMesh.Vertex.size()) return std::vector<uint32_t>();
+		}
+		return Corner;
+	}
+
+	// Stores triangle corners with the narrowest index width, matching gfx::mesh.
+	static void set_triangles(mesh& aMesh, const std::vector<uint32_t>& aCorner) {
+		aMesh.Topology.Primitive = mesh::TRIANGLE;
+		aMesh.Topology.Data16.clear();
+		aMesh.Topology.Data32.clear();
+		if (aMesh.Vertex.size() <= (1 << 16)) {
+			aMesh.Topology.Data16.assign(aCorner.begin(), aCorner.end());
+		}
+		else {
+			aMesh.Topology.Data32.assign(aCorner.begin(), aCorner.end());
+		}
+	}
+
+	static void finalize(mesh& aMesh) {
+		aMesh.CenterOfMass = aMesh.center_of_mass();
+		aMesh.BoundingRadius = aMesh.bounding_radius();
+		aMesh.Bounds = aMesh.bounding_volume();
+	}
+
+	mesh simplify(const mesh& aMesh, int aResolution) {
+		mesh Out;
+		Out.Name = aMesh.Name;
+		Out.Mass = aMesh.Mass;
+		const std::vector<uint32_t> Corner = triangle_list(aMesh);
+		const std::ptrdiff_t VertexCount = aMesh.Vertex.size();
+		if (VertexCount == 0) return Out;
+
+		float Lo[3] = { aMesh.Vertex[0].Position[0], aMesh.Vertex[0].Position[1], aMesh.Vertex[0].Position[2] };
+		float Hi[3] = { Lo[0], Lo[1], Lo[2] };
+		for (const auto& V : aMesh.Vertex) {
+			for (int k = 0; k < 3; k++) {
+				Lo[k] = std::min(Lo[k], V.Position[k]);
+				Hi[k] = std::max(Hi[k], V.Position[k]);
+			}
+		}
+		const float Side = std::max(Hi[0] - Lo[0], std::max(Hi[1] - Lo[1], Hi[2] - Lo[2]));
+		const int Resolution = std::min(aResolution, (1 << 20));
+
+		// Cell key of every vertex, 21 bits per axis. Without a grid each vertex is its own cell.
+		std::vector<std::pair<uint64_t, uint32_t>> Key(VertexCount);
+		#pragma omp parallel for if(VertexCount > 4096)
+		for (std::ptrdiff_t i = 0; i < VertexCount; i++) {
+			uint64_t K = (uint64_t)i;
+			if ((Resolution > 0) && (Side > 0.0f)) {
+				K = 0;
+				for (int k = 0; k < 3; k++) {
+					uint64_t Cell = (uint64_t)std::min((aMesh.Vertex[i].Position[k] - Lo[k]) / Side * Resolution, (float)Resolution);
+					K |= Cell << (21 * k);
+				}
+			}
+			Key[i] = std::make_pair(K, (uint32_t)i);
+		}
+		std::sort(Key.begin(), Key.end());
+
+		// Each occupied cell becomes one vertex at the mean of its members.
+		std::vector<uint32_t> Cluster(VertexCount);
+		std::vector<dvec> Sum;
+		std::vector<uint32_t> Count;
+		for (std::ptrdiff_t i = 0; i < VertexCount; i++) {
+			if ((i == 0) || (Key[i].first != Key[i - 1].first)) {
+				Sum.push_back(dvec(0.0, 0.0, 0.0));
+				Count.push_back(0);
+			}
+			Sum.back() += widen(aMesh.Vertex[Key[i].second].Position);
+			Count.back()++;
+			Cluster[Key[i].second] = (uint32_t)Sum.size() - 1;
+		}
+		Out.Vertex.resize(Sum.size());
+		for (std::size_t i = 0; i < Sum.size(); i++) {
+			Out.Vertex[i].Position = narrow(Sum[i] / (double)Count[i]);
+		}
+
+		// Triangles whose corners fell into fewer than three cells collapse.
+		std::vector<uint32_t> Remap;
+		Remap.reserve(Corner.size());
+		for (std::size_t t = 0; t < Corner.size(); t += 3) {
+			uint32_t A = Cluster[Corner[t]], B = Cluster[Corner[t + 1]], C = Cluster[Corner[t + 2]];
+			if ((A == B) || (B == C) || (C == A)) continue;
+			Remap.push_back(A);
+			Remap.push_back(B);
+			Remap.push_back(C);
+		}
+		if (Remap.size() > 0) {
+			set_triangles(Out, Remap);
+		}
+		else {
+			Out.Topology.Primitive = mesh::POINT;
+		}
+		finalize(Out);
+		return Out;
+	}
+
+	namespace {
+
+		struct hull_face {
+			uint32_t				V[3];
+			int						Adjacent[3];		// Face across edge V[k] -> V[(k + 1) % 3].
+			dvec					Normal;
+			double					Offset;
+			std::vector<uint32_t>	Outside;			// Points above this face, claimed by no earlier face.
+			uint32_t				Far;
+			double					FarDistance;
+			std::size_t				Visit;
+			bool					Alive;
+		};
+
+		// QuickHull over a point set. Faces keep their neighbours across each edge, so the region
+		// visible from a new point is found by walking outward from the face it was taken from.
+		class quickhull {
+		public:
+
+			const std::vector<dvec>&					Point;
+			double										Epsilon;
+			std::vector<hull_face>						Face;
+			std::priority_queue<std::pair<double, int>> Queue;		// Faces by the distance of their farthest point.
+			std::size_t									Stamp;
+			std::vector<int>							StartsAt;	// New face starting at each horizon vertex, -1 elsewhere.
+			std::vector<int>							Visible;	// Scratch lists of expand(), kept to spare reallocation.
+			std::vector<int>							Stack;
+			std::vector<int>							Created;
+			std::vector<uint32_t>						Orphan;
+
+			quickhull(const std::vector<dvec>& aPoint, double aEpsilon) : Point(aPoint) {
+				this->Epsilon = aEpsilon;
+				this->Stamp = 0;
+				this->StartsAt.assign(aPoint.size(), -1);
+			}
+
+			int add_face(uint32_t aA, uint32_t aB, uint32_t aC) {
+				hull_face F;
+				F.V[0] = aA; F.V[1] = aB; F.V[2] = aC;
+				F.Adjacent[0] = F.Adjacent[1] = F.Adjacent[2] = -1;
+				dvec N = (Point[aB] - Point[aA]) ^ (Point[aC] - Point[aA]);
+				double Length = math::length(N);
+				F.Normal = Length > 0.0 ? N / Length : dvec(0.0, 0.0, 0.0);
+				F.Offset = F.Normal * Point[aA];
+				F.Far = 0;
+				F.FarDistance = 0.0;
+				F.Visit = 0;
+				F.Alive = true;
+				Face.push_back(std::move(F));
+				return (int)Face.size() - 1;
+			}
+
+			double distance(int aFace, uint32_t aPoint) const {
+				return Face[aFace].Normal * Point[aPoint] - Face[aFace].Offset;
+			}
+
+			// Hands each point to the first face it lies above, points below all of them are inside.
+			void assign(const std::vector<uint32_t>& aPoint, const std::vector<int>& aFace) {
+				std::vector<int> Target(aPoint.size());
+				std::vector<double> Distance(aPoint.size());
+				#pragma omp parallel for if(aPoint.size() > 4096)
+				for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aPoint.size(); i++) {
+					Target[i] = -1;
+					for (int f : aFace) {
+						double d = this->distance(f, aPoint[i]);
+						if (d > Epsilon) {
+							Target[i] = f;
+							Distance[i] = d;
+							break;
+						}
+					}
+				}
+				for (std::size_t i = 0; i < aPoint.size(); i++) {
+					if (Target[i] < 0) continue;
+					hull_face& F = Face[Target[i]];
+					F.Outside.push_back(aPoint[i]);
+					if (Distance[i] > F.FarDistance) {
+						F.FarDistance = Distance[i];
+						F.Far = aPoint[i];
+					}
+				}
+				for (int f : aFace) {
+					if (Face[f].Outside.size() > 0) Queue.push(std::make_pair(Face[f].FarDistance, f));
+				}
+			}
+
+			// Adds the farthest outside point of the best face, returns false once no point is left.
+			bool expand() {
+				int Top = -1;
+				while (Queue.size() > 0) {
+					int f = Queue.top().second;
+					Queue.pop();
+					if (Face[f].Alive && (Face[f].Outside.size() > 0)) {
+						Top = f;
+						break;
+					}
+				}
+				if (Top < 0) return false;
+				const uint32_t Eye = Face[Top].Far;
+				Stamp++;
+
+				// Faces visible from the eye form a connected patch around the top face.
+				Visible.clear();
+				Stack.assign(1, Top);
+				Face[Top].Visit = Stamp;
+				while (Stack.size() > 0) {
+					int f = Stack.back();
+					Stack.pop_back();
+					Visible.push_back(f);
+					for (int k = 0; k < 3; k++) {
+						int g = Face[f].Adjacent[k];
+						if ((Face[g].Visit == Stamp) || (this->distance(g, Eye) <= Epsilon)) continue;
+						Face[g].Visit = Stamp;
+						Stack.push_back(g);
+					}
+				}
+
+				// Each horizon edge and the eye make a new face, linked to the hidden face across
+				// the edge and to the new faces on either side.
+				struct edge { uint32_t A, B; int Hidden; };
+				std::vector<edge> Horizon;
+				for (int f : Visible) {
+					for (int k = 0; k < 3; k++) {
+						int g = Face[f].Adjacent[k];
+						if (Face[g].Visit != Stamp) Horizon.push_back({ Face[f].V[k], Face[f].V[(k + 1) % 3], g });
+					}
+				}
+				Created.resize(Horizon.size());
+				for (std::size_t i = 0; i < Horizon.size(); i++) {
+					const edge& E = Horizon[i];
+					int n = this->add_face(E.A, E.B, Eye);
+					Created[i] = n;
+					StartsAt[E.A] = n;
+					Face[n].Adjacent[0] = E.Hidden;
+					for (int k = 0; k < 3; k++) {
+						if ((Face[E.Hidden].V[k] == E.B) && (Face[E.Hidden].V[(k + 1) % 3] == E.A)) {
+							Face[E.Hidden].Adjacent[k] = n;
+						}
+					}
+				}
+				for (int n : Created) {
+					int m = StartsAt[Face[n].V[1]];
+					Face[n].Adjacent[1] = m;
+					Face[m].Adjacent[2] = n;
+				}
+				for (const edge& E : Horizon) {
+					StartsAt[E.A] = -1;
+				}
+
+				// Points outside the removed faces go to the new ones.
+				Orphan.clear();
+				for (int f : Visible) {
+					for (uint32_t p : Face[f].Outside) {
+						if (p != Eye) Orphan.push_back(p);
+					}
+					Face[f].Alive = false;
+					std::vector<uint32_t>().swap(Face[f].Outside);
+				}
+				this->assign(Orphan, Created);
+				return true;
+			}
+
+		};
+
+		// Index of the point maximizing aScore, found in parallel.
+		template <typename F>
+		uint32_t farthest(std::size_t aCount, F&& aScore) {
+			uint32_t Best = 0;
+			double BestScore = -std::numeric_limits<double>::max();
+			#pragma omp parallel if(aCount > 4096)
+			{
+				uint32_t LocalBest = 0;
+				double LocalScore = -std::numeric_limits<double>::max();
+				#pragma omp for nowait
+				for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aCount; i++) {
+					double Score = aScore((uint32_t)i);
+					if (Score > LocalScore) {
+						LocalScore = Score;
+						LocalBest = (uint32_t)i;
+					}
+				}
+				#pragma omp critical
+				{
+					if ((LocalScore > BestScore) || ((LocalScore == BestScore) && (LocalBest < Best))) {
+						BestScore = LocalScore;
+						Best = LocalBest;
+					}
+				}
+			}
+			return Best;
+		}
+
+	}
+
+	// Hull of points in a plane through aA with unit normal aNormal, by monotone chain. Points
+	// within aEpsilon of a hull edge are dropped, so only corners remain. Both windings are
+	// emitted so the flat hull is still a closed surface.
+	static void planar_hull(const std::vector<dvec>& aPoint, const dvec& aA, const dvec& aNormal, const dvec& aAxis, double aEpsilon, mesh& aOut) {
+		const dvec U = aAxis;
+		const dvec W = aNormal ^ U;
+		std::vector<std::pair<std::pair<double, double>, uint32_t>> P(aPoint.size());
+		for (std::size_t i = 0; i < aPoint.size(); i++) {
+			const dvec D = aPoint[i] - aA;
+			P[i] = std::make_pair(std::make_pair(D * U, D * W), (uint32_t)i);
+		}
+		std::sort(P.begin(), P.end());
+		// Whether aI is no left turn from aO to aJ, or lies within aEpsilon of the edge between them.
+		auto inside = [&](std::size_t aO, std::size_t aI, std::size_t aJ) {
+			const double Cross = (P[aI].first.first - P[aO].first.first) * (P[aJ].first.second - P[aO].first.second)
+				- (P[aI].first.second - P[aO].first.second) * (P[aJ].first.first - P[aO].first.first);
+			return Cross <= aEpsilon * std::hypot(P[aJ].first.first - P[aO].first.first, P[aJ].first.second - P[aO].first.second);
+		};
+		std::vector<std::size_t> Chain(2 * P.size());
+		std::size_t k = 0;
+		for (std::size_t i = 0; i < P.size(); i++) {
+			while ((k >= 2) && inside(Chain[k - 2], Chain[k - 1], i)) k--;
+			Chain[k++] = i;
+		}
+		for (std::size_t i = P.size() - 1, Lower = k + 1; i-- > 0; ) {
+			while ((k >= Lower) && inside(Chain[k - 2], Chain[k - 1], i)) k--;
+			Chain[k++] = i;
+		}
+		Chain.resize(k > 1 ? k - 1 : k);
+
+		aOut.Vertex.resize(Chain.size());
+		for (std::size_t i = 0; i < Chain.size(); i++) {
+			aOut.Vertex[i].Position = narrow(aPoint[P[Chain[i]].second]);
+		}
+		std::vector<uint32_t> Corner;
+		for (uint32_t i = 1; i + 1 < Chain.size(); i++) {
+			Corner.insert(Corner.end(), { 0, i, i + 1, 0, i + 1, i });
+		}
+		set_triangles(aOut, Corner);
+	}
+
+	std::shared_ptr<mesh> convex_hull(const std::vector<math::vec<float, 3>>& aPoint, int aMaxVertex) {
+		std::shared_ptr<mesh> Out = std::make_shared<mesh>();
+		Out->Topology.Primitive = mesh::POINT;
+		const std::size_t PointCount = aPoint.size();
+		if (PointCount == 0) return Out;
+
+		std::vector<dvec> P(PointCount);
+		#pragma omp parallel for if(PointCount > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)PointCount; i++) {
+			P[i] = widen(aPoint[i]);
+		}
+
+		// Extreme points along each axis seed the initial simplex.
+		uint32_t Extreme[6];
+		double Scale = 0.0;
+		for (int k = 0; k < 3; k++) {
+			Extreme[2 * k + 0] = farthest(PointCount, [&](uint32_t i) { return -P[i][k]; });
+			Extreme[2 * k + 1] = farthest(PointCount, [&](uint32_t i) { return P[i][k]; });
+			Scale += std::max(std::abs(P[Extreme[2 * k + 0]][k]), std::abs(P[Extreme[2 * k + 1]][k]));
+		}
+		// Rounding bound of the plane tests. A fatter tolerance would drop near coplanar points
+		// but leaves faces that see each other's vertices, which later expansions turn inside out.
+		const double Epsilon = 3.0 * std::numeric_limits<double>::epsilon() * std::max(Scale, 1e-30);
+		// Points within the rounding of the float input of a line or plane lie on it, so flat
+		// meshes in any orientation get a flat hull without their collinear boundary points.
+		const double Flat = 4.0 * (double)std::numeric_limits<float>::epsilon() * std::max(Scale, 1e-30);
+
+		uint32_t A = Extreme[0], B = Extreme[1];
+		for (int i = 0; i < 6; i++) {
+			for (int j = i + 1; j < 6; j++) {
+				if (math::length(P[Extreme[i]] - P[Extreme[j]]) > math::length(P[A] - P[B])) {
+					A = Extreme[i];
+					B = Extreme[j];
+				}
+			}
+		}
+		if (math::length(P[B] - P[A]) <= Epsilon) {
+			Out->Vertex.resize(1);
+			Out->Vertex[0].Position = aPoint[A];
+			finalize(*Out);
+			return Out;
+		}
+		const dvec Line = math::normalize(P[B] - P[A]);
+		uint32_t C = farthest(PointCount, [&](uint32_t i) { return math::length((P[i] - P[A]) ^ Line); });
+		if (math::length((P[C] - P[A]) ^ Line) <= Flat) {
+			Out->Topology.Primitive = mesh::LINE;
+			Out->Vertex.resize(2);
+			Out->Vertex[0].Position = aPoint[A];
+			Out->Vertex[1].Position = aPoint[B];
+			Out->Topology.Data16 = { 0, 1 };
+			finalize(*Out);
+			return Out;
+		}
+		const dvec Normal = math::normalize((P[B] - P[A]) ^ (P[C] - P[A]));
+		uint32_t D = farthest(PointCount, [&](uint32_t i) { return std::abs((P[i] - P[A]) * Normal); });
+		if (std::abs((P[D] - P[A]) * Normal) <= Flat) {
+			planar_hull(P, P[A], Normal, Line, Flat, *Out);
+			finalize(*Out);
+			return Out;
+		}
+
+		// Tetrahedron with D below ABC, every face wound counter clockwise seen from outside.
+		if ((P[D] - P[A]) * Normal > 0.0) std::swap(B, C);
+		quickhull Hull(P, Epsilon);
+		Hull.add_face(A, B, C);
+		Hull.add_face(A, D, B);
+		Hull.add_face(B, D, C);
+		Hull.add_face(C, D, A);
+		for (int f = 0; f < 4; f++) {
+			for (int k = 0; k < 3; k++) {
+				uint32_t U = Hull.Face[f].V[k], V = Hull.Face[f].V[(k + 1) % 3];
+				for (int g = 0; g < 4; g++) {
+					for (int l = 0; l < 3; l++) {
+						if ((Hull.Face[g].V[l] == V) && (Hull.Face[g].V[(l + 1) % 3] == U)) Hull.Face[f].Adjacent[k] = g;
+					}
+				}
+			}
+		}
+		std::vector<uint32_t> Remaining;
+		Remaining.reserve(PointCount);
+		for (uint32_t i = 0; i < PointCount; i++) {
+			if ((i != A) && (i != B) && (i != C) && (i != D)) Remaining.push_back(i);
+		}
+		Hull.assign(Remaining, { 0, 1, 2, 3 });
+		std::vector<uint32_t>().swap(Remaining);
+
+		int VertexCount = 4;
+		while (((aMaxVertex <= 0) || (VertexCount < aMaxVertex)) && Hull.expand()) {
+			VertexCount++;
+		}
+
+		// Compact the vertices referenced by the surviving faces.
+		std::unordered_map<uint32_t, uint32_t> Index;
+		std::vector<uint32_t> Corner;
+		for (const hull_face& F : Hull.Face) {
+			if (!F.Alive) continue;
+			for (int k = 0; k < 3; k++) {
+				auto It = Index.find(F.V[k]);
+				if (It == Index.end()) {
+					It = Index.emplace(F.V[k], (uint32_t)Out->Vertex.size()).first;
+					Out->Vertex.emplace_back();
+					Out->Vertex.back().Position = aPoint[F.V[k]];
+				}
+				Corner.push_back(It->second);
+			}
+		}
+		set_triangles(*Out, Corner);
+		finalize(*Out);
+		return Out;
+	}
+
+	std::shared_ptr<mesh> convex_hull(const mesh& aMesh, int aMaxVertex) {
+		std::vector<math::vec<float, 3>> Point(aMesh.Vertex.size());
+		for (std::size_t i = 0; i < Point.size(); i++) {
+			Point[i] = aMesh.Vertex[i].Position;
+		}
+		std::shared_ptr<mesh> Out = convex_hull(Point, aMaxVertex);
+		Out->Name = aMesh.Name;
+		Out->Mass = aMesh.Mass;
+		return Out;
+	}
+
+	// Volume enclosed by a closed, outward wound triangle mesh.
+	static double volume(const mesh& aMesh) {
+		const std::vector<uint32_t> Corner = triangle_list(aMesh);
+		double Sum = 0.0;
+		for (std::size_t t = 0; t < Corner.size(); t += 3) {
+			const dvec A = widen(aMesh.Vertex[Corner[t]].Position);
+			const dvec B = widen(aMesh.Vertex[Corner[t + 1]].Position);
+			const dvec C = widen(aMesh.Vertex[Corner[t + 2]].Position);
+			Sum += A * (B ^ C);
+		}
+		return Sum / 6.0;
+	}
+
+	// Deepest a vertex of aPart lies inside aHull, measured to the nearest hull plane.
+	static double concavity(const mesh& aPart, const mesh& aHull) {
+		const std::vector<uint32_t> Corner = triangle_list(aHull);
+		std::vector<std::pair<dvec, double>> Plane;
+		for (std::size_t t = 0; t < Corner.size(); t += 3) {
+			const dvec A = widen(aHull.Vertex[Corner[t]].Position);
+			const dvec N = (widen(aHull.Vertex[Corner[t + 1]].Position) - A) ^ (widen(aHull.Vertex[Corner[t + 2]].Position) - A);
+			const double Length = math::length(N);
+			if (Length > 0.0) Plane.push_back(std::make_pair(N / Length, (N * A) / Length));
+		}
+		if (Plane.size() == 0) return 0.0;
+		double Deepest = 0.0;
+		#pragma omp parallel for reduction(max:Deepest) if(aPart.Vertex.size() > 1024)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aPart.Vertex.size(); i++) {
+			const dvec P = widen(aPart.Vertex[i].Position);
+			double Depth = std::numeric_limits<double>::max();
+			for (const auto& Q : Plane) {
+				Depth = std::min(Depth, Q.second - Q.first * P);
+			}
+			Deepest = std::max(Deepest, Depth);
+		}
+		return Deepest;
+	}
+
+	// Splits the triangles of a mesh by the side of a plane their centroids fall on.
+	static void split(const mesh& aMesh, const dvec& aPoint, const dvec& aNormal, mesh& aBelow, mesh& aAbove) {
+		const std::vector<uint32_t> Corner = triangle_list(aMesh);
+		mesh* Side[2] = { &aBelow, &aAbove };
+		std::vector<uint32_t> Index[2], Remap[2];
+		Remap[0].assign(aMesh.Vertex.size(), UINT32_MAX);
+		Remap[1].assign(aMesh.Vertex.size(), UINT32_MAX);
+		for (std::size_t t = 0; t < Corner.size(); t += 3) {
+			const dvec Centroid = (widen(aMesh.Vertex[Corner[t]].Position) + widen(aMesh.Vertex[Corner[t + 1]].Position) + widen(aMesh.Vertex[Corner[t + 2]].Position)) / 3.0;
+			const int s = ((Centroid - aPoint) * aNormal) > 0.0 ? 1 : 0;
+			for (int k = 0; k < 3; k++) {
+				uint32_t& R = Remap[s][Corner[t + k]];
+				if (R == UINT32_MAX) {
+					R = (uint32_t)Side[s]->Vertex.size();
+					Side[s]->Vertex.push_back(aMesh.Vertex[Corner[t + k]]);
+				}
+				Index[s].push_back(R);
+			}
+		}
+		for (int s = 0; s < 2; s++) {
+			Side[s]->Name = aMesh.Name;
+			set_triangles(*Side[s], Index[s]);
+		}
+	}
+
+	struct piece {
+		mesh						Part;
+		std::shared_ptr<mesh>		Hull;
+		double						Concavity;
+	};
+
+	static piece make_piece(mesh&& aPart, int aMaxVertex) {
+		piece Out;
+		Out.Part = std::move(aPart);
+		Out.Hull = convex_hull(Out.Part, aMaxVertex);
+		Out.Concavity = concavity(Out.Part, *Out.Hull);
+		return Out;
+	}
+
+	// Greedy plane splitting, the most concave piece is split until every piece is within the
+	// tolerance or the piece budget is spent.
+	static std::vector<std::shared_ptr<mesh>> decompose(const mesh& aMesh, const hull_create_info& aCreateInfo) {
+		const double Diagonal = 2.0 * math::length(widen(aMesh.bounding_radius()));
+		const double Tolerance = aCreateInfo.Concavity * Diagonal;
+		std::vector<piece> Piece;
+		Piece.push_back(make_piece(mesh(aMesh), aCreateInfo.MaxVertex));
+		while ((int)Piece.size() < std::max(aCreateInfo.MaxPiece, 1)) {
+			std::size_t Worst = 0;
+			for (std::size_t i = 1; i < Piece.size(); i++) {
+				if (Piece[i].Concavity > Piece[Worst].Concavity) Worst = i;
+			}
+			if (Piece[Worst].Concavity <= Tolerance) break;
+
+			// Candidate cuts through the centroid across each principal axis.
+			const mesh& Part = Piece[Worst].Part;
+			const dvec Centroid = widen(Part.center_of_mass());
+			math::mat<float, 3, 3> Covariance;
+			for (std::size_t i = 0; i < 9; i++) Covariance[i] = 0.0f;
+			for (const auto& V : Part.Vertex) {
+				const math::vec<float, 3> D = V.Position - narrow(Centroid);
+				for (std::size_t r = 0; r < 3; r++) {
+					for (std::size_t c = 0; c < 3; c++) Covariance(r, c) += D[r] * D[c];
+				}
+			}
+			math::vec<float, 3> Value;
+			math::mat<float, 3, 3> Axis;
+			math::eigen_symmetric(Covariance, Value, Axis);
+
+			piece Below[3], Above[3];
+			double Cost[3];
+			#pragma omp parallel for if(Part.Vertex.size() > 4096)
+			for (int a = 0; a < 3; a++) {
+				mesh Lower, Upper;
+				split(Part, Centroid, dvec(Axis(0, a), Axis(1, a), Axis(2, a)), Lower, Upper);
+				Cost[a] = std::numeric_limits<double>::max();
+				if ((Lower.Vertex.size() == 0) || (Upper.Vertex.size() == 0)) continue;
+				Below[a] = make_piece(std::move(Lower), aCreateInfo.MaxVertex);
+				Above[a] = make_piece(std::move(Upper), aCreateInfo.MaxVertex);
+				Cost[a] = volume(*Below[a].Hull) + volume(*Above[a].Hull);
+			}
+			int Best = (int)(std::min_element(Cost, Cost + 3) - Cost);
+			if (Cost[Best] == std::numeric_limits<double>::max()) {
+				// No plane separates any triangles, the piece stays as it is.
+				Piece[Worst].Concavity = 0.0;
+				continue;
+			}
+			Piece[Worst] = std::move(Below[Best]);
+			Piece.push_back(std::move(Above[Best]));
+		}
+
+		std::vector<std::shared_ptr<mesh>> Out;
+		for (piece& P : Piece) {
+			Out.push_back(P.Hull);
+		}
+		return Out;
+	}
+
+	std::vector<std::shared_ptr<mesh>> collision_mesh(const mesh& aMesh, const hull_create_info& aCreateInfo, hull_report* aReport) {
+		const mesh Clustered = simplify(aMesh, aCreateInfo.Resolution);
+		std::vector<std::shared_ptr<mesh>> Out;
+		if (aCreateInfo.Decompose) {
+			Out = decompose(Clustered, aCreateInfo);
+		}
+		else {
+			Out.push_back(convex_hull(Clustered, aCreateInfo.MaxVertex));
+		}
+
+		// Mass is shared out by hull volume.
+		double TotalVolume = 0.0;
+		for (const auto& Hull : Out) {
+			TotalVolume += std::max(volume(*Hull), 0.0);
+		}
+		hull_report Report;
+		Report.SourceVertex = aMesh.Vertex.size();
+		Report.ClusteredVertex = Clustered.Vertex.size();
+		Report.HullCount = Out.size();
+		for (std::size_t i = 0; i < Out.size(); i++) {
+			Out[i]->Name = Out.size() > 1 ? aMesh.Name + "_hull_" + std::to_string(i) : aMesh.Name + "_hull";
+			Out[i]->Mass = TotalVolume > 0.0 ? (float)(aMesh.Mass * std::max(volume(*Out[i]), 0.0) / TotalVolume) : aMesh.Mass / (float)Out.size();
+			Report.HullVertex += Out[i]->Vertex.size();
+		}
+		if (aReport != nullptr) *aReport += Report;
+		return Out;
+	}
+
+}
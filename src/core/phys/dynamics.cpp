@@ -0,0 +1,211 @@
+#include <geodesy/core/phys/dynamics.h>
+
+#include <geodesy/core/phys/node.h>
+
+#include <cmath>
+#include <limits>
+
+#include <omp.h>
+
+namespace geodesy::core::phys {
+
+	void dynamics::body_array::resize(std::size_t aCount) {
+		this->Node.resize(aCount);
+		this->InverseMass.resize(aCount);
+		this->GravityMass.resize(aCount);
+		for (std::size_t k = 0; k < 6; k++) {
+			this->InverseInertia[k].resize(aCount);
+		}
+		for (std::size_t k = 0; k < 3; k++) {
+			this->Position[k].resize(aCount);
+			this->LinearMomentum[k].resize(aCount);
+			this->AngularMomentum[k].resize(aCount);
+			this->Force[k].resize(aCount);
+			this->Torque[k].resize(aCount);
+		}
+		for (std::size_t k = 0; k < 4; k++) {
+			this->Orientation[k].resize(aCount);
+		}
+	}
+
+	std::size_t dynamics::body_array::size() const {
+		return this->Node.size();
+	}
+
+	dynamics::dynamics(double aSubstep, int aMaxSubstep) {
+		this->Gravity 		= { 0.0f, 0.0f, -9.80665f }; // Stage space is +Z up.
+		this->Substep 		= aSubstep;
+		this->MaxSubstep 	= aMaxSubstep;
+		this->Accumulator 	= 0.0;
+	}
+
+	void dynamics::apply(node* aNode, const force& aForce) {
+		this->AppliedForce[aNode].push_back(aForce);
+		aNode->Sleeping = false;
+		aNode->IdleTime = 0.0f;
+	}
+
+	void dynamics::gather(const std::vector<node*>& aNodeList) {
+		// Only roots carry world space state, child nodes follow through the hierarchy.
+		std::vector<node*> Listed;
+		Listed.reserve(this->Body.Node.size());
+		for (node* N : aNodeList) {
+			if ((N->Root == N) && (N->MotionType == node::motion::DYNAMIC) && !N->Sleeping) {
+				Listed.push_back(N);
+			}
+		}
+		if (Listed != this->Body.Node) {
+			this->Body.Node.swap(Listed);
+			this->Index.clear();
+			this->Index.reserve(this->Body.Node.size());
+			for (std::size_t i = 0; i < this->Body.Node.size(); i++) {
+				this->Index[this->Body.Node[i]] = (uint32_t)i;
+			}
+		}
+		this->Body.resize(this->Body.Node.size());
+
+		body_array& B = this->Body;
+		#pragma omp parallel for if(B.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)B.size(); i++) {
+			const node* N = B.Node[i];
+			bool Massive = N->Mass > 0.0f;
+			B.InverseMass[i] = Massive ? 1.0f / N->Mass : 0.0f;
+			B.GravityMass[i] = (Massive && N->GravityEnabled) ? N->Mass : 0.0f;
+
+			// A singular or absent inertia tensor locks rotation, as an infinite one would.
+			math::mat<float, 3, 3> Inverse;
+			const math::mat<float, 3, 3> Adjugate = math::adjugate(N->InertiaTensor);
+			const float Det = N->InertiaTensor(0, 0) * Adjugate(0, 0) + N->InertiaTensor(0, 1) * Adjugate(1, 0) + N->InertiaTensor(0, 2) * Adjugate(2, 0);
+			if (Massive && (Det > std::numeric_limits<float>::min())) {
+				Inverse = Adjugate * (1.0f / Det);
+			}
+			B.InverseInertia[0][i] = Inverse(0, 0);
+			B.InverseInertia[1][i] = Inverse(1, 1);
+			B.InverseInertia[2][i] = Inverse(2, 2);
+			B.InverseInertia[3][i] = 0.5f * (Inverse(0, 1) + Inverse(1, 0));
+			B.InverseInertia[4][i] = 0.5f * (Inverse(0, 2) + Inverse(2, 0));
+			B.InverseInertia[5][i] = 0.5f * (Inverse(1, 2) + Inverse(2, 1));
+
+			for (std::size_t k = 0; k < 3; k++) {
+				B.Position[k][i] 			= N->Position[k];
+				B.LinearMomentum[k][i] 		= N->LinearMomentum[k];
+				B.AngularMomentum[k][i] 	= N->AngularMomentum[k];
+				B.Force[k][i] 				= 0.0f;
+				B.Torque[k][i] 				= 0.0f;
+			}
+			for (std::size_t k = 0; k < 4; k++) {
+				B.Orientation[k][i] = N->Orientation[k];
+			}
+
+			// The force map is only read here, concurrent lookups are safe.
+			if (this->AppliedForce.empty()) continue;
+			auto It = this->AppliedForce.find(B.Node[i]);
+			if (It == this->AppliedForce.end()) continue;
+			math::vec<float, 3> F, T;
+			for (const force& AF : It->second) {
+				F += AF.Magnitude;
+				T += (AF.Position - N->Position) ^ AF.Magnitude;
+			}
+			for (std::size_t k = 0; k < 3; k++) {
+				B.Force[k][i] = F[k];
+				B.Torque[k][i] = T[k];
+			}
+		}
+	}
+
+	void dynamics::integrate_momentum(float aDeltaTime) {
+		body_array& B = this->Body;
+		const std::ptrdiff_t Count = B.size();
+		const float* GM = B.GravityMass.data();
+		for (std::size_t k = 0; k < 3; k++) {
+			float* P = B.LinearMomentum[k].data();
+			float* L = B.AngularMomentum[k].data();
+			const float* F = B.Force[k].data();
+			const float* T = B.Torque[k].data();
+			const float G = this->Gravity[k] * aDeltaTime;
+			#pragma omp parallel for if(Count > 16384)
+			for (std::ptrdiff_t i = 0; i < Count; i++) {
+				P[i] += F[i] * aDeltaTime + GM[i] * G;
+				L[i] += T[i] * aDeltaTime;
+			}
+		}
+	}
+
+	void dynamics::integrate_position(float aDeltaTime) {
+		body_array& B = this->Body;
+		const std::ptrdiff_t Count = B.size();
+		const float H = 0.5f * aDeltaTime;
+		#pragma omp parallel for if(Count > 4096)
+		for (std::ptrdiff_t i = 0; i < Count; i++) {
+			const float M = B.InverseMass[i] * aDeltaTime;
+			B.Position[0][i] += B.LinearMomentum[0][i] * M;
+			B.Position[1][i] += B.LinearMomentum[1][i] * M;
+			B.Position[2][i] += B.LinearMomentum[2][i] * M;
+
+			const float w = B.Orientation[0][i], x = B.Orientation[1][i], y = B.Orientation[2][i], z = B.Orientation[3][i];
+			const float Lx = B.AngularMomentum[0][i], Ly = B.AngularMomentum[1][i], Lz = B.AngularMomentum[2][i];
+
+			//tex:
+			// $$ \vec{\omega} = R \, I_{body}^{-1} \, R^{T} \vec{L} $$
+			const float R00 = 1.0f - 2.0f * (y * y + z * z), R01 = 2.0f * (x * y - w * z), R02 = 2.0f * (x * z + w * y);
+			const float R10 = 2.0f * (x * y + w * z), R11 = 1.0f - 2.0f * (x * x + z * z), R12 = 2.0f * (y * z - w * x);
+			const float R20 = 2.0f * (x * z - w * y), R21 = 2.0f * (y * z + w * x), R22 = 1.0f - 2.0f * (x * x + y * y);
+			const float ax = R00 * Lx + R10 * Ly + R20 * Lz;
+			const float ay = R01 * Lx + R11 * Ly + R21 * Lz;
+			const float az = R02 * Lx + R12 * Ly + R22 * Lz;
+			const float bx = B.InverseInertia[0][i] * ax + B.InverseInertia[3][i] * ay + B.InverseInertia[4][i] * az;
+			const float by = B.InverseInertia[3][i] * ax + B.InverseInertia[1][i] * ay + B.InverseInertia[5][i] * az;
+			const float bz = B.InverseInertia[4][i] * ax + B.InverseInertia[5][i] * ay + B.InverseInertia[2][i] * az;
+			const float Wx = R00 * bx + R01 * by + R02 * bz;
+			const float Wy = R10 * bx + R11 * by + R12 * bz;
+			const float Wz = R20 * bx + R21 * by + R22 * bz;
+
+			//tex:
+			// $$ q \leftarrow q + \frac{\Delta t}{2} (0, \vec{\omega}) \, q $$
+			float qw = w - H * (Wx * x + Wy * y + Wz * z);
+			float qx = x + H * (Wx * w + Wy * z - Wz * y);
+			float qy = y + H * (Wy * w + Wz * x - Wx * z);
+			float qz = z + H * (Wz * w + Wx * y - Wy * x);
+			const float Norm = 1.0f / std::sqrt(qw * qw + qx * qx + qy * qy + qz * qz);
+			B.Orientation[0][i] = qw * Norm;
+			B.Orientation[1][i] = qx * Norm;
+			B.Orientation[2][i] = qy * Norm;
+			B.Orientation[3][i] = qz * Norm;
+		}
+	}
+
+	int dynamics::step(double aDeltaTime) {
+		return this->step(aDeltaTime, [](float) {});
+	}
+
+	void dynamics::scatter() {
+		body_array& B = this->Body;
+		#pragma omp parallel for if(B.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)B.size(); i++) {
+			node* N = B.Node[i];
+			for (std::size_t k = 0; k < 3; k++) {
+				N->Position[k] 			= B.Position[k][i];
+				N->LinearMomentum[k] 	= B.LinearMomentum[k][i];
+				N->AngularMomentum[k] 	= B.AngularMomentum[k][i];
+			}
+			for (std::size_t k = 0; k < 4; k++) {
+				N->Orientation[k] = B.Orientation[k][i];
+			}
+			N->CurrentTransform = calculate_transform(N->Position, N->Orientation, N->Scale);
+		}
+	}
+
+	int dynamics::update(const std::vector<node*>& aNodeList, double aDeltaTime) {
+		// Not enough time for a substep, forces stay queued for the next frame.
+		if (this->Accumulator + aDeltaTime < this->Substep) {
+			this->Accumulator += aDeltaTime;
+			return 0;
+		}
+		this->gather(aNodeList);
+		int Count = this->step(aDeltaTime);
+		this->scatter();
+		this->AppliedForce.clear();
+		return Count;
+	}
+
+}
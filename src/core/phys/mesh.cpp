@@ -1,5 +1,7 @@
 #include <geodesy/core/phys/mesh.h>
 
+#include <algorithm>
+
 namespace geodesy::core::phys {
 
 	mesh::vertex::vertex() {
@@ -13,6 +15,20 @@ namespace geodesy::core::phys {
 		this->Color						= math::vec<float, 4>(0.0f, 0.0f, 0.0f, 0.0f);
 	}
 
+	mesh::bounds::bounds() {
+		this->Min 						= { 0.0f, 0.0f, 0.0f };
+		this->Max 						= { 0.0f, 0.0f, 0.0f };
+		this->Center 					= { 0.0f, 0.0f, 0.0f };
+		this->Radius 					= -1.0f;
+		this->BoxCenter 				= { 0.0f, 0.0f, 0.0f };
+		this->BoxAxis 					= { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+		this->BoxExtent 				= { 0.0f, 0.0f, 0.0f };
+	}
+
+	bool mesh::bounds::empty() const {
+		return this->Radius < 0.0f;
+	}
+
 	mesh::mesh() {
 		this->Name						= "";
 		this->Mass						= 1.0f;
@@ -30,27 +46,66 @@ namespace geodesy::core::phys {
 
 	// Calculates the center of mass of the mesh.
 	math::vec<float, 3> mesh::center_of_mass() const {
-		math::vec<float, 3> COM = math::vec<float, 3>(0.0f, 0.0f, 0.0f);
-		for (const auto& Vertex : this->Vertex) {
-			COM += Vertex.Position;
-		}
-		COM /= static_cast<float>(this->Vertex.size());
-		return COM;
+		if (this->Vertex.size() == 0) return math::vec<float, 3>(0.0f, 0.0f, 0.0f);
+		math::batch::span3<const float> Position = math::batch::view(this->Vertex.data(), this->Vertex.size(), &vertex::Position);
+		return math::batch::sum(Position) / static_cast<float>(this->Vertex.size());
 	}
 
 	// Determines the bounding radius of the mesh.
 	math::vec<float, 3> mesh::bounding_radius() const {
-		float MaxRadius = 0.0f;
-		math::vec<float, 3> MaxPosition = { 0.0f, 0.0f, 0.0f };
+		if (this->Vertex.size() == 0) return math::vec<float, 3>(0.0f, 0.0f, 0.0f);
 		math::vec<float, 3> COM = this->center_of_mass();
-		for (const auto& Vertex : this->Vertex) {
-			float Distance = math::length(Vertex.Position - COM);
-			if (Distance > MaxRadius) {
-				MaxRadius = Distance;
-				MaxPosition = Vertex.Position - COM;
-			}
+		math::batch::span3<const float> Position = math::batch::view(this->Vertex.data(), this->Vertex.size(), &vertex::Position);
+		return this->Vertex[math::batch::farthest(Position, COM)].Position - COM;
+	}
+
+	// Computes the bounding volumes of the mesh, every pass over the vertices is split across threads.
+	mesh::bounds mesh::bounding_volume() const {
+		bounds Out;
+		if (this->Vertex.size() == 0) return Out;
+		math::batch::span3<const float> Position = math::batch::view(this->Vertex.data(), this->Vertex.size(), &vertex::Position);
+
+		math::batch::bounds(Position, Out.Min, Out.Max);
+
+		// Ritter's sphere starts from the diameter between a point far from an arbitrary vertex and the
+		// point farthest from it, then grows toward the farthest vertex outside until none is left.
+		// Each growth step is one pass finding the farthest vertex, a few steps settle it.
+		const math::vec<float, 3> First = Position[math::batch::farthest(Position, Position[0])];
+		const math::vec<float, 3> Second = Position[math::batch::farthest(Position, First)];
+		math::vec<float, 3> Center = (First + Second) * 0.5f;
+		float Radius = math::length(Second - First) * 0.5f;
+		for (int i = 0; i < 16; i++) {
+			const math::vec<float, 3> Outside = Position[math::batch::farthest(Position, Center)];
+			const float Distance = math::length(Outside - Center);
+			if (Distance <= Radius) break;
+			// The grown sphere touches the far side of the old one and the outside vertex.
+			Center += (Outside - Center) * ((Distance - Radius) / (2.0f * Distance));
+			Radius = (Radius + Distance) * 0.5f;
+		}
+		// Out of steps the radius reaches the farthest vertex, which always bounds.
+		Out.Center = Center;
+		Out.Radius = std::max(Radius, math::length(Position[math::batch::farthest(Position, Center)] - Center));
+
+		// Principal axes from the covariance of the vertices.
+		const math::vec<float, 3> Mean = math::batch::sum(Position) / static_cast<float>(this->Vertex.size());
+		math::vec<float, 3> Variance;
+		math::mat<float, 3, 3> Axis;
+		math::eigen_symmetric(math::batch::covariance(Position, Mean), Variance, Axis);
+		math::vec<float, 3> Low, High;
+		math::batch::bounds(Position, Axis, Low, High);
+		const math::vec<float, 3> Extent = (High - Low) * 0.5f;
+		const math::vec<float, 3> Half = (Out.Max - Out.Min) * 0.5f;
+		// Symmetric shapes such as boxes have no preferred axes, there the axis aligned box wins.
+		if (Extent[0] * Extent[1] * Extent[2] < Half[0] * Half[1] * Half[2]) {
+			Out.BoxAxis = Axis;
+			Out.BoxExtent = Extent;
+			Out.BoxCenter = Axis * ((Low + High) * 0.5f);
+		}
+		else {
+			Out.BoxExtent = Half;
+			Out.BoxCenter = (Out.Min + Out.Max) * 0.5f;
 		}
-		return MaxPosition;
+		return Out;
 	}
 
 }
@@ -0,0 +1,994 @@
+#include <geodesy/core/phys/narrow_phase.h>
+
+#include <geodesy/core/phys/node.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <tuple>
+
+#include <omp.h>
+
+namespace geodesy::core::phys::collision {
+
+	// GJK and EPA run in double on float data, the simplex and polytope solves lose too much
+	// precision otherwise when the hulls are far from the origin.
+	typedef math::vec<double, 3> dvec;
+
+	static dvec widen(const math::vec<float, 3>& aVector) {
+		return dvec(aVector[0], aVector[1], aVector[2]);
+	}
+
+	static math::vec<float, 3> narrow(const dvec& aVector) {
+		return math::vec<float, 3>((float)aVector[0], (float)aVector[1], (float)aVector[2]);
+	}
+
+	// A hull placed in the world, remembers its last support vertex to start the next climb from.
+	struct placed_hull {
+		const hull*						Hull;
+		const math::affine<float>*		Transform;
+		math::mat<float, 3, 3>			InverseDirection;	// Maps world directions to mesh space.
+		uint32_t						Last;
+
+		placed_hull(const hull& aHull, const math::affine<float>& aTransform, uint32_t aStart) {
+			this->Hull = &aHull;
+			this->Transform = &aTransform;
+			this->InverseDirection = math::transpose(aTransform.Linear);
+			this->Last = aStart < aHull.Vertex.size() ? aStart : 0;
+		}
+
+		uint32_t support(const dvec& aDirection) {
+			this->Last = this->Hull->support(this->InverseDirection * narrow(aDirection), this->Last);
+			return this->Last;
+		}
+
+		dvec point(uint32_t aIndex) const {
+			return widen(this->Transform->transform_point(this->Hull->Vertex[aIndex]));
+		}
+	};
+
+	// Vertex of the Minkowski difference A - B, with the hull vertices it came from.
+	struct support_point {
+		dvec		W;
+		dvec		A;
+		dvec		B;
+		uint32_t	IndexA;
+		uint32_t	IndexB;
+	};
+
+	static support_point make_support(placed_hull& aA, placed_hull& aB, const dvec& aDirection) {
+		support_point P;
+		P.IndexA = aA.support(aDirection);
+		P.IndexB = aB.support(-aDirection);
+		P.A = aA.point(P.IndexA);
+		P.B = aB.point(P.IndexB);
+		P.W = P.A - P.B;
+		return P;
+	}
+
+	static support_point make_support(const placed_hull& aA, const placed_hull& aB, uint32_t aIndexA, uint32_t aIndexB) {
+		support_point P;
+		P.IndexA = aIndexA;
+		P.IndexB = aIndexB;
+		P.A = aA.point(P.IndexA);
+		P.B = aB.point(P.IndexB);
+		P.W = P.A - P.B;
+		return P;
+	}
+
+	// Closest point of a segment or triangle to the origin by Voronoi regions. The simplex is
+	// reduced to the vertices supporting the closest point, whose weights go to aLambda.
+	static int solve_segment(support_point* aS, double* aLambda) {
+		const dvec AB = aS[1].W - aS[0].W;
+		const double t = -(aS[0].W * AB);
+		const double Denominator = AB * AB;
+		if ((t <= 0.0) || (Denominator <= 0.0)) {
+			aLambda[0] = 1.0;
+			return 1;
+		}
+		if (t >= Denominator) {
+			aS[0] = aS[1];
+			aLambda[0] = 1.0;
+			return 1;
+		}
+		aLambda[1] = t / Denominator;
+		aLambda[0] = 1.0 - aLambda[1];
+		return 2;
+	}
+
+	static int solve_triangle(support_point* aS, double* aLambda) {
+		const dvec A = aS[0].W, B = aS[1].W, C = aS[2].W;
+		const dvec AB = B - A, AC = C - A;
+		const double d1 = -(AB * A), d2 = -(AC * A);
+		if ((d1 <= 0.0) && (d2 <= 0.0)) {
+			aLambda[0] = 1.0;
+			return 1;
+		}
+		const double d3 = -(AB * B), d4 = -(AC * B);
+		if ((d3 >= 0.0) && (d4 <= d3)) {
+			aS[0] = aS[1];
+			aLambda[0] = 1.0;
+			return 1;
+		}
+		const double vc = d1 * d4 - d3 * d2;
+		if ((vc <= 0.0) && (d1 >= 0.0) && (d3 <= 0.0)) {
+			aLambda[1] = d1 / (d1 - d3);
+			aLambda[0] = 1.0 - aLambda[1];
+			return 2;
+		}
+		const double d5 = -(AB * C), d6 = -(AC * C);
+		if ((d6 >= 0.0) && (d5 <= d6)) {
+			aS[0] = aS[2];
+			aLambda[0] = 1.0;
+			return 1;
+		}
+		const double vb = d5 * d2 - d1 * d6;
+		if ((vb <= 0.0) && (d2 >= 0.0) && (d6 <= 0.0)) {
+			aS[1] = aS[2];
+			aLambda[1] = d2 / (d2 - d6);
+			aLambda[0] = 1.0 - aLambda[1];
+			return 2;
+		}
+		const double va = d3 * d6 - d5 * d4;
+		if ((va <= 0.0) && ((d4 - d3) >= 0.0) && ((d5 - d6) >= 0.0)) {
+			aS[0] = aS[2];
+			aLambda[0] = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			aLambda[1] = 1.0 - aLambda[0];
+			return 2;
+		}
+		const double Denominator = va + vb + vc;
+		if (Denominator <= 0.0) {
+			// Degenerate triangle, fall back to its longest edge.
+			aS[1] = (AB * AB) >= (AC * AC) ? aS[1] : aS[2];
+			return solve_segment(aS, aLambda);
+		}
+		aLambda[1] = vb / Denominator;
+		aLambda[2] = vc / Denominator;
+		aLambda[0] = 1.0 - aLambda[1] - aLambda[2];
+		return 3;
+	}
+
+	// Returns 4 if the origin lies inside the tetrahedron, otherwise reduces to the closest face.
+	static int solve_tetrahedron(support_point* aS, double* aLambda) {
+		static const int Face[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+		double BestDistance = std::numeric_limits<double>::max();
+		support_point Best[3];
+		double BestLambda[3] = { 1.0, 0.0, 0.0 };
+		int BestCount = 0;
+		for (int f = 0; f < 4; f++) {
+			const dvec& A = aS[Face[f][0]].W;
+			const dvec N = (aS[Face[f][1]].W - A) ^ (aS[Face[f][2]].W - A);
+			const double OriginSide = -(N * A);
+			const double OppositeSide = N * (aS[Face[f][3]].W - A);
+			// Only faces separating the origin from the opposite vertex can hold the closest point.
+			if ((OriginSide * OppositeSide) > 0.0) continue;
+			support_point T[3] = { aS[Face[f][0]], aS[Face[f][1]], aS[Face[f][2]] };
+			double Lambda[3];
+			int Count = solve_triangle(T, Lambda);
+			dvec V(0.0, 0.0, 0.0);
+			for (int k = 0; k < Count; k++) V += T[k].W * Lambda[k];
+			double Distance = V * V;
+			if (Distance < BestDistance) {
+				BestDistance = Distance;
+				BestCount = Count;
+				for (int k = 0; k < Count; k++) {
+					Best[k] = T[k];
+					BestLambda[k] = Lambda[k];
+				}
+			}
+		}
+		if (BestCount == 0) return 4;
+		for (int k = 0; k < BestCount; k++) {
+			aS[k] = Best[k];
+			aLambda[k] = BestLambda[k];
+		}
+		return BestCount;
+	}
+
+	static int solve(support_point* aS, int aCount, double* aLambda) {
+		switch (aCount) {
+		case 1:		aLambda[0] = 1.0; return 1;
+		case 2:		return solve_segment(aS, aLambda);
+		case 3:		return solve_triangle(aS, aLambda);
+		default:	return solve_tetrahedron(aS, aLambda);
+		}
+	}
+
+	hull::hull() {
+		this->Convex = false;
+	}
+
+	hull::hull(const mesh& aMesh) {
+		this->Convex = false;
+		const std::size_t VertexCount = aMesh.Vertex.size();
+		if (VertexCount == 0) return;
+
+		float Extent = 0.0f;
+		for (const auto& V : aMesh.Vertex) {
+			for (std::size_t i = 0; i < 3; i++) Extent = std::max(Extent, std::abs(V.Position[i]));
+		}
+		Extent = std::max(Extent, 1e-6f);
+
+		// Weld positions on a fine grid. Split normals and texture seams duplicate vertices, and
+		// points that only differ by rounding, such as the poles of a UV sphere, would otherwise
+		// leave plateaus the support climb gets stuck on.
+		const float Cell = 1e-5f * Extent;
+		std::vector<std::tuple<int64_t, int64_t, int64_t, uint32_t>> Key(VertexCount);
+		for (uint32_t i = 0; i < VertexCount; i++) {
+			const math::vec<float, 3>& P = aMesh.Vertex[i].Position;
+			Key[i] = std::make_tuple(std::llround(P[0] / Cell), std::llround(P[1] / Cell), std::llround(P[2] / Cell), i);
+		}
+		std::sort(Key.begin(), Key.end());
+		std::vector<uint32_t> Weld(VertexCount);
+		for (std::size_t i = 0; i < VertexCount; i++) {
+			bool Same = (i > 0)
+				&& (std::get<0>(Key[i]) == std::get<0>(Key[i - 1]))
+				&& (std::get<1>(Key[i]) == std::get<1>(Key[i - 1]))
+				&& (std::get<2>(Key[i]) == std::get<2>(Key[i - 1]));
+			if (!Same) {
+				this->Vertex.push_back(aMesh.Vertex[std::get<3>(Key[i])].Position);
+			}
+			Weld[std::get<3>(Key[i])] = (uint32_t)this->Vertex.size() - 1;
+		}
+
+		// Triangle corners from whichever index width the mesh uses, or implied by vertex order.
+		std::vector<uint32_t> Corner;
+		if (aMesh.Topology.Primitive == mesh::TRIANGLE) {
+			if (aMesh.Topology.Data32.size() > 0) {
+				Corner.assign(aMesh.Topology.Data32.begin(), aMesh.Topology.Data32.end());
+			}
+			else if (aMesh.Topology.Data16.size() > 0) {
+				Corner.assign(aMesh.Topology.Data16.begin(), aMesh.Topology.Data16.end());
+			}
+			else {
+				Corner.resize(VertexCount - VertexCount % 3);
+				for (uint32_t i = 0; i < Corner.size(); i++) Corner[i] = i;
+			}
+		}
+		Corner.resize(Corner.size() - Corner.size() % 3);
+		for (uint32_t& C : Corner) {
+			if (C >= VertexCount) return;
+			C = Weld[C];
+		}
+		if (Corner.size() == 0) return;
+
+		// Edge graph in compressed rows.
+		std::vector<std::pair<uint32_t, uint32_t>> Edge;
+		Edge.reserve(2 * Corner.size());
+		for (std::size_t t = 0; t < Corner.size(); t += 3) {
+			for (int k = 0; k < 3; k++) {
+				uint32_t U = Corner[t + k], V = Corner[t + (k + 1) % 3];
+				if (U == V) continue;
+				Edge.emplace_back(U, V);
+				Edge.emplace_back(V, U);
+			}
+		}
+		std::sort(Edge.begin(), Edge.end());
+		Edge.erase(std::unique(Edge.begin(), Edge.end()), Edge.end());
+		this->Offset.assign(this->Vertex.size() + 1, 0);
+		for (const auto& E : Edge) this->Offset[E.first + 1]++;
+		for (std::size_t i = 0; i < this->Vertex.size(); i++) this->Offset[i + 1] += this->Offset[i];
+		this->Neighbour.resize(Edge.size());
+		for (std::size_t i = 0; i < Edge.size(); i++) this->Neighbour[i] = Edge[i].second;
+
+		// Hill climbing needs every vertex reachable and no vertex outside any face plane.
+		std::vector<char> Reached(this->Vertex.size(), 0);
+		std::vector<uint32_t> Frontier(1, 0);
+		Reached[0] = 1;
+		std::size_t ReachedCount = 1;
+		while (Frontier.size() > 0) {
+			uint32_t V = Frontier.back();
+			Frontier.pop_back();
+			for (uint32_t k = this->Offset[V]; k < this->Offset[V + 1]; k++) {
+				if (!Reached[this->Neighbour[k]]) {
+					Reached[this->Neighbour[k]] = 1;
+					ReachedCount++;
+					Frontier.push_back(this->Neighbour[k]);
+				}
+			}
+		}
+		if (ReachedCount != this->Vertex.size()) return;
+		if ((double)this->Vertex.size() * (double)(Corner.size() / 3) > 5.0e7) return;
+
+		const float Tolerance = 1e-4f * Extent;
+		for (std::size_t t = 0; t < Corner.size(); t += 3) {
+			const math::vec<float, 3>& A = this->Vertex[Corner[t]];
+			math::vec<float, 3> N = (this->Vertex[Corner[t + 1]] - A) ^ (this->Vertex[Corner[t + 2]] - A);
+			float Length = math::length(N);
+			if (!(Length > 0.0f)) continue;
+			N = N / Length;
+			// Winding is not trusted, every vertex just has to lie on one side of the plane.
+			bool Above = false, Below = false;
+			for (const auto& P : this->Vertex) {
+				float Side = N * (P - A);
+				Above |= Side > Tolerance;
+				Below |= Side < -Tolerance;
+			}
+			if (Above && Below) return;
+		}
+		this->Convex = true;
+	}
+
+	uint32_t hull::support(const math::vec<float, 3>& aDirection, uint32_t aStart) const {
+		if (!this->Convex) {
+			uint32_t Best = 0;
+			float BestValue = -std::numeric_limits<float>::max();
+			for (uint32_t i = 0; i < this->Vertex.size(); i++) {
+				float Value = this->Vertex[i] * aDirection;
+				if (Value > BestValue) {
+					BestValue = Value;
+					Best = i;
+				}
+			}
+			return Best;
+		}
+		uint32_t Current = aStart < this->Vertex.size() ? aStart : 0;
+		float CurrentValue = this->Vertex[Current] * aDirection;
+		// Steepest ascent, each step moves to the best neighbour until none improves.
+		while (true) {
+			uint32_t Next = Current;
+			for (uint32_t k = this->Offset[Current]; k < this->Offset[Current + 1]; k++) {
+				float Value = this->Vertex[this->Neighbour[k]] * aDirection;
+				if (Value > CurrentValue) {
+					CurrentValue = Value;
+					Next = this->Neighbour[k];
+				}
+			}
+			if (Next == Current) return Current;
+			Current = Next;
+		}
+	}
+
+	uint32_t hull::feature(const math::vec<float, 3>& aDirection, float aTolerance, uint32_t aStart, uint32_t* aFeature, uint32_t aCapacity) const {
+		if ((this->Vertex.size() == 0) || (aCapacity == 0)) return 0;
+		const uint32_t Top = this->support(aDirection, aStart);
+		const float Floor = this->Vertex[Top] * aDirection - aTolerance;
+		uint32_t Count = 0;
+		if (!this->Convex) {
+			for (uint32_t i = 0; (i < this->Vertex.size()) && (Count < aCapacity); i++) {
+				if (this->Vertex[i] * aDirection >= Floor) aFeature[Count++] = i;
+			}
+			return Count;
+		}
+		// The plateau of a linear function over a convex edge graph is connected, so a breadth
+		// first walk from the support vertex finds it. The feature list doubles as the queue.
+		aFeature[Count++] = Top;
+		for (uint32_t q = 0; q < Count; q++) {
+			const uint32_t Current = aFeature[q];
+			for (uint32_t k = this->Offset[Current]; k < this->Offset[Current + 1]; k++) {
+				const uint32_t Next = this->Neighbour[k];
+				if (this->Vertex[Next] * aDirection < Floor) continue;
+				if (std::find(aFeature, aFeature + Count, Next) != aFeature + Count) continue;
+				if (Count == aCapacity) return Count;
+				aFeature[Count++] = Next;
+			}
+		}
+		return Count;
+	}
+
+	simplex::simplex() {
+		this->Count = 0;
+	}
+
+	contact::contact() {
+		this->Depth = 0.0f;
+		this->Impulse[0] = 0.0f;
+		this->Impulse[1] = 0.0f;
+		this->Impulse[2] = 0.0f;
+	}
+
+	manifold::manifold() {
+		this->A = nullptr;
+		this->B = nullptr;
+		this->Count = 0;
+	}
+
+	proximity gjk(const hull& aA, const math::affine<float>& aTransformA, const hull& aB, const math::affine<float>& aTransformB, simplex& aSimplex) {
+		const int MaxIteration = 64;
+		placed_hull A(aA, aTransformA, aSimplex.Count > 0 ? aSimplex.IndexA[0] : 0);
+		placed_hull B(aB, aTransformB, aSimplex.Count > 0 ? aSimplex.IndexB[0] : 0);
+
+		// Warm start from last step's simplex, the vertices are re-evaluated under the new transforms.
+		support_point S[4];
+		int Count = 0;
+		for (int i = 0; i < aSimplex.Count; i++) {
+			if ((aSimplex.IndexA[i] < aA.Vertex.size()) && (aSimplex.IndexB[i] < aB.Vertex.size())) {
+				S[Count++] = make_support(A, B, aSimplex.IndexA[i], aSimplex.IndexB[i]);
+			}
+		}
+		if (Count == 0) {
+			dvec Direction = widen(aTransformB.Translation - aTransformA.Translation);
+			if (!((Direction * Direction) > 0.0)) Direction = dvec(1.0, 0.0, 0.0);
+			S[Count++] = make_support(A, B, -Direction);
+		}
+
+		double Lambda[4] = { 1.0, 0.0, 0.0, 0.0 };
+		bool Intersecting = false;
+		dvec V;
+		for (int Iteration = 0; ; Iteration++) {
+			Count = solve(S, Count, Lambda);
+			if (Count == 4) {
+				Intersecting = true;
+				break;
+			}
+			V = dvec(0.0, 0.0, 0.0);
+			double Scale = 0.0;
+			for (int k = 0; k < Count; k++) {
+				V += S[k].W * Lambda[k];
+				Scale = std::max(Scale, S[k].W * S[k].W);
+			}
+			const double VV = V * V;
+			if (VV <= 1e-12 * Scale) {
+				Intersecting = true;
+				break;
+			}
+			if (Iteration == MaxIteration) break;
+			support_point W = make_support(A, B, -V);
+			// No progress toward the origin, V is the closest point up to float precision.
+			if ((VV - V * W.W) <= 1e-6 * VV) break;
+			bool Repeated = false;
+			for (int k = 0; k < Count; k++) {
+				Repeated |= (S[k].IndexA == W.IndexA) && (S[k].IndexB == W.IndexB);
+			}
+			if (Repeated) break;
+			S[Count++] = W;
+		}
+
+		aSimplex.Count = Count;
+		for (int k = 0; k < Count; k++) {
+			aSimplex.IndexA[k] = S[k].IndexA;
+			aSimplex.IndexB[k] = S[k].IndexB;
+		}
+
+		proximity Result;
+		Result.Intersecting = Intersecting;
+		dvec PointA(0.0, 0.0, 0.0), PointB(0.0, 0.0, 0.0);
+		if (Count < 4) {
+			for (int k = 0; k < Count; k++) {
+				PointA += S[k].A * Lambda[k];
+				PointB += S[k].B * Lambda[k];
+			}
+		}
+		Result.PointA = narrow(PointA);
+		Result.PointB = narrow(PointB);
+		if (Intersecting) {
+			Result.Distance = 0.0f;
+			Result.Depth = 0.0f;
+			dvec Direction = widen(aTransformB.Translation - aTransformA.Translation);
+			double Length = math::length(Direction);
+			Result.Normal = Length > 0.0 ? narrow(Direction / Length) : math::vec<float, 3>(1.0f, 0.0f, 0.0f);
+		}
+		else {
+			double Length = math::length(V);
+			Result.Distance = (float)Length;
+			Result.Depth = -(float)Length;
+			Result.Normal = narrow(-V / Length);
+		}
+		return Result;
+	}
+
+	bool epa(const hull& aA, const math::affine<float>& aTransformA, const hull& aB, const math::affine<float>& aTransformB, const simplex& aSimplex, proximity& aResult) {
+		const int MaxIteration = 128;
+		placed_hull A(aA, aTransformA, aSimplex.Count > 0 ? aSimplex.IndexA[0] : 0);
+		placed_hull B(aB, aTransformB, aSimplex.Count > 0 ? aSimplex.IndexB[0] : 0);
+
+		std::vector<support_point> P;
+		P.reserve(64);
+		for (int i = 0; i < aSimplex.Count; i++) {
+			P.push_back(make_support(A, B, aSimplex.IndexA[i], aSimplex.IndexB[i]));
+		}
+		if (P.size() == 0) {
+			P.push_back(make_support(A, B, dvec(1.0, 0.0, 0.0)));
+		}
+
+		double Scale = 0.0;
+		for (const auto& S : P) Scale = std::max(Scale, S.W * S.W);
+		// Relative accuracy of the depth, finer than float data on faceted round hulls only costs iterations.
+		const double Tolerance = 1e-4 * std::sqrt(std::max(Scale, 1e-12));
+
+		// Grow a touching simplex into a tetrahedron, GJK stops early when the origin lies on
+		// a vertex, edge or face of the difference.
+		static const dvec Axis[6] = { dvec(1, 0, 0), dvec(-1, 0, 0), dvec(0, 1, 0), dvec(0, -1, 0), dvec(0, 0, 1), dvec(0, 0, -1) };
+		if (P.size() == 1) {
+			for (int k = 0; (k < 6) && (P.size() < 2); k++) {
+				support_point S = make_support(A, B, Axis[k]);
+				if (math::length(S.W - P[0].W) > Tolerance) P.push_back(S);
+			}
+		}
+		if (P.size() == 2) {
+			const dvec Line = P[1].W - P[0].W;
+			int Least = 0;
+			for (int k = 1; k < 3; k++) {
+				if (std::abs(Line[k]) < std::abs(Line[Least])) Least = k;
+			}
+			dvec Perpendicular = Line ^ Axis[2 * Least];
+			const dvec Other = math::normalize(Line) ^ Perpendicular;
+			for (int k = 0; (k < 6) && (P.size() < 3); k++) {
+				const double Angle = k * (math::constant::pi / 3.0);
+				support_point S = make_support(A, B, Perpendicular * std::cos(Angle) + Other * std::sin(Angle));
+				if (math::length((S.W - P[0].W) ^ Line) > Tolerance * math::length(Line)) P.push_back(S);
+			}
+		}
+		if (P.size() == 3) {
+			const dvec Normal = (P[1].W - P[0].W) ^ (P[2].W - P[0].W);
+			const double Length = math::length(Normal);
+			for (int k = 0; (k < 2) && (P.size() < 4) && (Length > 0.0); k++) {
+				support_point S = make_support(A, B, k == 0 ? Normal : -Normal);
+				if (std::abs(Normal * (S.W - P[0].W)) > Tolerance * Length) P.push_back(S);
+			}
+		}
+		if (P.size() < 4) return false;
+
+		struct face {
+			int			Index[3];
+			dvec		Normal;
+			double		Distance;
+			bool		Removed;
+		};
+
+		// Faces are oriented away from an interior point, which stays interior as the polytope grows.
+		const dvec Interior = (P[0].W + P[1].W + P[2].W + P[3].W) * 0.25;
+		std::vector<face> Face;
+		Face.reserve(256);
+		std::vector<std::pair<int, int>> Horizon;
+		auto add_face = [&](int aI, int aJ, int aK) -> bool {
+			face F;
+			F.Index[0] = aI; F.Index[1] = aJ; F.Index[2] = aK;
+			dvec N = (P[aJ].W - P[aI].W) ^ (P[aK].W - P[aI].W);
+			double Length = math::length(N);
+			if (!(Length > 0.0)) return false;
+			N = N / Length;
+			if (N * (P[aI].W - Interior) < 0.0) {
+				N = -N;
+				std::swap(F.Index[1], F.Index[2]);
+			}
+			F.Normal = N;
+			F.Distance = N * P[aI].W;
+			F.Removed = false;
+			Face.push_back(F);
+			return true;
+		};
+		if (!(add_face(0, 1, 2) && add_face(0, 3, 1) && add_face(0, 2, 3) && add_face(1, 3, 2))) return false;
+		for (const face& F : Face) {
+			// The origin has to be enclosed, touching hulls sit on the boundary within tolerance.
+			if (F.Distance < -Tolerance) return false;
+		}
+
+		int Closest = 0;
+		for (int Iteration = 0; Iteration < MaxIteration; Iteration++) {
+			Closest = -1;
+			for (int f = 0; f < (int)Face.size(); f++) {
+				if (Face[f].Removed) continue;
+				if ((Closest < 0) || (Face[f].Distance < Face[Closest].Distance)) Closest = f;
+			}
+			if (Closest < 0) return false;
+
+			support_point S = make_support(A, B, Face[Closest].Normal);
+			if ((S.W * Face[Closest].Normal) - Face[Closest].Distance <= Tolerance) break;
+
+			// Faces seen from the new point are removed, their unshared edges form the horizon.
+			const int NewIndex = (int)P.size();
+			P.push_back(S);
+			Horizon.clear();
+			for (face& F : Face) {
+				if (F.Removed || (F.Normal * (S.W - P[F.Index[0]].W) <= 0.0)) continue;
+				F.Removed = true;
+				for (int k = 0; k < 3; k++) {
+					std::pair<int, int> E(F.Index[k], F.Index[(k + 1) % 3]);
+					auto Shared = std::find(Horizon.begin(), Horizon.end(), std::pair<int, int>(E.second, E.first));
+					if (Shared != Horizon.end()) {
+						Horizon.erase(Shared);
+					}
+					else {
+						Horizon.push_back(E);
+					}
+				}
+			}
+			for (const auto& E : Horizon) {
+				add_face(E.first, E.second, NewIndex);
+			}
+			// Drop removed faces now and then, polytopes rarely grow past a few hundred faces.
+			if (Face.size() > 512) {
+				Face.erase(std::remove_if(Face.begin(), Face.end(), [](const face& aFace) { return aFace.Removed; }), Face.end());
+			}
+		}
+
+		// Contact points from the barycentric coordinates of the origin's projection on the face.
+		const face& F = Face[Closest];
+		const dvec Projection = F.Normal * F.Distance;
+		const dvec& W0 = P[F.Index[0]].W;
+		const dvec E1 = P[F.Index[1]].W - W0, E2 = P[F.Index[2]].W - W0, Q = Projection - W0;
+		const double d11 = E1 * E1, d12 = E1 * E2, d22 = E2 * E2, dq1 = Q * E1, dq2 = Q * E2;
+		const double Denominator = d11 * d22 - d12 * d12;
+		double Lambda[3] = { 1.0, 0.0, 0.0 };
+		if (Denominator > 0.0) {
+			Lambda[1] = (d22 * dq1 - d12 * dq2) / Denominator;
+			Lambda[2] = (d11 * dq2 - d12 * dq1) / Denominator;
+			Lambda[0] = 1.0 - Lambda[1] - Lambda[2];
+		}
+		dvec PointA(0.0, 0.0, 0.0), PointB(0.0, 0.0, 0.0);
+		for (int k = 0; k < 3; k++) {
+			PointA += P[F.Index[k]].A * Lambda[k];
+			PointB += P[F.Index[k]].B * Lambda[k];
+		}
+		aResult.Intersecting = true;
+		aResult.Distance = 0.0f;
+		aResult.Depth = (float)F.Distance;
+		aResult.PointA = narrow(PointA);
+		aResult.PointB = narrow(PointB);
+		aResult.Normal = narrow(F.Normal);
+		return true;
+	}
+
+	// Brings cached points to the current transforms and drops those that separated or slid away.
+	static void refresh(manifold& aManifold, const math::affine<float>& aTransformA, const math::affine<float>& aTransformB, float aMargin, float aBreaking) {
+		int Kept = 0;
+		for (int i = 0; i < aManifold.Count; i++) {
+			contact C = aManifold.Point[i];
+			C.PositionA = aTransformA.transform_point(C.LocalA);
+			C.PositionB = aTransformB.transform_point(C.LocalB);
+			const math::vec<float, 3> Offset = C.PositionA - C.PositionB;
+			C.Depth = Offset * C.Normal;
+			const math::vec<float, 3> Drift = Offset - C.Normal * C.Depth;
+			if ((C.Depth >= -aMargin) && ((Drift * Drift) <= aBreaking * aBreaking)) {
+				aManifold.Point[Kept++] = C;
+			}
+		}
+		aManifold.Count = Kept;
+	}
+
+	// Keeps four of five points, the deepest and the three that with it span the largest area.
+	static void reduce(const contact* aCandidate, manifold& aManifold) {
+		int Deepest = 0;
+		for (int i = 1; i < 5; i++) {
+			if (aCandidate[i].Depth > aCandidate[Deepest].Depth) Deepest = i;
+		}
+		int Drop = -1;
+		float BestArea = -1.0f;
+		for (int r = 0; r < 5; r++) {
+			if (r == Deepest) continue;
+			math::vec<float, 3> Q[4];
+			int n = 0;
+			for (int i = 0; i < 5; i++) {
+				if (i != r) Q[n++] = aCandidate[i].PositionA;
+			}
+			// The diagonals of a convex quadrilateral give the largest of the three pairings.
+			float Area = 0.0f;
+			const int Pairing[3][4] = { { 0, 1, 2, 3 }, { 0, 2, 1, 3 }, { 0, 3, 1, 2 } };
+			for (int k = 0; k < 3; k++) {
+				math::vec<float, 3> Cross = (Q[Pairing[k][0]] - Q[Pairing[k][1]]) ^ (Q[Pairing[k][2]] - Q[Pairing[k][3]]);
+				Area = std::max(Area, Cross * Cross);
+			}
+			if (Area > BestArea) {
+				BestArea = Area;
+				Drop = r;
+			}
+		}
+		int n = 0;
+		for (int i = 0; i < 5; i++) {
+			if (i != Drop) aManifold.Point[n++] = aCandidate[i];
+		}
+		aManifold.Count = 4;
+	}
+
+	// Largest feature considered for a contact patch, the clipped polygon can double in size.
+	static constexpr uint32_t MaxFeature = 24;
+
+	// Orthonormal pair across a unit normal.
+	static void plane_basis(const math::vec<float, 3>& aNormal, math::vec<float, 3>& aU, math::vec<float, 3>& aV) {
+		aU = std::abs(aNormal[0]) < 0.57f ? aNormal ^ math::vec<float, 3>(1.0f, 0.0f, 0.0f) : aNormal ^ math::vec<float, 3>(0.0f, 1.0f, 0.0f);
+		aU = aU / std::sqrt(aU * aU);
+		aV = aNormal ^ aU;
+	}
+
+	// Replaces a feature's points with their convex polygon seen along aNormal, counter clockwise
+	// about it, by monotone chain. Collinear features come out as their two end points.
+	static int polygon(math::vec<float, 3>* aPoint, int aCount, const math::vec<float, 3>& aNormal) {
+		if (aCount < 3) return aCount;
+		math::vec<float, 3> U, V;
+		plane_basis(aNormal, U, V);
+		std::pair<float, float> Flat[MaxFeature];
+		int Order[MaxFeature];
+		for (int i = 0; i < aCount; i++) {
+			Flat[i] = std::make_pair(aPoint[i] * U, aPoint[i] * V);
+			Order[i] = i;
+		}
+		std::sort(Order, Order + aCount, [&](int a, int b) { return Flat[a] < Flat[b]; });
+		auto turn = [&](int o, int a, int b) {
+			return (Flat[a].first - Flat[o].first) * (Flat[b].second - Flat[o].second) - (Flat[a].second - Flat[o].second) * (Flat[b].first - Flat[o].first);
+		};
+		int Chain[2 * MaxFeature];
+		int n = 0;
+		for (int i = 0; i < aCount; i++) {
+			while ((n >= 2) && (turn(Chain[n - 2], Chain[n - 1], Order[i]) <= 0.0f)) n--;
+			Chain[n++] = Order[i];
+		}
+		for (int i = aCount - 2, Lower = n + 1; i >= 0; i--) {
+			while ((n >= Lower) && (turn(Chain[n - 2], Chain[n - 1], Order[i]) <= 0.0f)) n--;
+			Chain[n++] = Order[i];
+		}
+		n = std::max(n - 1, 1);
+		math::vec<float, 3> Sorted[MaxFeature];
+		for (int i = 0; i < n; i++) Sorted[i] = aPoint[Chain[i]];
+		for (int i = 0; i < n; i++) aPoint[i] = Sorted[i];
+		return n;
+	}
+
+	// Clips an incident polygon or segment to the prism over a convex reference polygon, counter
+	// clockwise about aNormal, Sutherland-Hodgman one reference edge at a time.
+	static int clip(const math::vec<float, 3>* aReference, int aReferenceCount, const math::vec<float, 3>& aNormal, math::vec<float, 3>* aPoint, int aCount) {
+		math::vec<float, 3> Out[2 * MaxFeature];
+		for (int e = 0; (e < aReferenceCount) && (aCount > 0); e++) {
+			const math::vec<float, 3>& Start = aReference[e];
+			const math::vec<float, 3> Inward = aNormal ^ (aReference[(e + 1) % aReferenceCount] - Start);
+			int n = 0;
+			if (aCount == 2) {
+				// A segment is cut back to the inside, not walked as a closed loop.
+				const float d0 = (aPoint[0] - Start) * Inward, d1 = (aPoint[1] - Start) * Inward;
+				if ((d0 < 0.0f) && (d1 < 0.0f)) return 0;
+				Out[n++] = d0 < 0.0f ? aPoint[0] + (aPoint[1] - aPoint[0]) * (d0 / (d0 - d1)) : aPoint[0];
+				Out[n++] = d1 < 0.0f ? aPoint[1] + (aPoint[0] - aPoint[1]) * (d1 / (d1 - d0)) : aPoint[1];
+			}
+			else {
+				for (int i = 0; i < aCount; i++) {
+					const math::vec<float, 3>& A = aPoint[(i + aCount - 1) % aCount];
+					const math::vec<float, 3>& B = aPoint[i];
+					const float da = (A - Start) * Inward, db = (B - Start) * Inward;
+					if ((da >= 0.0f) != (db >= 0.0f)) Out[n++] = A + (B - A) * (da / (da - db));
+					if (db >= 0.0f) Out[n++] = B;
+				}
+			}
+			n = std::min(n, 2 * (int)MaxFeature);
+			for (int i = 0; i < n; i++) aPoint[i] = Out[i];
+			aCount = n;
+		}
+		return aCount;
+	}
+
+	// Contact patch of two hulls touching along a face, the incident feature clipped to the
+	// reference face, the larger of the two. Returns 0 when neither feature is a face or the
+	// other is a single vertex, the caller then falls back to the single closest point.
+	static int patch(const hull& aA, const math::affine<float>& aTransformA, const hull& aB, const math::affine<float>& aTransformB, const simplex& aSimplex, const proximity& aResult, float aMargin, contact* aPatch) {
+		const math::vec<float, 3>& Normal = aResult.Normal;
+		uint32_t Index[MaxFeature];
+		math::vec<float, 3> FeatureA[2 * MaxFeature], FeatureB[2 * MaxFeature];
+		const uint32_t StartA = aSimplex.Count > 0 ? aSimplex.IndexA[0] : 0;
+		const uint32_t StartB = aSimplex.Count > 0 ? aSimplex.IndexB[0] : 0;
+		// Directions map through the transpose, the plateau tolerance stays in world units.
+		int CountA = (int)aA.feature(math::transpose(aTransformA.Linear) * Normal, aMargin, StartA, Index, MaxFeature);
+		for (int i = 0; i < CountA; i++) FeatureA[i] = aTransformA.transform_point(aA.Vertex[Index[i]]);
+		int CountB = (int)aB.feature(math::transpose(aTransformB.Linear) * (-Normal), aMargin, StartB, Index, MaxFeature);
+		for (int i = 0; i < CountB; i++) FeatureB[i] = aTransformB.transform_point(aB.Vertex[Index[i]]);
+		CountA = polygon(FeatureA, CountA, Normal);
+		CountB = polygon(FeatureB, CountB, Normal);
+		if ((std::max(CountA, CountB) < 3) || (std::min(CountA, CountB) < 2)) return 0;
+
+		const bool ReferenceA = CountA >= CountB;
+		math::vec<float, 3>* Incident = ReferenceA ? FeatureB : FeatureA;
+		const int Count = clip(ReferenceA ? FeatureA : FeatureB, ReferenceA ? CountA : CountB, Normal, Incident, ReferenceA ? CountB : CountA);
+
+		// The reference face is taken as the plane across the normal through its furthest vertex.
+		float Plane = -std::numeric_limits<float>::max();
+		for (int i = 0; i < (ReferenceA ? CountA : CountB); i++) {
+			const float Height = (ReferenceA ? FeatureA[i] : -FeatureB[i]) * Normal;
+			Plane = std::max(Plane, Height);
+		}
+		if (!ReferenceA) Plane = -Plane;
+		int n = 0;
+		for (int i = 0; i < Count; i++) {
+			contact C;
+			C.Normal = Normal;
+			const float Height = Incident[i] * Normal;
+			C.Depth = ReferenceA ? Plane - Height : Height - Plane;
+			if (C.Depth < -aMargin) continue;
+			C.PositionA = ReferenceA ? Incident[i] + Normal * C.Depth : Incident[i];
+			C.PositionB = ReferenceA ? Incident[i] : Incident[i] - Normal * C.Depth;
+			aPatch[n++] = C;
+		}
+		return n;
+	}
+
+	// Keeps at most four points of a patch, the deepest, the one furthest from it, then the two
+	// adding the most area to the polygon they span.
+	static int select(contact* aPoint, int aCount) {
+		if (aCount <= 4) return aCount;
+		auto pick = [&](int aSlot, auto aScore) {
+			int Best = aSlot;
+			float BestScore = aScore(aPoint[aSlot]);
+			for (int i = aSlot + 1; i < aCount; i++) {
+				const float Score = aScore(aPoint[i]);
+				if (Score > BestScore) {
+					BestScore = Score;
+					Best = i;
+				}
+			}
+			std::swap(aPoint[aSlot], aPoint[Best]);
+			return BestScore;
+		};
+		pick(0, [](const contact& C) { return C.Depth; });
+		const math::vec<float, 3> P0 = aPoint[0].PositionA;
+		pick(1, [&](const contact& C) { const math::vec<float, 3> D = C.PositionA - P0; return D * D; });
+		const math::vec<float, 3> P1 = aPoint[1].PositionA;
+		pick(2, [&](const contact& C) { const math::vec<float, 3> X = (C.PositionA - P0) ^ (P1 - P0); return X * X; });
+		const math::vec<float, 3> P2 = aPoint[2].PositionA;
+		const math::vec<float, 3> Up = (P1 - P0) ^ (P2 - P0);
+		// Area a point adds outside the triangle, the most negative edge side.
+		const float Added = pick(3, [&](const contact& C) {
+			const math::vec<float, 3> P = C.PositionA;
+			const float s0 = ((P1 - P0) ^ (P - P0)) * Up, s1 = ((P2 - P1) ^ (P - P1)) * Up, s2 = ((P0 - P2) ^ (P - P2)) * Up;
+			return -std::min(s0, std::min(s1, s2));
+		});
+		return Added > 0.0f ? 4 : 3;
+	}
+
+	narrow_phase::narrow_phase(float aMargin, float aBreaking) {
+		this->Margin		= aMargin;
+		this->Breaking		= aBreaking;
+		this->Stamp			= 0;
+	}
+
+	void narrow_phase::build(const std::vector<node*>& aNodeList) {
+		std::vector<const mesh*> Missing;
+		for (node* N : aNodeList) {
+			if ((N == nullptr) || (N->CollisionMesh == nullptr)) continue;
+			if (this->Hull.emplace(N->CollisionMesh.get(), nullptr).second) {
+				Missing.push_back(N->CollisionMesh.get());
+			}
+		}
+		std::vector<std::shared_ptr<hull>> Built(Missing.size());
+		#pragma omp parallel for schedule(dynamic)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)Missing.size(); i++) {
+			Built[i] = std::make_shared<hull>(*Missing[i]);
+		}
+		for (std::size_t i = 0; i < Missing.size(); i++) {
+			this->Hull[Missing[i]] = Built[i];
+		}
+	}
+
+	std::vector<manifold> narrow_phase::collide(const std::vector<std::pair<node*, node*>>& aPair) {
+		this->Stamp++;
+
+		// Build hulls for meshes seen for the first time.
+		std::vector<node*> Listed;
+		Listed.reserve(2 * aPair.size());
+		for (const auto& Pair : aPair) {
+			Listed.push_back(Pair.first);
+			Listed.push_back(Pair.second);
+		}
+		this->build(Listed);
+
+		// Pair states are looked up serially, references into the map stay valid while it grows.
+		// A pair listed twice is only processed once.
+		std::vector<pair_state*> State(aPair.size(), nullptr);
+		std::vector<const hull*> HullA(aPair.size()), HullB(aPair.size());
+		for (std::size_t i = 0; i < aPair.size(); i++) {
+			// std::less gives unrelated pointers a total order, < does not.
+			node* A = std::min(aPair[i].first, aPair[i].second, std::less<node*>());
+			node* B = std::max(aPair[i].first, aPair[i].second, std::less<node*>());
+			if ((A == nullptr) || (A == B) || (A->CollisionMesh == nullptr) || (B->CollisionMesh == nullptr)) continue;
+			pair_state& S = this->State[std::make_pair(A, B)];
+			if (S.Seen == this->Stamp) continue;
+			S.Seen = this->Stamp;
+			S.Manifold.A = A;
+			S.Manifold.B = B;
+			State[i] = &S;
+			HullA[i] = this->Hull[A->CollisionMesh.get()].get();
+			HullB[i] = this->Hull[B->CollisionMesh.get()].get();
+		}
+
+		#pragma omp parallel for schedule(dynamic, 16) if(aPair.size() > 64)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aPair.size(); i++) {
+			if ((State[i] == nullptr) || (HullA[i]->Vertex.size() == 0) || (HullB[i]->Vertex.size() == 0)) continue;
+			pair_state& S = *State[i];
+			manifold& M = S.Manifold;
+			const math::affine<float>& TransformA = M.A->GlobalTransform;
+			const math::affine<float>& TransformB = M.B->GlobalTransform;
+
+			proximity Result = gjk(*HullA[i], TransformA, *HullB[i], TransformB, S.Simplex);
+			if (Result.Intersecting && !epa(*HullA[i], TransformA, *HullB[i], TransformB, S.Simplex, Result)) {
+				// Without a polytope the hulls only touch, GJK's point and center normal stand in.
+				// A full simplex has no such point, GJK leaves it at the origin, so no new contact
+				// is added and the cached ones carry the pair through this step.
+				if (S.Simplex.Count == 4) {
+					refresh(M, TransformA, TransformB, this->Margin, this->Breaking);
+					continue;
+				}
+			}
+
+			refresh(M, TransformA, TransformB, this->Margin, this->Breaking);
+			if (Result.Depth < -this->Margin) {
+				M.Count = 0;
+				continue;
+			}
+			const float DeterminantA = math::determinant(TransformA.Linear);
+			const float DeterminantB = math::determinant(TransformB.Linear);
+			if ((DeterminantA == 0.0f) || (DeterminantB == 0.0f)) continue;
+
+			const math::affine<float> InverseA = math::inverse(TransformA);
+			const math::affine<float> InverseB = math::inverse(TransformB);
+
+			// A face contact replaces the manifold with its clipped patch, points landing on
+			// cached ones carry their impulses over.
+			contact Patch[2 * MaxFeature];
+			const int PatchCount = select(Patch, patch(*HullA[i], TransformA, *HullB[i], TransformB, S.Simplex, Result, this->Margin, Patch));
+			if (PatchCount >= 2) {
+				for (int p = 0; p < PatchCount; p++) {
+					contact& C = Patch[p];
+					C.LocalA = InverseA.transform_point(C.PositionA);
+					C.LocalB = InverseB.transform_point(C.PositionB);
+					for (int k = 0; k < M.Count; k++) {
+						const math::vec<float, 3> Offset = M.Point[k].PositionA - C.PositionA;
+						if ((Offset * Offset) < this->Breaking * this->Breaking) {
+							for (int l = 0; l < 3; l++) C.Impulse[l] = M.Point[k].Impulse[l];
+							break;
+						}
+					}
+				}
+				for (int p = 0; p < PatchCount; p++) M.Point[p] = Patch[p];
+				M.Count = PatchCount;
+				continue;
+			}
+
+			contact C;
+			C.PositionA = Result.PointA;
+			C.PositionB = Result.PointB;
+			C.LocalA = InverseA.transform_point(Result.PointA);
+			C.LocalB = InverseB.transform_point(Result.PointB);
+			C.Normal = Result.Normal;
+			C.Depth = Result.Depth;
+
+			// A new point close to a cached one replaces it, otherwise it is added.
+			int Slot = M.Count;
+			for (int k = 0; k < M.Count; k++) {
+				const math::vec<float, 3> Offset = M.Point[k].PositionA - C.PositionA;
+				if ((Offset * Offset) < this->Breaking * this->Breaking) {
+					Slot = k;
+					break;
+				}
+			}
+			if (Slot < M.Count) {
+				// The replaced point was the same contact, its impulse stays a good guess.
+				for (int k = 0; k < 3; k++) C.Impulse[k] = M.Point[Slot].Impulse[k];
+				M.Point[Slot] = C;
+			}
+			else if (M.Count < 4) {
+				M.Point[M.Count++] = C;
+			}
+			else {
+				contact Candidate[5] = { M.Point[0], M.Point[1], M.Point[2], M.Point[3], C };
+				reduce(Candidate, M);
+			}
+		}
+
+		// Forget pairs that were not listed this step.
+		for (auto It = this->State.begin(); It != this->State.end(); ) {
+			if (It->second.Seen != this->Stamp) {
+				It = this->State.erase(It);
+			}
+			else {
+				++It;
+			}
+		}
+
+		std::vector<manifold> Out;
+		for (std::size_t i = 0; i < aPair.size(); i++) {
+			if ((State[i] != nullptr) && (State[i]->Manifold.Count > 0)) {
+				Out.push_back(State[i]->Manifold);
+			}
+		}
+		return Out;
+	}
+
+	void narrow_phase::store(const std::vector<manifold>& aManifold) {
+		for (const manifold& M : aManifold) {
+			auto It = this->State.find(std::make_pair(M.A, M.B));
+			if (It == this->State.end()) continue;
+			manifold& Cached = It->second.Manifold;
+			for (int i = 0; i < std::min(M.Count, Cached.Count); i++) {
+				for (int k = 0; k < 3; k++) Cached.Point[i].Impulse[k] = M.Point[i].Impulse[k];
+			}
+		}
+	}
+
+}
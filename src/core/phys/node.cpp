@@ -14,8 +14,13 @@ namespace geodesy::core::phys {
 	node::node() {
 		this->Identifier 				= "";
 		this->Type 				= node::PHYSICS; // Default type to PHYSICS.
+		this->MotionType 		= node::STATIC; // Default to not moving.
+		this->GravityEnabled 	= false;
+		this->Sleeping 			= false;
+		this->IdleTime 			= 0.0f;
 		this->Root 				= this;
 		this->Parent 			= nullptr;
+		this->TreeIndex 		= 0;
 		this->Mass 				= 1.0f; // Default mass to 1 kg.
 		this->InertiaTensor 	= {
 			1.0f, 0.0f, 0.0f,
@@ -27,19 +32,9 @@ namespace geodesy::core::phys {
 		this->Scale 			= { 1.0f, 1.0f, 1.0f }; // Default scale to 1 in all dimensions.
 		this->LinearMomentum 	= { 0.0f, 0.0f, 0.0f }; // Default linear momentum to zero.
 		this->AngularMomentum 	= { 0.0f, 0.0f, 0.0f }; // Default angular momentum to zero.
-		this->DefaultTransform 	= {
-			1.0f, 0.0f, 0.0f, 0.0f,
-			0.0f, 1.0f, 0.0f, 0.0f,
-			0.0f, 0.0f, 1.0f, 0.0f,
-			0.0f, 0.0f, 0.0f, 1.0f
-		};
-		this->CurrentTransform = this->DefaultTransform;
-		this->GlobalTransform = {
-			1.0f, 0.0f, 0.0f, 0.0f,
-			0.0f, 1.0f, 0.0f, 0.0f,
-			0.0f, 0.0f, 1.0f, 0.0f,
-			0.0f, 0.0f, 0.0f, 1.0f
-		};
+		this->DefaultTransform 	= math::affine<float>(); // Default transforms to identity.
+		this->CurrentTransform 	= this->DefaultTransform;
+		this->GlobalTransform 	= this->DefaultTransform;
 	}
 
 	node::~node() {
@@ -58,7 +53,7 @@ namespace geodesy::core::phys {
 	}
 
 	// The main transform function that calculates the model transform for this node.
-	math::mat<float, 4, 4> node::transform() const {
+	math::affine<float> node::transform() const {
 		// Recursively calculates the world transform for this node using current state of the node hierarchy.
 		if (this->Root != this) {
 			return this->Parent->transform() * this->CurrentTransform;
@@ -104,6 +99,10 @@ namespace geodesy::core::phys {
 		// This is used to copy data from one node to another.
 		this->Identifier = aNode->Identifier;
 		this->Type = aNode->Type;
+		this->MotionType = aNode->MotionType;
+		this->GravityEnabled = aNode->GravityEnabled;
+		this->Sleeping = aNode->Sleeping;
+		this->IdleTime = aNode->IdleTime;
 		this->Mass = aNode->Mass;
 		this->InertiaTensor = aNode->InertiaTensor;
 		this->Position = aNode->Position;
@@ -155,8 +154,8 @@ namespace geodesy::core::phys {
 		// Check if model exists.
 		if (Object->Model == nullptr) return;
 
-		auto AnimationWeight = Object->AnimationWeights;
-		auto PlaybackAnimation = Object->Model->Animation;
+		const auto& AnimationWeight = Object->AnimationWeights;
+		const auto& PlaybackAnimation = Object->Model->Animation;
 
 		// No Animation Data, just use bind pose.
 		if (!(PlaybackAnimation.size() > 0 ? PlaybackAnimation.size() + 1 == AnimationWeight.size() : false)) return;
@@ -164,23 +163,28 @@ namespace geodesy::core::phys {
 		// Bind Pose Transform
 		this->CurrentTransform = (this->DefaultTransform * AnimationWeight[0]);
 
-		// TODO: Figure out how to load animations per node. Also incredibly slow right now. Optimize Later.
+		// Each node plays back every clip of the model, and keeps where it left off in each.
+		if (this->AnimationCursor.size() != PlaybackAnimation.size()) {
+			this->AnimationCursor.resize(PlaybackAnimation.size());
+		}
+
 		// Overrides/Averages Animation Transformations with Bind Pose Transform based on weights.
 		for (size_t i = 0; i < PlaybackAnimation.size(); i++) {
 			// Check if Animation Data exists for this node, if not, use bind pose.
-			// Pull animation for readability.
-			auto& NodeAnimation = PlaybackAnimation[i][this->Identifier];
+			// Tracks are compiled in the order of the linearized hierarchy at model load.
+			const animation& Animation = PlaybackAnimation[i];
 			float Weight = AnimationWeight[i + 1];
-			if (NodeAnimation.exists()) {
+			if ((this->TreeIndex < Animation.Track.size()) && Animation.Track[this->TreeIndex].exists()) {
+				const animation::node& NodeAnimation = Animation.Track[this->TreeIndex];
 				// Calculate time in ticks
-				float TickerTime = aTime * PlaybackAnimation[i].TicksPerSecond;
+				float TickerTime = aTime * Animation.TicksPerSecond;
 				// Ensure TickerTime is within the bounds of the animation.
-				float BoundedTickerTime = std::fmod(TickerTime, PlaybackAnimation[i].Stop - PlaybackAnimation[i].Start) + PlaybackAnimation[i].Start;
+				float BoundedTickerTime = std::fmod(TickerTime, Animation.Stop - Animation.Start) + Animation.Start;
 				if (this->Root == this) {
-					this->CurrentTransform += this->DefaultTransform * NodeAnimation[BoundedTickerTime] * Weight;
+					this->CurrentTransform += this->DefaultTransform * NodeAnimation.sample(BoundedTickerTime, this->AnimationCursor[i]) * Weight;
 				}
 				else {
-					this->CurrentTransform += NodeAnimation[BoundedTickerTime] * Weight;
+					this->CurrentTransform += NodeAnimation.sample(BoundedTickerTime, this->AnimationCursor[i]) * Weight;
 				}
 			}
 			else {
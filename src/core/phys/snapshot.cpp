@@ -0,0 +1,186 @@
+#include <geodesy/core/phys/snapshot.h>
+
+#include <geodesy/core/phys/node.h>
+
+#include <stdexcept>
+
+#include <omp.h>
+
+namespace geodesy::core::phys {
+
+	snapshot::frame::frame() {
+		this->Time 			= 0.0;
+		this->DeltaTime 	= 0.0;
+		this->Accumulator 	= 0.0;
+		this->Stamp 		= 0;
+	}
+
+	snapshot::snapshot(std::size_t aCapacity) {
+		this->Capacity 		= 0;
+		this->Head 			= 0;
+		this->Count 		= 0;
+		this->reserve(aCapacity);
+	}
+
+	void snapshot::reserve(std::size_t aCapacity) {
+		this->Capacity = aCapacity;
+		this->Frame.resize(aCapacity);
+		this->State.resize(aCapacity * this->Node.size());
+		this->Head = 0;
+		this->Count = 0;
+	}
+
+	std::size_t snapshot::size() const {
+		return this->Count;
+	}
+
+	std::size_t snapshot::memory() const {
+		std::size_t Total = this->State.capacity() * sizeof(state) + this->Node.capacity() * sizeof(node*);
+		for (const frame& F : this->Frame) {
+			Total += sizeof(frame) + F.Pair.capacity() * sizeof(pair) + F.Point.capacity() * sizeof(point) + F.JointImpulse.capacity() * sizeof(math::vec<float, 3>) + F.Kinematic.capacity() * sizeof(std::pair<const node*, math::affine<float>>);
+		}
+		return Total;
+	}
+
+	const snapshot::frame& snapshot::operator[](std::size_t aBack) const {
+		if (aBack >= this->Count) {
+			throw std::out_of_range("phys::snapshot: no frame saved that far back.");
+		}
+		return this->Frame[(this->Head + this->Capacity - 1 - aBack) % this->Capacity];
+	}
+
+	void snapshot::save(const std::vector<node*>& aNodeList, double aTime, double aDeltaTime, const dynamics& aDynamics, const solver& aSolver, const collision::narrow_phase& aNarrowPhase) {
+		if (this->Capacity == 0) return;
+
+		// Nodes of STATIC hierarchies never change, the rest are kept in list order.
+		std::vector<node*> Listed;
+		Listed.reserve(this->Node.size());
+		for (node* N : aNodeList) {
+			if ((N->MotionType != node::motion::STATIC) || (N->Root->MotionType != node::motion::STATIC)) {
+				Listed.push_back(N);
+			}
+		}
+		if (Listed != this->Node) {
+			this->Node.swap(Listed);
+			this->reserve(this->Capacity);
+		}
+
+		const std::size_t Slot = this->Head;
+		state* Record = this->State.data() + Slot * this->Node.size();
+		#pragma omp parallel for if(this->Node.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)this->Node.size(); i++) {
+			const node* N = this->Node[i];
+			state& S = Record[i];
+			S.Position 			= N->Position;
+			S.Orientation 		= N->Orientation;
+			S.Scale 			= N->Scale;
+			S.LinearMomentum 	= N->LinearMomentum;
+			S.AngularMomentum 	= N->AngularMomentum;
+			S.IdleTime 			= N->IdleTime;
+			S.Sleeping 			= N->Sleeping ? 1u : 0u;
+			S.GlobalTransform 	= N->GlobalTransform;
+		}
+
+		frame& F = this->Frame[Slot];
+		F.Time 			= aTime;
+		F.DeltaTime 	= aDeltaTime;
+		F.Accumulator 	= aDynamics.Accumulator;
+		F.Stamp 		= aNarrowPhase.Stamp;
+		F.Pair.resize(aNarrowPhase.State.size());
+		F.Point.clear();
+		std::size_t p = 0;
+		for (const auto& Entry : aNarrowPhase.State) {
+			const collision::manifold& M = Entry.second.Manifold;
+			pair& P = F.Pair[p++];
+			P.A 		= Entry.first.first;
+			P.B 		= Entry.first.second;
+			P.Simplex 	= Entry.second.Simplex;
+			P.First 	= (uint32_t)F.Point.size();
+			P.Count 	= M.Count;
+			for (int k = 0; k < M.Count; k++) {
+				const collision::contact& C = M.Point[k];
+				F.Point.push_back({ C.LocalA, C.LocalB, C.Normal, { C.Impulse[0], C.Impulse[1], C.Impulse[2] } });
+			}
+		}
+		F.JointImpulse.resize(aSolver.Joint.size());
+		for (std::size_t j = 0; j < aSolver.Joint.size(); j++) {
+			F.JointImpulse[j] = aSolver.Joint[j].Impulse;
+		}
+		F.Kinematic.assign(aSolver.Kinematic.begin(), aSolver.Kinematic.end());
+
+		this->Head = (Slot + 1) % this->Capacity;
+		if (this->Count < this->Capacity) this->Count++;
+	}
+
+	double snapshot::restore(std::size_t aBack, dynamics& aDynamics, solver& aSolver, collision::narrow_phase& aNarrowPhase) {
+		if (aBack >= this->Count) {
+			throw std::out_of_range("phys::snapshot: no frame saved that far back.");
+		}
+		const std::size_t Slot = (this->Head + this->Capacity - 1 - aBack) % this->Capacity;
+
+		const state* Record = this->State.data() + Slot * this->Node.size();
+		#pragma omp parallel for if(this->Node.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)this->Node.size(); i++) {
+			node* N = this->Node[i];
+			const state& S = Record[i];
+			N->Position 			= S.Position;
+			N->Orientation 			= S.Orientation;
+			N->Scale 				= S.Scale;
+			N->LinearMomentum 		= S.LinearMomentum;
+			N->AngularMomentum 		= S.AngularMomentum;
+			N->IdleTime 			= S.IdleTime;
+			N->Sleeping 			= S.Sleeping != 0;
+			N->GlobalTransform 		= S.GlobalTransform;
+			if (N->Root == N) {
+				N->CurrentTransform = calculate_transform(N->Position, N->Orientation, N->Scale);
+			}
+		}
+
+		const frame& F = this->Frame[Slot];
+		// Queued forces belong to the frame being replaced.
+		aDynamics.Accumulator = F.Accumulator;
+		aDynamics.AppliedForce.clear();
+		if (F.JointImpulse.size() == aSolver.Joint.size()) {
+			for (std::size_t j = 0; j < aSolver.Joint.size(); j++) {
+				aSolver.Joint[j].Impulse = F.JointImpulse[j];
+			}
+		}
+		aSolver.Kinematic.clear();
+		aSolver.Kinematic.insert(F.Kinematic.begin(), F.Kinematic.end());
+		// Pairs still cached are overwritten in place, saved ones are marked with the frame's stamp
+		// and the cached ones left unmarked are newer than the frame.
+		aNarrowPhase.Stamp = F.Stamp;
+		for (auto& Entry : aNarrowPhase.State) {
+			Entry.second.Seen = F.Stamp + 1;
+		}
+		for (const pair& P : F.Pair) {
+			collision::narrow_phase::pair_state& S = aNarrowPhase.State[std::make_pair(P.A, P.B)];
+			S.Simplex 			= P.Simplex;
+			S.Seen 				= F.Stamp;
+			S.Manifold.A 		= P.A;
+			S.Manifold.B 		= P.B;
+			S.Manifold.Count 	= P.Count;
+			for (int k = 0; k < P.Count; k++) {
+				const point& C = F.Point[P.First + k];
+				collision::contact& Point = S.Manifold.Point[k];
+				Point.LocalA 	= C.LocalA;
+				Point.LocalB 	= C.LocalB;
+				Point.Normal 	= C.Normal;
+				for (int l = 0; l < 3; l++) Point.Impulse[l] = C.Impulse[l];
+			}
+		}
+		for (auto It = aNarrowPhase.State.begin(); It != aNarrowPhase.State.end(); ) {
+			if (It->second.Seen != F.Stamp) {
+				It = aNarrowPhase.State.erase(It);
+			}
+			else {
+				++It;
+			}
+		}
+
+		this->Head = (Slot + 1) % this->Capacity;
+		this->Count -= aBack;
+		return F.Time;
+	}
+
+}
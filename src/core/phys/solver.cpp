@@ -0,0 +1,500 @@
+#include <geodesy/core/phys/solver.h>
+
+#include <geodesy/core/phys/node.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include <omp.h>
+
+namespace geodesy::core::phys {
+
+	namespace {
+
+		typedef math::vec<float, 3> vec3;
+		typedef math::mat<float, 3, 3> mat3;
+
+		mat3 rotation(float w, float x, float y, float z) {
+			return mat3(
+				1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z), 2.0f * (x * z + w * y),
+				2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x),
+				2.0f * (x * z - w * y), 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + y * y)
+			);
+		}
+
+		mat3 rotation(const dynamics::body_array& aBody, int aIndex) {
+			return rotation(aBody.Orientation[0][aIndex], aBody.Orientation[1][aIndex], aBody.Orientation[2][aIndex], aBody.Orientation[3][aIndex]);
+		}
+
+		mat3 rotation(const node* aNode) {
+			return rotation(aNode->Orientation[0], aNode->Orientation[1], aNode->Orientation[2], aNode->Orientation[3]);
+		}
+
+		vec3 position(const dynamics::body_array& aBody, int aIndex) {
+			return vec3(aBody.Position[0][aIndex], aBody.Position[1][aIndex], aBody.Position[2][aIndex]);
+		}
+
+		// Body space inverse inertia of a gathered body.
+		mat3 inverse_inertia(const dynamics::body_array& aBody, int aIndex) {
+			const float xx = aBody.InverseInertia[0][aIndex], yy = aBody.InverseInertia[1][aIndex], zz = aBody.InverseInertia[2][aIndex];
+			const float xy = aBody.InverseInertia[3][aIndex], xz = aBody.InverseInertia[4][aIndex], yz = aBody.InverseInertia[5][aIndex];
+			return mat3(
+				xx, xy, xz,
+				xy, yy, yz,
+				xz, yz, zz
+			);
+		}
+
+		// Loads velocity and world space inverse inertia from the body's momenta.
+		void load(const dynamics::body_array& aBody, solver::body& aSolved) {
+			const int i = aSolved.Index;
+			const mat3 R = rotation(aBody, i);
+			aSolved.InverseMass = aBody.InverseMass[i];
+			aSolved.InverseInertia = R * inverse_inertia(aBody, i) * math::transpose(R);
+			const vec3 P(aBody.LinearMomentum[0][i], aBody.LinearMomentum[1][i], aBody.LinearMomentum[2][i]);
+			const vec3 L(aBody.AngularMomentum[0][i], aBody.AngularMomentum[1][i], aBody.AngularMomentum[2][i]);
+			aSolved.LinearVelocity = P * aSolved.InverseMass;
+			aSolved.AngularVelocity = aSolved.InverseInertia * L;
+			aSolved.LinearImpulse = vec3();
+			aSolved.AngularImpulse = vec3();
+		}
+
+		// Two unit tangents completing a right handed basis with the normal, a pure function of it
+		// so friction impulses stay meaningful across steps.
+		void basis(const vec3& aNormal, vec3& aTangentA, vec3& aTangentB) {
+			if (std::abs(aNormal[0]) >= 0.57735f) {
+				aTangentA = math::normalize(vec3(aNormal[1], -aNormal[0], 0.0f));
+			}
+			else {
+				aTangentA = math::normalize(vec3(0.0f, aNormal[2], -aNormal[1]));
+			}
+			aTangentB = aNormal ^ aTangentA;
+		}
+
+		// World point of an anchor, anchors of infinite mass bodies are already in world space.
+		vec3 anchor(const dynamics::body_array& aBody, const std::vector<solver::body>& aSolved, int aBodyIndex, const vec3& aAnchor) {
+			if (aBodyIndex < 0) return aAnchor;
+			const int i = aSolved[aBodyIndex].Index;
+			return position(aBody, i) + rotation(aBody, i) * aAnchor;
+		}
+
+		vec3 origin(const dynamics::body_array& aBody, const std::vector<solver::body>& aSolved, int aBodyIndex) {
+			return aBodyIndex < 0 ? vec3() : position(aBody, aSolved[aBodyIndex].Index);
+		}
+
+		// Velocity of a body point, zero for infinite mass bodies.
+		vec3 velocity(const std::vector<solver::body>& aSolved, int aBodyIndex, const vec3& aOffset) {
+			if (aBodyIndex < 0) return vec3();
+			const solver::body& S = aSolved[aBodyIndex];
+			return S.LinearVelocity + (S.AngularVelocity ^ aOffset);
+		}
+
+		void apply(std::vector<solver::body>& aSolved, int aBodyIndex, const vec3& aOffset, const vec3& aImpulse) {
+			if (aBodyIndex < 0) return;
+			solver::body& S = aSolved[aBodyIndex];
+			const vec3 Angular = aOffset ^ aImpulse;
+			S.LinearVelocity += aImpulse * S.InverseMass;
+			S.AngularVelocity += S.InverseInertia * Angular;
+			S.LinearImpulse += aImpulse;
+			S.AngularImpulse += Angular;
+		}
+
+		// Inverse mass seen along a direction at a body point.
+		float effective(const std::vector<solver::body>& aSolved, int aBodyIndex, const vec3& aOffset, const vec3& aDirection) {
+			if (aBodyIndex < 0) return 0.0f;
+			const solver::body& S = aSolved[aBodyIndex];
+			const vec3 Arm = aOffset ^ aDirection;
+			return S.InverseMass + Arm * (S.InverseInertia * Arm);
+		}
+
+		// Cross product matrix, skew(a) * b = a ^ b.
+		mat3 skew(const vec3& a) {
+			return mat3(
+				0.0f, -a[2], a[1],
+				a[2], 0.0f, -a[0],
+				-a[1], a[0], 0.0f
+			);
+		}
+
+	}
+
+	solver::joint::joint() {
+		this->A = nullptr;
+		this->B = nullptr;
+	}
+
+	solver::joint::joint(node* aA, node* aB, const math::vec<float, 3>& aPoint) {
+		this->A = aA;
+		this->B = aB;
+		this->LocalA = math::transpose(rotation(aA->Root)) * (aPoint - aA->Root->Position);
+		this->LocalB = aB == nullptr ? aPoint : math::transpose(rotation(aB->Root)) * (aPoint - aB->Root->Position);
+	}
+
+	solver::solver() {
+		this->Iteration 		= 8;
+		this->Friction 			= 0.5f;
+		this->Restitution 		= 0.0f;
+		this->BounceThreshold 	= 1.0f;
+		this->Baumgarte 		= 0.2f;
+		this->Slop 				= 0.005f;
+		this->MaxBias 			= 4.0f;
+		this->SleepLinear 		= 0.05f;
+		this->SleepAngular 		= 0.05f;
+		this->SleepTime 		= 0.5f;
+	}
+
+	int solver::find(int aIndex) {
+		while (this->Parent[aIndex] != aIndex) {
+			this->Parent[aIndex] = this->Parent[this->Parent[aIndex]];
+			aIndex = this->Parent[aIndex];
+		}
+		return aIndex;
+	}
+
+	void solver::wake(const std::vector<collision::manifold>& aContact) {
+		auto awake = [](const node* aNode) {
+			return (aNode != nullptr) && (aNode->MotionType == node::motion::DYNAMIC) && !aNode->Sleeping;
+		};
+		auto asleep = [](const node* aNode) {
+			return (aNode != nullptr) && (aNode->MotionType == node::motion::DYNAMIC) && aNode->Sleeping;
+		};
+		// Static and animated nodes are moved by animation or by hand, which shows as a change of
+		// GlobalTransform since the previous step.
+		for (const collision::manifold& M : aContact) {
+			for (int Side = 0; Side < 2; Side++) {
+				node* Sleeper = (Side == 0 ? M.A : M.B)->Root;
+				const node* Other = Side == 0 ? M.B : M.A;
+				if (!asleep(Sleeper) || (Other->Root->MotionType == node::motion::DYNAMIC)) continue;
+				auto It = this->Kinematic.find(Other);
+				if ((It != this->Kinematic.end()) && (std::memcmp(&It->second, &Other->GlobalTransform, sizeof(math::affine<float>)) != 0)) {
+					Sleeper->Sleeping = false;
+					Sleeper->IdleTime = 0.0f;
+				}
+			}
+		}
+
+		std::vector<std::pair<node*, node*>> Link;
+		for (const collision::manifold& M : aContact) {
+			if (asleep(M.A->Root) || asleep(M.B->Root)) Link.emplace_back(M.A->Root, M.B->Root);
+		}
+		for (const joint& J : this->Joint) {
+			if (J.B == nullptr) continue;
+			if (asleep(J.A->Root) || asleep(J.B->Root)) Link.emplace_back(J.A->Root, J.B->Root);
+		}
+		// Each pass wakes one more link down a chain, sleeping chains are short.
+		bool Changed = true;
+		while (Changed) {
+			Changed = false;
+			for (auto& L : Link) {
+				if (awake(L.first) == awake(L.second)) continue;
+				node* N = awake(L.first) ? L.second : L.first;
+				if (!asleep(N)) continue;
+				N->Sleeping = false;
+				N->IdleTime = 0.0f;
+				Changed = true;
+			}
+		}
+	}
+
+	void solver::record(const std::vector<node*>& aNodeList) {
+		auto kinematic = [](const node* aNode) {
+			return (aNode->CollisionMesh != nullptr) && (aNode->Root->MotionType != node::motion::DYNAMIC);
+		};
+		// Entries are overwritten in place, the map is only rebuilt when nodes left the list.
+		std::size_t Count = 0;
+		for (const node* N : aNodeList) {
+			if (!kinematic(N)) continue;
+			this->Kinematic[N] = N->GlobalTransform;
+			Count++;
+		}
+		if (this->Kinematic.size() == Count) return;
+		this->Kinematic.clear();
+		for (const node* N : aNodeList) {
+			if (kinematic(N)) this->Kinematic[N] = N->GlobalTransform;
+		}
+	}
+
+	void solver::prepare(dynamics& aDynamics, const std::vector<collision::manifold>& aContact) {
+		const dynamics::body_array& B = aDynamics.Body;
+		const std::ptrdiff_t Count = B.size();
+		this->Parent.resize(Count);
+		std::iota(this->Parent.begin(), this->Parent.end(), 0);
+		this->Slot.assign(Count, -1);
+		this->Solved.clear();
+		this->ContactRow.clear();
+		this->JointRow.clear();
+
+		// Maps a node to its body in Solved, -1 for bodies not integrated this frame.
+		auto solved = [&](const node* aNode) -> int {
+			if (aNode == nullptr) return -1;
+			auto It = aDynamics.Index.find(aNode->Root);
+			if (It == aDynamics.Index.end()) return -1;
+			const int i = (int)It->second;
+			if (this->Slot[i] < 0) {
+				this->Slot[i] = (int)this->Solved.size();
+				body S;
+				S.Index = i;
+				load(B, S);
+				this->Solved.push_back(S);
+			}
+			return this->Slot[i];
+		};
+		auto unite = [&](int aA, int aB) {
+			if ((aA < 0) || (aB < 0)) return;
+			const int RA = this->find(this->Solved[aA].Index);
+			const int RB = this->find(this->Solved[aB].Index);
+			if (RA != RB) this->Parent[RA] = RB;
+		};
+
+		for (std::size_t m = 0; m < aContact.size(); m++) {
+			const collision::manifold& M = aContact[m];
+			if (M.A->Root == M.B->Root) continue;
+			const int A = solved(M.A);
+			const int Bi = solved(M.B);
+			if ((A < 0) && (Bi < 0)) continue;
+			unite(A, Bi);
+			const vec3 OriginA = origin(B, this->Solved, A);
+			const vec3 OriginB = origin(B, this->Solved, Bi);
+			for (int p = 0; p < M.Count; p++) {
+				const collision::contact& C = M.Point[p];
+				contact_row R;
+				R.A = A;
+				R.B = Bi;
+				R.Manifold = (int)m;
+				R.Point = p;
+				R.AnchorA = A < 0 ? C.PositionA : math::transpose(rotation(B, this->Solved[A].Index)) * (C.PositionA - OriginA);
+				R.AnchorB = Bi < 0 ? C.PositionB : math::transpose(rotation(B, this->Solved[Bi].Index)) * (C.PositionB - OriginB);
+				R.Normal = C.Normal;
+				basis(R.Normal, R.Tangent[0], R.Tangent[1]);
+				for (int k = 0; k < 3; k++) R.Impulse[k] = C.Impulse[k];
+				// The approach speed before this frame's forces decides the bounce.
+				const vec3 OffsetA = A < 0 ? vec3() : C.PositionA - OriginA;
+				const vec3 OffsetB = Bi < 0 ? vec3() : C.PositionB - OriginB;
+				const float Approach = (velocity(this->Solved, Bi, OffsetB) - velocity(this->Solved, A, OffsetA)) * R.Normal;
+				R.Bounce = Approach < -this->BounceThreshold ? -this->Restitution * Approach : 0.0f;
+				this->ContactRow.push_back(R);
+			}
+		}
+
+		for (std::size_t j = 0; j < this->Joint.size(); j++) {
+			const joint& J = this->Joint[j];
+			if (J.A == nullptr) continue;
+			const int A = solved(J.A);
+			const int Bi = solved(J.B);
+			if ((A < 0) && (Bi < 0)) continue;
+			unite(A, Bi);
+			joint_row R;
+			R.A = A;
+			R.B = Bi;
+			R.Joint = (int)j;
+			R.Impulse = J.Impulse;
+			this->JointRow.push_back(R);
+		}
+
+		// Rows are grouped by the root of their island, joints encoded as -1 - index.
+		std::vector<std::pair<int, int>> Key;
+		Key.reserve(this->ContactRow.size() + this->JointRow.size());
+		for (std::size_t r = 0; r < this->ContactRow.size(); r++) {
+			const contact_row& R = this->ContactRow[r];
+			Key.emplace_back(this->find(this->Solved[R.A >= 0 ? R.A : R.B].Index), (int)r);
+		}
+		for (std::size_t r = 0; r < this->JointRow.size(); r++) {
+			const joint_row& R = this->JointRow[r];
+			Key.emplace_back(this->find(this->Solved[R.A >= 0 ? R.A : R.B].Index), -1 - (int)r);
+		}
+		std::sort(Key.begin(), Key.end());
+		this->Order.resize(Key.size());
+		this->IslandStart.clear();
+		for (std::size_t k = 0; k < Key.size(); k++) {
+			if ((k == 0) || (Key[k].first != Key[k - 1].first)) this->IslandStart.push_back(k);
+			this->Order[k] = Key[k].second;
+		}
+		this->IslandStart.push_back(Key.size());
+	}
+
+	void solver::solve_island(dynamics& aDynamics, std::size_t aIsland, float aDeltaTime) {
+		const dynamics::body_array& B = aDynamics.Body;
+		const std::size_t Start = this->IslandStart[aIsland];
+		const std::size_t End = this->IslandStart[aIsland + 1];
+
+		// Rows follow the current poses, then the impulses of the last substep are applied again.
+		for (std::size_t k = Start; k < End; k++) {
+			if (this->Order[k] >= 0) {
+				contact_row& R = this->ContactRow[this->Order[k]];
+				const vec3 PointA = anchor(B, this->Solved, R.A, R.AnchorA);
+				const vec3 PointB = anchor(B, this->Solved, R.B, R.AnchorB);
+				R.OffsetA = R.A < 0 ? vec3() : PointA - origin(B, this->Solved, R.A);
+				R.OffsetB = R.B < 0 ? vec3() : PointB - origin(B, this->Solved, R.B);
+				const float Depth = (PointA - PointB) * R.Normal;
+				// Points still apart may close the gap within the substep, but no further.
+				R.Bias = Depth < 0.0f ? Depth / aDeltaTime : std::min(this->Baumgarte * std::max(Depth - this->Slop, 0.0f) / aDeltaTime, this->MaxBias);
+				if (R.Bounce > 0.0f) R.Bias = std::max(R.Bias, R.Bounce);
+				const vec3* Direction[3] = { &R.Normal, &R.Tangent[0], &R.Tangent[1] };
+				vec3 Impulse;
+				for (int d = 0; d < 3; d++) {
+					const float K = effective(this->Solved, R.A, R.OffsetA, *Direction[d]) + effective(this->Solved, R.B, R.OffsetB, *Direction[d]);
+					R.Mass[d] = K > 0.0f ? 1.0f / K : 0.0f;
+					Impulse += (*Direction[d]) * R.Impulse[d];
+				}
+				apply(this->Solved, R.A, R.OffsetA, -Impulse);
+				apply(this->Solved, R.B, R.OffsetB, Impulse);
+			}
+			else {
+				joint_row& R = this->JointRow[-1 - this->Order[k]];
+				const joint& J = this->Joint[R.Joint];
+				const vec3 PointA = R.A < 0 ? J.A->Root->Position + rotation(J.A->Root) * J.LocalA : anchor(B, this->Solved, R.A, J.LocalA);
+				const vec3 PointB = R.B < 0 ? (J.B == nullptr ? J.LocalB : J.B->Root->Position + rotation(J.B->Root) * J.LocalB) : anchor(B, this->Solved, R.B, J.LocalB);
+				R.OffsetA = R.A < 0 ? vec3() : PointA - origin(B, this->Solved, R.A);
+				R.OffsetB = R.B < 0 ? vec3() : PointB - origin(B, this->Solved, R.B);
+				//tex:
+				// $$ K = (m_{A}^{-1} + m_{B}^{-1}) I - [r_{A}]_{\times} I_{A}^{-1} [r_{A}]_{\times} - [r_{B}]_{\times} I_{B}^{-1} [r_{B}]_{\times} $$
+				mat3 K;
+				for (int side = 0; side < 2; side++) {
+					const int Index = side == 0 ? R.A : R.B;
+					if (Index < 0) continue;
+					const mat3 S = skew(side == 0 ? R.OffsetA : R.OffsetB);
+					K = K - S * this->Solved[Index].InverseInertia * S;
+					for (int d = 0; d < 3; d++) K(d, d) += this->Solved[Index].InverseMass;
+				}
+				const mat3 Adjugate = math::adjugate(K);
+				const float Det = K(0, 0) * Adjugate(0, 0) + K(0, 1) * Adjugate(1, 0) + K(0, 2) * Adjugate(2, 0);
+				R.Mass = Det > std::numeric_limits<float>::min() ? Adjugate * (1.0f / Det) : mat3();
+				R.Bias = (PointA - PointB) * (this->Baumgarte / aDeltaTime);
+				apply(this->Solved, R.A, R.OffsetA, -R.Impulse);
+				apply(this->Solved, R.B, R.OffsetB, R.Impulse);
+			}
+		}
+
+		for (int Pass = 0; Pass < this->Iteration; Pass++) {
+			for (std::size_t k = Start; k < End; k++) {
+				if (this->Order[k] >= 0) {
+					contact_row& R = this->ContactRow[this->Order[k]];
+					// Friction first, bounded by the normal impulse of the last pass.
+					for (int d = 1; d < 3; d++) {
+						const vec3 Relative = velocity(this->Solved, R.B, R.OffsetB) - velocity(this->Solved, R.A, R.OffsetA);
+						const float Limit = this->Friction * R.Impulse[0];
+						const float Old = R.Impulse[d];
+						R.Impulse[d] = std::clamp(Old - R.Mass[d] * (Relative * R.Tangent[d - 1]), -Limit, Limit);
+						const vec3 Delta = R.Tangent[d - 1] * (R.Impulse[d] - Old);
+						apply(this->Solved, R.A, R.OffsetA, -Delta);
+						apply(this->Solved, R.B, R.OffsetB, Delta);
+					}
+					const vec3 Relative = velocity(this->Solved, R.B, R.OffsetB) - velocity(this->Solved, R.A, R.OffsetA);
+					const float Old = R.Impulse[0];
+					R.Impulse[0] = std::max(Old - R.Mass[0] * (Relative * R.Normal - R.Bias), 0.0f);
+					const vec3 Delta = R.Normal * (R.Impulse[0] - Old);
+					apply(this->Solved, R.A, R.OffsetA, -Delta);
+					apply(this->Solved, R.B, R.OffsetB, Delta);
+				}
+				else {
+					joint_row& R = this->JointRow[-1 - this->Order[k]];
+					const vec3 Relative = velocity(this->Solved, R.B, R.OffsetB) - velocity(this->Solved, R.A, R.OffsetA);
+					const vec3 Delta = R.Mass * (R.Bias - Relative);
+					R.Impulse += Delta;
+					apply(this->Solved, R.A, R.OffsetA, -Delta);
+					apply(this->Solved, R.B, R.OffsetB, Delta);
+				}
+			}
+		}
+	}
+
+	void solver::solve(dynamics& aDynamics, float aDeltaTime) {
+		dynamics::body_array& B = aDynamics.Body;
+		std::vector<body>& S = this->Solved;
+
+		#pragma omp parallel for if(S.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)S.size(); i++) {
+			load(B, S[i]);
+		}
+
+		// Islands share no bodies, each is solved start to finish by one thread.
+		const std::ptrdiff_t IslandCount = (std::ptrdiff_t)this->IslandStart.size() - 1;
+		#pragma omp parallel for schedule(dynamic, 4) if(IslandCount > 1)
+		for (std::ptrdiff_t i = 0; i < IslandCount; i++) {
+			this->solve_island(aDynamics, i, aDeltaTime);
+		}
+
+		#pragma omp parallel for if(S.size() > 4096)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)S.size(); i++) {
+			for (std::size_t k = 0; k < 3; k++) {
+				B.LinearMomentum[k][S[i].Index] += S[i].LinearImpulse[k];
+				B.AngularMomentum[k][S[i].Index] += S[i].AngularImpulse[k];
+			}
+		}
+	}
+
+	void solver::finish(dynamics& aDynamics, std::vector<collision::manifold>& aContact, double aElapsed) {
+		const dynamics::body_array& B = aDynamics.Body;
+		for (const contact_row& R : this->ContactRow) {
+			for (int k = 0; k < 3; k++) aContact[R.Manifold].Point[R.Point].Impulse[k] = R.Impulse[k];
+		}
+		for (const joint_row& R : this->JointRow) {
+			this->Joint[R.Joint].Impulse = R.Impulse;
+		}
+		if (aElapsed <= 0.0) return;
+
+		// Flattened so every body reads its island root directly.
+		const std::ptrdiff_t Count = B.size();
+		for (std::ptrdiff_t i = 0; i < Count; i++) {
+			this->Parent[i] = this->find((int)i);
+		}
+
+		// An island rests while all of its bodies are slow, and sleeps once all have rested long enough.
+		std::vector<uint8_t> Resting(Count, 1), Sleepy(Count, 1);
+		const float Linear = this->SleepLinear * this->SleepLinear;
+		const float Angular = this->SleepAngular * this->SleepAngular;
+		#pragma omp parallel for if(Count > 4096)
+		for (std::ptrdiff_t i = 0; i < Count; i++) {
+			const vec3 P(B.LinearMomentum[0][i], B.LinearMomentum[1][i], B.LinearMomentum[2][i]);
+			const vec3 L(B.AngularMomentum[0][i], B.AngularMomentum[1][i], B.AngularMomentum[2][i]);
+			// Rotation keeps lengths, so the body space angular velocity has the world space speed.
+			const vec3 W = inverse_inertia(B, (int)i) * (math::transpose(rotation(B, (int)i)) * L);
+			const vec3 V = P * B.InverseMass[i];
+			if (((V * V) > Linear) || ((W * W) > Angular)) {
+				#pragma omp atomic write
+				Resting[this->Parent[i]] = 0;
+			}
+		}
+		#pragma omp parallel for if(Count > 4096)
+		for (std::ptrdiff_t i = 0; i < Count; i++) {
+			node* N = B.Node[i];
+			N->IdleTime = Resting[this->Parent[i]] ? N->IdleTime + (float)aElapsed : 0.0f;
+			if (N->IdleTime < this->SleepTime) {
+				#pragma omp atomic write
+				Sleepy[this->Parent[i]] = 0;
+			}
+		}
+		#pragma omp parallel for if(Count > 4096)
+		for (std::ptrdiff_t i = 0; i < Count; i++) {
+			if (!Sleepy[this->Parent[i]]) continue;
+			node* N = B.Node[i];
+			N->Sleeping = true;
+			N->LinearMomentum = vec3();
+			N->AngularMomentum = vec3();
+		}
+	}
+
+	int solver::update(dynamics& aDynamics, const std::vector<node*>& aNodeList, std::vector<collision::manifold>& aContact, double aDeltaTime) {
+		// Not enough time for a substep, forces stay queued for the next frame.
+		if (aDynamics.Accumulator + aDeltaTime < aDynamics.Substep) {
+			aDynamics.Accumulator += aDeltaTime;
+			return 0;
+		}
+		this->wake(aContact);
+		this->record(aNodeList);
+		aDynamics.gather(aNodeList);
+		this->prepare(aDynamics, aContact);
+		int Count = aDynamics.step(aDeltaTime, [&](float aSubstep) {
+			this->solve(aDynamics, aSubstep);
+		});
+		aDynamics.scatter();
+		aDynamics.AppliedForce.clear();
+		this->finish(aDynamics, aContact, Count * aDynamics.Substep);
+		return Count;
+	}
+
+}
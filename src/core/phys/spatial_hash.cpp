@@ -0,0 +1,218 @@
+#include <geodesy/core/phys/spatial_hash.h>
+
+#include <geodesy/core/phys/node.h>
+
+#include <algorithm>
+
+#include <omp.h>
+
+namespace geodesy::core::phys {
+
+	spatial_hash::spatial_hash(float aCellSize) {
+		this->CellSize 			= aCellSize;
+		this->InverseCellSize 	= 1.0f / aCellSize;
+		this->Mask 				= 0;
+	}
+
+	void spatial_hash::build(const float* aX, const float* aY, const float* aZ, std::size_t aCount) {
+		this->InverseCellSize = 1.0f / this->CellSize;
+		// Twice as many buckets as points keeps collisions between occupied cells rare.
+		uint32_t BucketCount = 1;
+		while (BucketCount < 2 * aCount) BucketCount <<= 1;
+		this->Mask = BucketCount - 1;
+		for (std::size_t k = 0; k < 3; k++) {
+			this->Position[k].resize(aCount);
+		}
+		this->Index.resize(aCount);
+		this->Bucket.resize(aCount);
+		this->Start.assign(BucketCount + 1, 0);
+
+		// Thread t counts and scatters input slice t, its bucket offsets are the counts of every
+		// lower bucket plus the counts of its own bucket in lower slices, a stable sort.
+		const int ThreadCount = aCount > 16384 ? omp_get_max_threads() : 1;
+		this->Histogram.assign((std::size_t)ThreadCount * BucketCount, 0);
+		std::vector<uint32_t> RangeTotal(ThreadCount + 1, 0);
+		#pragma omp parallel num_threads(ThreadCount)
+		{
+			const int t = omp_get_thread_num();
+			const int Threads = omp_get_num_threads();
+			const std::size_t First = aCount * t / Threads, Last = aCount * (t + 1) / Threads;
+			uint32_t* Count = &this->Histogram[(std::size_t)t * BucketCount];
+			for (std::size_t i = First; i < Last; i++) {
+				const uint32_t b = this->hash(this->cell(aX[i]), this->cell(aY[i]), this->cell(aZ[i]));
+				this->Bucket[i] = b;
+				Count[b]++;
+			}
+			#pragma omp barrier
+
+			// Exclusive scan over (bucket, slice), each thread first totals a range of buckets.
+			const uint32_t Low = (uint32_t)((uint64_t)BucketCount * t / Threads), High = (uint32_t)((uint64_t)BucketCount * (t + 1) / Threads);
+			uint32_t Total = 0;
+			for (uint32_t b = Low; b < High; b++) {
+				for (int s = 0; s < Threads; s++) {
+					Total += this->Histogram[(std::size_t)s * BucketCount + b];
+				}
+			}
+			RangeTotal[t + 1] = Total;
+			#pragma omp barrier
+			#pragma omp single
+			{
+				for (int s = 0; s < Threads; s++) {
+					RangeTotal[s + 1] += RangeTotal[s];
+				}
+			}
+			uint32_t Offset = RangeTotal[t];
+			for (uint32_t b = Low; b < High; b++) {
+				this->Start[b] = Offset;
+				for (int s = 0; s < Threads; s++) {
+					uint32_t& C = this->Histogram[(std::size_t)s * BucketCount + b];
+					const uint32_t n = C;
+					C = Offset;
+					Offset += n;
+				}
+			}
+			#pragma omp barrier
+
+			for (std::size_t i = First; i < Last; i++) {
+				this->Index[Count[this->Bucket[i]]++] = (uint32_t)i;
+			}
+			#pragma omp barrier
+
+			// Positions are gathered in sorted order, independent reads overlap where scattered
+			// writes would not.
+			for (std::size_t s = First; s < Last; s++) {
+				const uint32_t i = this->Index[s];
+				this->Position[0][s] = aX[i];
+				this->Position[1][s] = aY[i];
+				this->Position[2][s] = aZ[i];
+			}
+		}
+		this->Start[BucketCount] = (uint32_t)aCount;
+	}
+
+	void spatial_hash::build(const std::vector<math::vec<float, 3>>& aPoint) {
+		for (std::size_t k = 0; k < 3; k++) {
+			this->Input[k].resize(aPoint.size());
+		}
+		#pragma omp parallel for if(aPoint.size() > 16384)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aPoint.size(); i++) {
+			for (std::size_t k = 0; k < 3; k++) {
+				this->Input[k][i] = aPoint[i][k];
+			}
+		}
+		this->build(this->Input[0].data(), this->Input[1].data(), this->Input[2].data(), aPoint.size());
+	}
+
+	void spatial_hash::build(const std::vector<node*>& aNodeList) {
+		for (std::size_t k = 0; k < 3; k++) {
+			this->Input[k].resize(aNodeList.size());
+		}
+		#pragma omp parallel for if(aNodeList.size() > 16384)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)aNodeList.size(); i++) {
+			for (std::size_t k = 0; k < 3; k++) {
+				this->Input[k][i] = aNodeList[i]->GlobalTransform.Translation[k];
+			}
+		}
+		this->build(this->Input[0].data(), this->Input[1].data(), this->Input[2].data(), aNodeList.size());
+	}
+
+	std::size_t spatial_hash::size() const {
+		return this->Index.size();
+	}
+
+	std::vector<uint32_t> spatial_hash::query(const math::vec<float, 3>& aCenter, float aRadius) const {
+		std::vector<uint32_t> Found;
+		this->query(aCenter, aRadius, [&](uint32_t aIndex, float) {
+			Found.push_back(aIndex);
+			return true;
+		});
+		return Found;
+	}
+
+	std::vector<uint32_t> spatial_hash::query(const collision::aabb& aBounds) const {
+		std::vector<uint32_t> Found;
+		this->query(aBounds, [&](uint32_t aIndex) {
+			Found.push_back(aIndex);
+			return true;
+		});
+		return Found;
+	}
+
+	void spatial_hash::neighbours(float aRadius, std::vector<uint32_t>& aOffset, std::vector<uint32_t>& aNeighbour) const {
+		const std::size_t Count = this->size();
+		aOffset.assign(Count + 1, 0);
+		const int ThreadCount = Count > 4096 ? omp_get_max_threads() : 1;
+		std::vector<std::vector<uint32_t>> Local(ThreadCount);
+		const float Radius2 = aRadius * aRadius;
+		// Cells either side of a point's own that a radius can reach.
+		const int Reach = (int)std::ceil(aRadius * this->InverseCellSize);
+
+		// Each thread lists a slice of the sorted points into its own buffer, the row lengths
+		// give the offsets, then the buffers are copied to their rows.
+		#pragma omp parallel num_threads(ThreadCount)
+		{
+			const int t = omp_get_thread_num();
+			const int Threads = omp_get_num_threads();
+			const std::size_t First = Count * t / Threads, Last = Count * (t + 1) / Threads;
+			std::vector<uint32_t>& List = Local[t];
+			// Points of a cell are consecutive, the buckets around a cell are listed once for all of them.
+			int Cell[3] = { 0, 0, 0 };
+			uint32_t Visit[27];
+			int VisitCount = -1;
+			for (std::size_t s = First; s < Last; s++) {
+				const std::size_t Before = List.size();
+				const float x = this->Position[0][s], y = this->Position[1][s], z = this->Position[2][s];
+				const uint32_t Self = this->Index[s];
+				const int Current[3] = { this->cell(x), this->cell(y), this->cell(z) };
+				if (Reach > 1) {
+					// Too many cells around a point to list, a plain query each.
+					this->query(math::vec<float, 3>(x, y, z), aRadius, [&](uint32_t aIndex, float) {
+						if (aIndex != Self) List.push_back(aIndex);
+						return true;
+					});
+				}
+				else {
+					if ((VisitCount < 0) || (Current[0] != Cell[0]) || (Current[1] != Cell[1]) || (Current[2] != Cell[2])) {
+						for (int k = 0; k < 3; k++) Cell[k] = Current[k];
+						VisitCount = 0;
+						for (int dz = -1; dz <= 1; dz++) {
+							for (int dy = -1; dy <= 1; dy++) {
+								for (int dx = -1; dx <= 1; dx++) {
+									const uint32_t b = this->hash(Cell[0] + dx, Cell[1] + dy, Cell[2] + dz);
+									int i = VisitCount;
+									for (; (i > 0) && (Visit[i - 1] > b); i--) Visit[i] = Visit[i - 1];
+									Visit[i] = b;
+									VisitCount++;
+								}
+							}
+						}
+						VisitCount = (int)(std::unique(Visit, Visit + VisitCount) - Visit);
+					}
+					for (int i = 0; i < VisitCount; i++) {
+						for (uint32_t c = this->Start[Visit[i]]; c < this->Start[Visit[i] + 1]; c++) {
+							const float dx = this->Position[0][c] - x, dy = this->Position[1][c] - y, dz = this->Position[2][c] - z;
+							if ((dx * dx + dy * dy + dz * dz <= Radius2) && (c != s)) List.push_back(this->Index[c]);
+						}
+					}
+				}
+				aOffset[Self + 1] = (uint32_t)(List.size() - Before);
+			}
+			#pragma omp barrier
+			#pragma omp single
+			{
+				for (std::size_t i = 0; i < Count; i++) {
+					aOffset[i + 1] += aOffset[i];
+				}
+				aNeighbour.resize(aOffset[Count]);
+			}
+			const uint32_t* Read = List.data();
+			for (std::size_t s = First; s < Last; s++) {
+				const uint32_t Self = this->Index[s];
+				const uint32_t n = aOffset[Self + 1] - aOffset[Self];
+				std::copy(Read, Read + n, aNeighbour.begin() + aOffset[Self]);
+				Read += n;
+			}
+		}
+	}
+
+}
@@ -37,7 +37,7 @@ namespace geodesy::core::util {
 		{	type::id::CHAR			,		"byte"			,	type::id::CHAR			,		1		  ,		1		,		1		,	sizeof(char)						},
 		{	type::id::SHORT			,		"short"			,	type::id::SHORT			,		1		  ,		1		,		1		,	sizeof(short)						},
 		{	type::id::INT			,		"int"			,	type::id::INT			,		1		  ,		1		,		1		,	sizeof(int)							},
-		//{	type::id::HALF			,		"half"			,	type::id::HALF			,		1		  ,		1		,		1		,	sizeof(half)						},
+		{	type::id::HALF			,		"half"			,	type::id::HALF			,		1		  ,		1		,		1		,	sizeof(math::half)					},
 		{	type::id::FLOAT			,		"float"			,	type::id::FLOAT			,		1		  ,		1		,		1		,	sizeof(float)						},
 		{	type::id::DOUBLE		,		"double"		,	type::id::DOUBLE		,		1		  ,		1		,		1		,	sizeof(double)						},
 		{	type::id::UCHAR2		,		"ubyte2"		,	type::id::UCHAR			,		2		  ,		1		,		1		,	sizeof(math::vec<uchar, 2>)			},
@@ -58,9 +58,9 @@ namespace geodesy::core::util {
 		{	type::id::INT2			,		"int2"			,	type::id::INT			,		2		  ,		1		,		1		,	sizeof(math::vec<int, 2>)			},
 		{	type::id::INT3			,		"int3"			,	type::id::INT			,		3		  ,		1		,		1		,	sizeof(math::vec<int, 3>)			},
 		{	type::id::INT4			,		"int4"			,	type::id::INT			,		4		  ,		1		,		1		,	sizeof(math::vec<int, 4>)			},
-		//{	type::id::HALF2			,		"half2"			,	type::id::HALF			,		2		  ,		1		,		1		,	sizeof(math::vec2<half>)			},
-		//{	type::id::HALF3			,		"half3"			,	type::id::HALF			,		3		  ,		1		,		1		,	sizeof(math::vec3<half>)			},
-		//{	type::id::HALF4			,		"half4"			,	type::id::HALF			,		4		  ,		1		,		1		,	sizeof(math::vec4<half>)			},
+		{	type::id::HALF2			,		"half2"			,	type::id::HALF			,		2		  ,		1		,		1		,	sizeof(math::vec<math::half, 2>)	},
+		{	type::id::HALF3			,		"half3"			,	type::id::HALF			,		3		  ,		1		,		1		,	sizeof(math::vec<math::half, 3>)	},
+		{	type::id::HALF4			,		"half4"			,	type::id::HALF			,		4		  ,		1		,		1		,	sizeof(math::vec<math::half, 4>)	},
 		{	type::id::FLOAT2		,		"float2"		,	type::id::FLOAT			,		2		  ,		1		,		1		,	sizeof(math::vec<float, 2>)			},
 		{	type::id::FLOAT3		,		"float3"		,	type::id::FLOAT			,		3		  ,		1		,		1		,	sizeof(math::vec<float, 3>)			},
 		{	type::id::FLOAT4		,		"float4"		,	type::id::FLOAT			,		4		  ,		1		,		1		,	sizeof(math::vec<float, 4>)			},
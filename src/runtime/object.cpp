@@ -1,6 +1,8 @@
 #include <geodesy/engine.h>
 #include <geodesy/runtime/object.h>
 
+#include <cstring>
+
 namespace geodesy::runtime {
 
 	using namespace core;
@@ -80,6 +82,8 @@ namespace geodesy::runtime {
 		this->Position 			= aCreator->Position;
 		this->Orientation 		= math::orientation(this->Theta, this->Phi);
 		this->Scale 			= aCreator->Scale;
+		this->MotionType 		= aCreator->MotionType;
+		this->GravityEnabled 	= aCreator->GravityEnabled;
 		this->DefaultTransform  = phys::calculate_transform(this->Position, this->Orientation, this->Scale);
 		this->CurrentTransform 	= this->DefaultTransform; // Set current transform to default.
 
@@ -127,6 +131,10 @@ namespace geodesy::runtime {
 
 		// Linearize node tree for faster processing.
 		this->LinearizedNodeTree = this->linearize();
+		for (size_t i = 0; i < this->LinearizedNodeTree.size(); i++) {
+			// Nodes find their animation tracks by position in the tree.
+			this->LinearizedNodeTree[i]->TreeIndex = i;
+		}
 
 		// Gather mesh instances.
 		this->TotalMeshInstance = this->gather_instances();
@@ -217,6 +225,34 @@ namespace geodesy::runtime {
 		return DrawCallList;
 	}
 
+	bool object::update_bounds() {
+		if (this->Model == nullptr) return false;
+
+		const size_t Count = this->TotalMeshInstance.size();
+		bool Moved = (this->InstanceBounds.size() != Count);
+		if (Moved) {
+			this->InstanceBounds.assign(Count, phys::collision::aabb());
+			this->InstanceTransform.resize(Count);
+		}
+		for (size_t i = 0; i < Count; i++) {
+			const gfx::mesh::instance* MeshInstance = this->TotalMeshInstance[i];
+			const math::affine<float>& Transform = MeshInstance->Parent->GlobalTransform;
+			// Instances that have not moved keep their box.
+			if (!Moved && (std::memcmp(&Transform, &this->InstanceTransform[i], sizeof(math::affine<float>)) == 0)) continue;
+			this->InstanceTransform[i] = Transform;
+			this->InstanceBounds[i] = phys::collision::bounds(*this->Model->Mesh[MeshInstance->MeshIndex], Transform);
+			Moved = true;
+		}
+		if (!Moved) return false;
+
+		phys::collision::aabb Total;
+		for (const phys::collision::aabb& Box : this->InstanceBounds) {
+			Total = phys::collision::merge(Total, Box);
+		}
+		this->WorldBounds = Total;
+		return true;
+	}
+
 	std::vector<VkCommandBuffer> convert(std::vector<std::shared_ptr<object::draw_call>> aDrawCallList) {
 		std::vector<VkCommandBuffer> CommandBufferList(aDrawCallList.size());
 		for (size_t i = 0; i < aDrawCallList.size(); i++) {
@@ -12,10 +12,11 @@
 // Why tf is single threaded better?
 // #define ENABLE_MULTITHREADED_PROCESSING
 
-#ifdef ENABLE_MULTITHREADED_PROCESSING
+// Broad phase pair generation is always split across threads, its work items are coarse.
 #include <omp.h>
-#endif // ENABLE_MULTITHREADED_PROCESSING
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
 
 namespace geodesy::runtime {
@@ -26,6 +27,7 @@ namespace geodesy::runtime {
 	stage::creator::creator() {
 		this->Name = "";
 		this->RTTIID = stage::rttiid;
+		this->BroadPhase = core::phys::collision::broad_phase::DYNAMIC_TREE;
 	}
 
 	std::vector<subject*> stage::purify_by_subject(const std::vector<std::shared_ptr<object>>& aObjectList) {
@@ -60,6 +62,7 @@ namespace geodesy::runtime {
 		this->Name		= aCreator->Name;
 		this->Time		= 0.0;
 		this->Context	= aContext;
+		this->BroadPhase = phys::collision::broad_phase::create(aCreator->BroadPhase);
 
 		// Create Stage Objects.
 		this->Object = this->build_objects(aContext, aCreator->ObjectCreationList);
@@ -156,23 +159,78 @@ namespace geodesy::runtime {
 
 	// Does Nothing by default.
 	void stage::update(double aDeltaTime) {
+		this->step(aDeltaTime);
+
+		// Keep the frame for rollback, a no-op until History is given a capacity.
+		this->History.save(this->NodeCache, this->Time, aDeltaTime, this->Dynamics, this->Solver, this->NarrowPhase);
+
+		this->publish();
+	}
+
+	void stage::resimulate(size_t aFrameCount, const std::function<void(size_t)>& aInput) {
+		if (aFrameCount == 0) return;
+
+		// Step lengths of the frames being replayed, oldest first, read before restore drops them.
+		std::vector<double> DeltaTime(aFrameCount);
+		for (size_t i = 0; i < aFrameCount; i++) {
+			DeltaTime[i] = this->History[aFrameCount - 1 - i].DeltaTime;
+		}
+		this->Time = this->History.restore(aFrameCount, this->Dynamics, this->Solver, this->NarrowPhase);
+
+		for (size_t i = 0; i < aFrameCount; i++) {
+			if (aInput) aInput(i);
+			this->step(DeltaTime[i]);
+			this->History.save(this->NodeCache, this->Time, DeltaTime[i], this->Dynamics, this->Solver, this->NarrowPhase);
+		}
+
+		this->publish();
+	}
+
+	void stage::step(double aDeltaTime) {
 		this->Time += aDeltaTime;
 
 		// Build Node Cache.
 		this->build_node_cache();
 
-		// This list contains the pairs that have been detected to be in collision on broad phase metrics.
-		// std::vector<std::pair<object*, object*>> BroadPhaseCollisionPair;
-		
-		// This list contains the pairs that have been detected to be in collision on narrow phase metrics.
-		// std::vector<std::pair<object*, object*>> NarrowPhaseCollisionPair;
-		
-		// TODO: Broad phase collision detection will use bounding spheres based on the objects farthest vertex.
-		// Yes, I know this is n2, suck my dick. I'll change it later.
-				
-		// TODO: Narrow phase collision detection will use the actual geometry of the objects.
+		// Broad phase, bring the stage's broad phase up to date with last step's global transforms,
+		// then each thread gathers the overlapping pairs of one workload of its work items.
+		this->BroadPhase->update(this->NodeCache);
+		std::vector<workload> PairWorkload = stage::determine_thread_workload(this->BroadPhase->work_count(), omp_get_max_threads());
+		std::vector<std::vector<std::pair<phys::node*, phys::node*>>> PairList(PairWorkload.size());
+		#pragma omp parallel for
+		for (std::ptrdiff_t i = 0; i < PairWorkload.size(); i++) {
+			this->BroadPhase->find_pairs(PairWorkload[i].Start, PairWorkload[i].Count, PairList[i]);
+		}
+		this->CollisionPair.clear();
+		for (size_t i = 0; i < PairList.size(); i++) {
+			this->CollisionPair.insert(this->CollisionPair.end(), PairList[i].begin(), PairList[i].end());
+		}
+		// While frames are kept for rollback the pairs go in a fixed order. The broad phase's own order
+		// depends on its history, which a rollback does not rewind, and a replayed step has to solve the
+		// contacts in the order the original did to reproduce it. Pointers are ordered with std::less,
+		// < leaves unrelated pointers unordered.
+		if (this->History.Capacity > 0) {
+			std::less<phys::node*> Less;
+			for (auto& Pair : this->CollisionPair) {
+				if (Less(Pair.second, Pair.first)) std::swap(Pair.first, Pair.second);
+			}
+			std::sort(this->CollisionPair.begin(), this->CollisionPair.end(), [&](const std::pair<phys::node*, phys::node*>& aLhs, const std::pair<phys::node*, phys::node*>& aRhs) {
+				return Less(aLhs.first, aRhs.first) || ((aLhs.first == aRhs.first) && Less(aLhs.second, aRhs.second));
+			});
+		}
+
+		// Narrow phase, GJK/EPA on the collision hulls of each pair, contact points persist across steps.
+		this->Contact = this->NarrowPhase.collide(this->CollisionPair);
 				
-		// TODO: This section of the code will evaluate collision responses between pairs.
+		// Collision response, the contacts and joints are solved island by island with sequential impulses
+		// inside every substep of the rigid body update, resting islands go to sleep.
+		this->Continuous.begin(this->NodeCache);
+		this->Solver.update(this->Dynamics, this->NodeCache, this->Contact, aDeltaTime);
+		this->NarrowPhase.store(this->Contact);
+
+		// Bodies that moved further than their size this step are swept along their path, and moved back
+		// to their first time of impact so they cannot tunnel through thin geometry.
+		this->Continuous.update(this->NodeCache, this->NarrowPhase);
 		
 		// After collision has been completed, and response forces determined, update objects accordingly.
 			
@@ -191,6 +249,29 @@ namespace geodesy::runtime {
 			// Recursively generate global transforms for all nodes.
 			this->NodeCache[i]->GlobalTransform = this->NodeCache[i]->transform();
 		}
+	}
+
+	void stage::publish() {
+		// Bin the node origins for proximity queries, query indices follow NodeCache.
+		this->SpatialHash.build(this->NodeCache);
+
+		// Refit the world bounds of the objects whose nodes moved.
+		#pragma omp parallel for if(this->Object.size() > 64)
+		for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)this->Object.size(); i++) {
+			this->Object[i]->update_bounds();
+		}
+
+		// Place the mesh instances for picking and line of sight queries, as the TLAS does.
+		std::vector<phys::collision::instance_bvh::instance> InstanceList;
+		for (const auto& Object : this->Object) {
+			if (Object->Model == nullptr) continue;
+			for (auto& MeshInstance : Object->TotalMeshInstance) {
+				auto Mesh = Object->Model->Mesh[MeshInstance->MeshIndex];
+				if (Mesh->BVH == nullptr) continue;
+				InstanceList.push_back(phys::collision::instance_bvh::instance(Mesh->BVH, MeshInstance->Parent->GlobalTransform, MeshInstance->Parent));
+			}
+		}
+		this->SceneBVH.build(InstanceList);
 
 		// This is serialized because the GPU memory is not thread safe.
 		for (std::ptrdiff_t i = 0; i < this->NodeCache.size(); i++) {
@@ -0,0 +1,63 @@
+// Times the per node cost of global transforms through a hierarchy with math::affine against
+// the 4x4 matrices it replaced, building each local transform from its pose as a stage does.
+
+#include <geodesy/core/math.h>
+
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+static vec<float, 3> random_vector(float aMin, float aMax) {
+	return vec<float, 3>(test::uniform(aMin, aMax), test::uniform(aMin, aMax), test::uniform(aMin, aMax));
+}
+
+// T * R * S the way phys::calculate_transform used to build it.
+static mat<float, 4, 4> trs_matrix(const vec<float, 3>& aPosition, const quaternion<float>& aOrientation, const vec<float, 3>& aScale) {
+	mat<float, 4, 4> Translation = {
+		1.0f, 0.0f, 0.0f, aPosition[0],
+		0.0f, 1.0f, 0.0f, aPosition[1],
+		0.0f, 0.0f, 1.0f, aPosition[2],
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	mat<float, 4, 4> Scale = {
+		aScale[0], 0.0f, 0.0f, 0.0f,
+		0.0f, aScale[1], 0.0f, 0.0f,
+		0.0f, 0.0f, aScale[2], 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	return Translation * mat<float, 4, 4>(aOrientation) * Scale;
+}
+
+int main() {
+	const std::size_t Count = 1 << 16;
+	std::vector<vec<float, 3>> Position(Count), Scale(Count);
+	std::vector<quaternion<float>> Orientation(Count);
+	for (std::size_t i = 0; i < Count; i++) {
+		Position[i] 	= random_vector(-1.0f, 1.0f);
+		Scale[i] 		= random_vector(0.9f, 1.1f);
+		Orientation[i] 	= normalize(quaternion<float>(test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f)));
+	}
+
+	// Parents come first, as in a linearized hierarchy eight levels deep.
+	std::vector<affine<float>> Global(Count);
+	std::vector<mat<float, 4, 4>> GlobalMatrix(Count);
+	const double AffineTime = test::time_average(20, [&]() {
+		for (std::size_t i = 0; i < Count; i++) {
+			const affine<float> Local(Position[i], Orientation[i], Scale[i]);
+			Global[i] = (i % 8 == 0) ? Local : Global[i - 1] * Local;
+		}
+	});
+	const double MatrixTime = test::time_average(20, [&]() {
+		for (std::size_t i = 0; i < Count; i++) {
+			const mat<float, 4, 4> Local = trs_matrix(Position[i], Orientation[i], Scale[i]);
+			GlobalMatrix[i] = (i % 8 == 0) ? Local : GlobalMatrix[i - 1] * Local;
+		}
+	});
+	std::printf("per node, affine: %6.2f ns\n", AffineTime * 1e6 / (double)Count);
+	std::printf("per node, mat4:   %6.2f ns\n", MatrixTime * 1e6 / (double)Count);
+	std::printf("checksum %g\n", Global[Count - 1].Translation[0] + GlobalMatrix[Count - 1](0, 3));
+	return 0;
+}
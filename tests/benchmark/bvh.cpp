@@ -0,0 +1,78 @@
+// Times triangle_bvh ray casts per second for coherent camera rays and incoherent random rays,
+// one at a time and as packets, and the build of the hierarchy itself.
+
+#include <geodesy/core/phys/bvh.h>
+
+#include <cmath>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+using namespace geodesy::core::phys;
+
+typedef math::vec<float, 3> vec3;
+
+static mesh bumpy_sphere(uint32_t n) {
+	mesh Mesh;
+	Mesh.Topology.Primitive = mesh::TRIANGLE;
+	Mesh.Vertex.resize((n + 1) * (n + 1));
+	for (uint32_t i = 0; i <= n; i++) {
+		for (uint32_t j = 0; j <= n; j++) {
+			const float Theta = 3.14159265f * (float)i / (float)n, Phi = 6.28318531f * (float)j / (float)n;
+			const float r = 1.0f + 0.05f * std::sin(7.0f * Theta) * std::cos(5.0f * Phi);
+			Mesh.Vertex[i * (n + 1) + j].Position = vec3(r * std::sin(Theta) * std::cos(Phi), r * std::sin(Theta) * std::sin(Phi), r * std::cos(Theta));
+		}
+	}
+	for (uint32_t i = 0; i < n; i++) {
+		for (uint32_t j = 0; j < n; j++) {
+			const uint32_t a = i * (n + 1) + j, b = a + 1, c = a + n + 1, d = c + 1;
+			for (uint32_t Index : { a, c, b, b, c, d }) {
+				Mesh.Topology.Data32.push_back(Index);
+			}
+		}
+	}
+	return Mesh;
+}
+
+static void run(const char* aName, const collision::triangle_bvh& aTree, const std::vector<collision::ray>& aRay) {
+	std::size_t Hits = 0;
+	const double SingleTime = test::time_average(3, [&]() {
+		Hits = 0;
+		for (const collision::ray& R : aRay) Hits += aTree.intersect(R).found();
+	});
+	const double PacketTime = test::time_average(3, [&]() { aTree.intersect(aRay); });
+	const double OccludedTime = test::time_average(3, [&]() { aTree.occluded(aRay); });
+	const double Count = (double)aRay.size();
+	std::printf("  %-10s closest hit %6.2f Mrays/s, packets %6.2f Mrays/s, occlusion packets %6.2f Mrays/s (%.0f%% hit)\n",
+		aName, Count / SingleTime * 1e-3, Count / PacketTime * 1e-3, Count / OccludedTime * 1e-3, 100.0 * (double)Hits / Count);
+}
+
+int main() {
+	for (uint32_t n : { 64, 256, 1024 }) {
+		const mesh Mesh = bumpy_sphere(n);
+		test::timer Timer;
+		collision::triangle_bvh Tree(Mesh);
+		std::printf("%zu triangles, build %.1f ms\n", Mesh.Topology.Data32.size() / 3, Timer.milliseconds());
+
+		// A 512 x 512 pinhole camera looking at the sphere.
+		std::vector<collision::ray> Camera;
+		for (int y = 0; y < 512; y++) {
+			for (int x = 0; x < 512; x++) {
+				Camera.push_back(collision::ray(vec3(0.0f, 0.0f, -4.0f), vec3(((float)x - 256.0f) / 512.0f, ((float)y - 256.0f) / 512.0f, 1.0f)));
+			}
+		}
+		// Random origins and directions around the sphere.
+		std::vector<collision::ray> Random;
+		for (std::size_t i = 0; i < Camera.size(); i++) {
+			Random.push_back(collision::ray(
+				vec3(test::uniform(-2.0f, 2.0f), test::uniform(-2.0f, 2.0f), test::uniform(-2.0f, 2.0f)),
+				vec3(test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f))
+			));
+		}
+		run("coherent", Tree, Camera);
+		run("incoherent", Tree, Random);
+	}
+	return 0;
+}
@@ -0,0 +1,64 @@
+// Times the closed form inverses against Gauss-Jordan, and the 3x3 symmetric eigen and polar
+// decompositions.
+
+#include <geodesy/core/math.h>
+
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+static vec<float, 3> random_vector(float aMin, float aMax) {
+	return vec<float, 3>(test::uniform(aMin, aMax), test::uniform(aMin, aMax), test::uniform(aMin, aMax));
+}
+
+int main() {
+	const std::size_t Count = 1 << 16;
+	std::vector<mat<float, 4, 4>> Matrix(Count), Out(Count);
+	std::vector<mat<float, 3, 3>> Linear(Count), Symmetric(Count), R(Count), S(Count);
+	std::vector<vec<float, 3>> Value(Count);
+	for (std::size_t i = 0; i < Count; i++) {
+		quaternion<float> Orientation = normalize(quaternion<float>(test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f)));
+		affine<float> Transform(random_vector(-1.0f, 1.0f), Orientation, random_vector(0.5f, 2.0f));
+		Matrix[i] = mat<float, 4, 4>(Transform);
+		Linear[i] = Transform.Linear;
+		Symmetric[i] = transpose(Linear[i]) * Linear[i];
+	}
+	float Checksum = 0.0f;
+
+	const double GeneralTime = test::time_average(5, [&]() {
+		for (std::size_t i = 0; i < Count; i++) Out[i] = inverse(Matrix[i]);
+	});
+	Checksum += Out[0](0, 0);
+	const double AffineTime = test::time_average(5, [&]() {
+		for (std::size_t i = 0; i < Count; i++) Out[i] = inverse_affine(Matrix[i]);
+	});
+	Checksum += Out[0](0, 0);
+	const double RigidTime = test::time_average(5, [&]() {
+		for (std::size_t i = 0; i < Count; i++) Out[i] = inverse_rigid(Matrix[i]);
+	});
+	Checksum += Out[0](0, 0);
+	const double NormalTime = test::time_average(5, [&]() {
+		for (std::size_t i = 0; i < Count; i++) R[i] = normal_matrix(Matrix[i]);
+	});
+	Checksum += R[0](0, 0);
+	const double EigenTime = test::time_average(5, [&]() {
+		for (std::size_t i = 0; i < Count; i++) eigen_symmetric(Symmetric[i], Value[i], R[i]);
+	});
+	Checksum += Value[0][0];
+	const double PolarTime = test::time_average(5, [&]() {
+		for (std::size_t i = 0; i < Count; i++) polar(Linear[i], R[i], S[i]);
+	});
+	Checksum += S[0](0, 0);
+
+	std::printf("inverse, Gauss-Jordan: %7.2f ns\n", GeneralTime * 1e6 / (double)Count);
+	std::printf("inverse_affine:        %7.2f ns\n", AffineTime * 1e6 / (double)Count);
+	std::printf("inverse_rigid:         %7.2f ns\n", RigidTime * 1e6 / (double)Count);
+	std::printf("normal_matrix:         %7.2f ns\n", NormalTime * 1e6 / (double)Count);
+	std::printf("eigen_symmetric:       %7.2f ns\n", EigenTime * 1e6 / (double)Count);
+	std::printf("polar:                 %7.2f ns\n", PolarTime * 1e6 / (double)Count);
+	std::printf("checksum %g\n", Checksum);
+	return 0;
+}
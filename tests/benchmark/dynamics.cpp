@@ -0,0 +1,43 @@
+// Times a full dynamics frame and a single integration substep for ten thousand to a million
+// free bodies.
+
+#include <geodesy/core/phys/node.h>
+#include <geodesy/core/phys/dynamics.h>
+
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+
+int main() {
+	for (std::size_t Count : { 10000, 100000, 1000000 }) {
+		std::vector<phys::node> Node(Count);
+		std::vector<phys::node*> List(Count);
+		for (std::size_t i = 0; i < Count; i++) {
+			List[i] = &Node[i];
+			Node[i].MotionType 		= phys::node::DYNAMIC;
+			Node[i].GravityEnabled 	= true;
+			Node[i].LinearMomentum 	= { test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f) };
+			Node[i].AngularMomentum = { test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f) };
+			Node[i].InertiaTensor 	= {
+				test::uniform(0.5f, 1.5f), 0.0f, 0.0f,
+				0.0f, 1.0f, 0.0f,
+				0.0f, 0.0f, 1.5f
+			};
+		}
+
+		phys::dynamics Dynamics;
+		const int Frames = (Count >= 1000000) ? 10 : 50;
+		int Substeps = 0;
+		const double FrameTime = test::time_average(Frames, [&]() { Substeps += Dynamics.update(List, 1.0 / 60.0); });
+		const double SubstepTime = test::time_average(Frames, [&]() {
+			Dynamics.integrate_momentum(1.0f / 120.0f);
+			Dynamics.integrate_position(1.0f / 120.0f);
+		});
+		std::printf("%7zu bodies: frame %8.3f ms (%d substeps), substep %8.3f ms, %5.1f ns per body\n",
+			Count, FrameTime, Substeps / (Frames + 1), SubstepTime, SubstepTime * 1e6 / (double)Count);
+	}
+	return 0;
+}
@@ -0,0 +1,51 @@
+// Times fused field expressions against evaluating them one temporary at a time, one pass per
+// operation, on 1D, 2D and 3D fields of about four million samples.
+
+#include <geodesy/core/math.h>
+
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+// 2 * (x * x - x) / (x + 7), five operations, so five passes and three temporaries unfused.
+template <std::size_t N>
+static float run(const vec<std::size_t, N>& aCount) {
+	vec<float, N> LowerBound, UpperBound;
+	for (std::size_t i = 0; i < N; i++) {
+		LowerBound[i] 	= -5.0f;
+		UpperBound[i] 	= 5.0f;
+	}
+	field<float, N, float> X(LowerBound, UpperBound, aCount);
+	for (float& Value : X) Value = test::uniform(-5.0f, 5.0f);
+	const std::size_t Count = X.size();
+
+	field<float, N, float> Out;
+	const double FusedTime = test::time_average(10, [&]() {
+		Out = 2.0f * (X * X - X) / (X + 7.0f);
+	});
+	float Checksum = Out[Count / 3];
+
+	std::vector<float> A(Count), B(Count), C(Count);
+	const double UnfusedTime = test::time_average(10, [&]() {
+		for (std::size_t i = 0; i < Count; i++) A[i] = X[i] * X[i];
+		for (std::size_t i = 0; i < Count; i++) A[i] = A[i] - X[i];
+		for (std::size_t i = 0; i < Count; i++) B[i] = 2.0f * A[i];
+		for (std::size_t i = 0; i < Count; i++) C[i] = X[i] + 7.0f;
+		for (std::size_t i = 0; i < Count; i++) B[i] = B[i] / C[i];
+	});
+	Checksum += B[Count / 3];
+	std::printf("%zuD, %zu samples: fused %7.2f ms (1 pass), temporaries %7.2f ms (5 passes)\n", N, Count, FusedTime, UnfusedTime);
+	return Checksum;
+}
+
+int main() {
+	float Checksum = 0.0f;
+	Checksum += run<1>(vec<std::size_t, 1>{ 1 << 22 });
+	Checksum += run<2>(vec<std::size_t, 2>{ 2048, 2048 });
+	Checksum += run<3>(vec<std::size_t, 3>{ 160, 160, 160 });
+	std::printf("checksum %g\n", Checksum);
+	return 0;
+}
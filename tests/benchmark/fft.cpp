@@ -0,0 +1,66 @@
+// Times the FFT against direct convolution, a one million point complex transform and a
+// 1024 x 1024 real field transform.
+
+#include <geodesy/core/math.h>
+
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+int main() {
+	float Checksum = 0.0f;
+
+	// Linear convolution of a signal with kernels of growing length.
+	{
+		const std::size_t n = 1 << 15;
+		std::vector<float> Signal(n);
+		for (float& Value : Signal) Value = test::uniform(-1.0f, 1.0f);
+		for (std::size_t m : { 16, 64, 256, 1024 }) {
+			std::vector<float> Kernel(m);
+			for (float& Value : Kernel) Value = test::uniform(-1.0f, 1.0f);
+			std::vector<float> Direct(n + m - 1), Fast;
+			const double DirectTime = test::time_average(3, [&]() {
+				std::fill(Direct.begin(), Direct.end(), 0.0f);
+				for (std::size_t i = 0; i < n; i++) {
+					for (std::size_t j = 0; j < m; j++) {
+						Direct[i + j] += Signal[i] * Kernel[j];
+					}
+				}
+			});
+			const double FastTime = test::time_average(10, [&]() { Fast = convolve(Signal, Kernel); });
+			Checksum += Direct[n / 2] + Fast[n / 2];
+			std::printf("convolve n=%zu m=%4zu: direct %8.3f ms, fft %7.3f ms\n", n, m, DirectTime, FastTime);
+		}
+	}
+
+	// One million point complex transform, forward and back.
+	{
+		const std::size_t n = 1 << 20;
+		std::vector<complex<float>> Signal(n);
+		for (complex<float>& Value : Signal) Value = complex<float>(test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f));
+		const double Time = test::time_average(5, [&]() {
+			fft(Signal.data(), n, fft_direction::FORWARD);
+			fft(Signal.data(), n, fft_direction::INVERSE);
+		});
+		Checksum += Signal[n / 2][0];
+		std::printf("c2c n=%zu:            %7.2f ms per transform\n", n, Time / 2.0);
+	}
+
+	// Real 1024 x 1024 field to its halved spectrum and back.
+	{
+		const std::size_t n = 1024;
+		field<float, 2, float> F(vec<std::size_t, 2>{ n, n });
+		for (float& Value : F) Value = test::uniform(-1.0f, 1.0f);
+		field<float, 2, complex<float>> Spectrum;
+		const double ForwardTime = test::time_average(5, [&]() { Spectrum = rfft(F); });
+		const double InverseTime = test::time_average(5, [&]() { F = irfft(Spectrum, n); });
+		Checksum += F[n * n / 2];
+		std::printf("rfft %zu^2:              %7.2f ms, irfft %7.2f ms\n", n, ForwardTime, InverseTime);
+	}
+
+	std::printf("checksum %g\n", Checksum);
+	return 0;
+}
@@ -0,0 +1,38 @@
+// Times multigrid against conjugate gradient on the Poisson equation for growing grids.
+
+#include <geodesy/core/math.h>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+int main() {
+	for (std::size_t n : { 64, 128, 256, 512 }) {
+		field<float, 2, float> F(vec<float, 2>{ 0.0f, 0.0f }, vec<float, 2>{ 1.0f, 1.0f }, vec<std::size_t, 2>{ n, n });
+		for (float& Value : F) Value = test::uniform(-1.0f, 1.0f);
+		multigrid<float, 2, float> Solver(F.domain(), stencil::ZERO);
+		field<float, 2, float> U, V;
+
+		test::timer Timer;
+		auto Multigrid = Solver.solve(U, F, 1e-5f);
+		const double MultigridTime = Timer.milliseconds();
+		Timer.reset();
+		auto ConjugateGradient = Solver.solve_conjugate_gradient(V, F, 1e-5f);
+		const double ConjugateGradientTime = Timer.milliseconds();
+		std::printf("poisson %4zu^2: multigrid %8.2f ms (%2zu cycles), conjugate gradient %8.2f ms (%4zu iterations)\n",
+			n, MultigridTime, Multigrid.Iterations, ConjugateGradientTime, ConjugateGradient.Iterations);
+	}
+
+	// Periodic 3D grid, the singular case.
+	for (std::size_t n : { 32, 64, 128 }) {
+		field<float, 3, float> F(vec<float, 3>{ 0.0f, 0.0f, 0.0f }, vec<float, 3>{ 1.0f, 1.0f, 1.0f }, vec<std::size_t, 3>{ n, n, n });
+		for (float& Value : F) Value = test::uniform(-1.0f, 1.0f);
+		multigrid<float, 3, float> Solver(F.domain(), stencil::WRAP);
+		field<float, 3, float> U;
+		test::timer Timer;
+		auto Report = Solver.solve(U, F, 1e-5f);
+		std::printf("periodic %3zu^3: multigrid %8.2f ms (%2zu cycles)\n", n, Timer.milliseconds(), Report.Iterations);
+	}
+	return 0;
+}
@@ -0,0 +1,82 @@
+// Times the SIMD mat4 kernels against the generic scalar loops they specialize, on arrays the
+// size of a stage's transform update.
+
+#include <geodesy/core/math.h>
+
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+int main() {
+	std::printf("math::simd: %s\n", simd::name());
+	const std::size_t Count = 1 << 16;
+	std::vector<mat<float, 4, 4>> Matrix(Count), Out(Count);
+	std::vector<vec<float, 4>> Vector(Count), VectorOut(Count);
+	for (std::size_t i = 0; i < Count; i++) {
+		for (std::size_t k = 0; k < 16; k++) Matrix[i][k] = test::uniform(-1.0f, 1.0f);
+		Vector[i] = vec<float, 4>(test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), 1.0f);
+	}
+	float Checksum = 0.0f;
+
+	// Products of independent matrices.
+	const double ProductTime = test::time_average(20, [&]() {
+		for (std::size_t i = 0; i < Count; i++) {
+			Out[i] = Matrix[i] * Matrix[Count - 1 - i];
+		}
+	});
+	Checksum += Out[Count / 2](0, 0);
+	const double ScalarProductTime = test::time_average(20, [&]() {
+		for (std::size_t i = 0; i < Count; i++) {
+			const mat<float, 4, 4>& A = Matrix[i];
+			const mat<float, 4, 4>& B = Matrix[Count - 1 - i];
+			mat<float, 4, 4> C;
+			for (std::size_t r = 0; r < 4; r++) {
+				for (std::size_t c = 0; c < 4; c++) {
+					for (std::size_t k = 0; k < 4; k++) {
+						C(r, c) += A(r, k) * B(k, c);
+					}
+				}
+			}
+			Out[i] = C;
+		}
+	});
+	Checksum += Out[Count / 2](0, 0);
+
+	// A chain of products through a hierarchy eight levels deep, as in a stage update.
+	const double ChainTime = test::time_average(20, [&]() {
+		for (std::size_t i = 0; i < Count; i++) {
+			Out[i] = (i % 8 == 0) ? Matrix[i] : Out[i - 1] * Matrix[i];
+		}
+	});
+	Checksum += Out[Count - 1](0, 3);
+
+	// Points through their matrices.
+	const double TransformTime = test::time_average(20, [&]() {
+		for (std::size_t i = 0; i < Count; i++) {
+			VectorOut[i] = Matrix[i] * Vector[i];
+		}
+	});
+	Checksum += VectorOut[Count / 2][0];
+	const double ScalarTransformTime = test::time_average(20, [&]() {
+		for (std::size_t i = 0; i < Count; i++) {
+			vec<float, 4> V;
+			for (std::size_t r = 0; r < 4; r++) {
+				V[r] = 0.0f;
+				for (std::size_t k = 0; k < 4; k++) {
+					V[r] += Matrix[i](r, k) * Vector[i][k];
+				}
+			}
+			VectorOut[i] = V;
+		}
+	});
+	Checksum += VectorOut[Count / 2][0];
+
+	std::printf("mat4 * mat4:  %6.2f ns, scalar %6.2f ns\n", ProductTime * 1e6 / (double)Count, ScalarProductTime * 1e6 / (double)Count);
+	std::printf("mat4 chain:   %6.2f ns per node\n", ChainTime * 1e6 / (double)Count);
+	std::printf("mat4 * vec4:  %6.2f ns, scalar %6.2f ns\n", TransformTime * 1e6 / (double)Count, ScalarTransformTime * 1e6 / (double)Count);
+	std::printf("checksum %g\n", Checksum);
+	return 0;
+}
@@ -0,0 +1,142 @@
+// Times snapshot save and restore for piles of resting boxes with a full contact cache, and
+// reports how far a restored stage drifts from the frames it resimulates.
+
+#include <geodesy/core/phys/node.h>
+#include <geodesy/core/phys/collision.h>
+#include <geodesy/core/phys/narrow_phase.h>
+#include <geodesy/core/phys/solver.h>
+#include <geodesy/core/phys/snapshot.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+
+typedef math::vec<float, 3> vec3;
+
+static std::shared_ptr<phys::mesh> box(float aX, float aY, float aZ) {
+	static const int Face[6][4][3] = {
+		{ { -1, -1, -1 }, { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 } },
+		{ { -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 } },
+		{ { -1, -1, -1 }, { 1, -1, -1 }, { 1, -1, 1 }, { -1, -1, 1 } },
+		{ { -1, 1, -1 }, { -1, 1, 1 }, { 1, 1, 1 }, { 1, 1, -1 } },
+		{ { -1, -1, -1 }, { -1, -1, 1 }, { -1, 1, 1 }, { -1, 1, -1 } },
+		{ { 1, -1, -1 }, { 1, 1, -1 }, { 1, 1, 1 }, { 1, -1, 1 } },
+	};
+	auto Mesh = std::make_shared<phys::mesh>();
+	Mesh->Topology.Primitive = phys::mesh::TRIANGLE;
+	for (int i = 0; i < 6; i++) {
+		for (int k = 0; k < 4; k++) {
+			phys::mesh::vertex Vertex;
+			Vertex.Position = vec3(Face[i][k][0] * aX, Face[i][k][1] * aY, Face[i][k][2] * aZ);
+			Mesh->Vertex.push_back(Vertex);
+		}
+		for (uint16_t Index : { 0, 1, 2, 0, 2, 3 }) {
+			Mesh->Topology.Data16.push_back((uint16_t)(4 * i + Index));
+		}
+	}
+	Mesh->CenterOfMass 		= vec3(0.0f, 0.0f, 0.0f);
+	Mesh->BoundingRadius 	= vec3(aX, aY, aZ);
+	return Mesh;
+}
+
+// The step of a stage without the graphics, bodies are roots so their pose is their transform.
+struct world {
+	std::vector<std::unique_ptr<phys::node>> 				Storage;
+	std::vector<phys::node*> 								Node;
+	std::shared_ptr<phys::collision::broad_phase> 			BroadPhase = phys::collision::broad_phase::create(phys::collision::broad_phase::DYNAMIC_TREE);
+	phys::collision::narrow_phase 							NarrowPhase;
+	phys::dynamics 											Dynamics;
+	phys::solver 											Solver;
+
+	phys::node* add(const vec3& aPosition, const std::shared_ptr<phys::mesh>& aMesh, float aMass) {
+		Storage.emplace_back(new phys::node());
+		phys::node* N = Storage.back().get();
+		N->CollisionMesh = aMesh;
+		N->Position = aPosition;
+		if (aMass > 0.0f) {
+			const float Inertia = aMass * 4.0f * aMesh->BoundingRadius[0] * aMesh->BoundingRadius[0] / 6.0f;
+			N->MotionType 		= phys::node::DYNAMIC;
+			N->GravityEnabled 	= true;
+			N->Mass 			= aMass;
+			N->InertiaTensor 	= {
+				Inertia, 0.0f, 0.0f,
+				0.0f, Inertia, 0.0f,
+				0.0f, 0.0f, Inertia
+			};
+		}
+		Node.push_back(N);
+		return N;
+	}
+
+	void step(double aDeltaTime) {
+		for (phys::node* N : Node) {
+			N->CurrentTransform = phys::calculate_transform(N->Position, N->Orientation, N->Scale);
+			N->GlobalTransform = N->CurrentTransform;
+		}
+		BroadPhase->update(Node);
+		std::vector<phys::collision::manifold> Contact = NarrowPhase.collide(BroadPhase->find_pairs());
+		Solver.update(Dynamics, Node, Contact, aDeltaTime);
+		NarrowPhase.store(Contact);
+	}
+};
+
+int main() {
+	const double DeltaTime = 1.0 / 60.0;
+	for (int Piles : { 400, 2000 }) {
+		world World;
+		World.add(vec3(0.0f, 0.0f, -0.5f), box(200.0f, 200.0f, 0.5f), 0.0f);
+		auto Cube = box(0.5f, 0.5f, 0.5f);
+		for (int p = 0; p < Piles; p++) {
+			for (int k = 0; k < 5; k++) {
+				World.add(vec3((float)(p % 100) * 3.0f - 150.0f, (float)(p / 100) * 3.0f - 60.0f, 0.5f + (float)k * 1.02f), Cube, 1.0f);
+			}
+		}
+
+		phys::snapshot History(16);
+		double Time = 0.0, SaveTime = 0.0;
+		int Saves = 0;
+		for (int Frame = 0; Frame < 40; Frame++) {
+			World.step(DeltaTime);
+			Time += DeltaTime;
+			test::timer Timer;
+			History.save(World.Node, Time, DeltaTime, World.Dynamics, World.Solver, World.NarrowPhase);
+			// The first frames fill the contact cache, only settled frames are timed.
+			if (Frame >= 30) {
+				SaveTime += Timer.milliseconds();
+				Saves++;
+			}
+		}
+
+		// Record ten frames, roll back over them and simulate them again.
+		std::vector<std::vector<vec3>> Reference;
+		for (int Frame = 0; Frame < 10; Frame++) {
+			World.step(DeltaTime);
+			Time += DeltaTime;
+			History.save(World.Node, Time, DeltaTime, World.Dynamics, World.Solver, World.NarrowPhase);
+			Reference.emplace_back();
+			for (phys::node* N : World.Node) Reference.back().push_back(N->Position);
+		}
+		test::timer Timer;
+		Time = History.restore(10, World.Dynamics, World.Solver, World.NarrowPhase);
+		const double RestoreTime = Timer.milliseconds();
+		float Deviation = 0.0f;
+		for (int Frame = 0; Frame < 10; Frame++) {
+			World.step(DeltaTime);
+			Time += DeltaTime;
+			History.save(World.Node, Time, DeltaTime, World.Dynamics, World.Solver, World.NarrowPhase);
+			for (std::size_t n = 0; n < World.Node.size(); n++) {
+				Deviation = std::max(Deviation, math::length(World.Node[n]->Position - Reference[Frame][n]));
+			}
+		}
+
+		const double PerBody = SaveTime / (double)Saves * 1e4 / (double)History.Node.size();
+		std::printf("%zu bodies, %zu contacts: save %.3f ms (%.3f ms per 10k bodies), restore %.3f ms, ring %.1f MB, resimulated deviation %.2e m\n",
+			History.Node.size(), World.NarrowPhase.State.size(), SaveTime / (double)Saves, PerBody, RestoreTime, (double)History.memory() / 1048576.0, Deviation);
+	}
+	return 0;
+}
@@ -0,0 +1,43 @@
+// Times spatial_hash builds, radius queries and neighbour lists for a hundred thousand and a
+// million points with about twenty neighbours each.
+
+#include <geodesy/core/phys/spatial_hash.h>
+
+#include <cmath>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+
+typedef math::vec<float, 3> vec3;
+
+int main() {
+	for (std::size_t Count : { 100000, 1000000 }) {
+		// Twenty points in a unit sphere on average.
+		const float Side = std::cbrt((float)Count * 4.18879f / 20.0f);
+		std::vector<vec3> Point(Count);
+		for (vec3& P : Point) P = vec3(test::uniform(0.0f, Side), test::uniform(0.0f, Side), test::uniform(0.0f, Side));
+
+		phys::spatial_hash Grid(1.0f);
+		const double BuildTime = test::time_average(5, [&]() { Grid.build(Point); });
+
+		const std::size_t Queries = 100000;
+		std::size_t Hits = 0;
+		test::timer Timer;
+		for (std::size_t i = 0; i < Queries; i++) {
+			Grid.query(Point[(i * 7919) % Count], 1.0f, [&](uint32_t, float) { Hits++; return true; });
+		}
+		const double QueryTime = Timer.milliseconds();
+
+		std::vector<uint32_t> Offset, Neighbour;
+		Timer.reset();
+		Grid.neighbours(1.0f, Offset, Neighbour);
+		const double NeighbourTime = Timer.milliseconds();
+
+		std::printf("%7zu points: build %7.2f ms, radius query %6.0f ns (%.1f hits), neighbour lists %7.1f ms (%.1f each)\n",
+			Count, BuildTime, QueryTime * 1e6 / (double)Queries, (double)Hits / (double)Queries, NeighbourTime, (double)Neighbour.size() / (double)Count);
+	}
+	return 0;
+}
@@ -0,0 +1,50 @@
+// Times the tiled laplacian against a per sample loop that looks up its neighbours by index.
+
+#include <geodesy/core/math.h>
+
+#include <algorithm>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+typedef field<float, 3, float> field3;
+
+static field3 naive_laplacian(const field3& aF) {
+	field3 Out(aF.LowerBound, aF.UpperBound, aF.ElementCount);
+	vec<float, 3> Step = aF.UpperBound - aF.LowerBound;
+	for (std::size_t j = 0; j < 3; j++) {
+		Step[j] /= (float)(aF.ElementCount[j] - 1);
+	}
+	for (std::size_t i = 0; i < aF.size(); i++) {
+		vec<std::size_t, 3> Index = aF.convert_to_dimensional_index(i);
+		float Sum = 0.0f;
+		for (std::size_t j = 0; j < 3; j++) {
+			vec<std::size_t, 3> Centre = Index;
+			Centre[j] = std::clamp<std::size_t>(Centre[j], 1, aF.ElementCount[j] - 2);
+			vec<std::size_t, 3> Lo = Centre, Hi = Centre;
+			Lo[j]--;
+			Hi[j]++;
+			Sum += (aF[aF.convert_to_global_index(Hi)] - 2.0f * aF[aF.convert_to_global_index(Centre)] + aF[aF.convert_to_global_index(Lo)]) / (Step[j] * Step[j]);
+		}
+		Out[i] = Sum;
+	}
+	return Out;
+}
+
+int main() {
+	float Checksum = 0.0f;
+	for (std::size_t n : { 64, 160 }) {
+		field3 F(vec<float, 3>{ 0.0f, 0.0f, 0.0f }, vec<float, 3>{ 1.0f, 1.0f, 1.0f }, vec<std::size_t, 3>{ n, n, n });
+		for (float& Value : F) Value = test::uniform(-1.0f, 1.0f);
+		field3 Out;
+		const double TiledTime = test::time_average(5, [&]() { Out = laplacian(F); });
+		Checksum += Out[F.size() / 2];
+		const double NaiveTime = test::time_average(2, [&]() { Out = naive_laplacian(F); });
+		Checksum += Out[F.size() / 2];
+		std::printf("laplacian %zu^3, tiled: %7.2f ms, naive: %7.2f ms\n", n, TiledTime, NaiveTime);
+	}
+	std::printf("checksum %g\n", Checksum);
+	return 0;
+}
@@ -0,0 +1,105 @@
+// Times update and pair search of both sweep and prune variants against the dynamic tree and
+// brute force, for bodies moving at random in a cube and for a coherent flow along x, where
+// sorting along x pays off.
+
+#include <geodesy/core/phys/node.h>
+#include <geodesy/core/phys/collision.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+
+typedef math::vec<float, 3> vec3;
+
+static std::size_t brute_force(const std::vector<phys::node*>& aNode) {
+	std::vector<phys::collision::aabb> Box(aNode.size());
+	for (std::size_t i = 0; i < aNode.size(); i++) {
+		Box[i] = phys::collision::bounds(aNode[i]);
+	}
+	std::size_t Count = 0;
+	for (std::size_t i = 0; i < aNode.size(); i++) {
+		for (std::size_t j = i + 1; j < aNode.size(); j++) {
+			Count += Box[i].overlaps(Box[j]);
+		}
+	}
+	return Count;
+}
+
+static void run(std::size_t aCount, bool aFlow, int aSteps) {
+	auto Mesh = std::make_shared<phys::mesh>();
+	Mesh->CenterOfMass 		= { 0.0f, 0.0f, 0.0f };
+	Mesh->BoundingRadius 	= { 1.0f, 0.0f, 0.0f };
+
+	const float Side = 10.0f * std::cbrt((float)aCount);
+	std::vector<std::unique_ptr<phys::node>> Storage;
+	std::vector<phys::node*> Node;
+	std::vector<vec3> Velocity;
+	for (std::size_t i = 0; i < aCount; i++) {
+		Storage.emplace_back(new phys::node());
+		phys::node* N = Storage.back().get();
+		N->CollisionMesh = Mesh;
+		const float s = test::uniform(0.5f, 2.5f);
+		vec3 Position;
+		if (aFlow) {
+			// A long flat slab, everything drifts along x at nearly the same speed.
+			Position = vec3(test::uniform(0.0f, 8.0f * Side), test::uniform(0.0f, Side / 2.83f), test::uniform(0.0f, Side / 2.83f));
+			Velocity.push_back(vec3(test::uniform(0.5f, 0.52f), test::uniform(-0.005f, 0.005f), test::uniform(-0.005f, 0.005f)));
+		}
+		else {
+			Position = vec3(test::uniform(0.0f, Side), test::uniform(0.0f, Side), test::uniform(0.0f, Side));
+			Velocity.push_back(vec3(test::uniform(-0.1f, 0.1f), test::uniform(-0.1f, 0.1f), test::uniform(-0.1f, 0.1f)));
+		}
+		N->GlobalTransform = math::affine<float>(Position, math::quaternion<float>(1.0f, 0.0f, 0.0f, 0.0f), vec3(s, s, s));
+		Node.push_back(N);
+	}
+
+	std::vector<std::shared_ptr<phys::collision::broad_phase>> BroadPhase = {
+		std::make_shared<phys::collision::dynamic_tree>(),
+		std::make_shared<phys::collision::sweep_and_prune>(phys::collision::sweep_and_prune::X),
+		std::make_shared<phys::collision::sweep_and_prune>(phys::collision::sweep_and_prune::ALL),
+	};
+	const char* Name[] = { "dynamic_tree", "sap X", "sap ALL" };
+	double Build[3], Update[3] = { 0.0, 0.0, 0.0 }, Pairs[3] = { 0.0, 0.0, 0.0 };
+	std::size_t PairCount[3];
+	for (std::size_t b = 0; b < BroadPhase.size(); b++) {
+		test::timer Timer;
+		BroadPhase[b]->update(Node);
+		Build[b] = Timer.milliseconds();
+	}
+	for (int Step = 0; Step < aSteps; Step++) {
+		for (std::size_t i = 0; i < aCount; i++) {
+			Node[i]->GlobalTransform.Translation += Velocity[i];
+		}
+		for (std::size_t b = 0; b < BroadPhase.size(); b++) {
+			test::timer Timer;
+			BroadPhase[b]->update(Node);
+			Update[b] += Timer.milliseconds();
+			Timer.reset();
+			PairCount[b] = BroadPhase[b]->find_pairs().size();
+			Pairs[b] += Timer.milliseconds();
+		}
+	}
+
+	std::printf("%s, %zu bodies\n", aFlow ? "coherent flow" : "random motion", aCount);
+	for (std::size_t b = 0; b < BroadPhase.size(); b++) {
+		std::printf("  %-12s build %8.2f ms, update %7.2f ms, pairs %7.2f ms (%zu pairs)\n", Name[b], Build[b], Update[b] / aSteps, Pairs[b] / aSteps, PairCount[b]);
+	}
+	if (aCount <= 20000) {
+		test::timer Timer;
+		const std::size_t Count = brute_force(Node);
+		std::printf("  %-12s %8.2f ms (%zu pairs)\n", "brute force", Timer.milliseconds(), Count);
+	}
+}
+
+int main() {
+	for (std::size_t Count : { 10000, 100000 }) {
+		run(Count, false, 20);
+		run(Count, true, 20);
+	}
+	return 0;
+}
@@ -0,0 +1,65 @@
+// Loads an animated model whose mesh decomposes into several convex pieces, and checks that
+// every compiled animation track lines up with its node in the final linearized hierarchy,
+// the order objects index tracks by.
+
+#include <geodesy/core/gfx/model.h>
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+
+static std::ptrdiff_t find(const std::vector<phys::node*>& aNode, const std::string& aIdentifier) {
+	for (std::size_t i = 0; i < aNode.size(); i++) {
+		if (aNode[i]->Identifier == aIdentifier) return (std::ptrdiff_t)i;
+	}
+	return -1;
+}
+
+int main() {
+	if (!GEODESY_TEST_CHECK(gfx::model::initialize())) return test::result();
+	{
+		// Frame is two boxes offset along a diagonal, Root { Frame { Bolt }, Arm { Hand } } with
+		// Frame translated and Arm rotated by the one animation.
+		phys::collision::hull_create_info HullCreateInfo;
+		HullCreateInfo.Decompose = true;
+		gfx::model Model("data/animated_hulls.gltf", nullptr, HullCreateInfo);
+		const std::vector<phys::node*> LinearHierarchy = Model.Hierarchy->linearize();
+
+		// The pieces join the hierarchy as children of Frame, ahead of Arm.
+		const std::ptrdiff_t Frame = find(LinearHierarchy, "Frame"), Arm = find(LinearHierarchy, "Arm");
+		std::size_t PieceCount = 0;
+		std::ptrdiff_t LastPiece = -1;
+		for (std::size_t i = 0; (Frame >= 0) && (i < LinearHierarchy.size()); i++) {
+			if ((LinearHierarchy[i]->Parent == LinearHierarchy[Frame]) && (LinearHierarchy[i]->CollisionMesh != nullptr)) {
+				PieceCount++;
+				LastPiece = (std::ptrdiff_t)i;
+			}
+		}
+		GEODESY_TEST_CHECK(Model.CollisionReport.HullCount >= 2);
+		GEODESY_TEST_CHECK(PieceCount == Model.CollisionReport.HullCount);
+		GEODESY_TEST_CHECK((Frame >= 0) && (Arm > LastPiece));
+
+		if (GEODESY_TEST_CHECK(Model.Animation.size() == 1)) {
+			const phys::animation& Animation = Model.Animation[0];
+			GEODESY_TEST_CHECK(Animation.Track.size() == LinearHierarchy.size());
+			std::size_t TrackCount = 0, Mismatch = 0;
+			for (std::size_t i = 0; (i < Animation.Track.size()) && (i < LinearHierarchy.size()); i++) {
+				if (!Animation.Track[i].exists()) continue;
+				TrackCount++;
+				Mismatch += (Animation.Track[i].Name != LinearHierarchy[i]->Identifier);
+			}
+			GEODESY_TEST_CHECK(TrackCount == 2);
+			GEODESY_TEST_CHECK(Mismatch == 0);
+			if ((Frame >= 0) && (Arm >= 0) && ((std::size_t)Arm < Animation.Track.size())) {
+				GEODESY_TEST_CHECK(Animation.Track[Frame].PositionKey.size() == 2);
+				GEODESY_TEST_CHECK(Animation.Track[Arm].RotationKey.size() == 2);
+			}
+		}
+	}
+	gfx::model::terminate();
+	return test::result();
+}
@@ -0,0 +1,69 @@
+// Checks math::affine against the 4x4 products it replaced, for construction from a pose,
+// composition, inversion and transforming points.
+
+#include <geodesy/core/math.h>
+
+#include <cmath>
+#include <algorithm>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+template <typename M>
+static double max_difference(const M& aLhs, const M& aRhs) {
+	double Out = 0.0;
+	for (std::size_t i = 0; i < aLhs.size(); i++) {
+		Out = std::max(Out, (double)std::fabs(aLhs[i] - aRhs[i]));
+	}
+	return Out;
+}
+
+static quaternion<float> random_rotation() {
+	return normalize(quaternion<float>(test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f)));
+}
+
+static vec<float, 3> random_vector(float aMin, float aMax) {
+	return vec<float, 3>(test::uniform(aMin, aMax), test::uniform(aMin, aMax), test::uniform(aMin, aMax));
+}
+
+// T * R * S the way phys::calculate_transform used to build it.
+static mat<float, 4, 4> trs_matrix(const vec<float, 3>& aPosition, const quaternion<float>& aOrientation, const vec<float, 3>& aScale) {
+	mat<float, 4, 4> Translation = {
+		1.0f, 0.0f, 0.0f, aPosition[0],
+		0.0f, 1.0f, 0.0f, aPosition[1],
+		0.0f, 0.0f, 1.0f, aPosition[2],
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	mat<float, 4, 4> Scale = {
+		aScale[0], 0.0f, 0.0f, 0.0f,
+		0.0f, aScale[1], 0.0f, 0.0f,
+		0.0f, 0.0f, aScale[2], 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	return Translation * mat<float, 4, 4>(aOrientation) * Scale;
+}
+
+int main() {
+	double TRSError = 0.0, ComposeError = 0.0, InverseError = 0.0, PointError = 0.0;
+	for (int n = 0; n < 1000; n++) {
+		vec<float, 3> Position = random_vector(-10.0f, 10.0f), Scale = random_vector(0.5f, 2.0f);
+		quaternion<float> Orientation = random_rotation();
+		affine<float> A(Position, Orientation, Scale), B(random_vector(-10.0f, 10.0f), random_rotation(), random_vector(0.5f, 2.0f));
+		mat<float, 4, 4> MA = trs_matrix(Position, Orientation, Scale), MB(B);
+
+		TRSError = std::max(TRSError, max_difference(mat<float, 4, 4>(A), MA));
+		ComposeError = std::max(ComposeError, max_difference(mat<float, 4, 4>(A * B), MA * MB));
+		InverseError = std::max(InverseError, max_difference(mat<float, 4, 4>(inverse(A) * A), mat<float, 4, 4>(affine<float>())));
+		vec<float, 3> Point = random_vector(-5.0f, 5.0f);
+		vec<float, 4> Homogeneous = MA * vec<float, 4>(Point[0], Point[1], Point[2], 1.0f);
+		PointError = std::max(PointError, max_difference(A.transform_point(Point), vec<float, 3>(Homogeneous[0], Homogeneous[1], Homogeneous[2])));
+	}
+	GEODESY_TEST_CHECK(TRSError < 1e-4);
+	GEODESY_TEST_CHECK(ComposeError < 1e-3);
+	GEODESY_TEST_CHECK(InverseError < 1e-4);
+	GEODESY_TEST_CHECK(PointError < 1e-4);
+
+	return test::result();
+}
@@ -0,0 +1,106 @@
+// Checks the closed form rigid and affine inverses and the normal matrix against Gauss-Jordan,
+// and the 3x3 symmetric eigen and polar decompositions against their defining identities.
+
+#include <geodesy/core/math.h>
+
+#include <cmath>
+#include <algorithm>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+template <typename M>
+static double max_difference(const M& aLhs, const M& aRhs) {
+	double Out = 0.0;
+	for (std::size_t i = 0; i < aLhs.size(); i++) {
+		Out = std::max(Out, (double)std::fabs(aLhs[i] - aRhs[i]));
+	}
+	return Out;
+}
+
+static quaternion<float> random_rotation() {
+	return normalize(quaternion<float>(test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f)));
+}
+
+static vec<float, 3> random_vector(float aMin, float aMax) {
+	return vec<float, 3>(test::uniform(aMin, aMax), test::uniform(aMin, aMax), test::uniform(aMin, aMax));
+}
+
+int main() {
+	const mat<double, 3, 3> Identity = {
+		1.0, 0.0, 0.0,
+		0.0, 1.0, 0.0,
+		0.0, 0.0, 1.0
+	};
+
+	// Closed form inverses of 4x4 matrices against Gauss-Jordan.
+	double RigidError = 0.0, AffineError = 0.0, NormalError = 0.0;
+	for (int n = 0; n < 1000; n++) {
+		vec<float, 3> Position = random_vector(-10.0f, 10.0f), Scale = random_vector(0.5f, 2.0f);
+		quaternion<float> Orientation = random_rotation();
+		mat<float, 4, 4> Rigid(affine<float>(Position, Orientation, vec<float, 3>(1.0f, 1.0f, 1.0f)));
+		mat<float, 4, 4> Affine(affine<float>(Position, Orientation, Scale));
+		RigidError = std::max(RigidError, max_difference(inverse_rigid(Rigid), inverse(Rigid)));
+		AffineError = std::max(AffineError, max_difference(inverse_affine(Affine), inverse(Affine)));
+		NormalError = std::max(NormalError, max_difference(normal_matrix(Affine), transpose(inverse(Affine.minor(3, 3)))));
+	}
+	GEODESY_TEST_CHECK(RigidError < 1e-4);
+	GEODESY_TEST_CHECK(AffineError < 1e-3);
+	GEODESY_TEST_CHECK(NormalError < 1e-3);
+
+	// A = V diag(L) V^T with orthonormal, right handed V and descending L.
+	for (int n = 0; n < 1000; n++) {
+		mat<double, 3, 3> A;
+		for (std::size_t i = 0; i < 3; i++) {
+			for (std::size_t j = i; j < 3; j++) {
+				A(i, j) = A(j, i) = test::uniform(-2.0f, 2.0f);
+			}
+		}
+		// Repeated eigenvalues every few iterations.
+		if (n % 5 == 0) {
+			A = {
+				2.0, 0.0, 0.0,
+				0.0, 2.0, 0.0,
+				0.0, 0.0, (double)test::uniform(-1.0f, 1.0f)
+			};
+		}
+		vec<double, 3> L;
+		mat<double, 3, 3> V;
+		eigen_symmetric(A, L, V);
+		mat<double, 3, 3> D = {
+			L[0], 0.0, 0.0,
+			0.0, L[1], 0.0,
+			0.0, 0.0, L[2]
+		};
+		GEODESY_TEST_CHECK(max_difference(V * D * transpose(V), A) < 1e-9);
+		GEODESY_TEST_CHECK(max_difference(transpose(V) * V, Identity) < 1e-9);
+		GEODESY_TEST_CHECK(std::fabs(determinant(V) - 1.0) < 1e-9);
+		GEODESY_TEST_CHECK((L[0] >= L[1]) && (L[1] >= L[2]));
+	}
+
+	// A = R S with orthogonal R and symmetric S, and R recovers the rotation of a scaled transform.
+	for (int n = 0; n < 1000; n++) {
+		mat<double, 3, 3> A;
+		for (std::size_t i = 0; i < 9; i++) {
+			A[i] = test::uniform(-2.0f, 2.0f);
+		}
+		if (std::fabs(determinant(A)) < 1e-3) continue;
+		mat<double, 3, 3> R, S;
+		polar(A, R, S);
+		GEODESY_TEST_CHECK(max_difference(R * S, A) < 1e-9);
+		GEODESY_TEST_CHECK(max_difference(transpose(R) * R, Identity) < 1e-9);
+		GEODESY_TEST_CHECK(max_difference(S, transpose(S)) < 1e-9);
+	}
+	{
+		quaternion<float> Orientation = random_rotation();
+		affine<float> Scaled(vec<float, 3>(1.0f, 2.0f, 3.0f), Orientation, vec<float, 3>(2.0f, 0.5f, 3.0f));
+		affine<float> Rotation(vec<float, 3>(1.0f, 2.0f, 3.0f), Orientation, vec<float, 3>(1.0f, 1.0f, 1.0f));
+		mat<float, 3, 3> R, S;
+		polar(Scaled.Linear, R, S);
+		GEODESY_TEST_CHECK(max_difference(R, Rotation.Linear) < 1e-5);
+	}
+
+	return test::result();
+}
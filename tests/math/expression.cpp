@@ -0,0 +1,61 @@
+// Checks that fused field expressions match element by element evaluation, including
+// compound assignment into a field the expression reads.
+
+#include <geodesy/core/math.h>
+
+#include <cmath>
+#include <algorithm>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+int main() {
+	// Expressions are evaluated in one pass, each element must match the scalar evaluation.
+	{
+		field<float, 1, float> X(-5.0f, 5.0f, 100003, 1);
+		field<float, 1, float> Arithmetic = 2.0f * (X * X - X) / (X + 7.0f);
+		field<float, 1, float> Transcendental = 10.0f * 0.5f * (sin(X * X) + 1.0f);
+		int ArithmeticMismatch = 0;
+		double TranscendentalError = 0.0;
+		for (std::size_t i = 0; i < X.size(); i++) {
+			const float x = X[i];
+			ArithmeticMismatch += (Arithmetic[i] != 2.0f * (x * x - x) / (x + 7.0f));
+			TranscendentalError = std::max(TranscendentalError, (double)std::fabs(Transcendental[i] - 10.0f * 0.5f * (std::sin(x * x) + 1.0f)));
+		}
+		GEODESY_TEST_CHECK(Arithmetic.size() == X.size());
+		GEODESY_TEST_CHECK(ArithmeticMismatch == 0);
+		GEODESY_TEST_CHECK(TranscendentalError < 1e-5);
+
+		// Compound assignment and aliasing the destination.
+		field<float, 1, float> Y = X;
+		Y += X;
+		Y *= 3.0f;
+		Y = Y - X;
+		int CompoundMismatch = 0;
+		for (std::size_t i = 0; i < X.size(); i++) {
+			CompoundMismatch += (Y[i] != (X[i] + X[i]) * 3.0f - X[i]);
+		}
+		GEODESY_TEST_CHECK(CompoundMismatch == 0);
+	}
+
+	// Multidimensional fields fuse the same way, sample by sample.
+	{
+		const vec<std::size_t, 3> Count = { 37, 41, 43 };
+		field<float, 3, float> A(Count), B(Count);
+		for (std::size_t i = 0; i < A.size(); i++) {
+			A[i] = test::uniform(-2.0f, 2.0f);
+			B[i] = test::uniform(-2.0f, 2.0f);
+		}
+		field<float, 3, float> C = A * B - 3.0f * (A + B);
+		int Mismatch = 0;
+		for (std::size_t i = 0; i < A.size(); i++) {
+			Mismatch += (C[i] != A[i] * B[i] - 3.0f * (A[i] + B[i]));
+		}
+		GEODESY_TEST_CHECK(C.size() == A.size());
+		GEODESY_TEST_CHECK(Mismatch == 0);
+	}
+
+	return test::result();
+}
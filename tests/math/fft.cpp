@@ -0,0 +1,187 @@
+// Checks the FFT against a direct DFT in long double for mixed radix, generic odd radix and
+// Bluestein lengths, real transforms, multidimensional fields and the convolution helpers.
+
+#include <geodesy/core/math.h>
+
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+typedef std::complex<long double> reference;
+
+static std::vector<reference> direct_dft(const std::vector<reference>& aIn) {
+	const std::size_t n = aIn.size();
+	const long double Pi = 3.141592653589793238462643383279502884L;
+	std::vector<reference> Out(n);
+	for (std::size_t k = 0; k < n; k++) {
+		reference Sum = 0.0L;
+		for (std::size_t j = 0; j < n; j++) {
+			const long double Angle = -2.0L * Pi * (long double)((j * k) % n) / (long double)n;
+			Sum += aIn[j] * reference(std::cos(Angle), std::sin(Angle));
+		}
+		Out[k] = Sum;
+	}
+	return Out;
+}
+
+// Largest error of forward, inverse, rfft and irfft of length aCount relative to the spectrum.
+template <typename T>
+static double transform_error(std::size_t aCount) {
+	std::vector<complex<T>> Signal(aCount);
+	std::vector<reference> Reference(aCount);
+	std::vector<T> Real(aCount);
+	std::vector<reference> RealReference(aCount);
+	for (std::size_t i = 0; i < aCount; i++) {
+		Signal[i] = complex<T>((T)test::uniform(-1.0f, 1.0f), (T)test::uniform(-1.0f, 1.0f));
+		Reference[i] = reference(Signal[i][0], Signal[i][1]);
+		Real[i] = Signal[i][0];
+		RealReference[i] = reference(Real[i], 0.0L);
+	}
+	std::vector<reference> Spectrum = direct_dft(Reference), RealSpectrum = direct_dft(RealReference);
+	long double Scale = 1.0L;
+	for (const reference& Bin : Spectrum) Scale = std::max(Scale, std::abs(Bin));
+
+	long double Error = 0.0L;
+	std::vector<complex<T>> Transformed = Signal;
+	fft(Transformed.data(), aCount, fft_direction::FORWARD);
+	for (std::size_t k = 0; k < aCount; k++) {
+		Error = std::max(Error, std::abs(Spectrum[k] - reference(Transformed[k][0], Transformed[k][1])) / Scale);
+	}
+	fft(Transformed.data(), aCount, fft_direction::INVERSE);
+	for (std::size_t i = 0; i < aCount; i++) {
+		Error = std::max(Error, std::abs(Reference[i] - reference(Transformed[i][0], Transformed[i][1])));
+	}
+
+	std::vector<complex<T>> Half(aCount / 2 + 1);
+	std::vector<T> Restored(aCount);
+	rfft(Real.data(), aCount, Half.data());
+	for (std::size_t k = 0; k <= aCount / 2; k++) {
+		Error = std::max(Error, std::abs(RealSpectrum[k] - reference(Half[k][0], Half[k][1])) / Scale);
+	}
+	irfft(Half.data(), aCount, Restored.data());
+	for (std::size_t i = 0; i < aCount; i++) {
+		Error = std::max(Error, std::fabs((long double)(Restored[i] - Real[i])));
+	}
+	return (double)Error;
+}
+
+int main() {
+	// Radix 2, 3, 4, 5 stages, generic odd radices up to 61 and Bluestein above it.
+	const std::size_t Size[] = { 1, 2, 3, 4, 5, 6, 7, 8, 12, 15, 16, 30, 49, 60, 61, 64, 97, 100, 121, 127, 128, 210, 243, 256, 360, 509, 1000, 1024, 1031 };
+	double FloatError = 0.0, DoubleError = 0.0;
+	for (std::size_t n : Size) {
+		FloatError = std::max(FloatError, transform_error<float>(n));
+		DoubleError = std::max(DoubleError, transform_error<double>(n));
+	}
+	std::printf("fft: worst float error %.2e, double error %.2e\n", FloatError, DoubleError);
+	GEODESY_TEST_CHECK(FloatError < 1e-5);
+	GEODESY_TEST_CHECK(DoubleError < 1e-12);
+
+	// Real 3D field, the halved spectrum matches the complex transform and a direct sum for one bin.
+	{
+		const std::size_t nx = 20, ny = 18, nz = 15;
+		field<float, 3, float> F(vec<std::size_t, 3>{ nx, ny, nz });
+		field<float, 3, complex<float>> C(vec<std::size_t, 3>{ nx, ny, nz });
+		for (std::size_t i = 0; i < F.size(); i++) {
+			F[i] = test::uniform(-1.0f, 1.0f);
+			C[i] = complex<float>(F[i], 0.0f);
+		}
+		field<float, 3, complex<float>> S = rfft(F);
+		fft(C, fft_direction::FORWARD);
+		double HalfError = 0.0;
+		for (std::size_t z = 0; z < nz; z++) {
+			for (std::size_t y = 0; y < ny; y++) {
+				for (std::size_t x = 0; x <= nx / 2; x++) {
+					const complex<float> A = C[x + nx * (y + ny * z)], B = S[x + (nx / 2 + 1) * (y + ny * z)];
+					HalfError = std::max(HalfError, (double)std::hypot(A[0] - B[0], A[1] - B[1]));
+				}
+			}
+		}
+		GEODESY_TEST_CHECK(HalfError < 1e-4);
+
+		const std::size_t kx = 3, ky = 5, kz = 7;
+		const long double Pi = 3.141592653589793238462643383279502884L;
+		reference Bin = 0.0L;
+		for (std::size_t z = 0; z < nz; z++) {
+			for (std::size_t y = 0; y < ny; y++) {
+				for (std::size_t x = 0; x < nx; x++) {
+					const long double Angle = -2.0L * Pi * ((long double)(kx * x) / nx + (long double)(ky * y) / ny + (long double)(kz * z) / nz);
+					Bin += (long double)F[x + nx * (y + ny * z)] * reference(std::cos(Angle), std::sin(Angle));
+				}
+			}
+		}
+		const complex<float> B = S[kx + (nx / 2 + 1) * (ky + ny * kz)];
+		GEODESY_TEST_CHECK(std::abs(Bin - reference(B[0], B[1])) < 1e-4L);
+
+		field<float, 3, float> G = irfft(S, nx);
+		double RoundTripError = 0.0;
+		for (std::size_t i = 0; i < F.size(); i++) {
+			RoundTripError = std::max(RoundTripError, (double)std::fabs(F[i] - G[i]));
+		}
+		GEODESY_TEST_CHECK(RoundTripError < 1e-5);
+	}
+
+	// Linear convolution and partitioned streaming convolution against the direct sum.
+	{
+		const std::size_t n = 4096, m = 700, Block = 256;
+		std::vector<float> Signal(n), Kernel(m);
+		for (float& Value : Signal) Value = test::uniform(-1.0f, 1.0f);
+		for (float& Value : Kernel) Value = test::uniform(-1.0f, 1.0f) * 0.05f;
+		std::vector<double> Direct(n + m - 1, 0.0);
+		for (std::size_t i = 0; i < n; i++) {
+			for (std::size_t j = 0; j < m; j++) {
+				Direct[i + j] += (double)Signal[i] * (double)Kernel[j];
+			}
+		}
+		std::vector<float> Linear = convolve(Signal, Kernel);
+		GEODESY_TEST_CHECK(Linear.size() == Direct.size());
+		double LinearError = 0.0;
+		for (std::size_t i = 0; i < Direct.size(); i++) {
+			LinearError = std::max(LinearError, std::fabs(Direct[i] - Linear[i]));
+		}
+		GEODESY_TEST_CHECK(LinearError < 1e-4);
+
+		fft_convolver<float> Convolver(Kernel.data(), m, Block);
+		std::vector<float> Streamed(n);
+		for (std::size_t b = 0; b < n; b += Block) {
+			Convolver.process(Signal.data() + b, Streamed.data() + b);
+		}
+		double StreamError = 0.0;
+		for (std::size_t i = 0; i < n; i++) {
+			StreamError = std::max(StreamError, std::fabs(Direct[i] - Streamed[i]));
+		}
+		GEODESY_TEST_CHECK(StreamError < 1e-4);
+	}
+
+	// Field convolution keeps the input size, the kernel is centred.
+	{
+		const std::size_t W = 64, H = 48, K = 7;
+		field<float, 2, float> F(vec<std::size_t, 2>{ W, H }), Kernel(vec<std::size_t, 2>{ K, K });
+		for (float& Value : F) Value = test::uniform(-1.0f, 1.0f);
+		for (float& Value : Kernel) Value = test::uniform(-1.0f, 1.0f);
+		field<float, 2, float> Out = convolve(F, Kernel);
+		double FieldError = 0.0;
+		for (std::ptrdiff_t y = 0; y < (std::ptrdiff_t)H; y++) {
+			for (std::ptrdiff_t x = 0; x < (std::ptrdiff_t)W; x++) {
+				double Sum = 0.0;
+				for (std::ptrdiff_t j = 0; j < (std::ptrdiff_t)K; j++) {
+					for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)K; i++) {
+						const std::ptrdiff_t sx = x + (std::ptrdiff_t)K / 2 - i, sy = y + (std::ptrdiff_t)K / 2 - j;
+						if ((sx < 0) || (sy < 0) || (sx >= (std::ptrdiff_t)W) || (sy >= (std::ptrdiff_t)H)) continue;
+						Sum += (double)F[sx + W * sy] * (double)Kernel[i + K * j];
+					}
+				}
+				FieldError = std::max(FieldError, std::fabs(Sum - Out[x + W * y]));
+			}
+		}
+		GEODESY_TEST_CHECK(FieldError < 1e-4);
+	}
+
+	return test::result();
+}
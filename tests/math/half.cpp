@@ -0,0 +1,98 @@
+// Checks math::half conversions, exhaustively for half -> float -> half, by nearest
+// even rounding for float -> half, and the bulk converters against the scalar ones.
+
+#include <geodesy/core/math.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+static bool is_nan_bits(std::uint16_t aBits) {
+	return ((aBits & 0x7C00u) == 0x7C00u) && ((aBits & 0x03FFu) != 0);
+}
+
+// True if aBits is the half nearest to aValue, ties going to the even mantissa.
+static bool rounds_to_nearest_even(float aValue, std::uint16_t aBits) {
+	if (std::isnan(aValue)) return is_nan_bits(aBits);
+	const std::uint16_t Sign = std::signbit(aValue) ? 0x8000u : 0x0000u;
+	if ((aBits & 0x8000u) != Sign) return false;
+	const double Magnitude = std::fabs((double)aValue);
+	// Halfway between the largest finite half and the next power of two overflows.
+	if (Magnitude >= 65520.0) return (aBits & 0x7FFFu) == 0x7C00u;
+	const std::uint16_t Bits = aBits & 0x7FFFu;
+	if (Bits >= 0x7C00u) return false;
+	const double Error = std::fabs((double)half_bits_to_float(Bits) - Magnitude);
+	for (int Step : { -1, 1 }) {
+		const int Neighbour = (int)Bits + Step;
+		if ((Neighbour < 0) || (Neighbour >= 0x7C00)) continue;
+		const double NeighbourError = std::fabs((double)half_bits_to_float((std::uint16_t)Neighbour) - Magnitude);
+		if (NeighbourError < Error) return false;
+		if ((NeighbourError == Error) && ((Bits & 1u) != 0)) return false;
+	}
+	return true;
+}
+
+int main() {
+	// Every half survives the round trip through float, NaNs stay NaN.
+	int RoundTripMismatch = 0;
+	for (std::uint32_t b = 0; b < 65536; b++) {
+		const half H = half::from_bits((std::uint16_t)b);
+		const float F = H;
+		if (is_nan_bits((std::uint16_t)b)) {
+			RoundTripMismatch += !std::isnan(F) || !is_nan_bits(half(F).Bits);
+		}
+		else {
+			RoundTripMismatch += (half(F).Bits != b);
+		}
+	}
+	GEODESY_TEST_CHECK(RoundTripMismatch == 0);
+
+	// A stride through all float bit patterns covers normals, subnormals, ties and overflow.
+	int RoundingMismatch = 0;
+	for (std::uint64_t u = 0; u < (1ull << 32); u += 4099) {
+		const std::uint32_t Pattern = (std::uint32_t)u;
+		float F;
+		std::memcpy(&F, &Pattern, sizeof(F));
+		RoundingMismatch += !rounds_to_nearest_even(F, float_to_half_bits(F));
+	}
+	// Exact ties between adjacent halves in the normal and subnormal ranges.
+	for (float Tie : { 1.0f + 1.0f / 2048.0f, 1.0f + 3.0f / 2048.0f, 0.5f * 5.9604645e-8f, 1.5f * 5.9604645e-8f, 65504.0f + 16.0f }) {
+		RoundingMismatch += !rounds_to_nearest_even(Tie, float_to_half_bits(Tie));
+		RoundingMismatch += !rounds_to_nearest_even(-Tie, float_to_half_bits(-Tie));
+	}
+	GEODESY_TEST_CHECK(RoundingMismatch == 0);
+
+	// Bulk conversion, vectorized or not, must give the scalar results.
+	{
+		const std::size_t Count = (1u << 20) + 13;
+		std::vector<float> F(Count), G(Count);
+		std::vector<half> H(Count);
+		for (std::size_t i = 0; i < Count; i++) {
+			F[i] = test::uniform(-70000.0f, 70000.0f) * ((i % 3 == 0) ? 1e-6f : 1.0f);
+		}
+		F[0] = std::nanf("");
+		F[1] = -0.0f;
+		convert(H.data(), F.data(), Count);
+		convert(G.data(), H.data(), Count);
+		int BulkMismatch = 0;
+		for (std::size_t i = 2; i < Count; i++) {
+			BulkMismatch += (H[i].Bits != float_to_half_bits(F[i]));
+			BulkMismatch += (G[i] != half_bits_to_float(H[i].Bits));
+		}
+		GEODESY_TEST_CHECK(BulkMismatch == 0);
+		GEODESY_TEST_CHECK(is_nan_bits(H[0].Bits));
+		GEODESY_TEST_CHECK(H[1].Bits == 0x8000u);
+	}
+
+	// Vectors of half convert component wise.
+	vec<float, 4> V = to_float(to_half(vec<float, 4>(1.0f, -2.5f, 1024.0f, 0.1f)));
+	GEODESY_TEST_CHECK((V[0] == 1.0f) && (V[1] == -2.5f) && (V[2] == 1024.0f));
+	GEODESY_TEST_CHECK(std::fabs(V[3] - 0.1f) < 1e-4f);
+
+	return test::result();
+}
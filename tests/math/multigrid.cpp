@@ -0,0 +1,109 @@
+// Checks that multigrid converges in a handful of V-cycles for every boundary and dimension,
+// that its residual is the true residual of the operator, and that it agrees with plain
+// conjugate gradient.
+
+#include <geodesy/core/math.h>
+
+#include <cmath>
+#include <algorithm>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+static const char* boundary_name(stencil::boundary aBoundary) {
+	switch (aBoundary) {
+	case stencil::ZERO: 	return "ZERO";
+	case stencil::CLAMP: 	return "CLAMP";
+	case stencil::WRAP: 	return "WRAP";
+	default: 				return "ONE_SIDED";
+	}
+}
+
+// Solves with a random right hand side and checks the report against the residual recomputed with apply().
+template <std::size_t N>
+static void check_solve(std::size_t aCount, stencil::boundary aBoundary, float aAlpha, float aBeta, std::size_t aMaxCycles) {
+	vec<float, N> LowerBound, UpperBound;
+	vec<std::size_t, N> Count;
+	for (std::size_t i = 0; i < N; i++) {
+		LowerBound[i] 	= 0.0f;
+		UpperBound[i] 	= 1.0f;
+		Count[i] 		= aCount + 2 * i;
+	}
+	field<float, N, float> F(LowerBound, UpperBound, Count);
+	for (float& Value : F) Value = test::uniform(-1.0f, 1.0f);
+
+	const float Tolerance = 1e-4f;
+	multigrid<float, N, float> Solver(F.domain(), aBoundary, aAlpha, aBeta);
+	field<float, N, float> U;
+	auto Report = Solver.solve(U, F, Tolerance);
+
+	// Singular systems only see f minus its mean.
+	field<float, N, float> Target = F;
+	if (Solver.singular()) {
+		double Mean = 0.0;
+		for (float Value : F) Mean += Value;
+		Mean /= (double)F.size();
+		for (float& Value : Target) Value -= (float)Mean;
+	}
+	field<float, N, float> AU;
+	Solver.apply(U, AU);
+	double Residual = 0.0, Norm = 0.0, Mean = 0.0;
+	for (std::size_t i = 0; i < F.size(); i++) {
+		Residual += ((double)Target[i] - AU[i]) * ((double)Target[i] - AU[i]);
+		Norm += (double)Target[i] * Target[i];
+		Mean += U[i];
+	}
+	Residual = std::sqrt(Residual / Norm);
+
+	std::printf("multigrid: %zuD n=%zu %-5s alpha=%g levels=%zu cycles=%zu residual=%.2e%s\n", N, aCount, boundary_name(aBoundary), aAlpha, Solver.Level.size(), Report.Iterations, Report.Residual, Report.Fallback ? " (fallback)" : "");
+	GEODESY_TEST_CHECK(Report.Converged);
+	GEODESY_TEST_CHECK(!Report.Fallback);
+	GEODESY_TEST_CHECK(Report.Iterations <= aMaxCycles);
+	// Removing the mean afterwards shifts u, which moves the float rounding of A u a little.
+	GEODESY_TEST_CHECK(std::fabs(Residual - Report.Residual) <= 0.25 * Tolerance);
+	GEODESY_TEST_CHECK(Residual <= 2.0 * Tolerance);
+	if (Solver.singular()) {
+		GEODESY_TEST_CHECK(std::fabs(Mean / (double)F.size()) < 1e-5);
+	}
+}
+
+int main() {
+	for (stencil::boundary Boundary : { stencil::ZERO, stencil::CLAMP, stencil::WRAP }) {
+		check_solve<1>(512, Boundary, 0.0f, 1.0f, 10);
+		check_solve<2>(64, Boundary, 0.0f, 1.0f, 10);
+		check_solve<2>(100, Boundary, 0.0f, 1.0f, 10);
+		check_solve<3>(32, Boundary, 0.0f, 1.0f, 10);
+		// Implicit diffusion, Alpha * u + Beta * laplacian(u) with Alpha and Beta of opposite sign.
+		check_solve<2>(64, Boundary, 1.0f, -0.01f, 10);
+	}
+
+	// Odd periodic axes, on the finest level or only further down as 264 -> 132 -> 66 -> 33.
+	check_solve<1>(264, stencil::WRAP, 0.0f, 1.0f, 10);
+	check_solve<2>(33, stencil::WRAP, 0.0f, 1.0f, 10);
+	check_solve<2>(129, stencil::WRAP, 0.0f, 1.0f, 10);
+	check_solve<2>(255, stencil::WRAP, 0.0f, 1.0f, 10);
+	check_solve<3>(17, stencil::WRAP, 0.0f, 1.0f, 10);
+	check_solve<3>(33, stencil::WRAP, 0.0f, 1.0f, 10);
+	check_solve<2>(65, stencil::WRAP, 1.0f, -0.01f, 10);
+
+	// Multigrid and conjugate gradient solve the same system.
+	{
+		field<float, 2, float> F(vec<float, 2>{ 0.0f, 0.0f }, vec<float, 2>{ 1.0f, 1.0f }, vec<std::size_t, 2>{ 48, 40 });
+		for (float& Value : F) Value = test::uniform(-1.0f, 1.0f);
+		multigrid<float, 2, float> Solver(F.domain(), stencil::ZERO);
+		field<float, 2, float> Multigrid, ConjugateGradient;
+		Solver.solve(Multigrid, F, 1e-6f);
+		auto Report = Solver.solve_conjugate_gradient(ConjugateGradient, F, 1e-6f);
+		GEODESY_TEST_CHECK(Report.Fallback);
+		double Difference = 0.0, Scale = 0.0;
+		for (std::size_t i = 0; i < F.size(); i++) {
+			Difference = std::max(Difference, (double)std::fabs(Multigrid[i] - ConjugateGradient[i]));
+			Scale = std::max(Scale, (double)std::fabs(ConjugateGradient[i]));
+		}
+		GEODESY_TEST_CHECK(Difference <= 1e-3 * Scale);
+	}
+
+	return test::result();
+}
@@ -0,0 +1,78 @@
+// Checks that batched nlerp and lerp produce exactly the bits of their scalar versions, and
+// that the corrected nlerp tracks slerp as closely as its documentation promises.
+
+#include <geodesy/core/math.h>
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+template <typename T>
+static bool same_bits(const T& aLhs, const T& aRhs) {
+	return std::memcmp(aLhs.data(), aRhs.data(), sizeof(float) * aLhs.size()) == 0;
+}
+
+static quaternion<float> random_rotation() {
+	return normalize(quaternion<float>(test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f)));
+}
+
+int main() {
+	// A tail that is not a multiple of four.
+	const std::size_t Count = 1027;
+	std::vector<quaternion<float>> From(Count), To(Count), Batch(Count);
+	std::vector<vec<float, 3>> FromPosition(Count), ToPosition(Count), BatchPosition(Count);
+	std::vector<float> Factor(Count);
+	for (std::size_t i = 0; i < Count; i++) {
+		From[i] 		= random_rotation();
+		To[i] 			= random_rotation();
+		FromPosition[i] = vec<float, 3>(test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f));
+		ToPosition[i] 	= vec<float, 3>(test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f));
+		Factor[i] 		= test::uniform(0.0f, 1.0f);
+	}
+	for (bool Correction : { false, true }) {
+		nlerp(Batch.data(), From.data(), To.data(), Factor.data(), Count, Correction);
+		int NlerpMismatch = 0;
+		for (std::size_t i = 0; i < Count; i++) {
+			NlerpMismatch += !same_bits(Batch[i], nlerp(From[i], To[i], Factor[i], Correction));
+		}
+		GEODESY_TEST_CHECK(NlerpMismatch == 0);
+	}
+	lerp(BatchPosition.data(), FromPosition.data(), ToPosition.data(), Factor.data(), Count);
+	int LerpMismatch = 0;
+	for (std::size_t i = 0; i < Count; i++) {
+		LerpMismatch += !same_bits(BatchPosition[i], lerp(FromPosition[i], ToPosition[i], Factor[i]));
+	}
+	GEODESY_TEST_CHECK(LerpMismatch == 0);
+
+	// Corrected nlerp against slerp, over any arc and over arcs under about 70 degrees.
+	double Error = 0.0, ShortArcError = 0.0;
+	for (int n = 0; n < 100000; n++) {
+		const quaternion<float> A = random_rotation(), B = random_rotation();
+		const float t = test::uniform(0.0f, 1.0f);
+		const quaternion<float> Fast = nlerp(A, B, t, true), Exact = slerp(A, B, t);
+		double Difference = 0.0;
+		for (std::size_t k = 0; k < 4; k++) {
+			Difference = std::max(Difference, (double)std::fabs(Fast[k] - Exact[k]));
+		}
+		// Both take the shortest arc, whose half angle follows from |A . B|.
+		float Cosine = 0.0f;
+		for (std::size_t k = 0; k < 4; k++) {
+			Cosine += A[k] * B[k];
+		}
+		Error = std::max(Error, Difference);
+		if (std::fabs(Cosine) > std::cos(0.5f * 70.0f * 3.14159265f / 180.0f)) {
+			ShortArcError = std::max(ShortArcError, Difference);
+		}
+	}
+	std::printf("nlerp: corrected against slerp %.2e, under 70 degrees %.2e\n", Error, ShortArcError);
+	GEODESY_TEST_CHECK(Error < 4e-4);
+	GEODESY_TEST_CHECK(ShortArcError < 2e-5);
+
+	return test::result();
+}
@@ -0,0 +1,99 @@
+// Checks that the SIMD specializations of vec, mat and quaternion produce exactly the
+// bits of the generic scalar templates, on random data including signed zeros.
+
+#include <geodesy/core/math.h>
+
+#include <cstring>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+template <typename T>
+static bool same_bits(const T& aLhs, const T& aRhs) {
+	return std::memcmp(aLhs.data(), aRhs.data(), sizeof(float) * aLhs.size()) == 0;
+}
+
+static bool same_bits(float aLhs, float aRhs) {
+	return std::memcmp(&aLhs, &aRhs, sizeof(float)) == 0;
+}
+
+int main() {
+	std::printf("math::simd: %s\n", simd::name());
+
+	const int Iterations = 100000;
+	int MatrixMismatch = 0, TransformMismatch = 0, DotMismatch = 0, ScaleMismatch = 0, CrossMismatch = 0, QuaternionMismatch = 0;
+	for (int n = 0; n < Iterations; n++) {
+		mat<float, 4, 4> A, B;
+		for (std::size_t i = 0; i < 16; i++) {
+			A[i] = test::uniform(-10.0f, 10.0f);
+			B[i] = test::uniform(-10.0f, 10.0f);
+		}
+		if (n % 7 == 0) {
+			A[3] = 0.0f;
+			A[5] = -0.0f;
+		}
+
+		// Generic mat * mat accumulates each element from zero over k.
+		mat<float, 4, 4> Product = A * B, Reference;
+		for (std::size_t i = 0; i < 4; i++) {
+			for (std::size_t j = 0; j < 4; j++) {
+				for (std::size_t k = 0; k < 4; k++) {
+					Reference(i, j) += A(i, k) * B(k, j);
+				}
+			}
+		}
+		MatrixMismatch += !same_bits(Product, Reference);
+
+		vec<float, 4> V(test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f));
+		vec<float, 4> AV = A * V, ReferenceAV;
+		for (std::size_t i = 0; i < 4; i++) {
+			ReferenceAV[i] = 0.0f;
+			for (std::size_t j = 0; j < 4; j++) {
+				ReferenceAV[i] += A(i, j) * V[j];
+			}
+		}
+		TransformMismatch += !same_bits(AV, ReferenceAV);
+
+		float Dot = V * AV, ReferenceDot = 0.0f;
+		for (std::size_t i = 0; i < 4; i++) {
+			ReferenceDot += V[i] * AV[i];
+		}
+		DotMismatch += !same_bits(Dot, ReferenceDot);
+
+		vec<float, 4> Normal = normalize(V), ReferenceNormal;
+		float SquaredLength = 0.0f;
+		for (std::size_t i = 0; i < 4; i++) {
+			SquaredLength += V[i] * V[i];
+		}
+		for (std::size_t i = 0; i < 4; i++) {
+			ReferenceNormal[i] = V[i] / std::sqrt(SquaredLength);
+		}
+		ScaleMismatch += !same_bits(Normal, ReferenceNormal);
+
+		vec<float, 3> L(test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f));
+		vec<float, 3> R(test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f), test::uniform(-10.0f, 10.0f));
+		vec<float, 3> Cross = L ^ R;
+		vec<float, 3> ReferenceCross(L[1] * R[2] - L[2] * R[1], L[2] * R[0] - L[0] * R[2], L[0] * R[1] - L[1] * R[0]);
+		CrossMismatch += !same_bits(Cross, ReferenceCross);
+
+		quaternion<float> P(V[0], V[1], V[2], V[3]), Q(AV[0], AV[1], AV[2], AV[3]);
+		quaternion<float> Hamilton = P * Q;
+		quaternion<float> ReferenceHamilton(
+			P[0] * Q[0] - P[1] * Q[1] - P[2] * Q[2] - P[3] * Q[3],
+			P[0] * Q[1] + P[1] * Q[0] + P[2] * Q[3] - P[3] * Q[2],
+			P[0] * Q[2] - P[1] * Q[3] + P[2] * Q[0] + P[3] * Q[1],
+			P[0] * Q[3] + P[1] * Q[2] - P[2] * Q[1] + P[3] * Q[0]
+		);
+		QuaternionMismatch += !same_bits(Hamilton, ReferenceHamilton);
+	}
+	GEODESY_TEST_CHECK(MatrixMismatch == 0);
+	GEODESY_TEST_CHECK(TransformMismatch == 0);
+	GEODESY_TEST_CHECK(DotMismatch == 0);
+	GEODESY_TEST_CHECK(ScaleMismatch == 0);
+	GEODESY_TEST_CHECK(CrossMismatch == 0);
+	GEODESY_TEST_CHECK(QuaternionMismatch == 0);
+
+	return test::result();
+}
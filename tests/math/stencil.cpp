@@ -0,0 +1,154 @@
+// Checks that the tiled stencil operators are exact on polynomials, agree with a naive per
+// sample loop, and handle periodic boundaries.
+
+#include <geodesy/core/math.h>
+
+#include <cmath>
+#include <algorithm>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core::math;
+
+typedef field<float, 3, float> field3;
+
+// Naive laplacian with the ONE_SIDED default, every sample looks up its neighbours by index.
+static field3 naive_laplacian(const field3& aF) {
+	field3 Out(aF.LowerBound, aF.UpperBound, aF.ElementCount);
+	vec<float, 3> Step = aF.UpperBound - aF.LowerBound;
+	for (std::size_t j = 0; j < 3; j++) {
+		Step[j] /= (float)(aF.ElementCount[j] - 1);
+	}
+	for (std::size_t i = 0; i < aF.size(); i++) {
+		vec<std::size_t, 3> Index = aF.convert_to_dimensional_index(i);
+		float Sum = 0.0f;
+		for (std::size_t j = 0; j < 3; j++) {
+			// Edges use the second difference of the nearest interior sample.
+			vec<std::size_t, 3> Centre = Index;
+			Centre[j] = std::clamp<std::size_t>(Centre[j], 1, aF.ElementCount[j] - 2);
+			vec<std::size_t, 3> Lo = Centre, Hi = Centre;
+			Lo[j]--;
+			Hi[j]++;
+			Sum += (aF[aF.convert_to_global_index(Hi)] - 2.0f * aF[aF.convert_to_global_index(Centre)] + aF[aF.convert_to_global_index(Lo)]) / (Step[j] * Step[j]);
+		}
+		Out[i] = Sum;
+	}
+	return Out;
+}
+
+int main() {
+	// Second differences are exact on quadratics away from the edges, and everywhere for the laplacian.
+	{
+		const std::size_t n = 40;
+		field3 F(vec<float, 3>{ 0.0f, 0.0f, 0.0f }, vec<float, 3>{ 1.0f, 1.0f, 1.0f }, vec<std::size_t, 3>{ n, n + 3, n + 5 });
+		for (std::size_t i = 0; i < F.size(); i++) {
+			vec<float, 3> P = F.convert_index_to_position(F.convert_to_dimensional_index(i));
+			F[i] = P[0] * P[0] + 2.0f * P[1] * P[1] + 3.0f * P[2] * P[2] + P[0] * P[1];
+		}
+		field3 L = laplacian(F);
+		double LaplacianError = 0.0;
+		for (std::size_t i = 0; i < L.size(); i++) {
+			LaplacianError = std::max(LaplacianError, (double)std::fabs(L[i] - 12.0f));
+		}
+		GEODESY_TEST_CHECK(LaplacianError < 1e-2);
+
+		field<float, 3, vec<float, 3>> G = grad(F);
+		field3 D = div(G);
+		double GradientError = 0.0, DivergenceError = 0.0;
+		for (std::size_t i = 0; i < F.size(); i++) {
+			vec<std::size_t, 3> Index = F.convert_to_dimensional_index(i);
+			vec<float, 3> P = F.convert_index_to_position(Index);
+			bool Interior = true;
+			for (std::size_t j = 0; j < 3; j++) {
+				Interior = Interior && (Index[j] > 1) && (Index[j] + 2 < F.ElementCount[j]);
+			}
+			if (!Interior) continue;
+			GradientError = std::max(GradientError, (double)std::fabs(G[i][0] - (2.0f * P[0] + P[1])));
+			GradientError = std::max(GradientError, (double)std::fabs(G[i][2] - 6.0f * P[2]));
+			DivergenceError = std::max(DivergenceError, (double)std::fabs(D[i] - 12.0f));
+		}
+		GEODESY_TEST_CHECK(GradientError < 1e-3);
+		GEODESY_TEST_CHECK(DivergenceError < 1e-2);
+
+		// Tiles must cover the grid exactly like a plain loop over every sample.
+		for (float& Value : F) Value = test::uniform(-1.0f, 1.0f);
+		field3 Tiled = laplacian(F), Naive = naive_laplacian(F);
+		double TileError = 0.0, Scale = 0.0;
+		for (std::size_t i = 0; i < F.size(); i++) {
+			TileError = std::max(TileError, (double)std::fabs(Tiled[i] - Naive[i]));
+			Scale = std::max(Scale, (double)std::fabs(Naive[i]));
+		}
+		GEODESY_TEST_CHECK(TileError <= 1e-5 * Scale);
+	}
+
+	// Rigid rotation (-y, x, 0) has curl (0, 0, 2).
+	{
+		field<float, 3, vec<float, 3>> V(vec<float, 3>{ -1.0f, -1.0f, -1.0f }, vec<float, 3>{ 1.0f, 1.0f, 1.0f }, vec<std::size_t, 3>{ 16, 17, 18 });
+		for (std::size_t i = 0; i < V.size(); i++) {
+			vec<float, 3> P = V.convert_index_to_position(V.convert_to_dimensional_index(i));
+			V[i] = vec<float, 3>(-P[1], P[0], 0.0f);
+		}
+		field<float, 3, vec<float, 3>> C = curl(V, stencil(stencil::FORWARD, stencil::ONE_SIDED));
+		double CurlError = 0.0;
+		for (const vec<float, 3>& Value : C) {
+			CurlError = std::max(CurlError, (double)(std::fabs(Value[0]) + std::fabs(Value[1]) + std::fabs(Value[2] - 2.0f)));
+		}
+		GEODESY_TEST_CHECK(CurlError < 1e-4);
+	}
+
+	// Periodic boundaries, the derivative of one period of sin wraps across the seam.
+	{
+		const std::size_t n = 1000;
+		field<float, 1, float> S(0.0f, (float)(n - 1) / (float)n, n);
+		for (std::size_t i = 0; i < n; i++) {
+			S[i] = std::sin(2.0f * 3.14159265f * (float)i / (float)n);
+		}
+		field<float, 1, vec<float, 1>> G = grad(S, stencil(stencil::CENTRAL, stencil::WRAP));
+		double WrapError = 0.0;
+		for (std::size_t i = 0; i < n; i++) {
+			WrapError = std::max(WrapError, std::fabs(G[i][0] - 2.0 * 3.14159265 * std::cos(2.0 * 3.14159265 * (double)i / (double)n)));
+		}
+		GEODESY_TEST_CHECK(WrapError < 1e-3);
+	}
+
+	// Axes too short for a difference contribute zero and read nothing past the grid.
+	for (stencil::boundary Boundary : { stencil::ONE_SIDED, stencil::CLAMP, stencil::WRAP, stencil::ZERO }) {
+		const stencil Stencil(stencil::CENTRAL, Boundary);
+		field<float, 2, float> F(vec<float, 2>{ 0.0f, 0.0f }, vec<float, 2>{ 1.0f, 1.0f }, vec<std::size_t, 2>{ 2, 8 });
+		for (std::size_t i = 0; i < F.size(); i++) {
+			vec<std::size_t, 2> Index = F.convert_to_dimensional_index(i);
+			const float y = (float)Index[1] / 7.0f;
+			F[i] = 100.0f * (float)Index[0] + y * y;
+		}
+		field<float, 2, float> L = laplacian(F, Stencil);
+		bool LaplacianFinite = true;
+		double LaplacianError = 0.0;
+		for (float Value : L) {
+			LaplacianFinite = LaplacianFinite && std::isfinite(Value);
+			LaplacianError = std::max(LaplacianError, (double)std::fabs(Value - 2.0f));
+		}
+		GEODESY_TEST_CHECK(LaplacianFinite);
+		if (Boundary == stencil::ONE_SIDED) {
+			GEODESY_TEST_CHECK(LaplacianError < 1e-3);
+		}
+
+		field<float, 2, float> Line(vec<float, 2>{ 0.0f, 0.0f }, vec<float, 2>{ 1.0f, 1.0f }, vec<std::size_t, 2>{ 1, 8 });
+		for (std::size_t i = 0; i < Line.size(); i++) {
+			Line[i] = 3.0f * (float)i / 7.0f;
+		}
+		field<float, 2, vec<float, 2>> G = grad(Line, Stencil);
+		bool GradientFinite = true;
+		double GradientError = 0.0;
+		for (std::size_t i = 0; i < G.size(); i++) {
+			GradientFinite = GradientFinite && std::isfinite(G[i][1]) && (G[i][0] == 0.0f);
+			GradientError = std::max(GradientError, (double)std::fabs(G[i][1] - 3.0f));
+		}
+		GEODESY_TEST_CHECK(GradientFinite);
+		if (Boundary == stencil::ONE_SIDED) {
+			GEODESY_TEST_CHECK(GradientError < 1e-4);
+		}
+	}
+
+	return test::result();
+}
@@ -0,0 +1,202 @@
+// Checks triangle_bvh and instance_bvh ray and sphere queries against brute force loops over
+// every triangle, and that packet traversal returns exactly what single rays return.
+
+#include <geodesy/core/phys/bvh.h>
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+using namespace geodesy::core::phys;
+
+typedef math::vec<float, 3> vec3;
+
+// Bumpy sphere of n x n quads, every triangle faces outward.
+static mesh bumpy_sphere(uint32_t n) {
+	mesh Mesh;
+	Mesh.Topology.Primitive = mesh::TRIANGLE;
+	Mesh.Vertex.resize((n + 1) * (n + 1));
+	for (uint32_t i = 0; i <= n; i++) {
+		for (uint32_t j = 0; j <= n; j++) {
+			const float Theta = 3.14159265f * (float)i / (float)n, Phi = 6.28318531f * (float)j / (float)n;
+			const float r = 1.0f + 0.05f * std::sin(7.0f * Theta) * std::cos(5.0f * Phi);
+			Mesh.Vertex[i * (n + 1) + j].Position = vec3(r * std::sin(Theta) * std::cos(Phi), r * std::sin(Theta) * std::sin(Phi), r * std::cos(Theta));
+		}
+	}
+	for (uint32_t i = 0; i < n; i++) {
+		for (uint32_t j = 0; j < n; j++) {
+			const uint32_t a = i * (n + 1) + j, b = a + 1, c = a + n + 1, d = c + 1;
+			for (uint32_t Index : { a, c, b, b, c, d }) {
+				Mesh.Topology.Data32.push_back(Index);
+			}
+		}
+	}
+	return Mesh;
+}
+
+static void corners(const mesh& aMesh, uint32_t aTriangle, vec3* aCorner) {
+	for (uint32_t k = 0; k < 3; k++) {
+		aCorner[k] = aMesh.Vertex[aMesh.Topology.Data32[3 * aTriangle + k]].Position;
+	}
+}
+
+// Moller-Trumbore, the distance of the hit in multiples of the ray direction.
+static bool intersect_triangle(const vec3* aCorner, const collision::ray& aRay, float& aDistance) {
+	const vec3 E1 = aCorner[1] - aCorner[0], E2 = aCorner[2] - aCorner[0];
+	const vec3 P = aRay.Direction ^ E2;
+	const float Determinant = E1 * P;
+	if (Determinant == 0.0f) return false;
+	const float Inverse = 1.0f / Determinant;
+	const vec3 T = aRay.Origin - aCorner[0];
+	const float u = (T * P) * Inverse;
+	if ((u < 0.0f) || (u > 1.0f)) return false;
+	const vec3 Q = T ^ E1;
+	const float v = (aRay.Direction * Q) * Inverse;
+	if ((v < 0.0f) || (u + v > 1.0f)) return false;
+	const float t = (E2 * Q) * Inverse;
+	if ((t < 0.0f) || (t > aRay.Length)) return false;
+	aDistance = t;
+	return true;
+}
+
+static float brute_closest(const mesh& aMesh, const collision::ray& aRay) {
+	float Best = std::numeric_limits<float>::infinity();
+	vec3 Corner[3];
+	for (uint32_t t = 0; t < aMesh.Topology.Data32.size() / 3; t++) {
+		corners(aMesh, t, Corner);
+		float Distance;
+		if (intersect_triangle(Corner, aRay, Distance)) Best = std::min(Best, Distance);
+	}
+	return Best;
+}
+
+// Squared distance from a point to a triangle, by the Voronoi regions of its corners and edges.
+static float distance2(const vec3* aCorner, const vec3& aPoint) {
+	const vec3 AB = aCorner[1] - aCorner[0], AC = aCorner[2] - aCorner[0], AP = aPoint - aCorner[0];
+	const float d1 = AB * AP, d2 = AC * AP;
+	vec3 Closest;
+	if ((d1 <= 0.0f) && (d2 <= 0.0f)) {
+		Closest = aCorner[0];
+	}
+	else {
+		const vec3 BP = aPoint - aCorner[1], CP = aPoint - aCorner[2];
+		const float d3 = AB * BP, d4 = AC * BP, d5 = AB * CP, d6 = AC * CP;
+		const float va = d3 * d6 - d5 * d4, vb = d5 * d2 - d1 * d6, vc = d1 * d4 - d3 * d2;
+		if ((d3 >= 0.0f) && (d4 <= d3)) 							Closest = aCorner[1];
+		else if ((d6 >= 0.0f) && (d5 <= d6)) 						Closest = aCorner[2];
+		else if ((vc <= 0.0f) && (d1 >= 0.0f) && (d3 <= 0.0f)) 		Closest = aCorner[0] + AB * (d1 / (d1 - d3));
+		else if ((vb <= 0.0f) && (d2 >= 0.0f) && (d6 <= 0.0f)) 		Closest = aCorner[0] + AC * (d2 / (d2 - d6));
+		else if ((va <= 0.0f) && (d4 - d3 >= 0.0f) && (d5 - d6 >= 0.0f)) {
+			Closest = aCorner[1] + (aCorner[2] - aCorner[1]) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		}
+		else {
+			const float Denominator = 1.0f / (va + vb + vc);
+			Closest = aCorner[0] + AB * (vb * Denominator) + AC * (vc * Denominator);
+		}
+	}
+	const vec3 Gap = Closest - aPoint;
+	return Gap * Gap;
+}
+
+static vec3 random_vector(float aMin, float aMax) {
+	return vec3(test::uniform(aMin, aMax), test::uniform(aMin, aMax), test::uniform(aMin, aMax));
+}
+
+int main() {
+	const mesh Mesh = bumpy_sphere(40);
+	const uint32_t TriangleCount = (uint32_t)(Mesh.Topology.Data32.size() / 3);
+	const float Infinity = std::numeric_limits<float>::max();
+
+	// Incoherent rays from inside and outside the surface, every third of bounded length.
+	std::vector<collision::ray> Ray;
+	for (int q = 0; q < 2000; q++) {
+		Ray.push_back(collision::ray(random_vector(-3.0f, 3.0f), random_vector(-1.0f, 1.0f), (q % 3 == 0) ? 1.0f : Infinity));
+	}
+	// A coherent packet, all rays head into the same octant.
+	for (int y = 0; y < 16; y++) {
+		for (int x = 0; x < 16; x++) {
+			Ray.push_back(collision::ray(vec3(0.1f, 0.05f, -3.0f), vec3((float)(x - 8) / 16.0f, (float)(y - 8) / 16.0f, 1.0f)));
+		}
+	}
+
+	{
+		collision::triangle_bvh Tree(Mesh);
+		std::vector<collision::hit> Packet = Tree.intersect(Ray);
+		std::vector<uint8_t> PacketOccluded = Tree.occluded(Ray);
+		int ClosestMismatch = 0, PacketMismatch = 0, OcclusionMismatch = 0, Hits = 0;
+		for (std::size_t q = 0; q < Ray.size(); q++) {
+			const float Expected = brute_closest(Mesh, Ray[q]);
+			const collision::hit Hit = Tree.intersect(Ray[q]);
+			Hits += Hit.found();
+			ClosestMismatch += (Hit.found() != std::isfinite(Expected)) || (Hit.found() && (std::fabs(Hit.Distance - Expected) > 1e-5f * std::max(1.0f, Expected)));
+			PacketMismatch += (Packet[q].found() != Hit.found()) || (Hit.found() && ((Packet[q].Distance != Hit.Distance) || (Packet[q].Triangle != Hit.Triangle)));
+			OcclusionMismatch += (Tree.occluded(Ray[q]) != Hit.found()) || ((PacketOccluded[q] != 0) != Hit.found());
+		}
+		std::printf("triangle_bvh: %u triangles, %d of %zu rays hit\n", TriangleCount, Hits, Ray.size());
+		GEODESY_TEST_CHECK(Hits > 0);
+		GEODESY_TEST_CHECK(ClosestMismatch == 0);
+		GEODESY_TEST_CHECK(PacketMismatch == 0);
+		GEODESY_TEST_CHECK(OcclusionMismatch == 0);
+
+		// Triangles clearly inside the sphere are reported, triangles clearly outside are not.
+		int OverlapMismatch = 0;
+		for (int q = 0; q < 200; q++) {
+			const vec3 Centre = random_vector(-1.3f, 1.3f);
+			const float Radius = test::uniform(0.05f, 0.25f);
+			std::vector<uint32_t> Found = Tree.overlap(Centre, Radius);
+			std::sort(Found.begin(), Found.end());
+			vec3 Corner[3];
+			for (uint32_t t = 0; t < TriangleCount; t++) {
+				corners(Mesh, t, Corner);
+				const float Distance2 = distance2(Corner, Centre);
+				const bool Reported = std::binary_search(Found.begin(), Found.end(), t);
+				if (Distance2 < Radius * Radius * 0.999f) OverlapMismatch += !Reported;
+				if (Distance2 > Radius * Radius * 1.001f) OverlapMismatch += Reported;
+			}
+		}
+		GEODESY_TEST_CHECK(OverlapMismatch == 0);
+	}
+
+	// Sheared and scaled instances sharing one mesh hierarchy.
+	{
+		auto Shared = std::make_shared<collision::triangle_bvh>(Mesh);
+		std::vector<collision::instance_bvh::instance> Instance;
+		for (int i = 0; i < 20; i++) {
+			math::affine<float> Transform(random_vector(-5.0f, 5.0f), normalize(math::quaternion<float>(1.0f, test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f), test::uniform(-1.0f, 1.0f))), random_vector(0.5f, 1.5f));
+			Transform.Linear(0, 1) += 0.3f;
+			Instance.push_back(collision::instance_bvh::instance(Shared, Transform));
+		}
+		collision::instance_bvh Scene;
+		Scene.build(Instance);
+
+		std::vector<collision::ray> SceneRay;
+		for (int q = 0; q < 1000; q++) {
+			SceneRay.push_back(collision::ray(random_vector(-7.0f, 7.0f), random_vector(-1.0f, 1.0f), (q % 4 == 0) ? 2.0f : Infinity));
+		}
+		std::vector<collision::hit> Packet = Scene.intersect(SceneRay);
+		int ClosestMismatch = 0, PacketMismatch = 0, OcclusionMismatch = 0;
+		for (std::size_t q = 0; q < SceneRay.size(); q++) {
+			// Distances along the ray are the same in mesh space, since the direction is carried along.
+			float Expected = std::numeric_limits<float>::infinity();
+			for (const auto& I : Instance) {
+				const math::affine<float> Inverse = math::inverse(I.Transform);
+				Expected = std::min(Expected, brute_closest(Mesh, collision::ray(Inverse.transform_point(SceneRay[q].Origin), Inverse.transform_vector(SceneRay[q].Direction), SceneRay[q].Length)));
+			}
+			const collision::hit Hit = Scene.intersect(SceneRay[q]);
+			ClosestMismatch += (Hit.found() != std::isfinite(Expected)) || (Hit.found() && (std::fabs(Hit.Distance - Expected) > 1e-4f * std::max(1.0f, Expected)));
+			PacketMismatch += (Packet[q].found() != Hit.found()) || (Hit.found() && (std::fabs(Packet[q].Distance - Hit.Distance) > 1e-6f * std::max(1.0f, Hit.Distance)));
+			OcclusionMismatch += (Scene.occluded(SceneRay[q]) != Hit.found());
+		}
+		GEODESY_TEST_CHECK(ClosestMismatch == 0);
+		GEODESY_TEST_CHECK(PacketMismatch == 0);
+		GEODESY_TEST_CHECK(OcclusionMismatch == 0);
+	}
+
+	return test::result();
+}
@@ -0,0 +1,56 @@
+// Checks that convex_hull keeps only the corners of degenerate and lattice inputs, flat grids
+// in and out of the axis planes, a line of points and a cube lattice.
+
+#include <geodesy/core/phys/convex_hull.h>
+
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+
+typedef math::vec<float, 3> vec3;
+
+int main() {
+	// A 20 x 20 grid in the z = 0 plane and in a tilted plane, neither keeps its edge points.
+	for (bool Tilted : { false, true }) {
+		std::vector<vec3> Point;
+		for (int i = 0; i < 20; i++) {
+			for (int j = 0; j < 20; j++) {
+				Point.push_back(Tilted ? vec3(0.6f * (float)i, (float)j, 0.8f * (float)i) : vec3((float)i, (float)j, 0.0f));
+			}
+		}
+		std::shared_ptr<phys::mesh> Hull = phys::collision::convex_hull(Point);
+		GEODESY_TEST_CHECK(Hull->Vertex.size() == 4);
+		// Both windings of the two fan triangles.
+		GEODESY_TEST_CHECK(Hull->Topology.Data16.size() == 12);
+	}
+
+	// Points along a line reduce to its two ends.
+	{
+		std::vector<vec3> Point;
+		for (int i = 0; i < 50; i++) {
+			Point.push_back(vec3(0.1f * (float)i, 0.2f * (float)i, -0.3f * (float)i));
+		}
+		std::shared_ptr<phys::mesh> Hull = phys::collision::convex_hull(Point);
+		GEODESY_TEST_CHECK(Hull->Topology.Primitive == phys::mesh::LINE);
+		GEODESY_TEST_CHECK(Hull->Vertex.size() == 2);
+	}
+
+	// A 6 x 6 x 6 lattice is a cube.
+	{
+		std::vector<vec3> Point;
+		for (int i = 0; i < 6; i++) {
+			for (int j = 0; j < 6; j++) {
+				for (int k = 0; k < 6; k++) {
+					Point.push_back(vec3((float)i, (float)j, (float)k));
+				}
+			}
+		}
+		std::shared_ptr<phys::mesh> Hull = phys::collision::convex_hull(Point);
+		GEODESY_TEST_CHECK(Hull->Vertex.size() == 8);
+	}
+
+	return test::result();
+}
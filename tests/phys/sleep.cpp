@@ -0,0 +1,157 @@
+// Checks that a sleeping body wakes on the first step an animated node moves into it, and
+// that rolling back and resimulating reproduces the original sleep states, which depend on
+// the poses the solver keeps of the nodes it does not simulate.
+
+#include <geodesy/core/phys/node.h>
+#include <geodesy/core/phys/collision.h>
+#include <geodesy/core/phys/narrow_phase.h>
+#include <geodesy/core/phys/solver.h>
+#include <geodesy/core/phys/snapshot.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+
+typedef math::vec<float, 3> vec3;
+
+static std::shared_ptr<phys::mesh> box(float aX, float aY, float aZ) {
+	static const int Face[6][4][3] = {
+		{ { -1, -1, -1 }, { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 } },
+		{ { -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 } },
+		{ { -1, -1, -1 }, { 1, -1, -1 }, { 1, -1, 1 }, { -1, -1, 1 } },
+		{ { -1, 1, -1 }, { -1, 1, 1 }, { 1, 1, 1 }, { 1, 1, -1 } },
+		{ { -1, -1, -1 }, { -1, -1, 1 }, { -1, 1, 1 }, { -1, 1, -1 } },
+		{ { 1, -1, -1 }, { 1, 1, -1 }, { 1, 1, 1 }, { 1, -1, 1 } },
+	};
+	auto Mesh = std::make_shared<phys::mesh>();
+	Mesh->Topology.Primitive = phys::mesh::TRIANGLE;
+	for (int i = 0; i < 6; i++) {
+		for (int k = 0; k < 4; k++) {
+			phys::mesh::vertex Vertex;
+			Vertex.Position = vec3(Face[i][k][0] * aX, Face[i][k][1] * aY, Face[i][k][2] * aZ);
+			Mesh->Vertex.push_back(Vertex);
+		}
+		for (uint16_t Index : { 0, 1, 2, 0, 2, 3 }) {
+			Mesh->Topology.Data16.push_back((uint16_t)(4 * i + Index));
+		}
+	}
+	Mesh->CenterOfMass 		= vec3(0.0f, 0.0f, 0.0f);
+	Mesh->BoundingRadius 	= vec3(aX, aY, aZ);
+	return Mesh;
+}
+
+// The step of a stage without the graphics, every node is a root so its pose is its transform.
+struct world {
+	std::vector<std::unique_ptr<phys::node>> 				Storage;
+	std::vector<phys::node*> 								Node;
+	std::shared_ptr<phys::collision::broad_phase> 			BroadPhase = phys::collision::broad_phase::create(phys::collision::broad_phase::DYNAMIC_TREE);
+	phys::collision::narrow_phase 							NarrowPhase;
+	phys::dynamics 											Dynamics;
+	phys::solver 											Solver;
+
+	phys::node* add(const vec3& aPosition, const std::shared_ptr<phys::mesh>& aMesh, phys::node::motion aMotion) {
+		Storage.emplace_back(new phys::node());
+		phys::node* N = Storage.back().get();
+		N->CollisionMesh = aMesh;
+		N->Position = aPosition;
+		N->MotionType = aMotion;
+		if (aMotion == phys::node::DYNAMIC) {
+			const float Inertia = 4.0f * aMesh->BoundingRadius[0] * aMesh->BoundingRadius[0] / 6.0f;
+			N->GravityEnabled 	= true;
+			N->Mass 			= 1.0f;
+			N->InertiaTensor 	= {
+				Inertia, 0.0f, 0.0f,
+				0.0f, Inertia, 0.0f,
+				0.0f, 0.0f, Inertia
+			};
+		}
+		Node.push_back(N);
+		return N;
+	}
+
+	void step(double aDeltaTime) {
+		for (phys::node* N : Node) {
+			N->CurrentTransform = phys::calculate_transform(N->Position, N->Orientation, N->Scale);
+			N->GlobalTransform = N->CurrentTransform;
+		}
+		BroadPhase->update(Node);
+		std::vector<phys::collision::manifold> Contact = NarrowPhase.collide(BroadPhase->find_pairs());
+		Solver.update(Dynamics, Node, Contact, aDeltaTime);
+		NarrowPhase.store(Contact);
+	}
+};
+
+int main() {
+	const double DeltaTime = 1.0 / 60.0;
+
+	// A paddle far from a resting cube moves into it in one step.
+	{
+		world World;
+		World.add(vec3(0.0f, 0.0f, -0.5f), box(10.0f, 10.0f, 0.5f), phys::node::STATIC);
+		phys::node* Cube = World.add(vec3(0.0f, 0.0f, 0.5f), box(0.5f, 0.5f, 0.5f), phys::node::DYNAMIC);
+		phys::node* Paddle = World.add(vec3(3.0f, 0.0f, 0.5f), box(0.5f, 0.5f, 0.5f), phys::node::ANIMATED);
+		for (int Frame = 0; (Frame < 300) && !Cube->Sleeping; Frame++) {
+			World.step(DeltaTime);
+		}
+		if (GEODESY_TEST_CHECK(Cube->Sleeping)) {
+			Paddle->Position = vec3(Cube->Position[0] + 0.99f, 0.0f, 0.5f);
+			World.step(DeltaTime);
+			GEODESY_TEST_CHECK(!Cube->Sleeping);
+		}
+	}
+
+	// The paddle rests against a sleeping cube, then pulls away. Replaying from while it still
+	// rests there must not wake the cube against where the paddle ended up.
+	{
+		world World;
+		World.add(vec3(0.0f, 0.0f, -0.5f), box(10.0f, 10.0f, 0.5f), phys::node::STATIC);
+		phys::node* Cube = World.add(vec3(0.0f, 0.0f, 0.5f), box(0.5f, 0.5f, 0.5f), phys::node::DYNAMIC);
+		phys::node* Paddle = World.add(vec3(1.0f, 0.0f, 0.5f), box(0.5f, 0.5f, 0.5f), phys::node::ANIMATED);
+		phys::snapshot History(32);
+		double Time = 0.0;
+		for (int Frame = 0; (Frame < 300) && !Cube->Sleeping; Frame++) {
+			World.step(DeltaTime);
+			Time += DeltaTime;
+			History.save(World.Node, Time, DeltaTime, World.Dynamics, World.Solver, World.NarrowPhase);
+		}
+		GEODESY_TEST_CHECK(Cube->Sleeping);
+
+		// The paddle's input, at rest for five frames and then moving away.
+		const float Rest = Paddle->Position[0];
+		auto input = [&](int aFrame) {
+			Paddle->Position[0] = aFrame < 5 ? Rest : Rest + 0.5f * (float)(aFrame - 4);
+		};
+		std::vector<std::vector<phys::snapshot::state>> Reference;
+		for (int Frame = 0; Frame < 10; Frame++) {
+			input(Frame);
+			World.step(DeltaTime);
+			Time += DeltaTime;
+			History.save(World.Node, Time, DeltaTime, World.Dynamics, World.Solver, World.NarrowPhase);
+			Reference.emplace_back();
+			for (phys::node* N : World.Node) {
+				Reference.back().push_back({ N->Position, N->Orientation, N->Scale, N->LinearMomentum, N->AngularMomentum, N->IdleTime, N->Sleeping ? 1u : 0u, N->GlobalTransform });
+			}
+		}
+		Time = History.restore(10, World.Dynamics, World.Solver, World.NarrowPhase);
+		int Mismatch = 0;
+		for (int Frame = 0; Frame < 10; Frame++) {
+			input(Frame);
+			World.step(DeltaTime);
+			Time += DeltaTime;
+			History.save(World.Node, Time, DeltaTime, World.Dynamics, World.Solver, World.NarrowPhase);
+			for (std::size_t n = 0; n < World.Node.size(); n++) {
+				const phys::node* N = World.Node[n];
+				const phys::snapshot::state& S = Reference[Frame][n];
+				Mismatch += (N->Sleeping != (S.Sleeping != 0)) || (std::memcmp(&N->Position, &S.Position, sizeof(vec3)) != 0) || (std::memcmp(&N->LinearMomentum, &S.LinearMomentum, sizeof(vec3)) != 0);
+			}
+		}
+		GEODESY_TEST_CHECK(Mismatch == 0);
+	}
+
+	return test::result();
+}
@@ -0,0 +1,79 @@
+// Checks spatial_hash radius and box queries and the neighbour lists against linear scans,
+// for radii below and above the cell size.
+
+#include <geodesy/core/phys/spatial_hash.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+
+typedef math::vec<float, 3> vec3;
+
+static vec3 random_vector(float aMin, float aMax) {
+	return vec3(test::uniform(aMin, aMax), test::uniform(aMin, aMax), test::uniform(aMin, aMax));
+}
+
+int main() {
+	std::vector<vec3> Point(4000);
+	for (vec3& P : Point) P = random_vector(-5.0f, 5.0f);
+	// Negative coordinates, a cell boundary and duplicates.
+	Point[0] = vec3(0.0f, 0.0f, 0.0f);
+	Point[1] = vec3(0.7f, -0.7f, 1.4f);
+	Point[2] = Point[3];
+
+	phys::spatial_hash Grid(0.7f);
+	Grid.build(Point);
+	GEODESY_TEST_CHECK(Grid.size() == Point.size());
+
+	int RadiusMismatch = 0, BoxMismatch = 0;
+	for (int q = 0; q < 300; q++) {
+		const vec3 Centre = random_vector(-5.5f, 5.5f);
+		const float Radius = 0.1f + 0.005f * (float)q;
+
+		std::vector<uint32_t> Found = Grid.query(Centre, Radius), Expected;
+		for (uint32_t i = 0; i < Point.size(); i++) {
+			const vec3 d = Point[i] - Centre;
+			if (d * d <= Radius * Radius) Expected.push_back(i);
+		}
+		std::sort(Found.begin(), Found.end());
+		RadiusMismatch += (Found != Expected);
+
+		const phys::collision::aabb Box(Centre - vec3(Radius, Radius, 2.0f * Radius), Centre + vec3(Radius, Radius, Radius));
+		std::vector<uint32_t> FoundBox = Grid.query(Box), ExpectedBox;
+		for (uint32_t i = 0; i < Point.size(); i++) {
+			bool Inside = true;
+			for (int k = 0; k < 3; k++) {
+				Inside = Inside && (Point[i][k] >= Box.Min[k]) && (Point[i][k] <= Box.Max[k]);
+			}
+			if (Inside) ExpectedBox.push_back(i);
+		}
+		std::sort(FoundBox.begin(), FoundBox.end());
+		BoxMismatch += (FoundBox != ExpectedBox);
+	}
+	GEODESY_TEST_CHECK(RadiusMismatch == 0);
+	GEODESY_TEST_CHECK(BoxMismatch == 0);
+
+	// Neighbour lists hold every point within the radius except the point itself.
+	for (float Radius : { 0.4f, 0.7f, 1.1f }) {
+		std::vector<uint32_t> Offset, Neighbour;
+		Grid.neighbours(Radius, Offset, Neighbour);
+		GEODESY_TEST_CHECK(Offset.size() == Point.size() + 1);
+		int ListMismatch = 0;
+		for (uint32_t i = 0; i < Point.size(); i++) {
+			std::vector<uint32_t> Found(Neighbour.begin() + Offset[i], Neighbour.begin() + Offset[i + 1]), Expected;
+			for (uint32_t j = 0; j < Point.size(); j++) {
+				const vec3 d = Point[j] - Point[i];
+				if ((j != i) && (d * d <= Radius * Radius)) Expected.push_back(j);
+			}
+			std::sort(Found.begin(), Found.end());
+			ListMismatch += (Found != Expected);
+		}
+		GEODESY_TEST_CHECK(ListMismatch == 0);
+	}
+
+	return test::result();
+}
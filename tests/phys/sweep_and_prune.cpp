@@ -0,0 +1,119 @@
+// Checks that both sweep and prune variants report exactly the pairs of a brute force overlap
+// test, while bodies move, teleport, join and leave the list, and that the work item ranges
+// handed to threads concatenate to find_pairs().
+
+#include <geodesy/core/phys/node.h>
+#include <geodesy/core/phys/collision.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "test.h"
+
+using namespace geodesy;
+using namespace geodesy::core;
+
+typedef std::vector<std::pair<phys::node*, phys::node*>> pair_list;
+
+static pair_list sorted(pair_list aPair) {
+	for (auto& P : aPair) {
+		if (P.second < P.first) std::swap(P.first, P.second);
+	}
+	std::sort(aPair.begin(), aPair.end());
+	return aPair;
+}
+
+static pair_list brute_force(const std::vector<phys::node*>& aNode) {
+	std::vector<phys::collision::aabb> Box(aNode.size());
+	for (std::size_t i = 0; i < aNode.size(); i++) {
+		if (aNode[i]->CollisionMesh != nullptr) Box[i] = phys::collision::bounds(aNode[i]);
+	}
+	pair_list Out;
+	for (std::size_t i = 0; i < aNode.size(); i++) {
+		if (aNode[i]->CollisionMesh == nullptr) continue;
+		for (std::size_t j = i + 1; j < aNode.size(); j++) {
+			if (aNode[j]->CollisionMesh == nullptr) continue;
+			if (aNode[i]->Root == aNode[j]->Root) continue;
+			if (Box[i].overlaps(Box[j])) Out.emplace_back(aNode[i], aNode[j]);
+		}
+	}
+	return sorted(Out);
+}
+
+static math::vec<float, 3> random_vector(float aMin, float aMax) {
+	return math::vec<float, 3>(test::uniform(aMin, aMax), test::uniform(aMin, aMax), test::uniform(aMin, aMax));
+}
+
+int main() {
+	const std::size_t Count = 3000;
+	const float Side = 120.0f;
+
+	auto Mesh = std::make_shared<phys::mesh>();
+	Mesh->CenterOfMass 		= { 0.0f, 0.0f, 0.0f };
+	Mesh->BoundingRadius 	= { 1.0f, 0.0f, 0.0f };
+
+	std::vector<std::unique_ptr<phys::node>> Storage;
+	std::vector<phys::node*> Node;
+	std::vector<math::vec<float, 3>> Velocity;
+	for (std::size_t i = 0; i < Count; i++) {
+		Storage.emplace_back(new phys::node());
+		phys::node* N = Storage.back().get();
+		// Every tenth node carries no collision mesh, every seventh belongs to the object before it.
+		if (i % 10 != 9) N->CollisionMesh = Mesh;
+		if ((i % 7 == 6) && (i > 0)) N->Root = Node.back()->Root;
+		const float s = test::uniform(0.5f, 2.5f);
+		N->GlobalTransform = math::affine<float>(random_vector(0.0f, Side), math::quaternion<float>(1.0f, 0.0f, 0.0f, 0.0f), math::vec<float, 3>(s, s, s));
+		Node.push_back(N);
+		Velocity.push_back(random_vector(-0.3f, 0.3f));
+	}
+
+	std::vector<std::shared_ptr<phys::collision::broad_phase>> BroadPhase = {
+		std::make_shared<phys::collision::sweep_and_prune>(phys::collision::sweep_and_prune::X),
+		std::make_shared<phys::collision::sweep_and_prune>(phys::collision::sweep_and_prune::ALL),
+	};
+	const char* Name[] = { "sweep_and_prune X", "sweep_and_prune ALL" };
+
+	std::vector<phys::node*> Listed = Node;
+	for (int Step = 0; Step < 30; Step++) {
+		for (std::size_t i = 0; i < Count; i++) {
+			Node[i]->GlobalTransform.Translation += Velocity[i];
+		}
+		// Teleports leave the fattened boxes, the list shrinks and grows again.
+		if (Step % 5 == 2) {
+			for (std::size_t i = 0; i < Count; i += 37) {
+				Node[i]->GlobalTransform.Translation = random_vector(0.0f, Side);
+			}
+		}
+		if (Step == 10) {
+			Listed.clear();
+			for (std::size_t i = 0; i < Count; i++) {
+				if (i % 3 != 0) Listed.push_back(Node[i]);
+			}
+		}
+		if (Step == 20) {
+			Listed = Node;
+			std::reverse(Listed.begin(), Listed.end());
+		}
+
+		const pair_list Reference = brute_force(Listed);
+		for (std::size_t b = 0; b < BroadPhase.size(); b++) {
+			BroadPhase[b]->update(Listed);
+			const pair_list Pair = BroadPhase[b]->find_pairs();
+			if (!GEODESY_TEST_CHECK(sorted(Pair) == Reference)) {
+				std::printf("%s: step %d, %zu pairs, expected %zu\n", Name[b], Step, Pair.size(), Reference.size());
+			}
+
+			// Any split of the work items into ranges reproduces find_pairs() in order.
+			const std::size_t Work = BroadPhase[b]->work_count();
+			const std::size_t Chunk = 1 + Work / 5;
+			pair_list Ranged;
+			for (std::size_t Start = 0; Start < Work; Start += Chunk) {
+				BroadPhase[b]->find_pairs(Start, std::min(Chunk, Work - Start), Ranged);
+			}
+			GEODESY_TEST_CHECK(Ranged == Pair);
+		}
+	}
+
+	return test::result();
+}
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef GEODESY_TESTS_TEST_H
+#define GEODESY_TESTS_TEST_H
+
+// ------------------------------ test.h ------------------------------ //
+/*
+Helpers shared by the unit tests and benchmark drivers. Every test is a plain
+executable registered with CTest, a failed check prints the expression and its
+location, and result() turns the failures into the exit code CTest looks at.
+Benchmarks time with timer and print their own tables.
+// Example usage:
+GEODESY_TEST_CHECK(Error < 1e-6);
+return test::result();
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace geodesy::test {
+
+	inline int& failure_count() {
+		static int Count = 0;
+		return Count;
+	}
+
+	inline bool check(bool aCondition, const char* aExpression, const char* aFile, int aLine) {
+		if (!aCondition) {
+			std::printf("%s:%d: check failed: %s\n", aFile, aLine, aExpression);
+			failure_count()++;
+		}
+		return aCondition;
+	}
+
+	// Exit code of a test executable, zero if every check passed.
+	inline int result() {
+		if (failure_count() > 0) {
+			std::printf("%d check(s) failed\n", failure_count());
+			return 1;
+		}
+		std::printf("all checks passed\n");
+		return 0;
+	}
+
+	// Fixed seed generator so every run of a test sees the same data.
+	inline std::mt19937& random_engine() {
+		static std::mt19937 Engine(20240601u);
+		return Engine;
+	}
+
+	inline float uniform(float aMin, float aMax) {
+		return std::uniform_real_distribution<float>(aMin, aMax)(random_engine());
+	}
+
+	// Wall clock time since construction or the last reset().
+	class timer {
+	public:
+
+		timer() { this->reset(); }
+
+		void reset() {
+			Start = std::chrono::steady_clock::now();
+		}
+
+		double milliseconds() const {
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+		}
+
+	private:
+
+		std::chrono::steady_clock::time_point Start;
+
+	};
+
+	// Average milliseconds of aRepeat calls of aFunction, after one untimed warm up call.
+	template <typename F> inline
+	double time_average(int aRepeat, F aFunction) {
+		aFunction();
+		timer Timer;
+		for (int i = 0; i < aRepeat; i++) {
+			aFunction();
+		}
+		return Timer.milliseconds() / (double)aRepeat;
+	}
+
+}
+
+#define GEODESY_TEST_CHECK(aCondition) ::geodesy::test::check((aCondition), #aCondition, __FILE__, __LINE__)
+
+#endif // !GEODESY_TESTS_TEST_H